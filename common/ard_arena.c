@@ -0,0 +1,185 @@
+/*****************************************************************************
+FILE: ard_arena.c
+  
+PURPOSE: Contains functions for the arena (block) allocator.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+*****************************************************************************/
+
+#include <string.h>
+#include <stdint.h>
+#include "ard_arena.h"
+
+/* Size of the block header, rounded up so the data is aligned */
+#define ARD_ARENA_HEADER \
+    ((sizeof (Ard_arena_block_t) + ARD_ARENA_ALIGN - 1) & \
+     ~((size_t) ARD_ARENA_ALIGN - 1))
+
+/******************************************************************************
+MODULE:  init_ard_arena
+
+PURPOSE:  Initializes the arena.  No memory is allocated until the first
+allocation from the arena.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+******************************************************************************/
+void init_ard_arena
+(
+    Ard_arena_t *arena,   /* O: arena to be initialized */
+    size_t block_size     /* I: size of each block (bytes); 0 for the
+                                default ARD_ARENA_BLOCK_SIZE */
+)
+{
+    arena->head = NULL;
+    arena->block_size = (block_size > 0) ? block_size : ARD_ARENA_BLOCK_SIZE;
+    arena->total = 0;
+}
+
+
+/******************************************************************************
+MODULE:  ard_arena_calloc
+
+PURPOSE:  Allocates zeroed memory for nmemb elements of size bytes from the
+arena.
+
+RETURN VALUE:
+Type = void *
+Value           Description
+-----           -----------
+NULL            Error allocating the memory
+non-NULL        Pointer to the allocated memory
+
+NOTES:
+  1. The memory is aligned to ARD_ARENA_ALIGN bytes and remains valid until
+     the arena is reset or freed.  It must not be passed to free.
+  2. Requests larger than the block size get a block of their own.
+******************************************************************************/
+void *ard_arena_calloc
+(
+    Ard_arena_t *arena,   /* I/O: arena to allocate from */
+    size_t nmemb,         /* I: number of elements */
+    size_t size           /* I: size of each element (bytes) */
+)
+{
+    size_t nbytes;               /* number of bytes to allocate */
+    size_t bsize;                /* size of a new block */
+    Ard_arena_block_t *block = NULL;  /* block to allocate from */
+    char *ptr = NULL;            /* pointer to the allocated memory */
+
+    /* Check for overflow, then round up to the alignment */
+    if (size != 0 && nmemb > SIZE_MAX / size)
+        return (NULL);
+    nbytes = nmemb * size;
+    if (nbytes > SIZE_MAX - ARD_ARENA_HEADER - ARD_ARENA_ALIGN)
+        return (NULL);
+    nbytes = (nbytes + ARD_ARENA_ALIGN - 1) & ~((size_t) ARD_ARENA_ALIGN - 1);
+    if (nbytes == 0)
+        nbytes = ARD_ARENA_ALIGN;
+
+    /* Start a new block if the current block doesn't have room */
+    block = arena->head;
+    if (block == NULL || block->size - block->used < nbytes)
+    {
+        bsize = (nbytes > arena->block_size) ? nbytes : arena->block_size;
+        block = malloc (ARD_ARENA_HEADER + bsize);
+        if (block == NULL)
+            return (NULL);
+        block->size = bsize;
+        block->used = 0;
+
+        /* A block of its own for a large request goes behind the current
+           block so the space left in the current block can still be used */
+        if (nbytes > arena->block_size && arena->head != NULL)
+        {
+            block->next = arena->head->next;
+            arena->head->next = block;
+        }
+        else
+        {
+            block->next = arena->head;
+            arena->head = block;
+        }
+    }
+
+    ptr = (char *) block + ARD_ARENA_HEADER + block->used;
+    block->used += nbytes;
+    arena->total += nbytes;
+    memset (ptr, 0, nbytes);
+
+    return (ptr);
+}
+
+
+/******************************************************************************
+MODULE:  reset_ard_arena
+
+PURPOSE:  Releases all the allocations from the arena, keeping the current
+block for reuse.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+  1. All the memory previously allocated from the arena becomes invalid.
+******************************************************************************/
+void reset_ard_arena
+(
+    Ard_arena_t *arena    /* I/O: arena to be reset */
+)
+{
+    Ard_arena_block_t *block = NULL;  /* current block */
+    Ard_arena_block_t *next = NULL;   /* next block */
+
+    if (arena->head == NULL)
+        return;
+
+    /* Free all but the current block */
+    for (block = arena->head->next; block != NULL; block = next)
+    {
+        next = block->next;
+        free (block);
+    }
+
+    arena->head->next = NULL;
+    arena->head->used = 0;
+    arena->total = 0;
+}
+
+
+/******************************************************************************
+MODULE:  free_ard_arena
+
+PURPOSE:  Frees all the memory in the arena.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+  1. All the memory previously allocated from the arena becomes invalid.  The
+     arena may be used again afterwards.
+******************************************************************************/
+void free_ard_arena
+(
+    Ard_arena_t *arena    /* I/O: arena to be freed */
+)
+{
+    Ard_arena_block_t *block = NULL;  /* current block */
+    Ard_arena_block_t *next = NULL;   /* next block */
+
+    for (block = arena->head; block != NULL; block = next)
+    {
+        next = block->next;
+        free (block);
+    }
+
+    arena->head = NULL;
+    arena->total = 0;
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+FILE: ard_arena.h
+  
+PURPOSE: Contains defines and structures for the arena (block) allocator
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. An arena hands out memory from large blocks.  The memory isn't freed
+   individually; the whole arena is released at once via reset_ard_arena or
+   free_ard_arena, regardless of the number of allocations.
+2. An arena isn't thread-safe.  Each thread should use its own arena.
+*****************************************************************************/
+
+#ifndef ARD_ARENA_H_
+#define ARD_ARENA_H_
+
+#include <stdlib.h>
+
+/* Defines */
+/* Default size of each arena block (bytes) */
+#define ARD_ARENA_BLOCK_SIZE 262144
+
+/* Alignment of each allocation from the arena (bytes) */
+#define ARD_ARENA_ALIGN 16
+
+/* Block of memory in the arena */
+typedef struct Ard_arena_block
+{
+    struct Ard_arena_block *next;  /* next (previously filled) block */
+    size_t size;                   /* number of bytes available in the block */
+    size_t used;                   /* number of bytes used in the block */
+} Ard_arena_block_t;
+
+typedef struct
+{
+    Ard_arena_block_t *head;  /* current block; NULL if nothing allocated */
+    size_t block_size;        /* size of each new block (bytes) */
+    size_t total;             /* total bytes allocated from the arena */
+} Ard_arena_t;
+
+/* Prototypes */
+void init_ard_arena
+(
+    Ard_arena_t *arena,   /* O: arena to be initialized */
+    size_t block_size     /* I: size of each block (bytes); 0 for the
+                                default ARD_ARENA_BLOCK_SIZE */
+);
+
+void *ard_arena_calloc
+(
+    Ard_arena_t *arena,   /* I/O: arena to allocate from */
+    size_t nmemb,         /* I: number of elements */
+    size_t size           /* I: size of each element (bytes) */
+);
+
+void reset_ard_arena
+(
+    Ard_arena_t *arena    /* I/O: arena to be reset */
+);
+
+void free_ard_arena
+(
+    Ard_arena_t *arena    /* I/O: arena to be freed */
+);
+
+#endif
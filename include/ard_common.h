@@ -0,0 +1,29 @@
+/*****************************************************************************
+FILE: ard_common.h
+  
+PURPOSE: Contains ARD common defines
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+*****************************************************************************/
+
+#ifndef ARD_COMMON_H_
+#define ARD_COMMON_H_
+
+#define ARD_COMMON_VERSION "1.3.1"
+
+/* Set up default success/error defines */
+#define SUCCESS 0
+#define ERROR -1
+
+/* Common string size definition */
+#define STR_SIZE 2048
+#define HUGE_STR_SIZE 7500
+
+/* Prototypes */
+
+#endif
@@ -0,0 +1,326 @@
+/*****************************************************************************
+FILE: ard_compact_metadata.h
+
+PURPOSE: Contains defines and structures for the compact representation of
+the ARD metadata
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. The compact metadata mirrors Ard_meta_t, but each string is stored once in
+   a string pool and referenced by its offset (Ard_str_t) rather than being
+   held in a STR_SIZE character array.  A band takes around 200 bytes rather
+   than the ~26 KB of an Ard_band_meta_t, and only the scenes which exist
+   are allocated.
+2. A string pool may be shared by the compact metadata for any number of
+   tiles, in which case the repeated strings (fill values, units, dates,
+   product names, etc.) are only stored once across all of the tiles.
+*****************************************************************************/
+
+#ifndef ARD_COMPACT_METADATA_H
+#define ARD_COMPACT_METADATA_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ard_error_handler.h"
+#include "ard_metadata.h"
+
+/* Defines */
+/* Initial size of the string pool buffer and hash table */
+#define ARD_STRING_POOL_SIZE 4096
+#define ARD_STRING_POOL_SLOTS 256
+
+/* Offset of a string within the string pool.  Offset 0 is the empty
+   string. */
+typedef unsigned int Ard_str_t;
+
+/* Known product types, used for the band product and source */
+enum Ard_product_type
+{
+    ARD_PRODUCT_LEVEL1, ARD_PRODUCT_TOA_REFL, ARD_PRODUCT_TOA_BT,
+    ARD_PRODUCT_SR_REFL, ARD_PRODUCT_LEVEL2_QA, ARD_PRODUCT_ANGLE_BANDS,
+    ARD_PRODUCT_UNDEFINED, ARD_PRODUCT_OTHER
+};
+
+/* Band category types (categoryType in the ARD schema) */
+enum Ard_category_type
+{
+    ARD_CATEGORY_IMAGE, ARD_CATEGORY_QA, ARD_CATEGORY_BROWSE,
+    ARD_CATEGORY_INDEX, ARD_CATEGORY_METADATA, ARD_CATEGORY_OTHER
+};
+
+/* Pool of unique strings.  Strings are stored back to back in a single
+   buffer and found via an open-addressing hash table of their offsets. */
+typedef struct
+{
+    char *buf;               /* buffer of NULL-terminated strings */
+    size_t len;              /* number of bytes used in buf */
+    size_t size;             /* number of bytes allocated for buf */
+    Ard_str_t *slots;        /* hash table of string offsets; 0 is empty */
+    unsigned int nslots;     /* number of hash slots (power of 2) */
+    unsigned int nstrings;   /* number of unique strings in the pool */
+} Ard_string_pool_t;
+
+typedef struct
+{
+    int class;                 /* class value */
+    Ard_str_t description;     /* class description */
+} Ard_compact_class_t;
+
+typedef struct
+{
+    int proj_type;             /* projection number (see GCTP_* in
+                                  gctp_defines.h) */
+    int datum_type;            /* datum type (see ARD_* in gctp_defines.h) */
+    Ard_str_t units;           /* projection units (degrees, meters) */
+    double ul_corner[2];       /* projection UL x, y */
+    double lr_corner[2];       /* projection LR x, y */
+    Ard_str_t grid_origin;     /* origin of gridded data (CORNER, CENTER) */
+    int utm_zone;              /* UTM zone; negative for southern zones */
+    double longitude_pole;
+    double latitude_true_scale;
+    double false_easting;
+    double false_northing;
+    double standard_parallel1;
+    double standard_parallel2;
+    double central_meridian;
+    double origin_latitude;
+    double sphere_radius;
+} Ard_compact_proj_meta_t;
+
+typedef struct
+{
+    Ard_str_t data_provider;   /* name of the original data provider */
+    Ard_str_t satellite;       /* name of the satellite */
+    Ard_str_t instrument;      /* name of instrument */
+    Ard_str_t level1_collection;  /* Level-1 collection number */
+    Ard_str_t ard_version;     /* ARD version number */
+    Ard_str_t region;          /* ARD region - CU, HI, AK, etc. */
+    Ard_str_t acquisition_date;   /* date of scene acquisition */
+    Ard_str_t start_date;      /* starting date of temporal products */
+    Ard_str_t end_date;        /* ending date of temporal products */
+    Ard_str_t product_id;      /* product ID */
+    Ard_str_t description;     /* product description */
+    Ard_str_t production_date; /* date the tile was processed */
+    double bounding_coords[4]; /* geographic west, east, north, south */
+    Ard_compact_proj_meta_t proj_info;  /* projection information */
+    float orientation_angle;   /* orientation angle of the scene (degrees) */
+    int htile;                 /* ARD horizontal tile number */
+    int vtile;                 /* ARD vertical tile number */
+    int scene_count;           /* number of scenes in this tile */
+    float cloud_cover;         /* percentage of cloud cover */
+    float cloud_shadow;        /* percentage of cloud shadow */
+    float snow_ice;            /* percentage of snow/ice */
+    float fill;                /* percentage of fill */
+} Ard_compact_global_tile_meta_t;
+
+typedef struct
+{
+    Ard_str_t data_provider;   /* name of the original data provider */
+    Ard_str_t satellite;       /* name of the satellite */
+    Ard_str_t instrument;      /* name of instrument */
+    Ard_str_t acquisition_date;   /* date of scene acquisition */
+    Ard_str_t scene_center_time;  /* GMT time at scene center */
+    Ard_str_t level1_production_date;  /* date the scene was processed to a
+                                          level 1 product */
+    int wrs_system;            /* 1 or 2 */
+    int wrs_path;              /* WRS path of this scene */
+    int wrs_row;               /* WRS row of this scene */
+    Ard_str_t request_id;      /* request ID */
+    Ard_str_t scene_id;        /* scene ID */
+    Ard_str_t product_id;      /* product ID */
+    enum Ard_elevation_type elevation_src; /* elevation source */
+    enum Ard_sensor_modes sensor_mode;     /* sensor mode */
+    enum Ard_ephem_type ephemeris_type;    /* ephemeris type */
+    Ard_str_t cpf_name;        /* name of Landsat CPF file */
+    Ard_str_t lpgs_metadata_file;  /* name of LPGS metadata file */
+    float geometric_rmse_model;    /* overall geometric RMSE */
+    float geometric_rmse_model_x;  /* x-direction geometric RMSE */
+    float geometric_rmse_model_y;  /* y-direction geometric RMSE */
+} Ard_compact_global_scene_meta_t;
+
+typedef struct
+{
+    enum Ard_product_type product_type;   /* product type of product */
+    enum Ard_product_type source_type;    /* product type of source */
+    enum Ard_category_type category_type; /* category type of category */
+    Ard_str_t product;         /* product type */
+    Ard_str_t source;          /* source type (level1, toa_refl, sr_refl) */
+    Ard_str_t name;            /* band name */
+    Ard_str_t category;        /* category type (image, qa, browse, index) */
+    enum Ard_data_type data_type;  /* data type of this band */
+    int nlines;                /* number of lines in the dataset */
+    int nsamps;                /* number of samples in the dataset */
+    long fill_value;           /* fill value */
+    int saturate_value;        /* saturation value (for Landsat) */
+    float scale_factor;        /* scaling factor */
+    float add_offset;          /* offset to be added */
+    Ard_str_t short_name;      /* short band name */
+    Ard_str_t long_name;       /* long band name */
+    Ard_str_t file_name;       /* file name for this band w/o the pathname */
+    double pixel_size[2];      /* pixel size x, y */
+    Ard_str_t pixel_units;     /* units for pixel size (meters, degrees) */
+    enum Ard_resampling_type resample_method;
+                               /* resampling method for this band */
+    Ard_str_t data_units;      /* units of data stored in this band */
+    float valid_range[2];      /* min, max valid value for this band */
+    int nbits;                 /* number of bits in bitmap_description */
+    Ard_str_t *bitmap_description;  /* bit descriptions for bits 0 to
+                                       nbits-1 */
+    int nclass;                /* number of classes in class_values */
+    Ard_compact_class_t *class_values;  /* class value descriptions */
+    Ard_str_t app_version;     /* version of the application which produced
+                                  the current band */
+    Ard_str_t production_date; /* date the band was produced */
+} Ard_compact_band_meta_t;
+
+typedef struct
+{
+    Ard_compact_global_tile_meta_t tile_global;  /* global metadata */
+    int nbands;                /* number of bands in the metadata file */
+    Ard_compact_band_meta_t *band;  /* array of band metadata */
+} Ard_compact_tile_meta_t;
+
+typedef struct
+{
+    Ard_compact_global_scene_meta_t scene_global;  /* global metadata */
+    int nbands;                /* number of bands in the metadata file */
+    Ard_compact_band_meta_t *band;  /* array of band metadata */
+} Ard_compact_scene_meta_t;
+
+typedef struct
+{
+    Ard_string_pool_t *pool;   /* string pool holding the strings; not owned
+                                  and may be shared with other metadata */
+    Ard_str_t meta_namespace;  /* namespace for this metadata file */
+    Ard_compact_tile_meta_t tile_meta;  /* tile-specific metadata */
+    int nscenes;               /* number of scenes in the tile metadata */
+    Ard_compact_scene_meta_t *scene_meta;  /* array of nscenes scene-specific
+                                              metadata */
+} Ard_compact_meta_t;
+
+
+/* Prototypes */
+int init_ard_string_pool
+(
+    Ard_string_pool_t *pool    /* O: string pool to be initialized */
+);
+
+void free_ard_string_pool
+(
+    Ard_string_pool_t *pool    /* I/O: string pool to be freed */
+);
+
+int ard_intern_string
+(
+    Ard_string_pool_t *pool,   /* I/O: string pool */
+    const char *str,           /* I: string to be added to the pool */
+    Ard_str_t *id              /* O: offset of the string in the pool */
+);
+
+const char *ard_pool_string
+(
+    const Ard_string_pool_t *pool,  /* I: string pool */
+    Ard_str_t id               /* I: offset of the string in the pool */
+);
+
+enum Ard_product_type ard_product_type
+(
+    const char *product        /* I: product or source name */
+);
+
+enum Ard_category_type ard_category_type
+(
+    const char *category       /* I: category name */
+);
+
+void init_ard_compact_metadata
+(
+    Ard_compact_meta_t *cmeta, /* O: compact metadata to be initialized */
+    Ard_string_pool_t *pool    /* I: string pool to use for the strings */
+);
+
+void free_ard_compact_band_metadata
+(
+    int nbands,                     /* I: number of bands in the array */
+    Ard_compact_band_meta_t *cband  /* I/O: array of bands to be freed */
+);
+
+void free_ard_compact_metadata
+(
+    Ard_compact_meta_t *cmeta  /* I/O: compact metadata to be freed; the
+                                      string pool isn't freed */
+);
+
+int allocate_ard_compact_scenes
+(
+    Ard_compact_meta_t *cmeta, /* I/O: compact metadata */
+    int nscenes                /* I: number of scenes */
+);
+
+int ard_band_to_compact
+(
+    Ard_string_pool_t *pool,        /* I/O: string pool */
+    Ard_band_meta_t *bmeta,         /* I: band metadata */
+    Ard_compact_band_meta_t *cband  /* O: compact band metadata */
+);
+
+int ard_compact_to_band
+(
+    const Ard_string_pool_t *pool,  /* I: string pool */
+    Ard_compact_band_meta_t *cband, /* I: compact band metadata */
+    Ard_band_meta_t *bmeta          /* O: band metadata; bitmap and class
+                                          values are allocated */
+);
+
+int ard_tile_global_to_compact
+(
+    Ard_string_pool_t *pool,                /* I/O: string pool */
+    Ard_global_tile_meta_t *gmeta,          /* I: tile global metadata */
+    Ard_compact_global_tile_meta_t *cgmeta  /* O: compact tile global
+                                                  metadata */
+);
+
+void ard_compact_to_tile_global
+(
+    const Ard_string_pool_t *pool,          /* I: string pool */
+    Ard_compact_global_tile_meta_t *cgmeta, /* I: compact tile global
+                                                  metadata */
+    Ard_global_tile_meta_t *gmeta           /* O: tile global metadata */
+);
+
+int ard_scene_global_to_compact
+(
+    Ard_string_pool_t *pool,                 /* I/O: string pool */
+    Ard_global_scene_meta_t *gmeta,          /* I: scene global metadata */
+    Ard_compact_global_scene_meta_t *cgmeta  /* O: compact scene global
+                                                   metadata */
+);
+
+void ard_compact_to_scene_global
+(
+    const Ard_string_pool_t *pool,           /* I: string pool */
+    Ard_compact_global_scene_meta_t *cgmeta, /* I: compact scene global
+                                                   metadata */
+    Ard_global_scene_meta_t *gmeta           /* O: scene global metadata */
+);
+
+int ard_metadata_to_compact
+(
+    Ard_meta_t *ard_meta,      /* I: ARD metadata */
+    Ard_compact_meta_t *cmeta  /* O: compact metadata, initialized via
+                                     init_ard_compact_metadata */
+);
+
+int ard_compact_to_metadata
+(
+    Ard_compact_meta_t *cmeta, /* I: compact metadata */
+    Ard_meta_t *ard_meta       /* O: ARD metadata, initialized via
+                                     init_ard_metadata_struct */
+);
+
+#endif
@@ -0,0 +1,124 @@
+/*****************************************************************************
+FILE: ard_tiff_cache.h
+
+PURPOSE: Contains defines, structures, and prototypes for the cache of
+decoded Tiff tiles which is shared by all of the windowed reads
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. Tiles are keyed by the file (device, inode, size, and modification time),
+   the offset of the Tiff directory, and the tile number, so the same tile
+   is found no matter which TIFF pointer or thread reads it, and a file
+   which is rewritten doesn't return stale tiles.
+2. The cache is thread-safe, and can be shared by any number of Tiff
+   pointers and threads.  The window reads (ard_read_tiff,
+   ard_read_tiff_window, ard_read_tiff_window_stride, ...) of a tile-oriented
+   file go through the cache in the read options attached to the Tiff pointer
+   (see ard_set_tiff_read_opts in ard_tiff_io.h).
+*****************************************************************************/
+
+#ifndef ARD_TIFF_CACHE_H
+#define ARD_TIFF_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "tiffio.h"
+
+/* Defines */
+/* Number of hash buckets for the cached tiles */
+#define ARD_TILE_CACHE_BUCKETS 4096
+
+/* Key for a cached tile */
+typedef struct
+{
+    uint64_t dev;          /* device holding the file */
+    uint64_t ino;          /* inode of the file */
+    uint64_t size;         /* size of the file (bytes) */
+    int64_t mtime_sec;     /* modification time of the file */
+    int64_t mtime_nsec;
+    uint64_t dir_offset;   /* offset of the Tiff directory */
+    uint32_t tile;         /* tile number within the directory */
+} Ard_tile_key_t;
+
+/* Cached tile */
+typedef struct Ard_tile_entry
+{
+    Ard_tile_key_t key;    /* key for the tile */
+    size_t size;           /* size of the decoded tile (bytes) */
+    int refs;              /* number of readers using the tile */
+    int cached;            /* is the tile still in the cache, or has it
+                              been evicted? */
+    struct Ard_tile_entry *hash_next;  /* next tile in the hash bucket */
+    struct Ard_tile_entry *lru_prev;   /* more recently used tile */
+    struct Ard_tile_entry *lru_next;   /* less recently used tile */
+    uint8_t *data;         /* decoded tile */
+} Ard_tile_entry_t;
+
+/* Cache of decoded tiles (see ard_init_tile_cache) */
+typedef struct
+{
+    pthread_mutex_t lock;  /* lock for all of the fields below */
+    size_t max_bytes;      /* byte budget for the decoded tiles */
+    size_t nbytes;         /* bytes of decoded tiles in the cache */
+    Ard_tile_entry_t **buckets;  /* hash buckets */
+    Ard_tile_entry_t *lru_head;  /* most recently used tile */
+    Ard_tile_entry_t *lru_tail;  /* least recently used tile */
+    unsigned long hits;    /* number of lookups which found the tile */
+    unsigned long misses;  /* number of lookups which didn't */
+    unsigned long evictions;  /* number of tiles evicted */
+} Ard_tile_cache_t;
+
+/* Prototypes */
+int ard_init_tile_cache
+(
+    Ard_tile_cache_t *cache, /* O: tile cache to be initialized */
+    size_t max_bytes         /* I: byte budget for the decoded tiles */
+);
+
+void ard_free_tile_cache
+(
+    Ard_tile_cache_t *cache  /* I/O: tile cache to be freed */
+);
+
+void ard_get_tile_cache_counts
+(
+    Ard_tile_cache_t *cache, /* I: tile cache */
+    unsigned long *hits,     /* O: number of lookups which found the tile */
+    unsigned long *misses,   /* O: number of lookups which didn't */
+    size_t *nbytes,          /* O: bytes of decoded tiles in the cache */
+    unsigned long *evictions /* O: number of tiles evicted */
+);
+
+int ard_tile_cache_key
+(
+    TIFF *tif,               /* I: pointer to the Tiff file */
+    uint32_t tile,           /* I: tile number within the current directory */
+    Ard_tile_key_t *key      /* O: key for the tile */
+);
+
+Ard_tile_entry_t *ard_get_cached_tile
+(
+    Ard_tile_cache_t *cache, /* I/O: tile cache */
+    const Ard_tile_key_t *key  /* I: key for the tile */
+);
+
+void ard_put_cached_tile
+(
+    Ard_tile_cache_t *cache, /* I/O: tile cache */
+    const Ard_tile_key_t *key, /* I: key for the tile */
+    const void *data,        /* I: decoded tile */
+    size_t size              /* I: size of the decoded tile (bytes) */
+);
+
+void ard_release_cached_tile
+(
+    Ard_tile_cache_t *cache, /* I/O: tile cache */
+    Ard_tile_entry_t *entry  /* I: tile from ard_get_cached_tile */
+);
+
+#endif
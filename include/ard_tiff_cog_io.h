@@ -0,0 +1,89 @@
+/*****************************************************************************
+FILE: ard_tiff_cog_io.h
+
+PURPOSE: Contains defines, structures, and prototypes for writing
+cloud-optimized GeoTiff files with internal overviews, and for reading the
+overviews back at a reduced resolution
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. Each overview is half the size of the previous level (rounded up), so the
+   overviews are 2x, 4x, 8x, ... reductions of the full-resolution image.
+*****************************************************************************/
+
+#ifndef ARD_TIFF_COG_IO_H
+#define ARD_TIFF_COG_IO_H
+
+#include "ard_tiff_io.h"
+
+/* Defines */
+/* Keep adding overviews until the smallest one fits within a single tile */
+#define ARD_COG_AUTO_OVERVIEWS -1
+
+/* Maximum number of overviews */
+#define ARD_COG_MAX_OVERVIEWS 16
+
+/* Resampling used to build each overview from the previous level */
+typedef enum {
+  ARD_RESAMPLE_NEAREST,      /* UL pixel of each 2x2 block; use for QA and
+                                other bitmap bands */
+  ARD_RESAMPLE_AVERAGE       /* mean of each 2x2 block */
+} Ard_tiff_resample_t;
+
+/* Options for building the overviews (see ard_write_tiff_cog) */
+typedef struct {
+  int noverviews;            /* number of overviews, or
+                                ARD_COG_AUTO_OVERVIEWS */
+  Ard_tiff_resample_t resample;  /* resampling for the overviews */
+  bool use_fill;             /* should fill pixels be left out of the
+                                average? */
+  long fill_value;           /* fill value for the band */
+} Ard_tiff_overview_opts_t;
+
+/* Prototypes */
+void init_ard_tiff_overview_opts
+(
+    Ard_tiff_overview_opts_t *ovr_opts  /* O: overview options to be
+                                               initialized */
+);
+
+int ard_write_tiff_cog
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be written (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to write to the file */
+    int nsamps,      /* I: number of samples to write to the file */
+    const Ard_tiff_write_opts_t *opts,  /* I: write options used to set the
+                           Tiff tags (see ard_set_tiff_tags_opts) */
+    const Ard_tiff_overview_opts_t *ovr_opts,  /* I: overview options */
+    void *img_buf    /* I: array of nlines * nsamps * size to be written to the
+                           Tiff file */
+);
+
+int ard_select_tiff_overview
+(
+    TIFF *tif,         /* I: pointer to the Tiff file */
+    int out_nlines,    /* I: number of lines needed */
+    int out_nsamps,    /* I: number of samples needed */
+    int *ovr_nlines,   /* O: number of lines in the selected level */
+    int *ovr_nsamps    /* O: number of samples in the selected level */
+);
+
+int ard_read_tiff_overview
+(
+    TIFF *tif,         /* I: pointer to the Tiff file */
+    int data_type,     /* I: data type of the array to be read (see
+                             Ard_data_type in ard_metadata.h) */
+    int out_nlines,    /* I: number of lines in the output image */
+    int out_nsamps,    /* I: number of samples in the output image */
+    void *img_buf      /* O: array of out_nlines * out_nsamps * size to be
+                             read from the Tiff file (sufficient space should
+                             already have been allocated) */
+);
+
+#endif
@@ -0,0 +1,403 @@
+/*****************************************************************************
+FILE: tiff_io.h
+  
+PURPOSE: Contains Tiff input/output related defines and structures
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+*****************************************************************************/
+
+#ifndef TIFF_IO_H
+#define TIFF_IO_H
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "tiffio.h"
+#include "xtiffio.h"
+#include "geotiffio.h"
+#include "ard_metadata.h"
+#include "parse_ard_metadata.h"
+#include "ard_error_handler.h"
+#include "ard_tiff_stats.h"
+#include "ard_tiff_cache.h"
+
+/* Defines */
+typedef enum {
+  ARD_TIFF_READ_FORMAT,
+  ARD_TIFF_WRITE_FORMAT,
+  ARD_TIFF_READ_WRITE_FORMAT,
+} Ard_tiff_format_t;
+
+/* Size of the blocks handed over by ard_read_tiff_blocks */
+typedef enum {
+  ARD_BLOCK_TILE,            /* one tile at a time */
+  ARD_BLOCK_TILE_ROW         /* one row of tiles (full image width) at a
+                                time */
+} Ard_block_type_t;
+
+/* Handler for each block read by ard_read_tiff_blocks.  Line i of the block
+   starts at block + i * stride bytes.  The block is only valid for the
+   duration of the call.  Returns SUCCESS to continue reading, or ERROR to
+   stop. */
+typedef int (*Ard_block_handler_t)
+(
+    void *handler_data,    /* I/O: data passed through from the caller */
+    int line,              /* I: line of the UL corner of the block */
+    int samp,              /* I: sample of the UL corner of the block */
+    int nlines,            /* I: number of lines in the block */
+    int nsamps,            /* I: number of samples in the block */
+    const void *block,     /* I: pixels for the block */
+    size_t stride          /* I: bytes between the lines of the block */
+);
+
+/* Compression codecs for writing (see Ard_tiff_write_opts_t) */
+typedef enum {
+  ARD_CODEC_NONE,
+  ARD_CODEC_LZW,
+  ARD_CODEC_DEFLATE,
+  ARD_CODEC_ZSTD,
+  ARD_CODEC_LZMA,
+  ARD_CODEC_LERC
+} Ard_tiff_codec_t;
+
+/* Predictors for writing (see Ard_tiff_write_opts_t) */
+typedef enum {
+  ARD_PREDICTOR_AUTO,        /* floating-point for float data types,
+                                horizontal for integer data types */
+  ARD_PREDICTOR_NONE,
+  ARD_PREDICTOR_HORIZONTAL,
+  ARD_PREDICTOR_FLOAT
+} Ard_tiff_predictor_t;
+
+/* Use the codec's default compression level */
+#define ARD_CODEC_DEFAULT_LEVEL -1
+
+/* Default number of lines and samples in each tile */
+#define ARD_TIFF_TILE_SIZE 256
+
+/* Options for writing a Tiff file (see ard_set_tiff_tags_opts) */
+typedef struct {
+  Ard_tiff_codec_t codec;    /* compression codec */
+  int level;                 /* compression level for deflate (1-9), ZSTD
+                                (1-22), and LZMA (0-9); ARD_CODEC_DEFAULT_LEVEL
+                                for the codec's default */
+  Ard_tiff_predictor_t predictor;  /* predictor to apply before compressing */
+  double lerc_max_z_error;   /* maximum error for LERC; 0.0 is lossless */
+  int t_nlines;              /* number of lines per tile */
+  int t_nsamps;              /* number of samples per tile */
+} Ard_tiff_write_opts_t;
+
+/* Options for reading a Tiff file, attached to the Tiff pointer (see
+   ard_set_tiff_read_opts) */
+typedef struct {
+  Ard_tile_cache_t *cache;   /* cache for the decoded tiles; NULL for no
+                                caching */
+  int prefetch;              /* number of tiles (or strips) to prefetch ahead
+                                of the reads; 0 for no prefetching */
+} Ard_tiff_read_opts_t;
+
+/* Writer for writing a tile-oriented Tiff file a block of lines at a time
+   (see ard_open_tiff_writer) */
+typedef struct
+{
+    TIFF *tif;             /* Tiff file being written */
+    int nlines;            /* number of lines in the image */
+    int nsamps;            /* number of samples in the image */
+    int t_nlines;          /* number of lines in each tile */
+    int t_nsamps;          /* number of samples in each tile */
+    int nbytes;            /* number of bytes per pixel */
+    int cur_line;          /* first line of the current row of tiles */
+    int row_nlines;        /* number of lines held in the row buffer */
+    size_t tile_size;      /* size of each tile (bytes) */
+    uint8_t *row_buf;      /* lines of the current row of tiles which have
+                              been pushed, if the row isn't complete */
+    void *t_buf;           /* tile buffer */
+} Ard_tiff_writer_t;
+
+/* Maximum number of GeoTiff keys set for any projection */
+#define ARD_MAX_GEOTIFF_KEYS 24
+
+/* GeoTiff key to be set (see Ard_geotiff_tags_t) */
+typedef struct
+{
+    int key_id;            /* GeoTiff key (geokey_t) */
+    int type;              /* TYPE_SHORT, TYPE_DOUBLE, or TYPE_ASCII */
+    int count;             /* count to pass to GTIFKeySet */
+    int short_value;       /* value for TYPE_SHORT */
+    double double_value;   /* value for TYPE_DOUBLE */
+} Ard_geotiff_key_t;
+
+/* Geolocation tags for a band, computed once by ard_compute_geotiff_tags and
+   applied to any number of Tiff files by ard_apply_geotiff_tags */
+typedef struct
+{
+    double tiepoints[6];   /* corner tie points for projection */
+    double pixelscale[3];  /* same as pixel size */
+    char citation[STR_SIZE];  /* value for the TYPE_ASCII (citation) key */
+    int nkeys;             /* number of GeoTiff keys */
+    Ard_geotiff_key_t keys[ARD_MAX_GEOTIFF_KEYS];  /* GeoTiff keys, in the
+                              order they are set */
+} Ard_geotiff_tags_t;
+
+/* Prototypes */
+int ard_set_geotiff_datum
+(
+    GTIF *gtif_fptr,    /* I: GeoTiff file pointer */
+    int datum_type,     /* I: datum type (see ARD_* in gctp_defines.h */
+    char *citation      /* I/O: string for geo citation tag (updated) */
+);
+
+int ard_set_geotiff_tags
+(
+    TIFF *tiff_fptr,             /* I: pointer to Tiff file */
+    Ard_band_meta_t *bmeta,      /* I: band metadata */
+    Ard_proj_meta_t *proj_info   /* I: global projection information */
+);
+
+int ard_compute_geotiff_tags
+(
+    const Ard_band_meta_t *bmeta,    /* I: band metadata */
+    const Ard_proj_meta_t *proj_info,  /* I: global projection information */
+    Ard_geotiff_tags_t *geo      /* O: geolocation tags for the band */
+);
+
+int ard_apply_geotiff_tags
+(
+    TIFF *tif,                   /* I: pointer to Tiff file */
+    const Ard_geotiff_tags_t *geo  /* I: geolocation tags to be set */
+);
+
+int ard_data_type_size
+(
+    int data_type     /* I: data type (see Ard_data_type in ard_metadata.h) */
+);
+
+void init_ard_tiff_write_opts
+(
+    Ard_tiff_write_opts_t *opts   /* O: write options to be initialized */
+);
+
+void ard_set_tiff_tags
+(
+    TIFF *tif,        /* I: pointer to Tiff file */
+    int data_type,    /* I: data type of this band (see ARD_* in
+                            ard_metadata.h) */
+    int nlines,       /* I: number of lines in image */
+    int nsamps,       /* I: number of samples in image */
+    int t_nlines,     /* I: number of lines per tile */
+    int t_nsamps      /* I: number of samples per tile */
+);
+
+int ard_set_tiff_tags_opts
+(
+    TIFF *tif,        /* I: pointer to Tiff file */
+    int data_type,    /* I: data type of this band (see ARD_* in
+                            ard_metadata.h) */
+    int nlines,       /* I: number of lines in image */
+    int nsamps,       /* I: number of samples in image */
+    const Ard_tiff_write_opts_t *opts  /* I: compression, predictor, and tile
+                            size to use */
+);
+
+TIFF *ard_open_tiff
+(
+    char *tiff_file,     /* I: name of the input Tiff file to be opened */
+    char *access_type    /* I: string for the access type for reading the
+                               input file; use the ard_tiff_format array at
+                               the top of this file */
+);
+
+void ard_close_tiff
+(
+    TIFF *tiff_fptr    /* I: pointer to Tiff file to be closed */
+);
+
+void ard_copy_rows
+(
+    const uint8_t *src,  /* I: first pixel of the first row to copy */
+    size_t src_stride,   /* I: bytes between source rows */
+    uint8_t *dst,        /* O: first pixel of the first destination row */
+    size_t dst_stride,   /* I: bytes between destination rows */
+    int nrows,           /* I: number of rows to copy */
+    size_t row_bytes     /* I: number of bytes per row to copy */
+);
+
+void init_ard_tiff_read_opts
+(
+    Ard_tiff_read_opts_t *opts    /* O: read options to be initialized */
+);
+
+void ard_set_tiff_read_opts
+(
+    TIFF *tif,        /* I/O: pointer to the Tiff file */
+    const Ard_tiff_read_opts_t *opts  /* I: read options for the file; NULL
+                            for the defaults */
+);
+
+int ard_write_tiff
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be written (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to write to the file */
+    int nsamps,      /* I: number of samples to write to the file */
+    void *img_buf    /* I: array of nlines * nsamps * size to be written to the
+                           Tiff file */
+);
+
+int ard_write_tiff_stride
+(
+    TIFF *tif,         /* I: pointer to the Tiff file */
+    int data_type,     /* I: data type of the array to be written (see
+                             Ard_data_type in ard_metadata.h) */
+    int nlines,        /* I: number of lines to write to the file */
+    int nsamps,        /* I: number of samples to write to the file */
+    const void *img_buf, /* I: first pixel of the image to be written to the
+                             Tiff file */
+    size_t stride      /* I: number of bytes between the start of each line
+                             in img_buf; 0 for nsamps * size */
+);
+
+int ard_write_tiff_stats
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be written (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to write to the file */
+    int nsamps,      /* I: number of samples to write to the file */
+    void *img_buf,   /* I: array of nlines * nsamps * size to be written to the
+                           Tiff file */
+    Ard_tiff_stats_t *stats  /* I/O: statistics to be updated */
+);
+
+int ard_read_tiff
+(
+    TIFF *tif_fptr,  /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be read (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to read from the file */
+    int nsamps,      /* I: number of samples to read from the file */
+    void *img_buf    /* O: array of nlines * nsamps * size to be read from the
+                           Tiff file (sufficient space should already have
+                           been allocated) */
+);
+
+int ard_read_tiff_window
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    int data_type,    /* I: data type of the array to be read (see
+                            Ard_data_type in ard_metadata.h) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf     /* O: array of nlines * nsamps * size to be read from
+                            the Tiff file (sufficient space should already
+                            have been allocated) */
+);
+
+int ard_read_tiff_window_stride
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    int data_type,    /* I: data type of the array to be read (see
+                            Ard_data_type in ard_metadata.h) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window; sufficient space for
+                            nlines of stride bytes should already have been
+                            allocated */
+    size_t stride     /* I: number of bytes between the start of each line in
+                            img_buf; 0 for nsamps * size */
+);
+
+int ard_read_tiff_stats
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    int data_type,    /* I: data type of the array to be read (see
+                            Ard_data_type in ard_metadata.h) */
+    int nlines,       /* I: number of lines to read from the file */
+    int nsamps,       /* I: number of samples to read from the file */
+    void *img_buf,    /* O: array of nlines * nsamps * size to be read from
+                            the Tiff file (sufficient space should already
+                            have been allocated) */
+    Ard_tiff_stats_t *stats  /* I/O: statistics to be updated */
+);
+
+int ard_read_tiff_window_scaled
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    const Ard_band_meta_t *bmeta,  /* I: band metadata for the data type,
+                            scale factor, offset, and fill value */
+    int out_type,     /* I: data type of the physical values (ARD_FLOAT32 or
+                            ARD_FLOAT64) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window; sufficient space for
+                            nlines of stride bytes should already have been
+                            allocated */
+    size_t stride     /* I: number of bytes between the start of each line in
+                            img_buf; 0 for nsamps * size of out_type */
+);
+
+int ard_read_tiff_scaled
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    const Ard_band_meta_t *bmeta,  /* I: band metadata for the data type,
+                            scale factor, offset, and fill value */
+    int out_type,     /* I: data type of the physical values (ARD_FLOAT32 or
+                            ARD_FLOAT64) */
+    int nlines,       /* I: number of lines to read from the file */
+    int nsamps,       /* I: number of samples to read from the file */
+    void *img_buf     /* O: array of nlines * nsamps * size of out_type to be
+                            read from the Tiff file (sufficient space should
+                            already have been allocated) */
+);
+
+int ard_read_tiff_blocks
+(
+    TIFF *tif,         /* I: pointer to the Tiff file */
+    int data_type,     /* I: data type of the array to be read (see
+                             Ard_data_type in ard_metadata.h) */
+    Ard_block_type_t block_type,  /* I: hand over single tiles or rows of
+                             tiles */
+    Ard_block_handler_t handler,  /* I: handler for each block */
+    void *handler_data /* I/O: data passed through to the handler */
+);
+
+int ard_open_tiff_writer
+(
+    TIFF *tif,                  /* I: pointer to the Tiff file */
+    int data_type,              /* I: data type of the image to be written
+                                      (see Ard_data_type in ard_metadata.h) */
+    int nlines,                 /* I: number of lines to write to the file */
+    int nsamps,                 /* I: number of samples to write to the
+                                      file */
+    Ard_tiff_writer_t *writer   /* O: Tiff writer */
+);
+
+int ard_write_tiff_rows
+(
+    Ard_tiff_writer_t *writer,  /* I/O: Tiff writer */
+    int nlines,                 /* I: number of lines in the block */
+    const void *rows,           /* I: first pixel of the block */
+    size_t stride               /* I: number of bytes between the start of
+                                      each line in rows; 0 for nsamps *
+                                      size */
+);
+
+int ard_finish_tiff_writer
+(
+    Ard_tiff_writer_t *writer   /* I/O: Tiff writer */
+);
+
+#endif
@@ -0,0 +1,70 @@
+/*****************************************************************************
+FILE: ard_tiff_memory_io.h
+
+PURPOSE: Contains defines, structures, and prototypes for reading and writing
+Tiff files held in memory rather than on disk
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. A Tiff file in memory is opened with ard_open_tiff_memory, after which it
+   is read and written with the same routines as a Tiff file on disk
+   (ard_read_tiff, ard_write_tiff, ard_set_geotiff_tags, ...) and closed with
+   ard_close_tiff.
+2. The memory is either supplied by the caller, or allocated and grown as
+   needed when writing.  A memory file isn't thread-safe.
+*****************************************************************************/
+
+#ifndef ARD_TIFF_MEMORY_IO_H
+#define ARD_TIFF_MEMORY_IO_H
+
+#include "ard_tiff_io.h"
+
+/* Defines */
+/* Default initial size of an allocated memory file (bytes) */
+#define ARD_TIFF_MEMORY_SIZE 1048576
+
+/* Tiff file held in memory */
+typedef struct
+{
+    uint8_t *buf;          /* contents of the file */
+    size_t size;           /* size of the file (bytes) */
+    size_t capacity;       /* size of the buffer (bytes) */
+    size_t pos;            /* current position within the file */
+    bool allocated;        /* was the buffer allocated, allowing it to grow? */
+} Ard_tiff_memory_t;
+
+/* Prototypes */
+int init_ard_tiff_memory
+(
+    Ard_tiff_memory_t *mem,  /* O: memory file to be initialized */
+    size_t capacity          /* I: initial size of the buffer (bytes); 0 for
+                                   the default ARD_TIFF_MEMORY_SIZE */
+);
+
+void init_ard_tiff_memory_fixed
+(
+    Ard_tiff_memory_t *mem,  /* O: memory file to be initialized */
+    void *buf,               /* I: caller memory holding the file */
+    size_t size,             /* I: size of the file already in buf (bytes);
+                                   0 for an empty file to be written */
+    size_t capacity          /* I: size of the caller memory (bytes) */
+);
+
+void free_ard_tiff_memory
+(
+    Ard_tiff_memory_t *mem   /* I/O: memory file to be freed */
+);
+
+TIFF *ard_open_tiff_memory
+(
+    Ard_tiff_memory_t *mem,  /* I/O: memory file to be opened */
+    char *access_type        /* I: string for the access type for reading the
+                                   memory file; use the ard_tiff_format
+                                   array in ard_tiff_io.c */
+);
+
+#endif
@@ -0,0 +1,77 @@
+/*****************************************************************************
+FILE: ard_tiff_mmap_io.h
+
+PURPOSE: Contains defines, structures, and prototypes for reading
+uncompressed tile-oriented Tiff files through a memory mapping of the file
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. Only uncompressed, single-sample, native byte order, tile-oriented files
+   can be memory-mapped, since the tiles are served straight from the file.
+2. Once opened, a memory-mapped file is read-only, so any number of threads
+   can read from it concurrently.
+*****************************************************************************/
+
+#ifndef ARD_TIFF_MMAP_IO_H
+#define ARD_TIFF_MMAP_IO_H
+
+#include "ard_tiff_io.h"
+
+/* Memory-mapped Tiff file */
+typedef struct
+{
+    int fd;                /* file descriptor for the Tiff file */
+    uint8_t *map;          /* memory mapping of the entire file */
+    size_t map_size;       /* size of the mapping (bytes) */
+    int nlines;            /* number of lines in the image */
+    int nsamps;            /* number of samples in the image */
+    int t_nlines;          /* number of lines in each tile */
+    int t_nsamps;          /* number of samples in each tile */
+    int nbytes;            /* number of bytes per pixel */
+    int ntiles_across;     /* number of tiles across the image */
+    uint32_t ntiles;       /* number of tiles in the image */
+    uint64_t *tile_offset; /* offset of each tile within the file */
+} Ard_tiff_mmap_t;
+
+/* Prototypes */
+int ard_open_tiff_mmap
+(
+    char *tiff_file,        /* I: name of the input Tiff file to be opened */
+    Ard_tiff_mmap_t *mtif   /* O: memory-mapped Tiff file */
+);
+
+void ard_close_tiff_mmap
+(
+    Ard_tiff_mmap_t *mtif   /* I/O: memory-mapped Tiff file to be closed */
+);
+
+const void *ard_tiff_mmap_tile
+(
+    const Ard_tiff_mmap_t *mtif,  /* I: memory-mapped Tiff file */
+    int line,               /* I: image line (0-based), not a line
+                                  within the tile */
+    int samp                /* I: image sample (0-based), not a sample
+                                  within the tile */
+);
+
+int ard_read_tiff_window_mmap
+(
+    const Ard_tiff_mmap_t *mtif,  /* I: memory-mapped Tiff file */
+    int data_type,    /* I: data type of the array to be read (see
+                            Ard_data_type in ard_metadata.h) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window; sufficient space for
+                            nlines of stride bytes should already have been
+                            allocated */
+    size_t stride     /* I: number of bytes between the start of each line in
+                            img_buf; 0 for nsamps * size */
+);
+
+#endif
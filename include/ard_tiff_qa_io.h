@@ -0,0 +1,68 @@
+/*****************************************************************************
+FILE: ard_tiff_qa_io.h
+
+PURPOSE: Contains defines, structures, and prototypes for reading a band
+with the pixels flagged in a QA band set to fill
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. The QA bits are selected by name, using the bitmap_description of the QA
+   band metadata (see ard_qa_bit_mask).
+*****************************************************************************/
+
+#ifndef ARD_TIFF_QA_IO_H
+#define ARD_TIFF_QA_IO_H
+
+#include "ard_tiff_io.h"
+
+/* Prototypes */
+int ard_qa_bit_mask
+(
+    const Ard_band_meta_t *qa_bmeta,  /* I: QA band metadata */
+    int nnames,              /* I: number of bit names */
+    const char *const *bit_names,  /* I: names of the bits to be masked, as
+                                   given in the bitmap_description */
+    uint32_t *mask           /* O: mask with the named bits set */
+);
+
+int ard_read_tiff_window_masked
+(
+    TIFF *tif,        /* I: pointer to the Tiff file for the band */
+    const Ard_band_meta_t *bmeta,  /* I: band metadata for the data type and
+                            fill value */
+    TIFF *qa_tif,     /* I: pointer to the Tiff file for the QA band */
+    const Ard_band_meta_t *qa_bmeta,  /* I: QA band metadata */
+    uint32_t mask,    /* I: QA bits which flag a pixel to be masked (see
+                            ard_qa_bit_mask) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window; sufficient space for
+                            nlines of stride bytes should already have been
+                            allocated */
+    size_t stride     /* I: number of bytes between the start of each line in
+                            img_buf; 0 for nsamps * size */
+);
+
+int ard_read_tiff_masked
+(
+    TIFF *tif,        /* I: pointer to the Tiff file for the band */
+    const Ard_band_meta_t *bmeta,  /* I: band metadata for the data type and
+                            fill value */
+    TIFF *qa_tif,     /* I: pointer to the Tiff file for the QA band */
+    const Ard_band_meta_t *qa_bmeta,  /* I: QA band metadata */
+    uint32_t mask,    /* I: QA bits which flag a pixel to be masked (see
+                            ard_qa_bit_mask) */
+    int nlines,       /* I: number of lines to read from the file */
+    int nsamps,       /* I: number of samples to read from the file */
+    void *img_buf     /* O: array of nlines * nsamps * size to be read from
+                            the Tiff file (sufficient space should already
+                            have been allocated) */
+);
+
+#endif
@@ -0,0 +1,105 @@
+/*****************************************************************************
+FILE: ard_tiff_threaded_io.h
+
+PURPOSE: Contains defines and prototypes for the multi-threaded tile-oriented
+Tiff read/write routines
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. Threading is only compiled in when the library is built with
+   ENABLE_THREADING=yes (OpenMP).  Otherwise these routines run serially.
+*****************************************************************************/
+
+#ifndef ARD_TIFF_THREADED_IO_H
+#define ARD_TIFF_THREADED_IO_H
+
+#include "ard_tiff_io.h"
+
+/* Defines */
+/* Number of tiles handed to each thread per batch; the raw (compressed)
+   tiles for one batch are held in memory at a time */
+#define ARD_TILES_PER_THREAD 4
+
+/* Number of pixels interleaved at a time when reading a BIP cube; small
+   enough for the block of every band to stay in cache */
+#define ARD_CUBE_BLOCK_PIXELS 512
+
+/* Maximum number of characters of a band file name included in an error
+   message, leaving room for the rest of the message */
+#define ARD_BAND_NAME_LEN (STR_SIZE - 64)
+
+/* Layout of a multi-band image cube */
+typedef enum {
+  ARD_CUBE_BSQ,    /* band sequential; each band is a separate image */
+  ARD_CUBE_BIP     /* band interleaved by pixel; the bands for each pixel are
+                      together */
+} Ard_cube_layout_t;
+
+/* Prototypes */
+int ard_write_tiff_threaded
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be written (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to write to the file */
+    int nsamps,      /* I: number of samples to write to the file */
+    int nthreads,    /* I: number of threads to use (0 = OpenMP default) */
+    void *img_buf    /* I: array of nlines * nsamps * size to be written to the
+                           Tiff file */
+);
+
+int ard_read_tiff_threaded
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be read (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to read from the file */
+    int nsamps,      /* I: number of samples to read from the file */
+    int nthreads,    /* I: number of threads to use (0 = OpenMP default) */
+    void *img_buf    /* O: array of nlines * nsamps * size to be read from the
+                           Tiff file (sufficient space should already have
+                           been allocated) */
+);
+
+int ard_read_tile_cube
+(
+    Ard_tile_meta_t *tile_meta,  /* I: tile metadata for the bands */
+    int nbands,          /* I: number of bands to read */
+    const int *bands,    /* I: index of each band to read in tile_meta->band;
+                               NULL for the first nbands bands */
+    Ard_cube_layout_t layout,  /* I: layout of the cube */
+    int start_line,      /* I: starting line of the window (0-based) */
+    int start_samp,      /* I: starting sample of the window (0-based) */
+    int nlines,          /* I: number of lines in the window; 0 for all the
+                               lines, ignoring start_line */
+    int nsamps,          /* I: number of samples in the window; 0 for all
+                               the samples, ignoring start_samp */
+    const Ard_tiff_read_opts_t *read_opts,  /* I: read options (such as the
+                               tile cache) for the band files; NULL for the
+                               defaults */
+    int nthreads,        /* I: number of threads to use (0 = OpenMP
+                               default) */
+    void *cube_buf       /* O: array of nbands * nlines * nsamps * size to be
+                               read from the band files (sufficient space
+                               should already have been allocated) */
+);
+
+int ard_write_tile_bands
+(
+    Ard_tile_meta_t *tile_meta,  /* I: tile metadata for the bands */
+    void **band_bufs,    /* I: image for each band in tile_meta->band, with
+                               nlines * nsamps * size pixels; NULL to skip
+                               the band */
+    const char *out_dir, /* I: directory for the band files; NULL to use the
+                               file names as they are */
+    const Ard_tiff_write_opts_t *opts,  /* I: compression, predictor, and
+                               tile size to use for every band */
+    int nthreads         /* I: number of threads to use (0 = OpenMP
+                               default) */
+);
+
+#endif
@@ -0,0 +1,127 @@
+/*****************************************************************************
+FILE: ard_xml_buffer.h
+
+PURPOSE: Contains defines, structures, and prototypes for the XML output
+buffer used when writing the ARD metadata
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. The output is serialized into memory and written out in a single write,
+   rather than through many small stdio calls.  The buffer is either
+   allocated and grown as needed, or supplied by the caller.  A caller
+   supplied buffer can optionally be flushed to an open FILE when it fills.
+2. The append routines don't return a status.  The first failure is reported
+   and saved in the buffer status, and the remaining appends are ignored, so
+   the status only needs to be checked once the output is complete.
+3. A buffer isn't thread-safe.  Each thread should use its own buffer.
+*****************************************************************************/
+
+#ifndef ARD_XML_BUFFER_H_
+#define ARD_XML_BUFFER_H_
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+/* Defines */
+/* Default initial size of an allocated XML buffer (bytes) */
+#define ARD_XML_BUF_SIZE 65536
+
+/* Size of the stack buffer used when writing to an open FILE (bytes) */
+#define ARD_XML_FILE_BUF_SIZE 8192
+
+/* XML output buffer */
+typedef struct
+{
+    char *buf;         /* output buffer */
+    size_t len;        /* number of bytes in the buffer */
+    size_t size;       /* size of the buffer (bytes) */
+    bool allocated;    /* was the buffer allocated, allowing it to grow? */
+    FILE *fptr;        /* if not NULL, the buffer is flushed to this file
+                          when it fills */
+    int status;        /* SUCCESS, or ERROR once an append or flush fails */
+} Ard_xml_buf_t;
+
+/* Prototypes */
+int init_ard_xml_buf
+(
+    Ard_xml_buf_t *xbuf,  /* O: XML buffer to be initialized */
+    size_t size           /* I: initial size of the buffer (bytes); 0 for the
+                                default ARD_XML_BUF_SIZE */
+);
+
+void init_ard_xml_buf_fixed
+(
+    Ard_xml_buf_t *xbuf,  /* O: XML buffer to be initialized */
+    char *mem,            /* I: caller memory to use for the buffer */
+    size_t size,          /* I: size of the caller memory (bytes) */
+    FILE *fptr            /* I: file to flush the buffer to when it fills;
+                                NULL if the output must fit in the buffer */
+);
+
+void reset_ard_xml_buf
+(
+    Ard_xml_buf_t *xbuf   /* I/O: XML buffer to be emptied */
+);
+
+void free_ard_xml_buf
+(
+    Ard_xml_buf_t *xbuf   /* I/O: XML buffer to be freed */
+);
+
+void ard_xml_putn
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    const char *str,      /* I: characters to append */
+    size_t n              /* I: number of characters to append */
+);
+
+void ard_xml_puts
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    const char *str       /* I: string to append */
+);
+
+void ard_xml_put_int
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    long value,           /* I: value to append */
+    int width             /* I: minimum number of digits, zero-padded */
+);
+
+void ard_xml_put_double
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    double value          /* I: value to append */
+);
+
+void ard_xml_printf
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    const char *format,   /* I: printf-style format */
+    ...                   /* I: values for the format */
+);
+
+int flush_ard_xml_buf
+(
+    Ard_xml_buf_t *xbuf   /* I/O: XML buffer to be flushed to its file */
+);
+
+int write_ard_xml_buf_fd
+(
+    Ard_xml_buf_t *xbuf,  /* I: XML buffer to be written */
+    int fd                /* I: open file descriptor to write to */
+);
+
+int write_ard_xml_buf_file
+(
+    Ard_xml_buf_t *xbuf,  /* I: XML buffer to be written */
+    char *xml_file        /* I: name of the file to be written or
+                                overwritten */
+);
+
+#endif
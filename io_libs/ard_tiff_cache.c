@@ -0,0 +1,436 @@
+/*****************************************************************************
+FILE: ard_tiff_cache.c
+
+PURPOSE: Contains functions for the cache of decoded Tiff tiles which is
+shared by all of the windowed reads.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+  1. The least recently used tiles are evicted once the decoded tiles go
+     over the byte budget.
+  2. Readers copy out of a cached tile without holding the lock.  Each
+     lookup takes a reference on the tile, and a tile which is evicted while
+     it is still referenced is only freed once it has been released.
+*****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "ard_tiff_cache.h"
+#include "ard_error_handler.h"
+
+/******************************************************************************
+MODULE: ard_init_tile_cache
+
+PURPOSE: Initializes an empty tile cache
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred allocating the cache
+SUCCESS      The cache was initialized
+
+NOTES:
+1. A tile which is larger than the byte budget is never cached.
+*****************************************************************************/
+int ard_init_tile_cache
+(
+    Ard_tile_cache_t *cache, /* O: tile cache to be initialized */
+    size_t max_bytes         /* I: byte budget for the decoded tiles */
+)
+{
+    char FUNC_NAME[] = "ard_init_tile_cache"; /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+
+    cache->buckets = calloc (ARD_TILE_CACHE_BUCKETS,
+        sizeof (Ard_tile_entry_t *));
+    if (cache->buckets == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for the tile cache");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    pthread_mutex_init (&cache->lock, NULL);
+    cache->max_bytes = max_bytes;
+    cache->nbytes = 0;
+    cache->lru_head = NULL;
+    cache->lru_tail = NULL;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_free_tile_cache
+
+PURPOSE: Frees all of the tiles in the cache, along with its hash buckets
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. No tiles from the cache should still be in use, and the cache should no
+   longer be in the read options of any Tiff file being read.
+*****************************************************************************/
+void ard_free_tile_cache
+(
+    Ard_tile_cache_t *cache  /* I/O: tile cache to be freed */
+)
+{
+    Ard_tile_entry_t *entry; /* current tile */
+    Ard_tile_entry_t *next;  /* next tile */
+
+    for (entry = cache->lru_head; entry != NULL; entry = next)
+    {
+        next = entry->lru_next;
+        free (entry);
+    }
+    free (cache->buckets);
+    cache->buckets = NULL;
+    cache->lru_head = NULL;
+    cache->lru_tail = NULL;
+    cache->nbytes = 0;
+    pthread_mutex_destroy (&cache->lock);
+}
+
+
+/******************************************************************************
+MODULE: ard_get_tile_cache_counts
+
+PURPOSE: Returns the hit, miss, and eviction counts and the size of the
+cache
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+*****************************************************************************/
+void ard_get_tile_cache_counts
+(
+    Ard_tile_cache_t *cache, /* I: tile cache */
+    unsigned long *hits,     /* O: number of lookups which found the tile */
+    unsigned long *misses,   /* O: number of lookups which didn't */
+    size_t *nbytes,          /* O: bytes of decoded tiles in the cache */
+    unsigned long *evictions /* O: number of tiles evicted */
+)
+{
+    pthread_mutex_lock (&cache->lock);
+    *hits = cache->hits;
+    *misses = cache->misses;
+    *nbytes = cache->nbytes;
+    *evictions = cache->evictions;
+    pthread_mutex_unlock (&cache->lock);
+}
+
+
+/******************************************************************************
+MODULE: ard_tile_cache_key
+
+PURPOSE: Builds the cache key for a tile of the current directory of a Tiff
+file
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        The file can't be identified (e.g. it isn't backed by a file
+             descriptor), so its tiles can't be cached
+SUCCESS      The key was built
+
+NOTES:
+*****************************************************************************/
+int ard_tile_cache_key
+(
+    TIFF *tif,               /* I: pointer to the Tiff file */
+    uint32_t tile,           /* I: tile number within the current directory */
+    Ard_tile_key_t *key      /* O: key for the tile */
+)
+{
+    struct stat file_stat;   /* status of the Tiff file */
+
+    if (TIFFFileno (tif) < 0 || fstat (TIFFFileno (tif), &file_stat) != 0)
+        return ERROR;
+
+    memset (key, 0, sizeof (*key));
+    key->dev = file_stat.st_dev;
+    key->ino = file_stat.st_ino;
+    key->size = file_stat.st_size;
+    key->mtime_sec = file_stat.st_mtim.tv_sec;
+    key->mtime_nsec = file_stat.st_mtim.tv_nsec;
+    key->dir_offset = TIFFCurrentDirOffset (tif);
+    key->tile = tile;
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_tile_key_hash
+
+PURPOSE: Returns the hash bucket for a tile key
+
+RETURN VALUE:
+Type = size_t
+Value        Description
+-----        -----------
+bucket       Hash bucket for the key
+
+NOTES:
+*****************************************************************************/
+static size_t ard_tile_key_hash
+(
+    const Ard_tile_key_t *key  /* I: key for the tile */
+)
+{
+    uint64_t hash;           /* hash of the key fields */
+
+    hash = key->ino * 0x9E3779B97F4A7C15ULL;
+    hash ^= key->dev + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    hash ^= key->dir_offset + 0x9E3779B97F4A7C15ULL + (hash << 6) +
+        (hash >> 2);
+    hash ^= key->tile * 0xC2B2AE3D27D4EB4FULL;
+    hash ^= hash >> 29;
+
+    return (size_t) (hash % ARD_TILE_CACHE_BUCKETS);
+}
+
+
+/******************************************************************************
+MODULE: ard_unlink_cached_tile
+
+PURPOSE: Removes a tile from the LRU list
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The cache lock must be held.
+*****************************************************************************/
+static void ard_unlink_cached_tile
+(
+    Ard_tile_cache_t *cache, /* I/O: tile cache */
+    Ard_tile_entry_t *entry  /* I/O: tile to be unlinked */
+)
+{
+    if (entry->lru_prev != NULL)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        cache->lru_head = entry->lru_next;
+    if (entry->lru_next != NULL)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        cache->lru_tail = entry->lru_prev;
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+
+/******************************************************************************
+MODULE: ard_push_cached_tile
+
+PURPOSE: Adds a tile to the front (most recently used end) of the LRU list
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The cache lock must be held.
+*****************************************************************************/
+static void ard_push_cached_tile
+(
+    Ard_tile_cache_t *cache, /* I/O: tile cache */
+    Ard_tile_entry_t *entry  /* I/O: tile to be added */
+)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head != NULL)
+        cache->lru_head->lru_prev = entry;
+    else
+        cache->lru_tail = entry;
+    cache->lru_head = entry;
+}
+
+
+/******************************************************************************
+MODULE: ard_evict_cached_tiles
+
+PURPOSE: Evicts the least recently used tiles until the cache fits within
+its byte budget
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The cache lock must be held.
+2. Evicted tiles which are still referenced are freed when released.
+*****************************************************************************/
+static void ard_evict_cached_tiles
+(
+    Ard_tile_cache_t *cache  /* I/O: tile cache */
+)
+{
+    Ard_tile_entry_t *entry; /* tile being evicted */
+    Ard_tile_entry_t **link; /* link to the tile within its hash bucket */
+
+    while (cache->nbytes > cache->max_bytes && cache->lru_tail != NULL)
+    {
+        entry = cache->lru_tail;
+        ard_unlink_cached_tile (cache, entry);
+
+        link = &cache->buckets[ard_tile_key_hash (&entry->key)];
+        while (*link != entry)
+            link = &(*link)->hash_next;
+        *link = entry->hash_next;
+
+        cache->nbytes -= entry->size;
+        cache->evictions++;
+        entry->cached = 0;
+        if (entry->refs == 0)
+            free (entry);
+    }
+}
+
+
+/******************************************************************************
+MODULE: ard_get_cached_tile
+
+PURPOSE: Looks up a tile in the cache
+
+RETURN VALUE:
+Type = Ard_tile_entry_t *
+Value        Description
+-----        -----------
+NULL         The tile isn't in the cache
+entry        Cached tile; entry->data holds the decoded tile
+
+NOTES:
+1. A tile which is found must be released with ard_release_cached_tile once
+   the caller is done with it.
+*****************************************************************************/
+Ard_tile_entry_t *ard_get_cached_tile
+(
+    Ard_tile_cache_t *cache, /* I/O: tile cache */
+    const Ard_tile_key_t *key  /* I: key for the tile */
+)
+{
+    Ard_tile_entry_t *entry; /* current tile in the hash bucket */
+
+    pthread_mutex_lock (&cache->lock);
+    for (entry = cache->buckets[ard_tile_key_hash (key)]; entry != NULL;
+         entry = entry->hash_next)
+    {
+        if (!memcmp (&entry->key, key, sizeof (*key)))
+            break;
+    }
+
+    if (entry != NULL)
+    {
+        /* Move the tile to the front of the LRU list */
+        ard_unlink_cached_tile (cache, entry);
+        ard_push_cached_tile (cache, entry);
+        entry->refs++;
+        cache->hits++;
+    }
+    else
+        cache->misses++;
+    pthread_mutex_unlock (&cache->lock);
+
+    return entry;
+}
+
+
+/******************************************************************************
+MODULE: ard_put_cached_tile
+
+PURPOSE: Adds a copy of a decoded tile to the cache
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. Caching is best effort.  If the tile is too large for the byte budget,
+   is already cached (another thread decoded it at the same time), or memory
+   can't be allocated, then it just isn't added.
+*****************************************************************************/
+void ard_put_cached_tile
+(
+    Ard_tile_cache_t *cache, /* I/O: tile cache */
+    const Ard_tile_key_t *key, /* I: key for the tile */
+    const void *data,        /* I: decoded tile */
+    size_t size              /* I: size of the decoded tile (bytes) */
+)
+{
+    size_t bucket;           /* hash bucket for the tile */
+    Ard_tile_entry_t *entry; /* new tile */
+    Ard_tile_entry_t *cur;   /* current tile in the hash bucket */
+
+    if (size > cache->max_bytes)
+        return;
+
+    /* Copy the tile outside of the lock */
+    entry = malloc (sizeof (Ard_tile_entry_t) + size);
+    if (entry == NULL)
+        return;
+    memcpy (&entry->key, key, sizeof (*key));
+    entry->size = size;
+    entry->refs = 0;
+    entry->cached = 1;
+    entry->data = (uint8_t *) (entry + 1);
+    memcpy (entry->data, data, size);
+
+    bucket = ard_tile_key_hash (key);
+    pthread_mutex_lock (&cache->lock);
+    for (cur = cache->buckets[bucket]; cur != NULL; cur = cur->hash_next)
+    {
+        if (!memcmp (&cur->key, key, sizeof (*key)))
+            break;
+    }
+    if (cur != NULL)
+    {
+        pthread_mutex_unlock (&cache->lock);
+        free (entry);
+        return;
+    }
+
+    entry->hash_next = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+    ard_push_cached_tile (cache, entry);
+    cache->nbytes += size;
+    ard_evict_cached_tiles (cache);
+    pthread_mutex_unlock (&cache->lock);
+}
+
+
+/******************************************************************************
+MODULE: ard_release_cached_tile
+
+PURPOSE: Releases a tile found with ard_get_cached_tile
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The tile is freed if it was evicted while it was in use.
+*****************************************************************************/
+void ard_release_cached_tile
+(
+    Ard_tile_cache_t *cache, /* I/O: tile cache */
+    Ard_tile_entry_t *entry  /* I: tile from ard_get_cached_tile */
+)
+{
+    pthread_mutex_lock (&cache->lock);
+    entry->refs--;
+    if (entry->refs == 0 && !entry->cached)
+        free (entry);
+    pthread_mutex_unlock (&cache->lock);
+}
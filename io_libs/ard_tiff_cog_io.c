@@ -0,0 +1,579 @@
+/*****************************************************************************
+FILE: ard_tiff_cog_io.c
+
+PURPOSE: Contains functions for writing cloud-optimized GeoTiff files with
+internal overviews, and for reading the overviews back at a reduced
+resolution.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+  1. The file is laid out in cloud-optimized order.  The directories for the
+     full-resolution image and each overview are written first, at the start
+     of the file, followed by the tiles of the smallest overview, the next
+     larger overview, and so on, with the full-resolution tiles last.  A
+     reader can then get the layout of every level from the first few KB of
+     the file and fetch a zoomed-out view with a few contiguous reads.
+  2. The tile offsets and byte counts for each directory are reserved when
+     the directory is written and filled in once the tiles for that level
+     have been written (TIFFDeferStrileArrayWriting), so libtiff 4.1 or
+     later is required.
+*****************************************************************************/
+
+#include "ard_tiff_cog_io.h"
+
+
+/******************************************************************************
+MODULE: init_ard_tiff_overview_opts
+
+PURPOSE: Initializes the overview options to the defaults
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The defaults are as many nearest neighbor overviews as it takes for the
+   smallest one to fit in a single tile, and no fill value.
+*****************************************************************************/
+void init_ard_tiff_overview_opts
+(
+    Ard_tiff_overview_opts_t *ovr_opts  /* O: overview options to be
+                                               initialized */
+)
+{
+    ovr_opts->noverviews = ARD_COG_AUTO_OVERVIEWS;
+    ovr_opts->resample = ARD_RESAMPLE_NEAREST;
+    ovr_opts->use_fill = false;
+    ovr_opts->fill_value = 0;
+}
+
+
+/******************************************************************************
+MODULE: ard_downsample_2x
+
+PURPOSE: Builds the next overview level by reducing the image by a factor of
+two in each direction
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The last line and sample of an image with an odd number of lines or
+   samples are averaged over a 2x1 or 1x2 block.
+2. Averages of the integer data types are rounded to the nearest integer.  A
+   block which is all fill is set to fill.
+*****************************************************************************/
+static void ard_downsample_2x
+(
+    const void *in_buf,   /* I: image for the previous level */
+    int in_nlines,        /* I: number of lines in the previous level */
+    int in_nsamps,        /* I: number of samples in the previous level */
+    void *out_buf,        /* O: image for the new level */
+    int out_nlines,       /* I: number of lines in the new level */
+    int out_nsamps,       /* I: number of samples in the new level */
+    int data_type,        /* I: data type of the image (see Ard_data_type in
+                                ard_metadata.h) */
+    const Ard_tiff_overview_opts_t *ovr_opts  /* I: overview options */
+)
+{
+    int line, samp;       /* looping variables for the new level */
+    int in_line, in_samp; /* looping variables for the 2x2 block */
+    int count;            /* number of valid pixels in the 2x2 block */
+    double sum;           /* sum of the valid pixels in the 2x2 block */
+    double mean;          /* mean of the valid pixels in the 2x2 block */
+
+#define ARD_DOWNSAMPLE(type, is_int)                                        \
+    {                                                                       \
+        const type *in = in_buf;                                            \
+        type *out = out_buf;                                                \
+        type fill = (type) ovr_opts->fill_value;                            \
+        type pix;                                                           \
+        for (line = 0; line < out_nlines; line++)                           \
+        {                                                                   \
+            for (samp = 0; samp < out_nsamps; samp++)                       \
+            {                                                               \
+                if (ovr_opts->resample == ARD_RESAMPLE_NEAREST)             \
+                {                                                           \
+                    *out++ = in[(size_t) 2 * line * in_nsamps + 2 * samp];  \
+                    continue;                                               \
+                }                                                           \
+                sum = 0.0;                                                  \
+                count = 0;                                                  \
+                for (in_line = 2 * line; in_line < 2 * line + 2 &&          \
+                     in_line < in_nlines; in_line++)                        \
+                {                                                           \
+                    for (in_samp = 2 * samp; in_samp < 2 * samp + 2 &&      \
+                         in_samp < in_nsamps; in_samp++)                    \
+                    {                                                       \
+                        pix = in[(size_t) in_line * in_nsamps + in_samp];   \
+                        if (ovr_opts->use_fill && pix == fill)              \
+                            continue;                                       \
+                        sum += pix;                                         \
+                        count++;                                            \
+                    }                                                       \
+                }                                                           \
+                if (count == 0)                                             \
+                    *out++ = fill;                                          \
+                else                                                        \
+                {                                                           \
+                    mean = sum / count;                                     \
+                    if (is_int)                                             \
+                        mean += (mean < 0.0) ? -0.5 : 0.5;                  \
+                    *out++ = (type) mean;                                   \
+                }                                                           \
+            }                                                               \
+        }                                                                   \
+    }
+
+    switch (data_type)
+    {
+        case ARD_INT8: ARD_DOWNSAMPLE (int8_t, true); break;
+        case ARD_UINT8: ARD_DOWNSAMPLE (uint8_t, true); break;
+        case ARD_INT16: ARD_DOWNSAMPLE (int16_t, true); break;
+        case ARD_UINT16: ARD_DOWNSAMPLE (uint16_t, true); break;
+        case ARD_INT32: ARD_DOWNSAMPLE (int32_t, true); break;
+        case ARD_UINT32: ARD_DOWNSAMPLE (uint32_t, true); break;
+        case ARD_FLOAT32: ARD_DOWNSAMPLE (float, false); break;
+        case ARD_FLOAT64: ARD_DOWNSAMPLE (double, false); break;
+    }
+#undef ARD_DOWNSAMPLE
+}
+
+
+/******************************************************************************
+MODULE: ard_write_tiff_cog
+
+PURPOSE: Writes the entire Tiff file as a cloud-optimized GeoTiff, along with
+internal overviews
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred writing data to the Tiff file
+SUCCESS      Writing was successful
+
+NOTES:
+1. The Tiff tags for the full-resolution image need to be set with
+   ard_set_tiff_tags_opts, using the same write options, before calling this
+   routine.  Since the full-resolution directory is written before any of
+   the image data, the GeoTiff tags (ard_set_geotiff_tags) also need to be
+   set before calling this routine rather than after writing the image.
+2. The overviews use the same compression, predictor, and tile size as the
+   full-resolution image.  They are all built in memory before writing,
+   which takes about a third of the size of the full-resolution image.
+3. On return the full-resolution directory is the current directory.
+*****************************************************************************/
+int ard_write_tiff_cog
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be written (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to write to the file */
+    int nsamps,      /* I: number of samples to write to the file */
+    const Ard_tiff_write_opts_t *opts,  /* I: write options used to set the
+                           Tiff tags (see ard_set_tiff_tags_opts) */
+    const Ard_tiff_overview_opts_t *ovr_opts,  /* I: overview options */
+    void *img_buf    /* I: array of nlines * nsamps * size to be written to the
+                           Tiff file */
+)
+{
+    char FUNC_NAME[] = "ard_write_tiff_cog"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int level;              /* looping variable for the levels */
+    int nlevels;            /* number of levels, including the
+                               full-resolution image */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+    int t_nlines = 0;       /* number of lines in each tile */
+    int t_nsamps = 0;       /* number of samples in each tile */
+    int nbytes;             /* number of bytes per pixel */
+    int status = SUCCESS;   /* return status */
+    int lvl_nlines[ARD_COG_MAX_OVERVIEWS+1];  /* number of lines in each
+                               level */
+    int lvl_nsamps[ARD_COG_MAX_OVERVIEWS+1];  /* number of samples in each
+                               level */
+    void *lvl_buf[ARD_COG_MAX_OVERVIEWS+1];   /* image for each level */
+
+    /* Get the size of the image as well as the size of each tile */
+    TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    TIFFGetField (tif, TIFFTAG_TILEWIDTH, &t_nsamps);
+    TIFFGetField (tif, TIFFTAG_TILELENGTH, &t_nlines);
+
+    /* The Tiff tags need to have been set with the same write options */
+    if (t_nsamps != opts->t_nsamps || t_nlines != opts->t_nlines)
+    {
+        sprintf (errmsg, "Tiff tile size (%d lines x %d samps) doesn't match "
+            "the write options (%d lines x %d samps)", t_nlines, t_nsamps,
+            opts->t_nlines, opts->t_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* If the size of the image doesn't match that of the user-specified
+       size (and the size of the input image buffer), then it's an error */
+    if (img_nsamps != nsamps || img_nlines != nlines)
+    {
+        sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
+            "match Tiff image size (%d lines x %d samps)", nlines, nsamps,
+            img_nlines, img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Determine the size of each pixel */
+    nbytes = ard_data_type_size (data_type);
+    if (nbytes == ERROR)
+    {
+        sprintf (errmsg, "Unsupported data type %d", data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Determine the number of levels and the size of each */
+    if (ovr_opts->noverviews != ARD_COG_AUTO_OVERVIEWS &&
+        (ovr_opts->noverviews < 0 ||
+         ovr_opts->noverviews > ARD_COG_MAX_OVERVIEWS))
+    {
+        sprintf (errmsg, "Number of overviews (%d) must be 0-%d or "
+            "ARD_COG_AUTO_OVERVIEWS", ovr_opts->noverviews,
+            ARD_COG_MAX_OVERVIEWS);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    lvl_nlines[0] = nlines;
+    lvl_nsamps[0] = nsamps;
+    lvl_buf[0] = img_buf;
+    for (nlevels = 1; nlevels <= ARD_COG_MAX_OVERVIEWS; nlevels++)
+    {
+        if (ovr_opts->noverviews == ARD_COG_AUTO_OVERVIEWS)
+        {
+            if (lvl_nlines[nlevels-1] <= t_nlines &&
+                lvl_nsamps[nlevels-1] <= t_nsamps)
+                break;
+        }
+        else if (nlevels > ovr_opts->noverviews)
+            break;
+
+        lvl_nlines[nlevels] = (lvl_nlines[nlevels-1] + 1) / 2;
+        lvl_nsamps[nlevels] = (lvl_nsamps[nlevels-1] + 1) / 2;
+        lvl_buf[nlevels] = NULL;
+    }
+
+    /* Build each overview from the previous level */
+    for (level = 1; level < nlevels; level++)
+    {
+        lvl_buf[level] = malloc ((size_t) lvl_nlines[level] *
+            lvl_nsamps[level] * nbytes);
+        if (lvl_buf[level] == NULL)
+        {
+            sprintf (errmsg, "Unable to allocate memory for overview %d",
+                level);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            nlevels = level;
+            goto cleanup;
+        }
+
+        ard_downsample_2x (lvl_buf[level-1], lvl_nlines[level-1],
+            lvl_nsamps[level-1], lvl_buf[level], lvl_nlines[level],
+            lvl_nsamps[level], data_type, ovr_opts);
+    }
+
+    /* Write the directories for all the levels, reserving space for the
+       tile offsets and byte counts */
+    for (level = 0; level < nlevels; level++)
+    {
+        if (level > 0)
+        {
+            TIFFSetField (tif, TIFFTAG_SUBFILETYPE, FILETYPE_REDUCEDIMAGE);
+            if (ard_set_tiff_tags_opts (tif, data_type, lvl_nlines[level],
+                lvl_nsamps[level], opts) != SUCCESS)
+            {
+                sprintf (errmsg, "Setting the Tiff tags for overview %d",
+                    level);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                status = ERROR;
+                goto cleanup;
+            }
+        }
+
+        if (!TIFFDeferStrileArrayWriting (tif) ||
+            !TIFFWriteCheck (tif, 1 /*tiles*/, FUNC_NAME) ||
+            !TIFFWriteDirectory (tif))
+        {
+            sprintf (errmsg, "Writing the Tiff directory for level %d",
+                level);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
+    }
+
+    /* Write the tiles, starting with the smallest overview, then fill in
+       the tile offsets and byte counts for that level */
+    for (level = nlevels - 1; level >= 0; level--)
+    {
+        if (!TIFFSetDirectory (tif, level))
+        {
+            sprintf (errmsg, "Setting the Tiff directory for level %d",
+                level);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
+
+        if (ard_write_tiff_stride (tif, data_type, lvl_nlines[level],
+            lvl_nsamps[level], lvl_buf[level], 0) != SUCCESS)
+        {
+            sprintf (errmsg, "Writing the tiles for level %d", level);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
+
+        if (!TIFFForceStrileArrayWriting (tif))
+        {
+            sprintf (errmsg, "Writing the tile offsets for level %d", level);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    /* Free the overviews */
+    for (level = 1; level < nlevels; level++)
+        free (lvl_buf[level]);
+
+    return status;
+}
+
+
+/******************************************************************************
+MODULE: ard_select_tiff_overview
+
+PURPOSE: Selects the smallest level of the Tiff file which is at least the
+requested size, and makes it the current directory
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred selecting the level
+>= 0         Selected level; 0 is the full-resolution image and 1 is the
+             first overview
+
+NOTES:
+1. If no level is large enough, the full-resolution image is selected.
+2. Once the level is selected, it can be read with ard_read_tiff or
+   ard_read_tiff_window using the returned size.  TIFFSetDirectory (tif, 0)
+   returns to the full-resolution image.
+*****************************************************************************/
+int ard_select_tiff_overview
+(
+    TIFF *tif,         /* I: pointer to the Tiff file */
+    int out_nlines,    /* I: number of lines needed */
+    int out_nsamps,    /* I: number of samples needed */
+    int *ovr_nlines,   /* O: number of lines in the selected level */
+    int *ovr_nsamps    /* O: number of samples in the selected level */
+)
+{
+    char FUNC_NAME[] = "ard_select_tiff_overview"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int level;              /* looping variable for the levels */
+    int nlevels;            /* number of directories in the Tiff file */
+    int best = 0;           /* selected level */
+    int lvl_nlines;         /* number of lines in the current level */
+    int lvl_nsamps;         /* number of samples in the current level */
+    uint32_t subfile_type;  /* subfile type of the current level */
+
+    nlevels = TIFFNumberOfDirectories (tif);
+    for (level = 0; level < nlevels; level++)
+    {
+        if (!TIFFSetDirectory (tif, level))
+        {
+            sprintf (errmsg, "Setting the Tiff directory for level %d",
+                level);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return ERROR;
+        }
+
+        /* Stop at the first directory which isn't an overview */
+        subfile_type = 0;
+        TIFFGetField (tif, TIFFTAG_SUBFILETYPE, &subfile_type);
+        if (level > 0 && !(subfile_type & FILETYPE_REDUCEDIMAGE))
+            break;
+
+        /* The levels get smaller, so stop at the first one which is too
+           small */
+        TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &lvl_nsamps);
+        TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &lvl_nlines);
+        if (level > 0 && (lvl_nlines < out_nlines || lvl_nsamps < out_nsamps))
+            break;
+        best = level;
+        *ovr_nlines = lvl_nlines;
+        *ovr_nsamps = lvl_nsamps;
+    }
+
+    if (!TIFFSetDirectory (tif, best))
+    {
+        sprintf (errmsg, "Setting the Tiff directory for level %d", best);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    return best;
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_overview
+
+PURPOSE: Reads the entire Tiff file at the requested size, using the
+smallest overview which is at least that size
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. The selected level is resampled to the requested size using nearest
+   neighbor.  If the level is already the requested size, it's read directly
+   into img_buf.
+2. The current directory is restored before returning.
+*****************************************************************************/
+int ard_read_tiff_overview
+(
+    TIFF *tif,         /* I: pointer to the Tiff file */
+    int data_type,     /* I: data type of the array to be read (see
+                             Ard_data_type in ard_metadata.h) */
+    int out_nlines,    /* I: number of lines in the output image */
+    int out_nsamps,    /* I: number of samples in the output image */
+    void *img_buf      /* O: array of out_nlines * out_nsamps * size to be
+                             read from the Tiff file (sufficient space should
+                             already have been allocated) */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_overview"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int line, samp;         /* looping variables for the output image */
+    int level;              /* selected level */
+    int lvl_nlines = 0;     /* number of lines in the selected level */
+    int lvl_nsamps = 0;     /* number of samples in the selected level */
+    int nbytes;             /* number of bytes per pixel */
+    int status = SUCCESS;   /* return status */
+    tdir_t cur_dir;         /* current directory on input */
+    size_t in_line;         /* line in the selected level for the current
+                               output line */
+    int *in_samp = NULL;    /* sample in the selected level for each output
+                               sample */
+    void *lvl_buf = NULL;   /* image for the selected level */
+
+    if (out_nlines <= 0 || out_nsamps <= 0)
+    {
+        sprintf (errmsg, "Invalid output size (%d lines x %d samps)",
+            out_nlines, out_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Determine the size of each pixel */
+    nbytes = ard_data_type_size (data_type);
+    if (nbytes == ERROR)
+    {
+        sprintf (errmsg, "Unsupported data type %d", data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Select the level */
+    cur_dir = TIFFCurrentDirectory (tif);
+    level = ard_select_tiff_overview (tif, out_nlines, out_nsamps,
+        &lvl_nlines, &lvl_nsamps);
+    if (level == ERROR)
+    {
+        sprintf (errmsg, "Selecting the overview for %d lines x %d samps",
+            out_nlines, out_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        TIFFSetDirectory (tif, cur_dir);
+        return ERROR;
+    }
+
+    /* If the level is the requested size, then read it directly */
+    if (lvl_nlines == out_nlines && lvl_nsamps == out_nsamps)
+    {
+        status = ard_read_tiff (tif, data_type, out_nlines, out_nsamps,
+            img_buf);
+        if (status != SUCCESS)
+        {
+            sprintf (errmsg, "Reading level %d", level);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+        }
+        TIFFSetDirectory (tif, cur_dir);
+        return status;
+    }
+
+    /* Read the level and resample it to the requested size */
+    lvl_buf = malloc ((size_t) lvl_nlines * lvl_nsamps * nbytes);
+    in_samp = malloc (out_nsamps * sizeof (int));
+    if (lvl_buf == NULL || in_samp == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for level %d", level);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        status = ERROR;
+        goto cleanup;
+    }
+
+    if (ard_read_tiff (tif, data_type, lvl_nlines, lvl_nsamps, lvl_buf)
+        != SUCCESS)
+    {
+        sprintf (errmsg, "Reading level %d", level);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        status = ERROR;
+        goto cleanup;
+    }
+
+    /* Use the level pixel containing the center of each output pixel */
+    for (samp = 0; samp < out_nsamps; samp++)
+        in_samp[samp] = ((2 * (int64_t) samp + 1) * lvl_nsamps) /
+            (2 * (int64_t) out_nsamps);
+
+#define ARD_RESAMPLE(type)                                                  \
+    {                                                                       \
+        const type *in;                                                     \
+        type *out = img_buf;                                                \
+        for (line = 0; line < out_nlines; line++)                           \
+        {                                                                   \
+            in_line = ((2 * (int64_t) line + 1) * lvl_nlines) /             \
+                (2 * (int64_t) out_nlines);                                 \
+            in = (const type *) lvl_buf + in_line * lvl_nsamps;             \
+            for (samp = 0; samp < out_nsamps; samp++)                       \
+                *out++ = in[in_samp[samp]];                                 \
+        }                                                                   \
+    }
+
+    switch (nbytes)
+    {
+        case 1: ARD_RESAMPLE (uint8_t); break;
+        case 2: ARD_RESAMPLE (uint16_t); break;
+        case 4: ARD_RESAMPLE (uint32_t); break;
+        case 8: ARD_RESAMPLE (uint64_t); break;
+    }
+#undef ARD_RESAMPLE
+
+cleanup:
+    free (lvl_buf);
+    free (in_samp);
+    TIFFSetDirectory (tif, cur_dir);
+
+    return status;
+}
@@ -17,59 +17,126 @@ NOTES:
      https://landsat.usgs.gov/ard/ard_metadata_vX_X.xsd
 *****************************************************************************/
 
+#include <math.h>
+#include <fcntl.h>
 #include "ard_tiff_io.h"
+#include "ard_tiff_cache.h"
 
 /* define the read/write formats to be used for opening a file */
 /* TIFF_READ_FORMAT, TIFF_WRITE_FORMAT, TIFF_READ_WRITE_FORMAT */
 const char ard_tiff_format[][3] = {"r", "w", "a"};
 
+/* Conversion of stored values to physical values, applied as each tile or
+   strip is copied into the window (see ard_scale_rows) */
+typedef struct
+{
+    int in_type;           /* data type stored in the Tiff file */
+    int out_type;          /* ARD_FLOAT32 or ARD_FLOAT64 */
+    double scale_factor;   /* physical = stored * scale_factor + add_offset */
+    double add_offset;
+    bool use_fill;         /* should fill pixels be converted to NaN? */
+    long fill_value;       /* fill value for the band */
+} Ard_scale_t;
+
+/* Name of the read options attached to a Tiff pointer (see
+   ard_set_tiff_read_opts) */
+static const char ard_read_opts_name[] = "ard_tiff_read_opts";
+
+/* Prefetching for a scan over a rectangle of tiles (or a run of strips),
+   in row-major order (see ard_prefetch_tiles) */
+typedef struct
+{
+    TIFF *tif;             /* Tiff file being read */
+    int fd;                /* file descriptor of the Tiff file; -1 for no
+                              prefetching */
+    int ahead;             /* number of tiles to prefetch ahead of the tile
+                              being read */
+    uint32_t first_tile;   /* number of the first (UL) tile of the scan */
+    int ncols;             /* number of tiles across the scan */
+    int ntiles_across;     /* number of tiles across the image */
+    int ntiles;            /* number of tiles in the scan */
+    int next;              /* next tile of the scan to be prefetched */
+} Ard_prefetch_t;
+
 
 /******************************************************************************
-MODULE: ard_set_geotiff_datum
+MODULE: ard_add_geotiff_key
 
-PURPOSE: Sets the GeoTiff tags for the datum used
+PURPOSE: Adds a GeoTiff key to the geolocation tags
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. For TYPE_ASCII keys, the value is the citation of the geolocation tags.
+*****************************************************************************/
+static void ard_add_geotiff_key
+(
+    Ard_geotiff_tags_t *geo,   /* I/O: geolocation tags */
+    int key_id,                /* I: GeoTiff key (geokey_t) */
+    int type,                  /* I: TYPE_SHORT, TYPE_DOUBLE, or TYPE_ASCII */
+    int count,                 /* I: count to pass to GTIFKeySet */
+    int short_value,           /* I: value for TYPE_SHORT */
+    double double_value        /* I: value for TYPE_DOUBLE */
+)
+{
+    Ard_geotiff_key_t *key = &geo->keys[geo->nkeys++];
+
+    key->key_id = key_id;
+    key->type = type;
+    key->count = count;
+    key->short_value = short_value;
+    key->double_value = double_value;
+}
+
+
+/******************************************************************************
+MODULE: ard_compute_geotiff_datum
+
+PURPOSE: Adds the GeoTiff keys for the datum used to the geolocation tags
 
 RETURN VALUE:
 Type = int
 ERROR        An unknown datum was specified
-SUCCESS      Writing of datum geolocation tags was successful
+SUCCESS      Adding the datum keys was successful
 
 NOTES:
 *****************************************************************************/
-int ard_set_geotiff_datum
+static int ard_compute_geotiff_datum
 (
-    GTIF *gtif,        /* I: GeoTiff file pointer */
-    int datum_type,    /* I: datum type (see ARD_* in gctp_defines.h) */
-    char *citation     /* I/O: string for geo citation tag (updated) */
+    Ard_geotiff_tags_t *geo,   /* I/O: geolocation tags; the citation is
+                                       updated */
+    int datum_type             /* I: datum type (see ARD_* in
+                                     gctp_defines.h) */
 )
 {
-    char FUNC_NAME[] = "ard_set_geotiff_datum"; /* function name */
+    char FUNC_NAME[] = "ard_compute_geotiff_datum"; /* function name */
     char errmsg[STR_SIZE];      /* error message */
 
     switch (datum_type)
     {
         case (ARD_WGS84):
-            strcat (citation, "WGS 1984");
-            GTIFKeySet (gtif, GeogGeodeticDatumGeoKey, TYPE_SHORT, 1,
-                Datum_WGS84);
-            GTIFKeySet (gtif, GeographicTypeGeoKey, TYPE_SHORT, 1,
-                GCS_WGS_84);
+            strcat (geo->citation, "WGS 1984");
+            ard_add_geotiff_key (geo, GeogGeodeticDatumGeoKey, TYPE_SHORT, 1,
+                Datum_WGS84, 0.0);
+            ard_add_geotiff_key (geo, GeographicTypeGeoKey, TYPE_SHORT, 1,
+                GCS_WGS_84, 0.0);
             break;
 
         case (ARD_NAD83):
-            strcat (citation, "North American Datum 1983");
-            GTIFKeySet (gtif, GeogGeodeticDatumGeoKey, TYPE_SHORT, 1,
-                Datum_North_American_Datum_1983);
-            GTIFKeySet (gtif, GeographicTypeGeoKey, TYPE_SHORT, 1,
-                GCS_NAD83);
+            strcat (geo->citation, "North American Datum 1983");
+            ard_add_geotiff_key (geo, GeogGeodeticDatumGeoKey, TYPE_SHORT, 1,
+                Datum_North_American_Datum_1983, 0.0);
+            ard_add_geotiff_key (geo, GeographicTypeGeoKey, TYPE_SHORT, 1,
+                GCS_NAD83, 0.0);
             break;
 
         case (ARD_NAD27):
-            strcat (citation, "North American Datum 1927");
-            GTIFKeySet (gtif, GeogGeodeticDatumGeoKey, TYPE_SHORT, 1,
-                Datum_North_American_Datum_1927);
-            GTIFKeySet (gtif, GeographicTypeGeoKey, TYPE_SHORT, 1,
-                GCS_NAD27);
+            strcat (geo->citation, "North American Datum 1927");
+            ard_add_geotiff_key (geo, GeogGeodeticDatumGeoKey, TYPE_SHORT, 1,
+                Datum_North_American_Datum_1927, 0.0);
+            ard_add_geotiff_key (geo, GeographicTypeGeoKey, TYPE_SHORT, 1,
+                GCS_NAD27, 0.0);
             break;
 
         default:
@@ -83,38 +150,73 @@ int ard_set_geotiff_datum
 
 
 /******************************************************************************
-MODULE: ard_set_geotiff_tags
+MODULE: ard_set_geotiff_datum
 
-PURPOSE: Sets the GeoTiff tags for the current Tiff and GeoTiff pointers
+PURPOSE: Sets the GeoTiff tags for the datum used
 
 RETURN VALUE:
 Type = int
-ERROR        An error occurred writing geolocation tags to the Tiff and
-             GeoTiff files
-SUCCESS      Writing of geolocation tags was successful
+ERROR        An unknown datum was specified
+SUCCESS      Writing of datum geolocation tags was successful
 
 NOTES:
 *****************************************************************************/
-int ard_set_geotiff_tags
+int ard_set_geotiff_datum
 (
-    TIFF *tif,                   /* I: pointer to Tiff file */
-    Ard_band_meta_t *bmeta,      /* I: band metadata */
-    Ard_proj_meta_t *proj_info   /* I: global projection information */
+    GTIF *gtif,        /* I: GeoTiff file pointer */
+    int datum_type,    /* I: datum type (see ARD_* in gctp_defines.h) */
+    char *citation     /* I/O: string for geo citation tag (updated) */
+)
+{
+    int i;                      /* looping variable for the keys */
+    Ard_geotiff_tags_t geo;     /* datum keys */
+
+    geo.citation[0] = '\0';
+    geo.nkeys = 0;
+    if (ard_compute_geotiff_datum (&geo, datum_type) != SUCCESS)
+        return ERROR;
+
+    strcat (citation, geo.citation);
+    for (i = 0; i < geo.nkeys; i++)
+        GTIFKeySet (gtif, geo.keys[i].key_id, geo.keys[i].type,
+            geo.keys[i].count, geo.keys[i].short_value);
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_compute_geotiff_tags
+
+PURPOSE: Computes the Tiff geolocation tags and the GeoTiff keys for a band,
+without applying them to a Tiff file
+
+RETURN VALUE:
+Type = int
+ERROR        An unsupported projection was specified
+SUCCESS      Computing the geolocation tags was successful
+
+NOTES:
+1. The tags only depend on the projection and the pixel size, so they can
+   be computed once and applied to every band of a product of the same pixel
+   size with ard_apply_geotiff_tags.
+*****************************************************************************/
+int ard_compute_geotiff_tags
+(
+    const Ard_band_meta_t *bmeta,    /* I: band metadata */
+    const Ard_proj_meta_t *proj_info,  /* I: global projection information */
+    Ard_geotiff_tags_t *geo      /* O: geolocation tags for the band */
 )
 {
-    char FUNC_NAME[] = "ard_set_geotiff_tags"; /* function name */
+    char FUNC_NAME[] = "ard_compute_geotiff_tags"; /* function name */
     char errmsg[STR_SIZE];      /* error message */
     char nors;                  /* north or south UTM zone */
-    char citation[STR_SIZE];    /* string for geo citation tag */
-    char gt_citation_text[STR_SIZE];  /* UTM GTCitationText */
-    double tiepoints[6];        /* corner tie points for projection */
-    double pixelscale[3];       /* same as pixel size */
     int nors_set;               /* north or south UTM zone codes */
     int zone;                   /* abs UTM zone number */
     int linear_value = Linear_Meter;  /* default linear value */
-    GTIF *gtif = NULL;          /* GeoTiff file pointer */
 
-    int UTMWGS84_ZoneCodes[2][60] = { /* zone code for UTM WGS84 projections */
+    /* zone code for UTM WGS84 projections */
+    static const int UTMWGS84_ZoneCodes[2][60] = {
         {PCS_WGS84_UTM_zone_1N,
          PCS_WGS84_UTM_zone_2N,
          PCS_WGS84_UTM_zone_3N,
@@ -237,7 +339,8 @@ int ard_set_geotiff_tags
          PCS_WGS84_UTM_zone_60S}
     };     
 
-    int UTMNAD27_ZoneCodes[] =      /* zone code for UTM NAD27 projections */
+    /* zone code for UTM NAD27 projections */
+    static const int UTMNAD27_ZoneCodes[] =
         {0,
          0,
          PCS_NAD27_UTM_zone_3N,
@@ -261,7 +364,8 @@ int ard_set_geotiff_tags
          PCS_NAD27_UTM_zone_21N,
          PCS_NAD27_UTM_zone_22N};
 
-    int UTMNAD83_ZoneCodes[] =      /* zone code for UTM NAD83 projections */
+    /* zone code for UTM NAD83 projections */
+    static const int UTMNAD83_ZoneCodes[] =
         {0,
          0,
          PCS_NAD83_UTM_zone_3N,
@@ -286,57 +390,51 @@ int ard_set_geotiff_tags
          PCS_NAD83_UTM_zone_22N,
          PCS_NAD83_UTM_zone_23N};
 
+    geo->citation[0] = '\0';
+    geo->nkeys = 0;
+
     /* Handle the Tiff geolocation tags */
     /* UL corner
        NOTE: according to the Geotiff documentation, only one tiepoint
        (the UL corner) is specified. */
     /* Since we are using RasterPixelIsPoint for the RasterTypeGeoKey, the
        UL corner point needs to be the center of the pixel */
-    tiepoints[0] = 0.0;
-    tiepoints[1] = 0.0;
-    tiepoints[2] = 0.0;
-    tiepoints[5] = 0.0;
+    geo->tiepoints[0] = 0.0;
+    geo->tiepoints[1] = 0.0;
+    geo->tiepoints[2] = 0.0;
+    geo->tiepoints[5] = 0.0;
 
     if (!strcmp (proj_info->grid_origin, "CENTER"))
     {  /* projection corners represent center of the pixel */
-        tiepoints[3] = proj_info->ul_corner[0];
-        tiepoints[4] = proj_info->ul_corner[1];
+        geo->tiepoints[3] = proj_info->ul_corner[0];
+        geo->tiepoints[4] = proj_info->ul_corner[1];
     }
     else
     {  /* projection corners represent UL corner of the pixel */
-        tiepoints[3] = proj_info->ul_corner[0] + 0.5 * bmeta->pixel_size[0];
-        tiepoints[4] = proj_info->ul_corner[1] - 0.5 * bmeta->pixel_size[1];
+        geo->tiepoints[3] = proj_info->ul_corner[0] +
+            0.5 * bmeta->pixel_size[0];
+        geo->tiepoints[4] = proj_info->ul_corner[1] -
+            0.5 * bmeta->pixel_size[1];
     }
-    TIFFSetField (tif, TIFFTAG_GEOTIEPOINTS, 6, tiepoints);
 
     /* Pixel size */
-    pixelscale[0] = bmeta->pixel_size[0];
-    pixelscale[1] = bmeta->pixel_size[1];
-    pixelscale[2] = 0.0;
-    TIFFSetField (tif, TIFFTAG_GEOPIXELSCALE, 3, pixelscale);
-
-    /* Set up a GeoTiff file descriptor */
-    gtif = GTIFNew (tif);
-    if (gtif == NULL)
-    {
-        sprintf (errmsg, "Unable to initialize the GeoTiff file descriptor");
-        ard_error_handler (true, FUNC_NAME, errmsg);
-        return ERROR;
-    }
+    geo->pixelscale[0] = bmeta->pixel_size[0];
+    geo->pixelscale[1] = bmeta->pixel_size[1];
+    geo->pixelscale[2] = 0.0;
 
     /* Handle the GeoTiff geolocation tags */
     switch (proj_info->proj_type)
     {
         case (ARD_GCTP_GEO_PROJ):
-            GTIFKeySet (gtif, GTModelTypeGeoKey, TYPE_SHORT, 1,
-                ModelTypeGeographic);
-            GTIFKeySet (gtif, GTRasterTypeGeoKey, TYPE_SHORT, 1,
-                RasterPixelIsPoint);
-            GTIFKeySet (gtif, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
-                Angular_Degree);
-            strcpy (citation, "Geographic (Longitude, Latitude) ");
-            ard_set_geotiff_datum (gtif, proj_info->datum_type, citation);
-            GTIFKeySet (gtif, GTCitationGeoKey, TYPE_ASCII, 1, citation);
+            ard_add_geotiff_key (geo, GTModelTypeGeoKey, TYPE_SHORT, 1,
+                ModelTypeGeographic, 0.0);
+            ard_add_geotiff_key (geo, GTRasterTypeGeoKey, TYPE_SHORT, 1,
+                RasterPixelIsPoint, 0.0);
+            ard_add_geotiff_key (geo, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
+                Angular_Degree, 0.0);
+            strcpy (geo->citation, "Geographic (Longitude, Latitude) ");
+            ard_compute_geotiff_datum (geo, proj_info->datum_type);
+            ard_add_geotiff_key (geo, GTCitationGeoKey, TYPE_ASCII, 1, 0, 0.0);
             break;
 
         case (ARD_GCTP_UTM_PROJ):
@@ -355,157 +453,159 @@ int ard_set_geotiff_tags
 
             if (proj_info->datum_type == ARD_WGS84) /* WGS84 */
             {
-                sprintf (gt_citation_text, "UTM Zone %d %c with WGS84", zone,
+                sprintf (geo->citation, "UTM Zone %d %c with WGS84", zone,
                     nors);
                 zone -= 1; /* zero base */
 
-                GTIFKeySet (gtif, GTModelTypeGeoKey, TYPE_SHORT, 1,
-                    ModelTypeProjected);
-                GTIFKeySet (gtif, GTRasterTypeGeoKey, TYPE_SHORT, 1,
-                    RasterPixelIsPoint);
-                GTIFKeySet (gtif, GTCitationGeoKey, TYPE_ASCII, 0,
-                    gt_citation_text);
-                GTIFKeySet (gtif, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
-                    linear_value);
-                GTIFKeySet (gtif, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
-                    Angular_Degree);
-                GTIFKeySet (gtif, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
-                    UTMWGS84_ZoneCodes[nors_set][zone]);
+                ard_add_geotiff_key (geo, GTModelTypeGeoKey, TYPE_SHORT, 1,
+                    ModelTypeProjected, 0.0);
+                ard_add_geotiff_key (geo, GTRasterTypeGeoKey, TYPE_SHORT, 1,
+                    RasterPixelIsPoint, 0.0);
+                ard_add_geotiff_key (geo, GTCitationGeoKey, TYPE_ASCII, 0, 0,
+                    0.0);
+                ard_add_geotiff_key (geo, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
+                    linear_value, 0.0);
+                ard_add_geotiff_key (geo, GeogAngularUnitsGeoKey, TYPE_SHORT,
+                    1, Angular_Degree, 0.0);
+                ard_add_geotiff_key (geo, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
+                    UTMWGS84_ZoneCodes[nors_set][zone], 0.0);
             }
             else if (proj_info->datum_type == ARD_NAD27 &&
                     (zone >= 3 && zone <= 22) &&
                      nors == 'N') /* NAD27 (only valid are 3N to 22N) */
             {
-                sprintf (gt_citation_text, "UTM Zone %d %c with NAD27", zone,
+                sprintf (geo->citation, "UTM Zone %d %c with NAD27", zone,
                     nors);
                 zone -= 1; /* zero base */
 
-                GTIFKeySet (gtif, GTModelTypeGeoKey, TYPE_SHORT, 1,
-                    ModelTypeProjected);
-                GTIFKeySet (gtif, GTRasterTypeGeoKey, TYPE_SHORT, 1,
-                    RasterPixelIsPoint);
-                GTIFKeySet (gtif, GTCitationGeoKey, TYPE_ASCII, 0,
-                    gt_citation_text);
-                GTIFKeySet (gtif, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
-                    linear_value);
-                GTIFKeySet (gtif, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
-                    Angular_Degree);
-                GTIFKeySet (gtif, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
-                    UTMNAD27_ZoneCodes[zone]);
+                ard_add_geotiff_key (geo, GTModelTypeGeoKey, TYPE_SHORT, 1,
+                    ModelTypeProjected, 0.0);
+                ard_add_geotiff_key (geo, GTRasterTypeGeoKey, TYPE_SHORT, 1,
+                    RasterPixelIsPoint, 0.0);
+                ard_add_geotiff_key (geo, GTCitationGeoKey, TYPE_ASCII, 0, 0,
+                    0.0);
+                ard_add_geotiff_key (geo, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
+                    linear_value, 0.0);
+                ard_add_geotiff_key (geo, GeogAngularUnitsGeoKey, TYPE_SHORT,
+                    1, Angular_Degree, 0.0);
+                ard_add_geotiff_key (geo, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
+                    UTMNAD27_ZoneCodes[zone], 0.0);
             }
             else if (proj_info->datum_type == ARD_NAD83 &&
                     (zone >= 3 && zone <= 23) &&
                      nors == 'N') /* NAD83 (only valid are 3N to 23N) */
             {
-                sprintf (gt_citation_text, "UTM Zone %d %c with NAD83", zone,
+                sprintf (geo->citation, "UTM Zone %d %c with NAD83", zone,
                     nors);
                 zone -= 1; /* zero base */
 
-                GTIFKeySet (gtif, GTModelTypeGeoKey, TYPE_SHORT, 1,
-                    ModelTypeProjected);
-                GTIFKeySet (gtif, GTRasterTypeGeoKey, TYPE_SHORT, 1,
-                    RasterPixelIsPoint);
-                GTIFKeySet (gtif, GTCitationGeoKey, TYPE_ASCII, 0,
-                    gt_citation_text);
-                GTIFKeySet (gtif, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
-                    linear_value);
-                GTIFKeySet (gtif, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
-                    Angular_Degree);
-                GTIFKeySet (gtif, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
-                    UTMNAD83_ZoneCodes[zone]);
+                ard_add_geotiff_key (geo, GTModelTypeGeoKey, TYPE_SHORT, 1,
+                    ModelTypeProjected, 0.0);
+                ard_add_geotiff_key (geo, GTRasterTypeGeoKey, TYPE_SHORT, 1,
+                    RasterPixelIsPoint, 0.0);
+                ard_add_geotiff_key (geo, GTCitationGeoKey, TYPE_ASCII, 0, 0,
+                    0.0);
+                ard_add_geotiff_key (geo, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
+                    linear_value, 0.0);
+                ard_add_geotiff_key (geo, GeogAngularUnitsGeoKey, TYPE_SHORT,
+                    1, Angular_Degree, 0.0);
+                ard_add_geotiff_key (geo, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
+                    UTMNAD83_ZoneCodes[zone], 0.0);
             }
             break;
 
         case (ARD_GCTP_ALBERS_PROJ):
-            GTIFKeySet (gtif, ProjCoordTransGeoKey, TYPE_SHORT, 1,
-                CT_AlbersEqualArea);
-            GTIFKeySet (gtif, GTModelTypeGeoKey, TYPE_SHORT, 1,
-                ModelTypeProjected);
-            GTIFKeySet (gtif, GTRasterTypeGeoKey, TYPE_SHORT, 1,
-                RasterPixelIsPoint);
-            strcpy (citation, "Albers|");
-            ard_set_geotiff_datum (gtif, proj_info->datum_type, citation);
-            GTIFKeySet (gtif, GTCitationGeoKey, TYPE_ASCII, 0, citation);
-            GTIFKeySet (gtif, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
-                linear_value);
-            GTIFKeySet (gtif, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
-                Angular_Degree);
-            GTIFKeySet (gtif, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
-                KvUserDefined);
-            GTIFKeySet (gtif, ProjectionGeoKey, TYPE_SHORT, 1, KvUserDefined);
-            GTIFKeySet (gtif, ProjLinearUnitsGeoKey, TYPE_SHORT, 1,
-                linear_value);
-            GTIFKeySet (gtif, ProjStdParallel1GeoKey, TYPE_DOUBLE, 1,
-                proj_info->standard_parallel1);
-            GTIFKeySet (gtif, ProjStdParallel2GeoKey, TYPE_DOUBLE, 1,
-                proj_info->standard_parallel2);
-            GTIFKeySet (gtif, ProjNatOriginLongGeoKey, TYPE_DOUBLE, 1,
-                proj_info->central_meridian);
-            GTIFKeySet (gtif, ProjNatOriginLatGeoKey, TYPE_DOUBLE, 1,
-                proj_info->origin_latitude);
-            GTIFKeySet (gtif, ProjFalseEastingGeoKey, TYPE_DOUBLE, 1,
-                proj_info->false_easting);
-            GTIFKeySet (gtif, ProjFalseNorthingGeoKey, TYPE_DOUBLE, 1,
-                proj_info->false_northing);
-            GTIFKeySet (gtif, ProjFalseOriginLongGeoKey, TYPE_DOUBLE, 1,
-                (double) 0.0);
-            GTIFKeySet (gtif, ProjFalseOriginLatGeoKey, TYPE_DOUBLE, 1,
-                (double) 0.0);
+            ard_add_geotiff_key (geo, ProjCoordTransGeoKey, TYPE_SHORT, 1,
+                CT_AlbersEqualArea, 0.0);
+            ard_add_geotiff_key (geo, GTModelTypeGeoKey, TYPE_SHORT, 1,
+                ModelTypeProjected, 0.0);
+            ard_add_geotiff_key (geo, GTRasterTypeGeoKey, TYPE_SHORT, 1,
+                RasterPixelIsPoint, 0.0);
+            strcpy (geo->citation, "Albers|");
+            ard_compute_geotiff_datum (geo, proj_info->datum_type);
+            ard_add_geotiff_key (geo, GTCitationGeoKey, TYPE_ASCII, 0, 0, 0.0);
+            ard_add_geotiff_key (geo, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
+                linear_value, 0.0);
+            ard_add_geotiff_key (geo, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
+                Angular_Degree, 0.0);
+            ard_add_geotiff_key (geo, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
+                KvUserDefined, 0.0);
+            ard_add_geotiff_key (geo, ProjectionGeoKey, TYPE_SHORT, 1,
+                KvUserDefined, 0.0);
+            ard_add_geotiff_key (geo, ProjLinearUnitsGeoKey, TYPE_SHORT, 1,
+                linear_value, 0.0);
+            ard_add_geotiff_key (geo, ProjStdParallel1GeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->standard_parallel1);
+            ard_add_geotiff_key (geo, ProjStdParallel2GeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->standard_parallel2);
+            ard_add_geotiff_key (geo, ProjNatOriginLongGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->central_meridian);
+            ard_add_geotiff_key (geo, ProjNatOriginLatGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->origin_latitude);
+            ard_add_geotiff_key (geo, ProjFalseEastingGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->false_easting);
+            ard_add_geotiff_key (geo, ProjFalseNorthingGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->false_northing);
+            ard_add_geotiff_key (geo, ProjFalseOriginLongGeoKey, TYPE_DOUBLE,
+                1, 0, (double) 0.0);
+            ard_add_geotiff_key (geo, ProjFalseOriginLatGeoKey, TYPE_DOUBLE, 1,
+                0, (double) 0.0);
             break;
 
         case (ARD_GCTP_PS_PROJ):
-            GTIFKeySet (gtif, ProjCoordTransGeoKey, TYPE_SHORT, 1,
-                CT_PolarStereographic);
-            GTIFKeySet (gtif, GTModelTypeGeoKey, TYPE_SHORT, 1,
-                ModelTypeProjected);
-            GTIFKeySet (gtif, GTRasterTypeGeoKey, TYPE_SHORT, 1,
-                RasterPixelIsPoint);
-            strcpy (citation, "PS|");
-            ard_set_geotiff_datum (gtif, proj_info->datum_type, citation);
-            GTIFKeySet (gtif, GTCitationGeoKey, TYPE_ASCII, 0, citation);
-            GTIFKeySet (gtif, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
-                linear_value);
-            GTIFKeySet (gtif, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
-                Angular_Degree);
-            GTIFKeySet (gtif, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
-                KvUserDefined);
-            GTIFKeySet (gtif, ProjectionGeoKey, TYPE_SHORT, 1, KvUserDefined);
-            GTIFKeySet (gtif, ProjLinearUnitsGeoKey, TYPE_SHORT, 1,
-                linear_value);
-            GTIFKeySet (gtif, ProjStraightVertPoleLongGeoKey, TYPE_DOUBLE, 1,
-                proj_info->longitude_pole);
-            GTIFKeySet (gtif, ProjNatOriginLatGeoKey, TYPE_DOUBLE, 1,
-                proj_info->latitude_true_scale);
-            GTIFKeySet (gtif, ProjFalseEastingGeoKey, TYPE_DOUBLE, 1,
-                proj_info->false_easting);
-            GTIFKeySet (gtif, ProjFalseNorthingGeoKey, TYPE_DOUBLE, 1,
-                proj_info->false_northing);
+            ard_add_geotiff_key (geo, ProjCoordTransGeoKey, TYPE_SHORT, 1,
+                CT_PolarStereographic, 0.0);
+            ard_add_geotiff_key (geo, GTModelTypeGeoKey, TYPE_SHORT, 1,
+                ModelTypeProjected, 0.0);
+            ard_add_geotiff_key (geo, GTRasterTypeGeoKey, TYPE_SHORT, 1,
+                RasterPixelIsPoint, 0.0);
+            strcpy (geo->citation, "PS|");
+            ard_compute_geotiff_datum (geo, proj_info->datum_type);
+            ard_add_geotiff_key (geo, GTCitationGeoKey, TYPE_ASCII, 0, 0, 0.0);
+            ard_add_geotiff_key (geo, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
+                linear_value, 0.0);
+            ard_add_geotiff_key (geo, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
+                Angular_Degree, 0.0);
+            ard_add_geotiff_key (geo, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
+                KvUserDefined, 0.0);
+            ard_add_geotiff_key (geo, ProjectionGeoKey, TYPE_SHORT, 1,
+                KvUserDefined, 0.0);
+            ard_add_geotiff_key (geo, ProjLinearUnitsGeoKey, TYPE_SHORT, 1,
+                linear_value, 0.0);
+            ard_add_geotiff_key (geo, ProjStraightVertPoleLongGeoKey,
+                TYPE_DOUBLE, 1, 0, proj_info->longitude_pole);
+            ard_add_geotiff_key (geo, ProjNatOriginLatGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->latitude_true_scale);
+            ard_add_geotiff_key (geo, ProjFalseEastingGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->false_easting);
+            ard_add_geotiff_key (geo, ProjFalseNorthingGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->false_northing);
             break;
 
         case (ARD_GCTP_SIN_PROJ):
-            GTIFKeySet (gtif, ProjCoordTransGeoKey, TYPE_SHORT, 1,
-                CT_Sinusoidal);
-            GTIFKeySet (gtif, GTModelTypeGeoKey, TYPE_SHORT, 1,
-                ModelTypeProjected );
-            GTIFKeySet (gtif, GTRasterTypeGeoKey, TYPE_SHORT, 1,
-                RasterPixelIsPoint);
-            strcpy( citation, "SINUSOIDAL|" );
-            ard_set_geotiff_datum (gtif, proj_info->datum_type, citation);
-            GTIFKeySet (gtif, GTCitationGeoKey, TYPE_ASCII, 0, citation);
-            GTIFKeySet (gtif, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
-                linear_value);
-            GTIFKeySet (gtif, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
-                Angular_Degree);
-            GTIFKeySet (gtif, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
-                KvUserDefined);
-            GTIFKeySet (gtif, ProjLinearUnitsGeoKey, TYPE_SHORT, 1,
-                linear_value);
-            GTIFKeySet (gtif, ProjNatOriginLongGeoKey, TYPE_DOUBLE, 1,
-                proj_info->central_meridian);
-            GTIFKeySet (gtif, ProjFalseEastingGeoKey, TYPE_DOUBLE, 1,
-                proj_info->false_easting);
-            GTIFKeySet (gtif, ProjFalseNorthingGeoKey, TYPE_DOUBLE, 1,
-                proj_info->false_northing);
+            ard_add_geotiff_key (geo, ProjCoordTransGeoKey, TYPE_SHORT, 1,
+                CT_Sinusoidal, 0.0);
+            ard_add_geotiff_key (geo, GTModelTypeGeoKey, TYPE_SHORT, 1,
+                ModelTypeProjected, 0.0);
+            ard_add_geotiff_key (geo, GTRasterTypeGeoKey, TYPE_SHORT, 1,
+                RasterPixelIsPoint, 0.0);
+            strcpy (geo->citation, "SINUSOIDAL|" );
+            ard_compute_geotiff_datum (geo, proj_info->datum_type);
+            ard_add_geotiff_key (geo, GTCitationGeoKey, TYPE_ASCII, 0, 0, 0.0);
+            ard_add_geotiff_key (geo, GeogLinearUnitsGeoKey, TYPE_SHORT, 1,
+                linear_value, 0.0);
+            ard_add_geotiff_key (geo, GeogAngularUnitsGeoKey, TYPE_SHORT, 1,
+                Angular_Degree, 0.0);
+            ard_add_geotiff_key (geo, ProjectedCSTypeGeoKey, TYPE_SHORT, 1,
+                KvUserDefined, 0.0);
+            ard_add_geotiff_key (geo, ProjLinearUnitsGeoKey, TYPE_SHORT, 1,
+                linear_value, 0.0);
+            ard_add_geotiff_key (geo, ProjNatOriginLongGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->central_meridian);
+            ard_add_geotiff_key (geo, ProjFalseEastingGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->false_easting);
+            ard_add_geotiff_key (geo, ProjFalseNorthingGeoKey, TYPE_DOUBLE, 1,
+                0, proj_info->false_northing);
             break;
 
         default:
@@ -515,6 +615,68 @@ int ard_set_geotiff_tags
             return ERROR;
     }
 
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_apply_geotiff_tags
+
+PURPOSE: Sets the geolocation tags computed by ard_compute_geotiff_tags for
+the current Tiff and GeoTiff pointers
+
+RETURN VALUE:
+Type = int
+ERROR        An error occurred writing geolocation tags to the Tiff and
+             GeoTiff files
+SUCCESS      Writing of geolocation tags was successful
+
+NOTES:
+1. The keys are set in the order they were computed, so the Tiff file is
+   the same as one written by ard_set_geotiff_tags.
+2. geo is only read, so the same tags can be applied to several Tiff files
+   at once from different threads.
+*****************************************************************************/
+int ard_apply_geotiff_tags
+(
+    TIFF *tif,                   /* I: pointer to Tiff file */
+    const Ard_geotiff_tags_t *geo  /* I: geolocation tags to be set */
+)
+{
+    char FUNC_NAME[] = "ard_apply_geotiff_tags"; /* function name */
+    char errmsg[STR_SIZE];      /* error message */
+    int i;                      /* looping variable for the keys */
+    const Ard_geotiff_key_t *key = NULL;  /* current GeoTiff key */
+    GTIF *gtif = NULL;          /* GeoTiff file pointer */
+
+    /* Handle the Tiff geolocation tags */
+    TIFFSetField (tif, TIFFTAG_GEOTIEPOINTS, 6, geo->tiepoints);
+    TIFFSetField (tif, TIFFTAG_GEOPIXELSCALE, 3, geo->pixelscale);
+
+    /* Set up a GeoTiff file descriptor */
+    gtif = GTIFNew (tif);
+    if (gtif == NULL)
+    {
+        sprintf (errmsg, "Unable to initialize the GeoTiff file descriptor");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Handle the GeoTiff geolocation tags */
+    for (i = 0; i < geo->nkeys; i++)
+    {
+        key = &geo->keys[i];
+        if (key->type == TYPE_ASCII)
+            GTIFKeySet (gtif, key->key_id, key->type, key->count,
+                geo->citation);
+        else if (key->type == TYPE_DOUBLE)
+            GTIFKeySet (gtif, key->key_id, key->type, key->count,
+                key->double_value);
+        else
+            GTIFKeySet (gtif, key->key_id, key->type, key->count,
+                key->short_value);
+    }
+
     /* Write the GeoTiff tags and close the GeoTiff file descriptor.  Keys
        are ultimately written when the Tiff file pointer is closed. */
     GTIFWriteKeys (gtif);
@@ -525,32 +687,134 @@ int ard_set_geotiff_tags
 
 
 /******************************************************************************
-MODULE: ard_set_tiff_tags
+MODULE: ard_set_geotiff_tags
 
-PURPOSE: Sets the Tiff tags for the current Tiff pointer
+PURPOSE: Sets the GeoTiff tags for the current Tiff and GeoTiff pointers
+
+RETURN VALUE:
+Type = int
+ERROR        An error occurred writing geolocation tags to the Tiff and
+             GeoTiff files
+SUCCESS      Writing of geolocation tags was successful
+
+NOTES:
+1. When writing several bands with the same projection and pixel size, use
+   ard_compute_geotiff_tags once and ard_apply_geotiff_tags for each band.
+*****************************************************************************/
+int ard_set_geotiff_tags
+(
+    TIFF *tif,                   /* I: pointer to Tiff file */
+    Ard_band_meta_t *bmeta,      /* I: band metadata */
+    Ard_proj_meta_t *proj_info   /* I: global projection information */
+)
+{
+    Ard_geotiff_tags_t geo;     /* geolocation tags for the band */
+
+    if (ard_compute_geotiff_tags (bmeta, proj_info, &geo) != SUCCESS)
+        return ERROR;
+
+    return ard_apply_geotiff_tags (tif, &geo);
+}
+
+
+/******************************************************************************
+MODULE: ard_data_type_size
+
+PURPOSE: Returns the number of bytes in a single pixel of the specified
+data type
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        Unsupported data type
+1, 2, 4, 8   Number of bytes per pixel
+
+NOTES:
+*****************************************************************************/
+int ard_data_type_size
+(
+    int data_type     /* I: data type (see Ard_data_type in ard_metadata.h) */
+)
+{
+    switch (data_type)
+    {
+        case ARD_INT8:
+        case ARD_UINT8:
+            return sizeof (uint8_t);
+        case ARD_INT16:
+        case ARD_UINT16:
+            return sizeof (uint16_t);
+        case ARD_INT32:
+        case ARD_UINT32:
+            return sizeof (uint32_t);
+        case ARD_FLOAT32:
+            return sizeof (float);
+        case ARD_FLOAT64:
+            return sizeof (double);
+        default:
+            return ERROR;
+    }
+}
+
+
+/******************************************************************************
+MODULE: init_ard_tiff_write_opts
+
+PURPOSE: Initializes the Tiff write options to the defaults
 
 RETURN VALUE:
 Type = N/A
 
 NOTES:
-1. Compression is turned on and set to Adobe deflate.
-2. Tiling is used and the size of the tiles is passed into the routine.
+1. The defaults are deflate compression at the codec's default level, the
+   predictor chosen for the data type, and ARD_TIFF_TILE_SIZE square tiles.
 *****************************************************************************/
-void ard_set_tiff_tags
+void init_ard_tiff_write_opts
+(
+    Ard_tiff_write_opts_t *opts   /* O: write options to be initialized */
+)
+{
+    opts->codec = ARD_CODEC_DEFLATE;
+    opts->level = ARD_CODEC_DEFAULT_LEVEL;
+    opts->predictor = ARD_PREDICTOR_AUTO;
+    opts->lerc_max_z_error = 0.0;
+    opts->t_nlines = ARD_TIFF_TILE_SIZE;
+    opts->t_nsamps = ARD_TIFF_TILE_SIZE;
+}
+
+
+/******************************************************************************
+MODULE: ard_apply_tiff_tags
+
+PURPOSE: Sets the compression, tiling, and image Tiff tags for the current
+Tiff pointer, without validating them
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The codec-specific tags (e.g. the level) are only available once the
+   compression has been set, so they are set by the caller afterwards.
+*****************************************************************************/
+static void ard_apply_tiff_tags
 (
     TIFF *tif,        /* I: pointer to Tiff file */
     int data_type,    /* I: data type of this band (see ARD_* in
                             ard_metadata.h) */
     int nlines,       /* I: number of lines in image */
     int nsamps,       /* I: number of samples in image */
+    uint16_t compression,  /* I: Tiff compression scheme */
+    bool has_predictor,    /* I: does the codec support a predictor? */
+    uint16_t predictor,    /* I: Tiff predictor, if supported */
     int t_nlines,     /* I: number of lines per tile */
     int t_nsamps      /* I: number of samples per tile */
 )
 {
     int samps_per_pixel = 1;    /* number of samples per pixel */
 
-    /* Set compression to deflate */
-    TIFFSetField (tif, TIFFTAG_COMPRESSION, COMPRESSION_ADOBE_DEFLATE);
+    /* Set the compression */
+    TIFFSetField (tif, TIFFTAG_COMPRESSION, compression);
 
     /* Turn on the tiling */
     TIFFSetField (tif, TIFFTAG_TILEWIDTH, t_nsamps);
@@ -563,7 +827,8 @@ void ard_set_tiff_tags
     TIFFSetField (tif, TIFFTAG_SAMPLESPERPIXEL, samps_per_pixel);
     TIFFSetField (tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
     TIFFSetField (tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
-    TIFFSetField (tif, TIFFTAG_PREDICTOR, PREDICTOR_HORIZONTAL);
+    if (has_predictor)
+        TIFFSetField (tif, TIFFTAG_PREDICTOR, predictor);
 
     switch (data_type)
     {
@@ -604,123 +869,1629 @@ void ard_set_tiff_tags
 
 
 /******************************************************************************
-MODULE: ard_open_tiff
-
-PURPOSE: Opens a Tiff file for specified read/write/append binary access.
- 
-RETURN VALUE:
-Type = FILE *
-Value        Description
------        -----------
-NULL         Error opening the specified file for read specified access
-non-NULL     FILE pointer to the opened file
-
-NOTES:
-*****************************************************************************/
-TIFF *ard_open_tiff
-(
-    char *tiff_file,     /* I: name of the input Tiff file to be opened */
-    char *access_type    /* I: string for the access type for reading the
-                               input file; use the ard_tiff_format array at
-                               the top of this file */
-)
-{
-    char FUNC_NAME[] = "ard_open_tiff"; /* function name */
-    char errmsg[STR_SIZE];    /* error message */
-    TIFF *tif = NULL;    /* pointer to the Tiff file */
-
-    /* Open the file with the specified access type */
-    tif = XTIFFOpen (tiff_file, access_type);
-    if (tif == NULL)
-    {
-        sprintf (errmsg, "Opening Tiff file %s with %s access.", tiff_file,
-            access_type);
-        ard_error_handler (true, FUNC_NAME, errmsg);
-        return NULL;
-    }
-
-    /* Return the file pointer */
-    return tif;
-}
-
+MODULE: ard_set_tiff_tags
 
-/******************************************************************************
-MODULE: ard_close_tiff
+PURPOSE: Sets the Tiff tags for the current Tiff pointer
 
-PURPOSE: Close the Tiff file
- 
 RETURN VALUE:
 Type = N/A
 
 NOTES:
+1. Compression is turned on and set to Adobe deflate with the horizontal
+   predictor.  Use ard_set_tiff_tags_opts to choose the compression.
+2. Tiling is used and the size of the tiles is passed into the routine.
+3. The tags are set as given, without the validation done by
+   ard_set_tiff_tags_opts.
 *****************************************************************************/
-void ard_close_tiff
+void ard_set_tiff_tags
 (
-    TIFF *tif    /* I: pointer to Tiff file to be closed */
+    TIFF *tif,        /* I: pointer to Tiff file */
+    int data_type,    /* I: data type of this band (see ARD_* in
+                            ard_metadata.h) */
+    int nlines,       /* I: number of lines in image */
+    int nsamps,       /* I: number of samples in image */
+    int t_nlines,     /* I: number of lines per tile */
+    int t_nsamps      /* I: number of samples per tile */
 )
 {
-    XTIFFClose (tif);
+    ard_apply_tiff_tags (tif, data_type, nlines, nsamps,
+        COMPRESSION_ADOBE_DEFLATE, true, PREDICTOR_HORIZONTAL, t_nlines,
+        t_nsamps);
 }
 
 
 /******************************************************************************
-MODULE: ard_write_tiff
+MODULE: ard_set_tiff_tags_opts
+
+PURPOSE: Sets the Tiff tags for the current Tiff pointer, using the
+specified compression, predictor, and tile size
 
-PURPOSE: Writes the entire Tiff file as tile-oriented and compressed
- 
 RETURN VALUE:
 Type = int
 Value        Description
 -----        -----------
-ERROR        An error occurred writing data to the Tiff file
-SUCCESS      Writing was successful
+ERROR        The write options aren't valid for this data type or the codec
+             isn't available
+SUCCESS      The Tiff tags were set
 
 NOTES:
-1. It is expected the Tiff file will have tiling specified and the tile size
-   is already identified for the Tiff pointer (see set_tiff_tags).
-2. It is assumed the compression is already specified as well
-   (see set_tiff_tags).
+1. ARD_PREDICTOR_AUTO uses the floating-point predictor for the FLOAT32 and
+   FLOAT64 data types and the horizontal predictor for the integer types.
+   No predictor is used for uncompressed and LERC compressed files, which
+   don't support one.
+2. The level is 1-9 for deflate, 1-22 for ZSTD, and 0-9 for LZMA.  It is
+   ignored for the other codecs.
+3. Tiles need to be a multiple of 16 lines and samples.
 *****************************************************************************/
-int ard_write_tiff
+int ard_set_tiff_tags_opts
 (
-    TIFF *tif,       /* I: pointer to the Tiff file */
-    int data_type,   /* I: data type of the array to be written (see
-                           Ard_data_type in ard_metadata.h) */
-    int nlines,      /* I: number of lines to write to the file */
-    int nsamps,      /* I: number of samples to write to the file */
-    void *img_buf    /* I: array of nlines * nsamps * size to be written to the
+    TIFF *tif,        /* I: pointer to Tiff file */
+    int data_type,    /* I: data type of this band (see ARD_* in
+                            ard_metadata.h) */
+    int nlines,       /* I: number of lines in image */
+    int nsamps,       /* I: number of samples in image */
+    const Ard_tiff_write_opts_t *opts  /* I: compression, predictor, and tile
+                            size to use */
+)
+{
+    char FUNC_NAME[] = "ard_set_tiff_tags_opts"; /* function name */
+    char errmsg[STR_SIZE];      /* error message */
+    int max_level = 0;          /* maximum level for the codec */
+    int min_level = 1;          /* minimum level for the codec */
+    uint32_t level_tag = 0;     /* Tiff tag for the codec level */
+    uint16_t compression;       /* Tiff compression scheme */
+    uint16_t predictor;         /* Tiff predictor */
+    bool is_float;              /* is the data type floating point? */
+    bool has_predictor = true;  /* does the codec support a predictor? */
+
+    /* Determine the Tiff compression scheme and level tag */
+    switch (opts->codec)
+    {
+        case ARD_CODEC_NONE:
+            compression = COMPRESSION_NONE;
+            has_predictor = false;
+            break;
+        case ARD_CODEC_LZW:
+            compression = COMPRESSION_LZW;
+            break;
+        case ARD_CODEC_DEFLATE:
+            compression = COMPRESSION_ADOBE_DEFLATE;
+            level_tag = TIFFTAG_ZIPQUALITY;
+            max_level = 9;
+            break;
+        case ARD_CODEC_ZSTD:
+            compression = COMPRESSION_ZSTD;
+            level_tag = TIFFTAG_ZSTD_LEVEL;
+            max_level = 22;
+            break;
+        case ARD_CODEC_LZMA:
+            compression = COMPRESSION_LZMA;
+            level_tag = TIFFTAG_LZMAPRESET;
+            min_level = 0;
+            max_level = 9;
+            break;
+        case ARD_CODEC_LERC:
+            compression = COMPRESSION_LERC;
+            has_predictor = false;
+            break;
+        default:
+            sprintf (errmsg, "Unsupported compression codec %d",
+                opts->codec);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return ERROR;
+    }
+
+    if (!TIFFIsCODECConfigured (compression))
+    {
+        sprintf (errmsg, "Compression codec %d is not configured in the "
+            "Tiff library", opts->codec);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    if (opts->level != ARD_CODEC_DEFAULT_LEVEL && level_tag != 0 &&
+        (opts->level < min_level || opts->level > max_level))
+    {
+        sprintf (errmsg, "Compression level %d is not within %d-%d for "
+            "codec %d", opts->level, min_level, max_level, opts->codec);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Determine the predictor */
+    if (ard_data_type_size (data_type) == ERROR)
+    {
+        sprintf (errmsg, "Unsupported data type %d", data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+    is_float = (data_type == ARD_FLOAT32 || data_type == ARD_FLOAT64);
+
+    switch (opts->predictor)
+    {
+        case ARD_PREDICTOR_AUTO:
+            if (!has_predictor)
+                predictor = PREDICTOR_NONE;
+            else if (is_float)
+                predictor = PREDICTOR_FLOATINGPOINT;
+            else
+                predictor = PREDICTOR_HORIZONTAL;
+            break;
+        case ARD_PREDICTOR_NONE:
+            predictor = PREDICTOR_NONE;
+            break;
+        case ARD_PREDICTOR_HORIZONTAL:
+            predictor = PREDICTOR_HORIZONTAL;
+            break;
+        case ARD_PREDICTOR_FLOAT:
+            if (!is_float)
+            {
+                sprintf (errmsg, "The floating-point predictor requires a "
+                    "floating-point data type");
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return ERROR;
+            }
+            predictor = PREDICTOR_FLOATINGPOINT;
+            break;
+        default:
+            sprintf (errmsg, "Unsupported predictor %d", opts->predictor);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return ERROR;
+    }
+
+    if (!has_predictor && predictor != PREDICTOR_NONE)
+    {
+        sprintf (errmsg, "Codec %d does not support a predictor",
+            opts->codec);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Validate the tile size */
+    if (opts->t_nlines <= 0 || opts->t_nsamps <= 0 ||
+        opts->t_nlines % 16 != 0 || opts->t_nsamps % 16 != 0)
+    {
+        sprintf (errmsg, "Tile size (%d lines x %d samps) must be a positive "
+            "multiple of 16", opts->t_nlines, opts->t_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Set the compression, tiling, and the remaining tags */
+    ard_apply_tiff_tags (tif, data_type, nlines, nsamps, compression,
+        has_predictor, predictor, opts->t_nlines, opts->t_nsamps);
+    if (level_tag != 0 && opts->level != ARD_CODEC_DEFAULT_LEVEL)
+        TIFFSetField (tif, level_tag, opts->level);
+    if (compression == COMPRESSION_LERC)
+        TIFFSetField (tif, TIFFTAG_LERC_MAXZERROR, opts->lerc_max_z_error);
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_open_tiff
+
+PURPOSE: Opens a Tiff file for specified read/write/append binary access.
+ 
+RETURN VALUE:
+Type = FILE *
+Value        Description
+-----        -----------
+NULL         Error opening the specified file for read specified access
+non-NULL     FILE pointer to the opened file
+
+NOTES:
+*****************************************************************************/
+TIFF *ard_open_tiff
+(
+    char *tiff_file,     /* I: name of the input Tiff file to be opened */
+    char *access_type    /* I: string for the access type for reading the
+                               input file; use the ard_tiff_format array at
+                               the top of this file */
+)
+{
+    char FUNC_NAME[] = "ard_open_tiff"; /* function name */
+    char errmsg[STR_SIZE];    /* error message */
+    TIFF *tif = NULL;    /* pointer to the Tiff file */
+
+    /* Open the file with the specified access type */
+    tif = XTIFFOpen (tiff_file, access_type);
+    if (tif == NULL)
+    {
+        sprintf (errmsg, "Opening Tiff file %s with %s access.", tiff_file,
+            access_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return NULL;
+    }
+
+    /* Return the file pointer */
+    return tif;
+}
+
+
+/******************************************************************************
+MODULE: ard_close_tiff
+
+PURPOSE: Close the Tiff file
+ 
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+*****************************************************************************/
+void ard_close_tiff
+(
+    TIFF *tif    /* I: pointer to Tiff file to be closed */
+)
+{
+    XTIFFClose (tif);
+}
+
+
+/******************************************************************************
+MODULE: ard_copy_rows
+
+PURPOSE: Copy a block of rows between two buffers with arbitrary row strides
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. When both buffers are packed (each stride is the size of a row), the rows
+   are contiguous and are copied with a single memcpy.
+*****************************************************************************/
+void ard_copy_rows
+(
+    const uint8_t *src,  /* I: first pixel of the first row to copy */
+    size_t src_stride,   /* I: bytes between source rows */
+    uint8_t *dst,        /* O: first pixel of the first destination row */
+    size_t dst_stride,   /* I: bytes between destination rows */
+    int nrows,           /* I: number of rows to copy */
+    size_t row_bytes     /* I: number of bytes per row to copy */
+)
+{
+    int row;             /* looping variable for the rows */
+
+    if (nrows <= 0)
+        return;
+
+    /* Copy packed rows in one go */
+    if (src_stride == row_bytes && dst_stride == row_bytes)
+    {
+        memcpy (dst, src, (size_t) nrows * row_bytes);
+        return;
+    }
+
+    for (row = 0; row < nrows; row++)
+    {
+        memcpy (dst, src, row_bytes);
+        src += src_stride;
+        dst += dst_stride;
+    }
+}
+
+
+/******************************************************************************
+MODULE: init_ard_tiff_read_opts
+
+PURPOSE: Initializes the Tiff read options to the defaults
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The default is no tile cache and no prefetching.
+*****************************************************************************/
+void init_ard_tiff_read_opts
+(
+    Ard_tiff_read_opts_t *opts    /* O: read options to be initialized */
+)
+{
+    opts->cache = NULL;
+    opts->prefetch = 0;
+}
+
+
+/******************************************************************************
+MODULE: ard_set_tiff_read_opts
+
+PURPOSE: Attaches the read options to a Tiff pointer, so they are used by
+all of the window, full image, and block reads of the file
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The options are kept with the Tiff pointer rather than copied, so they
+   (and the tile cache) must stay in place until the file is closed with
+   ard_close_tiff, or until other options are attached.
+2. Each reading thread has its own Tiff pointer, so the options of one
+   reader never affect another.
+*****************************************************************************/
+void ard_set_tiff_read_opts
+(
+    TIFF *tif,        /* I/O: pointer to the Tiff file */
+    const Ard_tiff_read_opts_t *opts  /* I: read options for the file; NULL
+                            for the defaults */
+)
+{
+    TIFFSetClientInfo (tif, (void *) opts, ard_read_opts_name);
+}
+
+
+/******************************************************************************
+MODULE: ard_get_tiff_read_opts
+
+PURPOSE: Returns the read options attached to a Tiff pointer
+
+RETURN VALUE:
+Type = const Ard_tiff_read_opts_t *
+Value        Description
+-----        -----------
+NULL         No read options are attached, so the defaults are used
+opts         Read options for the file
+
+NOTES:
+*****************************************************************************/
+static const Ard_tiff_read_opts_t *ard_get_tiff_read_opts
+(
+    TIFF *tif         /* I: pointer to the Tiff file */
+)
+{
+    return TIFFGetClientInfo (tif, ard_read_opts_name);
+}
+
+
+/******************************************************************************
+MODULE: ard_init_prefetch
+
+PURPOSE: Sets up the prefetching for a scan over a rectangle of tiles
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. For strip-oriented files, use a single column with the strip numbers.
+2. The prefetch distance comes from the read options of the file (see
+   ard_set_tiff_read_opts).  Prefetching is turned off for the scan if it is
+   off in the read options or the file isn't backed by a file descriptor.
+3. The reads know which tiles are coming up next, so they can tell the
+   kernel to start reading them (posix_fadvise POSIX_FADV_WILLNEED) while
+   the current tile is being decoded.  This hides the latency of spinning
+   disks and network file systems on sequential scans.
+*****************************************************************************/
+static void ard_init_prefetch
+(
+    Ard_prefetch_t *pf,  /* O: prefetching for the scan */
+    TIFF *tif,           /* I: pointer to the Tiff file */
+    uint32_t first_tile, /* I: number of the first (UL) tile of the scan */
+    int nrows,           /* I: number of rows of tiles in the scan */
+    int ncols,           /* I: number of tiles across the scan */
+    int ntiles_across    /* I: number of tiles across the image */
+)
+{
+    const Ard_tiff_read_opts_t *read_opts = ard_get_tiff_read_opts (tif);
+                            /* read options attached to the file */
+
+    pf->tif = tif;
+    pf->ahead = (read_opts != NULL && read_opts->prefetch > 0) ?
+        read_opts->prefetch : 0;
+    pf->fd = (pf->ahead > 0) ? TIFFFileno (tif) : -1;
+    pf->first_tile = first_tile;
+    pf->ncols = ncols;
+    pf->ntiles_across = ntiles_across;
+    pf->ntiles = nrows * ncols;
+    pf->next = 0;
+}
+
+
+/******************************************************************************
+MODULE: ard_prefetch_tiles
+
+PURPOSE: Prefetches the tiles of the scan which are within the prefetch
+distance of the tile about to be read
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The byte ranges of consecutive tiles which are contiguous in the file are
+   merged, so a scan over a tile-ordered file issues a few large requests
+   rather than one per tile.
+2. Prefetching is only advice to the kernel, so any errors are ignored.
+*****************************************************************************/
+static void ard_prefetch_tiles
+(
+    Ard_prefetch_t *pf,  /* I/O: prefetching for the scan */
+    int index            /* I: index within the scan of the tile about to be
+                               read */
+)
+{
+    uint32_t tile;       /* number of the tile to be prefetched */
+    uint64_t offset;     /* offset of the tile within the file */
+    uint64_t nbytes;     /* size of the tile within the file */
+    uint64_t start = 0;  /* start of the current byte range */
+    uint64_t len = 0;    /* length of the current byte range */
+
+    if (pf->fd < 0)
+        return;
+
+    for (; pf->next < pf->ntiles && pf->next <= index + pf->ahead;
+         pf->next++)
+    {
+        tile = pf->first_tile + (uint32_t) (pf->next / pf->ncols) *
+            pf->ntiles_across + pf->next % pf->ncols;
+        offset = TIFFGetStrileOffset (pf->tif, tile);
+        nbytes = TIFFGetStrileByteCount (pf->tif, tile);
+        if (nbytes == 0)
+            continue;
+
+        if (len > 0 && offset == start + len)
+            len += nbytes;
+        else
+        {
+            if (len > 0)
+                posix_fadvise (pf->fd, start, len, POSIX_FADV_WILLNEED);
+            start = offset;
+            len = nbytes;
+        }
+    }
+
+    if (len > 0)
+        posix_fadvise (pf->fd, start, len, POSIX_FADV_WILLNEED);
+}
+
+
+/******************************************************************************
+MODULE: ard_scale_rows
+
+PURPOSE: Converts a block of rows of stored values to physical values,
+between two buffers with arbitrary row strides (in bytes)
+
+RETURN VALUE: N/A
+
+NOTES:
+1. Each pixel is converted to stored * scale_factor + add_offset in the
+   output data type, and fill pixels are converted to NaN.
+2. The conversion is expanded for every pair of input and output data types.
+   Each row is converted in one pass and the fill pixels are blended to NaN
+   in a second pass, so both inner loops are branch-free and are vectorized
+   by the compiler (e.g. gcc -O3, or -O2 -ftree-vectorize).  Blending in the
+   conversion loop would need the floating-point conversion to be done
+   speculatively, which the compiler won't do.
+*****************************************************************************/
+static void ard_scale_rows
+(
+    const uint8_t *src,  /* I: first pixel of the first row to convert */
+    size_t src_stride,   /* I: bytes between source rows */
+    uint8_t *dst,        /* O: first pixel of the first destination row */
+    size_t dst_stride,   /* I: bytes between destination rows */
+    int nrows,           /* I: number of rows to convert */
+    int npix,            /* I: number of pixels per row to convert */
+    const Ard_scale_t *scale  /* I: conversion to physical values */
+)
+{
+    int row;             /* looping variable for the rows */
+    int pix;             /* looping variable for the pixels */
+
+#define ARD_SCALE_ROWS(in_t, out_t)                                         \
+    {                                                                       \
+        const bool use_fill = scale->use_fill;                              \
+        const in_t fill = (in_t) scale->fill_value;                         \
+        const out_t gain = (out_t) scale->scale_factor;                     \
+        const out_t offset = (out_t) scale->add_offset;                     \
+        const out_t nan = (out_t) NAN;                                      \
+        for (row = 0; row < nrows; row++)                                   \
+        {                                                                   \
+            const in_t *restrict in = (const in_t *) src;                   \
+            out_t *restrict out = (out_t *) dst;                            \
+            for (pix = 0; pix < npix; pix++)                                \
+                out[pix] = (out_t) in[pix] * gain + offset;                 \
+            if (use_fill)                                                   \
+            {                                                               \
+                for (pix = 0; pix < npix; pix++)                            \
+                    out[pix] = (in[pix] == fill) ? nan : out[pix];          \
+            }                                                               \
+            src += src_stride;                                              \
+            dst += dst_stride;                                              \
+        }                                                                   \
+    }
+
+#define ARD_SCALE_ROWS_TO(in_t)                                             \
+    {                                                                       \
+        if (scale->out_type == ARD_FLOAT32)                                 \
+            ARD_SCALE_ROWS (in_t, float)                                    \
+        else                                                                \
+            ARD_SCALE_ROWS (in_t, double)                                   \
+    }
+
+    switch (scale->in_type)
+    {
+        case ARD_INT8:    ARD_SCALE_ROWS_TO (int8_t); break;
+        case ARD_UINT8:   ARD_SCALE_ROWS_TO (uint8_t); break;
+        case ARD_INT16:   ARD_SCALE_ROWS_TO (int16_t); break;
+        case ARD_UINT16:  ARD_SCALE_ROWS_TO (uint16_t); break;
+        case ARD_INT32:   ARD_SCALE_ROWS_TO (int32_t); break;
+        case ARD_UINT32:  ARD_SCALE_ROWS_TO (uint32_t); break;
+        case ARD_FLOAT32: ARD_SCALE_ROWS_TO (float); break;
+        case ARD_FLOAT64: ARD_SCALE_ROWS_TO (double); break;
+    }
+
+#undef ARD_SCALE_ROWS_TO
+#undef ARD_SCALE_ROWS
+}
+
+
+/******************************************************************************
+MODULE: ard_write_tiff
+
+PURPOSE: Writes the entire Tiff file as tile-oriented and compressed
+ 
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred writing data to the Tiff file
+SUCCESS      Writing was successful
+
+NOTES:
+1. It is expected the Tiff file will have tiling specified and the tile size
+   is already identified for the Tiff pointer (see set_tiff_tags).
+2. It is assumed the compression is already specified as well
+   (see set_tiff_tags).
+3. The image is written from a packed buffer (see ard_write_tiff_stride).
+*****************************************************************************/
+int ard_write_tiff
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be written (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to write to the file */
+    int nsamps,      /* I: number of samples to write to the file */
+    void *img_buf    /* I: array of nlines * nsamps * size to be written to the
+                           Tiff file */
+)
+{
+    return ard_write_tiff_stride (tif, data_type, nlines, nsamps, img_buf, 0);
+}
+
+
+/******************************************************************************
+MODULE: ard_write_tiff_tiles
+
+PURPOSE: Writes the entire Tiff file as tile-oriented and compressed, from an
+image buffer with an arbitrary row stride, optionally accumulating the
+statistics of the band on the way
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred writing data to the Tiff file
+SUCCESS      Writing was successful
+
+NOTES:
+1. See ard_write_tiff_stride and ard_write_tiff_stats.
+2. The statistics are accumulated from each tile just after it has been
+   copied into the tile buffer, while it is still in cache.
+*****************************************************************************/
+static int ard_write_tiff_tiles
+(
+    TIFF *tif,         /* I: pointer to the Tiff file */
+    int data_type,     /* I: data type of the array to be written (see
+                             Ard_data_type in ard_metadata.h) */
+    int nlines,        /* I: number of lines to write to the file */
+    int nsamps,        /* I: number of samples to write to the file */
+    const void *img_buf, /* I: first pixel of the image to be written to the
+                             Tiff file */
+    size_t stride,     /* I: number of bytes between the start of each line
+                             in img_buf; 0 for nsamps * size */
+    Ard_tiff_stats_t *stats  /* I/O: statistics to be updated; NULL for no
+                             statistics */
+)
+{
+    char FUNC_NAME[] = "ard_write_tiff_tiles"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int line, samp;         /* UL line, samp of the current tile */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+    int t_nlines = 0;       /* number of lines in each tile */
+    int t_nsamps = 0;       /* number of samples in each tile */
+    int copy_nlines;        /* how many lines of the image will be copied to
+                               the tile */
+    int copy_nsamps;        /* how many samples of the image will be copied
+                               to the tile */
+    int nbytes;             /* number of bytes per pixel */
+    size_t tile_size;       /* size of each tile (bytes) */
+    const uint8_t *img_ptr = img_buf;  /* byte pointer to the image buffer */
+    tdata_t t_buf = NULL;   /* tile data buffer (void ptr from TIFF) */
+
+    /* Get the size of the image as well as the size of each tile */
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    TIFFGetField(tif, TIFFTAG_TILEWIDTH, &t_nsamps);
+    TIFFGetField(tif, TIFFTAG_TILELENGTH, &t_nlines);
+
+    /* If the size of the tile is invalid, then tiling hasn't been turned
+       on for this image (which is expected) */
+    if (t_nsamps <= 0 || t_nlines <= 0)
+    {
+        sprintf (errmsg, "Tiff is not a tile-oriented image");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* If the size of the image doesn't match that of the user-specified
+       size (and the size of the input image buffer), then it's an error */
+    if (img_nsamps != nsamps || img_nlines != nlines)
+    {
+        sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
+            "match Tiff image size (%d lines x %d samps)", nlines, nsamps,
+            img_nlines, img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Get the size of each pixel */
+    nbytes = ard_data_type_size (data_type);
+    if (nbytes == ERROR)
+    {
+        sprintf (errmsg, "Unsupported data type %d", data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Check the stride */
+    if (stride == 0)
+        stride = (size_t) nsamps * nbytes;
+    else if (stride < (size_t) nsamps * nbytes)
+    {
+        sprintf (errmsg, "Stride of %ld bytes is less than one line of %d "
+            "samps", (long) stride, nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Allocate space for the tile buffer */
+    tile_size = TIFFTileSize (tif);
+    t_buf = _TIFFmalloc (tile_size);
+    if (t_buf == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for the tile buffer");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Tile the data and write each tile */
+    for (line = 0; line < nlines; line += t_nlines)
+    {
+        copy_nlines = nlines - line;
+        if (copy_nlines > t_nlines)
+            copy_nlines = t_nlines;
+
+        for (samp = 0; samp < nsamps; samp += t_nsamps)
+        {
+            /* Determine how many samples to copy to the tile.  If this
+               is the last tile in the line, then we won't be copying the
+               data to fill the entire tile. */
+            copy_nsamps = nsamps - samp;
+            if (copy_nsamps > t_nsamps)
+                copy_nsamps = t_nsamps;
+
+            /* Copy the image into the tile, padding the partial tiles on the
+               right and bottom edges with zeros */
+            if (copy_nlines < t_nlines || copy_nsamps < t_nsamps)
+                memset (t_buf, 0, tile_size);
+            ard_copy_rows (&img_ptr[(size_t) line * stride + (size_t) samp *
+                nbytes], stride, t_buf, (size_t) t_nsamps * nbytes,
+                copy_nlines, (size_t) copy_nsamps * nbytes);
+            if (stats != NULL)
+                ard_add_tiff_stats (stats, data_type, t_buf,
+                    (size_t) t_nsamps * nbytes, copy_nlines, copy_nsamps);
+
+            /* Write the current tile (i.e. write the tile containing the
+               current x,y which should be the UL corner of the tile) */
+            if (TIFFWriteTile (tif, t_buf, samp, line, 0 /*z*/, 0) < 0)
+            {
+                sprintf (errmsg, "Writing Tiff file for line, samp: %d, %d.",
+                    line, samp);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                _TIFFfree (t_buf);
+                return ERROR;
+            }
+        }  /* samp */
+    }  /* line */
+
+    /* Free the tile buffer */
+    _TIFFfree (t_buf);
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_write_tiff_stride
+
+PURPOSE: Writes the entire Tiff file as tile-oriented and compressed, from an
+image buffer with an arbitrary row stride
+ 
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred writing data to the Tiff file
+SUCCESS      Writing was successful
+
+NOTES:
+1. It is expected the Tiff file will have tiling specified and the tile size
+   is already identified for the Tiff pointer (see set_tiff_tags).
+2. It is assumed the compression is already specified as well
+   (see set_tiff_tags).
+3. Line i of the image starts at img_buf + i * stride, so the image can be a
+   region within a larger mosaic or a padded buffer.  A stride of 0 means the
+   image is packed (nsamps * size bytes per line).
+4. The partial tiles on the right and bottom edges of the image are padded
+   with zeros.
+*****************************************************************************/
+int ard_write_tiff_stride
+(
+    TIFF *tif,         /* I: pointer to the Tiff file */
+    int data_type,     /* I: data type of the array to be written (see
+                             Ard_data_type in ard_metadata.h) */
+    int nlines,        /* I: number of lines to write to the file */
+    int nsamps,        /* I: number of samples to write to the file */
+    const void *img_buf, /* I: first pixel of the image to be written to the
+                             Tiff file */
+    size_t stride      /* I: number of bytes between the start of each line
+                             in img_buf; 0 for nsamps * size */
+)
+{
+    return ard_write_tiff_tiles (tif, data_type, nlines, nsamps, img_buf,
+        stride, NULL);
+}
+
+
+/******************************************************************************
+MODULE: ard_write_tiff_stats
+
+PURPOSE: Writes the entire Tiff file as tile-oriented and compressed (see
+ard_write_tiff), accumulating the statistics and histogram of the band from
+each tile as it is written
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred writing data to the Tiff file
+SUCCESS      Writing was successful
+
+NOTES:
+1. The statistics options (fill value and histogram) should be set, and any
+   earlier results cleared, before calling (see init_ard_tiff_stats).  The
+   tiles are added to the existing results, so a band can be accumulated
+   over several calls.
+2. Use ard_tiff_stats_valid_range to copy the min and max to the band
+   metadata.
+*****************************************************************************/
+int ard_write_tiff_stats
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be written (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to write to the file */
+    int nsamps,      /* I: number of samples to write to the file */
+    void *img_buf,   /* I: array of nlines * nsamps * size to be written to the
                            Tiff file */
+    Ard_tiff_stats_t *stats  /* I/O: statistics to be updated */
+)
+{
+    return ard_write_tiff_tiles (tif, data_type, nlines, nsamps, img_buf, 0,
+        stats);
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_strips
+
+PURPOSE: Reads a rectangular window (region of interest) from a
+strip-oriented Tiff file into an image buffer with an arbitrary row stride.
+Only the strips which intersect the window are read and decompressed.
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. Each strip is decoded once, no matter how many lines of the window it
+   holds.  Strips which lie completely within the window are decoded
+   directly into img_buf when the window is the full width of the image and
+   the lines are packed, otherwise they are decoded into a strip buffer and
+   the window is copied with the row copy kernel for the data type (or
+   converted with ard_scale_rows).
+2. The window and stride are expected to have been validated by the caller
+   (see ard_read_tiff_window_stride).
+3. Only single-sample images, with lines of nsamps * nbytes bytes, are
+   supported.
+*****************************************************************************/
+static int ard_read_tiff_strips
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    int data_type,    /* I: data type stored in the Tiff file (see
+                            Ard_data_type in ard_metadata.h) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window */
+    size_t stride,    /* I: number of bytes between the start of each line in
+                            img_buf */
+    const Ard_scale_t *scale,  /* I: conversion to physical values; NULL to
+                            copy the stored values */
+    Ard_tiff_stats_t *stats  /* I/O: statistics to be updated; NULL for no
+                            statistics */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_strips"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int line;               /* first line of the current strip */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+    int end_line;           /* line after the last line of the window */
+    int first_line;         /* first window line covered by the current
+                               strip */
+    int last_line;          /* line after the last window line covered by the
+                               current strip */
+    int strip_nlines;       /* number of lines in the current strip */
+    uint32_t rows_per_strip = 0;  /* number of lines in each strip */
+    size_t line_size;       /* number of bytes in each line of the image */
+    tstrip_t strip;         /* current strip */
+    uint8_t *win_ptr = img_buf; /* byte pointer to the window buffer */
+    uint8_t *strip_buf = NULL;  /* strip data buffer */
+    uint8_t *src_ptr = NULL;    /* strip location for the current window
+                                   lines */
+    uint8_t *dst_ptr = NULL;    /* window location for the current strip */
+    Ard_prefetch_t pf;      /* prefetching for the strips of the window */
+    int nbytes = ard_data_type_size (data_type);
+                            /* number of bytes per pixel */
+
+    /* Get the size of the image and of each strip */
+    TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    TIFFGetField (tif, TIFFTAG_ROWSPERSTRIP, &rows_per_strip);
+    if (rows_per_strip == 0 || rows_per_strip > (uint32_t) img_nlines)
+        rows_per_strip = img_nlines;
+
+    /* Make sure the lines are laid out as expected for the data type */
+    line_size = (size_t) img_nsamps * nbytes;
+    if ((size_t) TIFFScanlineSize (tif) != line_size)
+    {
+        sprintf (errmsg, "Tiff lines are %ld bytes rather than %d samps of "
+            "%d bytes", (long) TIFFScanlineSize (tif), img_nsamps, nbytes);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Read only the strips which intersect the window */
+    end_line = start_line + nlines;
+    ard_init_prefetch (&pf, tif, start_line / rows_per_strip,
+        (end_line - 1) / rows_per_strip - start_line / rows_per_strip + 1, 1,
+        1);
+    for (line = start_line - start_line % rows_per_strip; line < end_line;
+         line += rows_per_strip)
+    {
+        strip = TIFFComputeStrip (tif, line, 0);
+        ard_prefetch_tiles (&pf, strip - start_line / rows_per_strip);
+        strip_nlines = img_nlines - line;
+        if (strip_nlines > (int) rows_per_strip)
+            strip_nlines = rows_per_strip;
+
+        /* Determine the window lines covered by this strip */
+        first_line = (line > start_line) ? line : start_line;
+        last_line = line + strip_nlines;
+        if (last_line > end_line)
+            last_line = end_line;
+
+        /* If the window lines for the entire strip are laid out the same as
+           the strip, then decode it in place */
+        if (scale == NULL && first_line == line &&
+            last_line == line + strip_nlines && nsamps == img_nsamps &&
+            stride == line_size)
+        {
+            if (TIFFReadEncodedStrip (tif, strip,
+                &win_ptr[(size_t) (line - start_line) * stride],
+                (tmsize_t) strip_nlines * line_size) < 0)
+            {
+                sprintf (errmsg, "Reading Tiff file for strip %u.", strip);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                free (strip_buf);
+                return ERROR;
+            }
+            if (stats != NULL)
+                ard_add_tiff_stats (stats, data_type,
+                    &win_ptr[(size_t) (line - start_line) * stride], stride,
+                    strip_nlines, nsamps);
+            continue;
+        }
+
+        /* Otherwise decode the strip into the strip buffer and copy the
+           window from there */
+        if (strip_buf == NULL)
+        {
+            strip_buf = malloc ((size_t) rows_per_strip * line_size);
+            if (strip_buf == NULL)
+            {
+                sprintf (errmsg, "Unable to allocate memory for the strip "
+                    "buffer");
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return ERROR;
+            }
+        }
+
+        if (TIFFReadEncodedStrip (tif, strip, strip_buf,
+            (tmsize_t) strip_nlines * line_size) < 0)
+        {
+            sprintf (errmsg, "Reading Tiff file for strip %u.", strip);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            free (strip_buf);
+            return ERROR;
+        }
+
+        src_ptr = &strip_buf[(size_t) (first_line - line) * line_size +
+            (size_t) start_samp * nbytes];
+        dst_ptr = &win_ptr[(size_t) (first_line - start_line) * stride];
+        if (stats != NULL)
+            ard_add_tiff_stats (stats, data_type, src_ptr, line_size,
+                last_line - first_line, nsamps);
+        if (scale == NULL)
+            ard_copy_rows (src_ptr, line_size, dst_ptr, stride,
+                last_line - first_line, (size_t) nsamps * nbytes);
+        else
+            ard_scale_rows (src_ptr, line_size, dst_ptr, stride,
+                last_line - first_line, nsamps, scale);
+    }  /* line */
+
+    /* Free the strip buffer */
+    free (strip_buf);
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff
+
+PURPOSE: Reads the entire Tiff file, which can be tile or strip-oriented
+ 
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. The full image is read as a window covering the entire image (see
+   ard_read_tiff_window).
+*****************************************************************************/
+int ard_read_tiff
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be read (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to read from the file */
+    int nsamps,      /* I: number of samples to read from the file */
+    void *img_buf    /* O: array of nlines * nsamps * size to be read from the
+                           Tiff file (sufficient space should already have
+                           been allocated) */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+
+    /* Get the size of the image */
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+
+    /* If the size of the image doesn't match that of the user-specified
+       size (and the size of the input image buffer), then it's an error */
+    if (img_nsamps != nsamps || img_nlines != nlines)
+    {
+        sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
+            "match Tiff image size (%d lines x %d samps)", nlines, nsamps,
+            img_nlines, img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Read the entire image as one window */
+    if (ard_read_tiff_window (tif, data_type, 0, 0, nlines, nsamps, img_buf)
+        != SUCCESS)
+    {
+        sprintf (errmsg, "Reading the full Tiff image");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_window
+
+PURPOSE: Reads a rectangular window (region of interest) from a tile-oriented
+Tiff file.  Only the tiles which intersect the window are read and
+decompressed.
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. The window is returned packed in img_buf, i.e. line i of the window starts
+   at img_buf + i * nsamps * size (see ard_read_tiff_window_stride).
+2. The window must lie completely within the image.
+*****************************************************************************/
+int ard_read_tiff_window
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    int data_type,    /* I: data type of the array to be read (see
+                            Ard_data_type in ard_metadata.h) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf     /* O: array of nlines * nsamps * size to be read from
+                            the Tiff file (sufficient space should already
+                            have been allocated) */
+)
+{
+    return ard_read_tiff_window_stride (tif, data_type, start_line,
+        start_samp, nlines, nsamps, img_buf, 0);
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_window_conv
+
+PURPOSE: Reads a rectangular window (region of interest) from a tile or
+strip-oriented Tiff file into an image buffer with an arbitrary row stride,
+optionally converting the stored values to physical values and accumulating
+their statistics on the way.
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. See ard_read_tiff_window_stride and ard_read_tiff_window_scaled.
+2. When converting, each tile is decoded into the tile buffer and converted
+   into img_buf with ard_scale_rows, so the stored values never need a full
+   size buffer of their own.
+3. The statistics are accumulated from the window portion of each tile (or
+   strip) just after it has been decoded, while it is still in cache.
+4. If the read options of the file have a tile cache (see
+   ard_set_tiff_read_opts), then the tiles are taken from the cache when
+   they are there, and added to it when they have to be decoded.
+*****************************************************************************/
+static int ard_read_tiff_window_conv
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    int data_type,    /* I: data type stored in the Tiff file (see
+                            Ard_data_type in ard_metadata.h) */
+    const Ard_scale_t *scale,  /* I: conversion to physical values; NULL to
+                            copy the stored values */
+    Ard_tiff_stats_t *stats,  /* I/O: statistics of the stored values to be
+                            updated; NULL for no statistics */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window */
+    size_t stride     /* I: number of bytes between the start of each line in
+                            img_buf; 0 for nsamps * size */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_window_conv"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int line, samp;         /* UL line, samp of the current tile */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+    int t_nlines = 0;       /* number of lines in each tile */
+    int t_nsamps = 0;       /* number of samples in each tile */
+    int end_line;           /* line after the last line of the window */
+    int end_samp;           /* sample after the last sample of the window */
+    int first_line;         /* first window line covered by the current tile */
+    int last_line;          /* line after the last window line covered by the
+                               current tile */
+    int first_samp;         /* first window samp covered by the current tile */
+    int copy_nsamps;        /* how many samples from the tile will be copied
+                               to the window */
+    int nbytes;             /* number of bytes per pixel */
+    int out_nbytes;         /* number of bytes per pixel in img_buf */
+    size_t t_stride;        /* number of bytes in each line of a tile */
+    uint8_t *win_ptr = img_buf; /* byte pointer to the window buffer */
+    uint8_t *tile_ptr = NULL;   /* byte pointer to the tile buffer */
+    uint8_t *src_ptr = NULL;    /* tile location for the current window
+                                   lines */
+    uint8_t *dst_ptr = NULL;    /* window location for the current tile */
+    tdata_t t_buf = NULL;   /* tile data buffer (void ptr from TIFF) */
+    tmsize_t tile_size;     /* size of each tile (bytes) */
+    const Ard_tiff_read_opts_t *read_opts = ard_get_tiff_read_opts (tif);
+                            /* read options attached to the file */
+    Ard_tile_cache_t *cache = (read_opts != NULL) ? read_opts->cache : NULL;
+                            /* tile cache, if any */
+    Ard_tile_key_t key;     /* cache key for the current tile */
+    Ard_tile_entry_t *entry = NULL;  /* cached copy of the current tile */
+    Ard_prefetch_t pf;      /* prefetching for the tiles of the window */
+    int tile_count = 0;     /* number of window tiles read so far */
+
+    /* Get the size of the image as well as the size of each tile */
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    TIFFGetField(tif, TIFFTAG_TILEWIDTH, &t_nsamps);
+    TIFFGetField(tif, TIFFTAG_TILELENGTH, &t_nlines);
+
+    /* Make sure the window is within the image */
+    end_line = start_line + nlines;
+    end_samp = start_samp + nsamps;
+    if (start_line < 0 || start_samp < 0 || nlines <= 0 || nsamps <= 0 ||
+        end_line > img_nlines || end_samp > img_nsamps)
+    {
+        sprintf (errmsg, "Window (start line %d, start samp %d, %d lines x "
+            "%d samps) is not within the Tiff image size (%d lines x %d "
+            "samps)", start_line, start_samp, nlines, nsamps, img_nlines,
+            img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Get the size of each pixel */
+    nbytes = ard_data_type_size (data_type);
+    if (nbytes == ERROR)
+    {
+        sprintf (errmsg, "Unsupported data type %d", data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Check the stride */
+    out_nbytes = (scale == NULL) ? nbytes : ard_data_type_size
+        (scale->out_type);
+    t_stride = (size_t) t_nsamps * nbytes;
+    if (stride == 0)
+        stride = (size_t) nsamps * out_nbytes;
+    else if (stride < (size_t) nsamps * out_nbytes)
+    {
+        sprintf (errmsg, "Stride of %ld bytes is less than one line of %d "
+            "samps", (long) stride, nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Strip-oriented images are read a strip at a time */
+    if (!TIFFIsTiled (tif))
+        return ard_read_tiff_strips (tif, data_type, start_line, start_samp,
+            nlines, nsamps, img_buf, stride, scale, stats);
+
+    /* If the size of the tile is invalid, then this isn't a tile-oriented
+       image */
+    if (t_nsamps <= 0 || t_nlines <= 0)
+    {
+        sprintf (errmsg, "Tiff is not a tile-oriented image");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Allocate space for the tile buffer */
+    tile_size = TIFFTileSize (tif);
+    t_buf = _TIFFmalloc (tile_size);
+    if (t_buf == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for the tile buffer");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Files which can't be identified aren't cached */
+    if (cache != NULL && ard_tile_cache_key (tif, 0, &key) != SUCCESS)
+        cache = NULL;
+
+    /* Read only the tiles which intersect the window.  Start with the tile
+       containing the UL corner of the window. */
+    ard_init_prefetch (&pf, tif, TIFFComputeTile (tif, start_samp,
+        start_line, 0, 0), (end_line - 1) / t_nlines - start_line / t_nlines
+        + 1, (end_samp - 1) / t_nsamps - start_samp / t_nsamps + 1,
+        (img_nsamps + t_nsamps - 1) / t_nsamps);
+    for (line = start_line - start_line % t_nlines; line < end_line;
+         line += t_nlines)
+    {
+        /* Determine the window lines covered by this row of tiles */
+        first_line = (line > start_line) ? line : start_line;
+        last_line = line + t_nlines;
+        if (last_line > end_line)
+            last_line = end_line;
+
+        for (samp = start_samp - start_samp % t_nsamps; samp < end_samp;
+             samp += t_nsamps)
+        {
+            /* Determine the window samples covered by this tile */
+            first_samp = (samp > start_samp) ? samp : start_samp;
+            copy_nsamps = samp + t_nsamps;
+            if (copy_nsamps > end_samp)
+                copy_nsamps = end_samp;
+            copy_nsamps -= first_samp;
+            dst_ptr = &win_ptr[(size_t) (first_line - start_line) * stride +
+                (size_t) (first_samp - start_samp) * out_nbytes];
+
+            /* Prefetch the upcoming tiles */
+            ard_prefetch_tiles (&pf, tile_count++);
+
+            /* Use the cached copy of the tile, if there is one */
+            entry = NULL;
+            if (cache != NULL)
+            {
+                key.tile = TIFFComputeTile (tif, samp, line, 0, 0);
+                entry = ard_get_cached_tile (cache, &key);
+            }
+
+            /* If the entire tile is within the window and its lines are laid
+               out the same as the window lines, then decode it in place */
+            if (entry == NULL && scale == NULL && stride == t_stride &&
+                first_line == line && last_line - line == t_nlines &&
+                first_samp == samp && copy_nsamps == t_nsamps)
+            {
+                if (TIFFReadTile (tif, dst_ptr, samp, line, 0 /*z*/, 0) < 0)
+                {
+                    sprintf (errmsg, "Reading Tiff file for line, samp: "
+                        "%d, %d.", line, samp);
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    _TIFFfree (t_buf);
+                    return ERROR;
+                }
+                if (cache != NULL)
+                    ard_put_cached_tile (cache, &key, dst_ptr, tile_size);
+                if (stats != NULL)
+                    ard_add_tiff_stats (stats, data_type, dst_ptr, stride,
+                        t_nlines, t_nsamps);
+                continue;
+            }
+
+            /* Otherwise read the current tile (i.e. read the tile
+               containing the current x,y which should be the UL corner of
+               the tile) */
+            if (entry != NULL)
+                tile_ptr = entry->data;
+            else
+            {
+                if (TIFFReadTile (tif, t_buf, samp, line, 0 /*z*/, 0) < 0)
+                {
+                    sprintf (errmsg, "Reading Tiff file for line, samp: "
+                        "%d, %d.", line, samp);
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    _TIFFfree (t_buf);
+                    return ERROR;
+                }
+                tile_ptr = t_buf;
+                if (cache != NULL)
+                    ard_put_cached_tile (cache, &key, t_buf, tile_size);
+            }
+
+            /* Copy (or convert) the portion of the tile within the window */
+            src_ptr = &tile_ptr[(size_t) (first_line - line) * t_stride +
+                (size_t) (first_samp - samp) * nbytes];
+            if (stats != NULL)
+                ard_add_tiff_stats (stats, data_type, src_ptr, t_stride,
+                    last_line - first_line, copy_nsamps);
+            if (scale == NULL)
+                ard_copy_rows (src_ptr, t_stride, dst_ptr, stride,
+                    last_line - first_line, (size_t) copy_nsamps * nbytes);
+            else
+                ard_scale_rows (src_ptr, t_stride, dst_ptr, stride,
+                    last_line - first_line, copy_nsamps, scale);
+            if (entry != NULL)
+                ard_release_cached_tile (cache, entry);
+        }  /* samp */
+    }  /* line */
+
+    /* Free the tile buffer */
+    _TIFFfree (t_buf);
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_window_stride
+
+PURPOSE: Reads a rectangular window (region of interest) from a tile or
+strip-oriented Tiff file into an image buffer with an arbitrary row stride.
+Only the tiles or strips which intersect the window are read and
+decompressed.
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. Line i of the window is returned at img_buf + i * stride, so the window
+   can be read directly into its place within a larger mosaic or a padded
+   buffer.  A stride of 0 means the window is packed (nsamps * size bytes per
+   line).
+2. The window must lie completely within the image.
+3. Tiles which lie completely within the window are decoded directly into
+   img_buf when the stride matches the tile width, otherwise they are decoded
+   into a tile buffer and copied with the row copy kernel for the data type.
+4. Strip-oriented images are read with ard_read_tiff_strips.
+*****************************************************************************/
+int ard_read_tiff_window_stride
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    int data_type,    /* I: data type of the array to be read (see
+                            Ard_data_type in ard_metadata.h) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window; sufficient space for
+                            nlines of stride bytes should already have been
+                            allocated */
+    size_t stride     /* I: number of bytes between the start of each line in
+                            img_buf; 0 for nsamps * size */
+)
+{
+    return ard_read_tiff_window_conv (tif, data_type, NULL, NULL, start_line,
+        start_samp, nlines, nsamps, img_buf, stride);
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_stats
+
+PURPOSE: Reads the entire Tiff file (see ard_read_tiff), accumulating the
+statistics and histogram of the band from each tile as it is decoded
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. The statistics options (fill value and histogram) should be set, and any
+   earlier results cleared, before calling (see init_ard_tiff_stats).  The
+   tiles are added to the existing results, so a band can be accumulated
+   over several calls.
+2. Use ard_tiff_stats_valid_range to copy the min and max to the band
+   metadata.
+*****************************************************************************/
+int ard_read_tiff_stats
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    int data_type,    /* I: data type of the array to be read (see
+                            Ard_data_type in ard_metadata.h) */
+    int nlines,       /* I: number of lines to read from the file */
+    int nsamps,       /* I: number of samples to read from the file */
+    void *img_buf,    /* O: array of nlines * nsamps * size to be read from
+                            the Tiff file (sufficient space should already
+                            have been allocated) */
+    Ard_tiff_stats_t *stats  /* I/O: statistics to be updated */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_stats"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+
+    /* Make sure the size of the image matches the user-specified size */
+    TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    if (img_nsamps != nsamps || img_nlines != nlines)
+    {
+        sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
+            "match Tiff image size (%d lines x %d samps)", nlines, nsamps,
+            img_nlines, img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    return ard_read_tiff_window_conv (tif, data_type, NULL, stats, 0, 0,
+        nlines, nsamps, img_buf, 0);
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_window_scaled
+
+PURPOSE: Reads a rectangular window (region of interest) from a tile or
+strip-oriented Tiff file as physical values, i.e. with the scale factor and
+offset of the band applied and fill pixels converted to NaN.
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. The stored values are expected to be of bmeta->data_type.  Each tile (or
+   strip) is converted into img_buf as it is decoded, so there is no second
+   pass over the window and no full size buffer of stored values.
+2. A scale factor or offset which isn't defined in the band metadata
+   (ARD_FLOAT_META_FILL) is taken as 1.0 or 0.0.  If the fill value isn't
+   defined (ARD_INT_META_FILL), then no pixels are converted to NaN.
+3. Line i of the window is returned at img_buf + i * stride (see
+   ard_read_tiff_window_stride).
+*****************************************************************************/
+int ard_read_tiff_window_scaled
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    const Ard_band_meta_t *bmeta,  /* I: band metadata for the data type,
+                            scale factor, offset, and fill value */
+    int out_type,     /* I: data type of the physical values (ARD_FLOAT32 or
+                            ARD_FLOAT64) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window; sufficient space for
+                            nlines of stride bytes should already have been
+                            allocated */
+    size_t stride     /* I: number of bytes between the start of each line in
+                            img_buf; 0 for nsamps * size of out_type */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_window_scaled"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    Ard_scale_t scale;      /* conversion to physical values */
+
+    /* Physical values are always floating point */
+    if (out_type != ARD_FLOAT32 && out_type != ARD_FLOAT64)
+    {
+        sprintf (errmsg, "Output data type %d is not a floating point data "
+            "type", out_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Set up the conversion from the band metadata */
+    scale.in_type = bmeta->data_type;
+    scale.out_type = out_type;
+    scale.scale_factor = 1.0;
+    if (fabs (bmeta->scale_factor - ARD_FLOAT_META_FILL) > ARD_EPSILON)
+        scale.scale_factor = bmeta->scale_factor;
+    scale.add_offset = 0.0;
+    if (fabs (bmeta->add_offset - ARD_FLOAT_META_FILL) > ARD_EPSILON)
+        scale.add_offset = bmeta->add_offset;
+    scale.use_fill = (bmeta->fill_value != ARD_INT_META_FILL);
+    scale.fill_value = bmeta->fill_value;
+
+    return ard_read_tiff_window_conv (tif, bmeta->data_type, &scale, NULL,
+        start_line, start_samp, nlines, nsamps, img_buf, stride);
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_scaled
+
+PURPOSE: Reads the entire Tiff file as physical values (see
+ard_read_tiff_window_scaled)
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+*****************************************************************************/
+int ard_read_tiff_scaled
+(
+    TIFF *tif,        /* I: pointer to the Tiff file */
+    const Ard_band_meta_t *bmeta,  /* I: band metadata for the data type,
+                            scale factor, offset, and fill value */
+    int out_type,     /* I: data type of the physical values (ARD_FLOAT32 or
+                            ARD_FLOAT64) */
+    int nlines,       /* I: number of lines to read from the file */
+    int nsamps,       /* I: number of samples to read from the file */
+    void *img_buf     /* O: array of nlines * nsamps * size of out_type to be
+                            read from the Tiff file (sufficient space should
+                            already have been allocated) */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_scaled"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+
+    /* Make sure the size of the image matches the user-specified size */
+    TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    if (img_nsamps != nsamps || img_nlines != nlines)
+    {
+        sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
+            "match Tiff image size (%d lines x %d samps)", nlines, nsamps,
+            img_nlines, img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    return ard_read_tiff_window_scaled (tif, bmeta, out_type, 0, 0, nlines,
+        nsamps, img_buf, 0);
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_blocks
+
+PURPOSE: Reads the entire Tiff file one tile, or one row of tiles, at a time
+and hands each block to the caller's handler
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file, or the
+             handler returned an error
+SUCCESS      Reading was successful
+
+NOTES:
+1. Only one tile (ARD_BLOCK_TILE) or one row of tiles (ARD_BLOCK_TILE_ROW)
+   is held in memory at a time, no matter the size of the image, and the
+   buffers are reused from block to block.
+2. The blocks are clipped to the image, so the tiles on the right and bottom
+   edges are handed over without their padding.  Line i of each block starts
+   at i * stride bytes; for ARD_BLOCK_TILE the stride is that of the full
+   tile, and the block is the tile buffer libtiff decoded into.
+3. The blocks are handed over in order, left to right and top to bottom.
+   The block is only valid for the duration of the handler call.
+*****************************************************************************/
+int ard_read_tiff_blocks
+(
+    TIFF *tif,         /* I: pointer to the Tiff file */
+    int data_type,     /* I: data type of the array to be read (see
+                             Ard_data_type in ard_metadata.h) */
+    Ard_block_type_t block_type,  /* I: hand over single tiles or rows of
+                             tiles */
+    Ard_block_handler_t handler,  /* I: handler for each block */
+    void *handler_data /* I/O: data passed through to the handler */
 )
 {
-    char FUNC_NAME[] = "ard_write_tiff"; /* function name */
-    char errmsg[STR_SIZE];   /* error message */
-    int line, samp;         /* looping variables for full image */
-    int t_line;             /* looping variable for tile */
-    int curr_pix;           /* current pixel in the full image */
-    int curr_tile_pix;      /* current pixel in the tile */
+    char FUNC_NAME[] = "ard_read_tiff_blocks"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int line, samp;         /* UL line, samp of the current tile */
     int img_nlines;         /* number of lines in the Tiff file */
     int img_nsamps;         /* number of samples in the Tiff file */
     int t_nlines = 0;       /* number of lines in each tile */
     int t_nsamps = 0;       /* number of samples in each tile */
-    int copy_nsamps;        /* how many samples from the tile will be copied
-                               to the full image */
-    int8_t *int8_ptr = NULL;       /* pointer for int8 data types */
-    int8_t *int8_t_ptr = NULL;     /* pointer for int8 tile data types */
-    uint8_t *uint8_ptr = NULL;     /* pointer for uint8 data types */
-    uint8_t *uint8_t_ptr = NULL;   /* pointer for uint8 tile data types */
-    int16_t *int16_ptr = NULL;     /* pointer for int16 data types */
-    int16_t *int16_t_ptr = NULL;   /* pointer for int16 tile data types */
-    uint16_t *uint16_ptr = NULL;   /* pointer for uint16 data types */
-    uint16_t *uint16_t_ptr = NULL; /* pointer for uint16 tile data types */
-    int32_t *int32_ptr = NULL;     /* pointer for int32 data types */
-    int32_t *int32_t_ptr = NULL;   /* pointer for int32 tile data types */
-    uint32_t *uint32_ptr = NULL;   /* pointer for uint32 data types */
-    uint32_t *uint32_t_ptr = NULL; /* pointer for uint32 tile data types */
-    float *float_ptr = NULL;       /* pointer for float data types */
-    float *float_t_ptr = NULL;     /* pointer for float tile data types */
-    double *double_ptr = NULL;     /* pointer for double data types */
-    double *double_t_ptr = NULL;   /* pointer for double tile data types */
-    tdata_t t_buf = NULL;          /* tile data buffer (void ptr from TIFF) */
+    int copy_nlines;        /* number of image lines in the current tile */
+    int copy_nsamps;        /* number of image samples in the current tile */
+    int nbytes;             /* number of bytes per pixel */
+    int status = SUCCESS;   /* return status */
+    size_t t_stride;        /* number of bytes in each line of a tile */
+    size_t row_stride;      /* number of bytes in each line of the image */
+    uint8_t *row_buf = NULL;    /* buffer for a row of tiles */
+    tdata_t t_buf = NULL;   /* tile data buffer (void ptr from TIFF) */
+    Ard_prefetch_t pf;      /* prefetching for the tiles of the image */
+    int tile_count = 0;     /* number of tiles read so far */
 
     /* Get the size of the image as well as the size of each tile */
     TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
@@ -728,8 +2499,8 @@ int ard_write_tiff
     TIFFGetField(tif, TIFFTAG_TILEWIDTH, &t_nsamps);
     TIFFGetField(tif, TIFFTAG_TILELENGTH, &t_nlines);
 
-    /* If the size of the tile is invalid, then tiling hasn't been turned
-       on for this image (which is expected) */
+    /* If the size of the tile is invalid, then this isn't a tile-oriented
+       image */
     if (t_nsamps <= 0 || t_nlines <= 0)
     {
         sprintf (errmsg, "Tiff is not a tile-oriented image");
@@ -737,228 +2508,207 @@ int ard_write_tiff
         return ERROR;
     }
 
-    /* If the size of the image doesn't match that of the user-specified
-       size (and the size of the input image buffer), then it's an error */
-    if (img_nsamps != nsamps || img_nlines != nlines)
+    /* Get the size of each pixel */
+    nbytes = ard_data_type_size (data_type);
+    if (nbytes == ERROR)
     {
-        sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
-            "match Tiff image size (%d lines x %d samps)", nlines, nsamps,
-            img_nlines, img_nsamps);
+        sprintf (errmsg, "Unsupported data type %d", data_type);
         ard_error_handler (true, FUNC_NAME, errmsg);
         return ERROR;
     }
+    t_stride = (size_t) t_nsamps * nbytes;
+    row_stride = (size_t) img_nsamps * nbytes;
 
-    /* Allocate space for the tile buffer */
+    /* Allocate space for the tile buffer, and the row buffer if the tiles
+       are handed over a row at a time */
     t_buf = _TIFFmalloc (TIFFTileSize (tif));
-    if (t_buf == NULL)
+    if (block_type == ARD_BLOCK_TILE_ROW)
+        row_buf = malloc ((size_t) t_nlines * row_stride);
+    if (t_buf == NULL || (block_type == ARD_BLOCK_TILE_ROW && row_buf == NULL))
     {
-        sprintf (errmsg, "Unable to allocate memory for the tile buffer");
+        sprintf (errmsg, "Unable to allocate memory for the tile buffers");
         ard_error_handler (true, FUNC_NAME, errmsg);
-        return ERROR;
+        status = ERROR;
+        goto cleanup;
     }
 
-    /* Set up the data type specific pointers */
-    switch (data_type)
+    ard_init_prefetch (&pf, tif, 0, (img_nlines + t_nlines - 1) / t_nlines,
+        (img_nsamps + t_nsamps - 1) / t_nsamps,
+        (img_nsamps + t_nsamps - 1) / t_nsamps);
+    for (line = 0; line < img_nlines; line += t_nlines)
     {
-        case ARD_INT8:
-            int8_ptr = img_buf;
-            int8_t_ptr = t_buf;
-            break;
-        case ARD_UINT8:
-            uint8_ptr = img_buf;
-            uint8_t_ptr = t_buf;
-            break;
-        case ARD_INT16:
-            int16_ptr = img_buf;
-            int16_t_ptr = t_buf;
-            break;
-        case ARD_UINT16:
-            uint16_ptr = img_buf;
-            uint16_t_ptr = t_buf;
-            break;
-        case ARD_INT32:
-            int32_ptr = img_buf;
-            int32_t_ptr = t_buf;
-            break;
-        case ARD_UINT32:
-            uint32_ptr = img_buf;
-            uint32_t_ptr = t_buf;
-            break;
-        case ARD_FLOAT32:
-            float_ptr = img_buf;
-            float_t_ptr = t_buf;
-            break;
-        case ARD_FLOAT64:
-            double_ptr = img_buf;
-            double_t_ptr = t_buf;
-            break;
-        default:
-            sprintf (errmsg, "Unsupported data type %d", data_type);
-            ard_error_handler (true, FUNC_NAME, errmsg);
-            return ERROR;
-    }
+        copy_nlines = img_nlines - line;
+        if (copy_nlines > t_nlines)
+            copy_nlines = t_nlines;
 
-    /* Tile the data from the Tiff file. Use the void pointer to point to
-       the location of the current line in the data type specific pointer. */
-    for (line = 0; line < nlines; line += t_nlines)
-    {
-        for (samp = 0; samp < nsamps; samp += t_nsamps)
+        for (samp = 0; samp < img_nsamps; samp += t_nsamps)
         {
-            /* Chop the full-sized image into the tiles */
-            for (t_line = 0; t_line < t_nlines; t_line++)
-            {
-                /* Make sure this line is within the image */
-                if (line + t_line >= nlines)
-                    break;
-
-                /* Set up the location of the current line, samp in the image
-                   as well as the tile buffers */
-                curr_pix = (line + t_line) * nsamps + samp;
-                curr_tile_pix = t_line * t_nsamps;
-
-                /* Determine how many samples to copy to the tile.  If this
-                   is the last tile in the line, then we won't be copying the
-                   data to fill the entire tile. */
-                copy_nsamps = nsamps - samp;
-                if (copy_nsamps > t_nsamps)
-                    copy_nsamps = t_nsamps;
-
-                /* Copy the data */
-                switch (data_type)
-                {
-                    case ARD_INT8:
-                        memcpy (&int8_t_ptr[curr_tile_pix], &int8_ptr[curr_pix],
-                            copy_nsamps * sizeof (int8));
-                        break;
-
-                    case ARD_UINT8:
-                        memcpy (&uint8_t_ptr[curr_tile_pix],
-                                &uint8_ptr[curr_pix],
-                                copy_nsamps * sizeof (uint8));
-                        break;
-
-                    case ARD_INT16:
-                        memcpy (&int16_t_ptr[curr_tile_pix],
-                                &int16_ptr[curr_pix],
-                                copy_nsamps * sizeof (int16));
-                        break;
-
-                    case ARD_UINT16:
-                        memcpy (&uint16_t_ptr[curr_tile_pix],
-                                &uint16_ptr[curr_pix],
-                                copy_nsamps * sizeof (uint16));
-                        break;
-
-                    case ARD_INT32:
-                        memcpy (&int32_t_ptr[curr_tile_pix],
-                                &int32_ptr[curr_pix],
-                                copy_nsamps * sizeof (int32));
-                        break;
-
-                    case ARD_UINT32:
-                        memcpy (&uint32_t_ptr[curr_tile_pix],
-                                &uint32_ptr[curr_pix],
-                                copy_nsamps * sizeof (uint32));
-                        break;
-
-                    case ARD_FLOAT32:
-                        memcpy (&float_t_ptr[curr_tile_pix],
-                                &float_ptr[curr_pix],
-                                copy_nsamps * sizeof (float));
-                        break;
-
-                    case ARD_FLOAT64:
-                        memcpy (&double_t_ptr[curr_tile_pix],
-                                &double_ptr[curr_pix],
-                                copy_nsamps * sizeof (double));
-                        break;
-                }
-            }  /* for t_line */
+            copy_nsamps = img_nsamps - samp;
+            if (copy_nsamps > t_nsamps)
+                copy_nsamps = t_nsamps;
 
-            /* Write the current tile (i.e. write the tile containing the
-               current x,y which should be the UL corner of the tile) */
-            if (TIFFWriteTile (tif, t_buf, samp, line, 0 /*z*/, 0) < 0)
+            /* Read the current tile (i.e. read the tile containing the
+               current x,y which should be the UL corner of the tile),
+               prefetching the upcoming tiles */
+            ard_prefetch_tiles (&pf, tile_count++);
+            if (TIFFReadTile (tif, t_buf, samp, line, 0 /*z*/, 0) < 0)
             {
-                sprintf (errmsg, "Writing Tiff file for line, samp: %d, %d.",
+                sprintf (errmsg, "Reading Tiff file for line, samp: %d, %d.",
                     line, samp);
                 ard_error_handler (true, FUNC_NAME, errmsg);
-                return ERROR;
+                status = ERROR;
+                goto cleanup;
+            }
+
+            /* Hand over the tile, or add it to the row of tiles */
+            if (block_type == ARD_BLOCK_TILE_ROW)
+            {
+                ard_copy_rows (t_buf, t_stride,
+                    &row_buf[(size_t) samp * nbytes], row_stride,
+                    copy_nlines, (size_t) copy_nsamps * nbytes);
+            }
+            else if (handler (handler_data, line, samp, copy_nlines,
+                copy_nsamps, t_buf, t_stride) != SUCCESS)
+            {
+                sprintf (errmsg, "Handler failed for the tile at line, "
+                    "samp: %d, %d.", line, samp);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                status = ERROR;
+                goto cleanup;
             }
         }  /* samp */
+
+        /* Hand over the row of tiles */
+        if (block_type == ARD_BLOCK_TILE_ROW &&
+            handler (handler_data, line, 0, copy_nlines, img_nsamps, row_buf,
+                row_stride) != SUCCESS)
+        {
+            sprintf (errmsg, "Handler failed for the row of tiles at line "
+                "%d.", line);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
     }  /* line */
 
-    /* Free the tile buffer */
-    _TIFFfree (t_buf);
+cleanup:
+    /* Free the buffers */
+    if (t_buf != NULL)
+        _TIFFfree (t_buf);
+    free (row_buf);
+
+    return status;
+}
+
+
+/******************************************************************************
+MODULE: ard_write_tiff_tile_row
+
+PURPOSE: Compresses and writes one row of tiles of the image
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred writing data to the Tiff file
+SUCCESS      Writing was successful
+
+NOTES:
+1. The partial tiles on the right and bottom edges of the image are padded
+   with zeros.
+*****************************************************************************/
+static int ard_write_tiff_tile_row
+(
+    Ard_tiff_writer_t *writer,  /* I/O: Tiff writer */
+    const uint8_t *rows,        /* I: first pixel of the row of tiles */
+    size_t stride,              /* I: bytes between the lines in rows */
+    int nlines                  /* I: number of lines in the row of tiles */
+)
+{
+    char FUNC_NAME[] = "ard_write_tiff_tile_row"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int samp;               /* UL samp of the current tile */
+    int copy_nsamps;        /* how many samples of the image will be copied
+                               to the tile */
+
+    for (samp = 0; samp < writer->nsamps; samp += writer->t_nsamps)
+    {
+        copy_nsamps = writer->nsamps - samp;
+        if (copy_nsamps > writer->t_nsamps)
+            copy_nsamps = writer->t_nsamps;
+
+        /* Copy the image into the tile, padding the partial tiles on the
+           right and bottom edges with zeros */
+        if (nlines < writer->t_nlines || copy_nsamps < writer->t_nsamps)
+            memset (writer->t_buf, 0, writer->tile_size);
+        ard_copy_rows (&rows[(size_t) samp * writer->nbytes], stride,
+            writer->t_buf, (size_t) writer->t_nsamps * writer->nbytes,
+            nlines, (size_t) copy_nsamps * writer->nbytes);
+
+        if (TIFFWriteTile (writer->tif, writer->t_buf, samp, writer->cur_line,
+            0 /*z*/, 0) < 0)
+        {
+            sprintf (errmsg, "Writing Tiff file for line, samp: %d, %d.",
+                writer->cur_line, samp);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return ERROR;
+        }
+    }
 
     return SUCCESS;
 }
 
 
 /******************************************************************************
-MODULE: ard_read_tiff
+MODULE: ard_open_tiff_writer
+
+PURPOSE: Sets up a writer for writing the Tiff file incrementally, a line or
+block of lines at a time
 
-PURPOSE: Reads the entire Tiff file, which should be tile-oriented
- 
 RETURN VALUE:
 Type = int
 Value        Description
 -----        -----------
-ERROR        An error occurred reading data from the Tiff file
-SUCCESS      Reading was successful
+ERROR        An error occurred setting up the writer
+SUCCESS      The writer is ready for ard_write_tiff_rows
 
 NOTES:
+1. The Tiff tags need to be set (ard_set_tiff_tags) before calling this
+   routine, same as for ard_write_tiff.
+2. The lines are pushed with ard_write_tiff_rows, and ard_finish_tiff_writer
+   needs to be called once all the lines have been pushed.
+3. At most one row of tiles is held in memory, rather than the entire image.
 *****************************************************************************/
-int ard_read_tiff
+int ard_open_tiff_writer
 (
-    TIFF *tif,       /* I: pointer to the Tiff file */
-    int data_type,   /* I: data type of the array to be read (see
-                           Ard_data_type in ard_metadata.h) */
-    int nlines,      /* I: number of lines to read from the file */
-    int nsamps,      /* I: number of samples to read from the file */
-    void *img_buf    /* O: array of nlines * nsamps * size to be read from the
-                           Tiff file (sufficient space should already have
-                           been allocated) */
+    TIFF *tif,                  /* I: pointer to the Tiff file */
+    int data_type,              /* I: data type of the image to be written
+                                      (see Ard_data_type in ard_metadata.h) */
+    int nlines,                 /* I: number of lines to write to the file */
+    int nsamps,                 /* I: number of samples to write to the
+                                      file */
+    Ard_tiff_writer_t *writer   /* O: Tiff writer */
 )
 {
-    char FUNC_NAME[] = "ard_read_tiff"; /* function name */
+    char FUNC_NAME[] = "ard_open_tiff_writer"; /* function name */
     char errmsg[STR_SIZE];  /* error message */
-    int line, samp;         /* looping variables for full image */
-    int t_line;             /* looping variable for tile */
-    int curr_pix;           /* current pixel in the full image */
-    int curr_tile_pix;      /* current pixel in the tile */
     int img_nlines;         /* number of lines in the Tiff file */
     int img_nsamps;         /* number of samples in the Tiff file */
-    int t_nlines = 0;       /* number of lines in each tile */
-    int t_nsamps = 0;       /* number of samples in each tile */
-    int copy_nsamps;        /* how many samples from the tile will be copied
-                               to the full image */
-    int8_t *int8_ptr = NULL;       /* pointer for int8 data types */
-    int8_t *int8_t_ptr = NULL;     /* pointer for int8 tile data types */
-    uint8_t *uint8_ptr = NULL;     /* pointer for uint8 data types */
-    uint8_t *uint8_t_ptr = NULL;   /* pointer for uint8 tile data types */
-    int16_t *int16_ptr = NULL;     /* pointer for int16 data types */
-    int16_t *int16_t_ptr = NULL;   /* pointer for int16 tile data types */
-    uint16_t *uint16_ptr = NULL;   /* pointer for uint16 data types */
-    uint16_t *uint16_t_ptr = NULL; /* pointer for uint16 tile data types */
-    int32_t *int32_ptr = NULL;     /* pointer for int32 data types */
-    int32_t *int32_t_ptr = NULL;   /* pointer for int32 tile data types */
-    uint32_t *uint32_ptr = NULL;   /* pointer for uint32 data types */
-    uint32_t *uint32_t_ptr = NULL; /* pointer for uint32 tile data types */
-    float *float_ptr = NULL;       /* pointer for float data types */
-    float *float_t_ptr = NULL;     /* pointer for float tile data types */
-    double *double_ptr = NULL;     /* pointer for double data types */
-    double *double_t_ptr = NULL;   /* pointer for double tile data types */
-    tdata_t t_buf = NULL;          /* tile data buffer (void ptr from TIFF) */
+
+    memset (writer, 0, sizeof (Ard_tiff_writer_t));
+    writer->tif = tif;
+    writer->nlines = nlines;
+    writer->nsamps = nsamps;
 
     /* Get the size of the image as well as the size of each tile */
     TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
     TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &img_nlines);
-    TIFFGetField(tif, TIFFTAG_TILEWIDTH, &t_nsamps);
-    TIFFGetField(tif, TIFFTAG_TILELENGTH, &t_nlines);
+    TIFFGetField(tif, TIFFTAG_TILEWIDTH, &writer->t_nsamps);
+    TIFFGetField(tif, TIFFTAG_TILELENGTH, &writer->t_nlines);
 
-    /* If the size of the tile is invalid, then this isn't a tile-oriented
-       image */
-    if (t_nsamps <= 0 || t_nlines <= 0)
+    /* If the size of the tile is invalid, then tiling hasn't been turned
+       on for this image (which is expected) */
+    if (writer->t_nsamps <= 0 || writer->t_nlines <= 0)
     {
         sprintf (errmsg, "Tiff is not a tile-oriented image");
         ard_error_handler (true, FUNC_NAME, errmsg);
@@ -966,7 +2716,7 @@ int ard_read_tiff
     }
 
     /* If the size of the image doesn't match that of the user-specified
-       size (and the size of the input image buffer), then it's an error */
+       size, then it's an error */
     if (img_nsamps != nsamps || img_nlines != nlines)
     {
         sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
@@ -976,148 +2726,197 @@ int ard_read_tiff
         return ERROR;
     }
 
-    /* Allocate space for the tile buffer */
-    t_buf = _TIFFmalloc (TIFFTileSize (tif));
-    if (t_buf == NULL)
+    /* Get the size of each pixel */
+    writer->nbytes = ard_data_type_size (data_type);
+    if (writer->nbytes == ERROR)
+    {
+        sprintf (errmsg, "Unsupported data type %d", data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Allocate space for the tile buffer.  The row buffer is only allocated
+       if the lines are pushed in blocks which don't line up with the rows
+       of tiles. */
+    writer->tile_size = TIFFTileSize (tif);
+    writer->t_buf = _TIFFmalloc (writer->tile_size);
+    if (writer->t_buf == NULL)
     {
         sprintf (errmsg, "Unable to allocate memory for the tile buffer");
         ard_error_handler (true, FUNC_NAME, errmsg);
         return ERROR;
     }
 
-    /* Set up the data type specific pointers */
-    switch (data_type)
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_write_tiff_rows
+
+PURPOSE: Pushes the next block of lines of the image to the Tiff writer,
+writing each row of tiles as it is completed
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred writing data to the Tiff file
+SUCCESS      Writing was successful
+
+NOTES:
+1. The blocks can be any number of lines.  Complete rows of tiles within the
+   block are written directly from the block.  Lines which don't complete a
+   row of tiles are held in the writer's row buffer until the rest of that
+   row of tiles is pushed.
+2. The last row of tiles is written as soon as the last line of the image is
+   pushed.
+*****************************************************************************/
+int ard_write_tiff_rows
+(
+    Ard_tiff_writer_t *writer,  /* I/O: Tiff writer */
+    int nlines,                 /* I: number of lines in the block */
+    const void *rows,           /* I: first pixel of the block */
+    size_t stride               /* I: number of bytes between the start of
+                                      each line in rows; 0 for nsamps *
+                                      size */
+)
+{
+    char FUNC_NAME[] = "ard_write_tiff_rows"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int row_nlines;         /* number of lines in the current row of tiles */
+    int copy_nlines;        /* number of lines to add to the row buffer */
+    size_t row_stride;      /* number of bytes in each line of the image */
+    const uint8_t *in_ptr = rows;  /* byte pointer to the block */
+
+    /* Check the block */
+    row_stride = (size_t) writer->nsamps * writer->nbytes;
+    if (stride == 0)
+        stride = row_stride;
+    else if (stride < row_stride)
     {
-        case ARD_INT8:
-            int8_ptr = img_buf;
-            int8_t_ptr = t_buf;
-            break;
-        case ARD_UINT8:
-            uint8_ptr = img_buf;
-            uint8_t_ptr = t_buf;
-            break;
-        case ARD_INT16:
-            int16_ptr = img_buf;
-            int16_t_ptr = t_buf;
-            break;
-        case ARD_UINT16:
-            uint16_ptr = img_buf;
-            uint16_t_ptr = t_buf;
-            break;
-        case ARD_INT32:
-            int32_ptr = img_buf;
-            int32_t_ptr = t_buf;
-            break;
-        case ARD_UINT32:
-            uint32_ptr = img_buf;
-            uint32_t_ptr = t_buf;
-            break;
-        case ARD_FLOAT32:
-            float_ptr = img_buf;
-            float_t_ptr = t_buf;
-            break;
-        case ARD_FLOAT64:
-            double_ptr = img_buf;
-            double_t_ptr = t_buf;
-            break;
-        default:
-            sprintf (errmsg, "Unsupported data type %d", data_type);
-            ard_error_handler (true, FUNC_NAME, errmsg);
-            return ERROR;
+        sprintf (errmsg, "Stride of %ld bytes is less than one line of %d "
+            "samps", (long) stride, writer->nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
     }
 
-    /* Read the data from the Tiff file. Use the void pointer to point to
-       the location of the current line in the data type specific pointer. */
-    for (line = 0; line < nlines; line += t_nlines)
+    if (nlines < 0 ||
+        writer->cur_line + writer->row_nlines + nlines > writer->nlines)
     {
-        for (samp = 0; samp < nsamps; samp += t_nsamps)
+        sprintf (errmsg, "Pushing %d lines after line %d would go past the "
+            "%d lines of the image", nlines,
+            writer->cur_line + writer->row_nlines, writer->nlines);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    while (nlines > 0)
+    {
+        /* Determine the number of lines in the current row of tiles */
+        row_nlines = writer->nlines - writer->cur_line;
+        if (row_nlines > writer->t_nlines)
+            row_nlines = writer->t_nlines;
+
+        /* If the block has the entire row of tiles, write it directly */
+        if (writer->row_nlines == 0 && nlines >= row_nlines)
         {
-            /* Read the current tile (i.e. read the tile containing the
-               current x,y which should be the UL corner of the tile) */
-            if (TIFFReadTile (tif, t_buf, samp, line, 0 /*z*/, 0) < 0)
+            if (ard_write_tiff_tile_row (writer, in_ptr, stride, row_nlines)
+                != SUCCESS)
             {
-                sprintf (errmsg, "Reading Tiff file for line, samp: %d, %d.",
-                    line, samp);
+                sprintf (errmsg, "Writing the row of tiles at line %d",
+                    writer->cur_line);
                 ard_error_handler (true, FUNC_NAME, errmsg);
                 return ERROR;
             }
-
-            /* Copy the tile into the full-sized image */
-            for (t_line = 0; t_line < t_nlines; t_line++)
+            writer->cur_line += row_nlines;
+            in_ptr += (size_t) row_nlines * stride;
+            nlines -= row_nlines;
+            continue;
+        }
+
+        /* Otherwise add the lines to the row buffer */
+        if (writer->row_buf == NULL)
+        {
+            writer->row_buf = malloc ((size_t) writer->t_nlines * row_stride);
+            if (writer->row_buf == NULL)
             {
-                /* Make sure this line is within the image */
-                if (line + t_line >= nlines)
-                    break;
-
-                /* Set up the location of the current line, samp in the image
-                   as well as the tile buffers */
-                curr_pix = (line + t_line) * nsamps + samp;
-                curr_tile_pix = t_line * t_nsamps;
-
-                /* Determine how many samples to copy from the tile.  If this
-                   is the last tile in the line, then we won't be copying the
-                   entire tile. */
-                copy_nsamps = nsamps - samp;
-                if (copy_nsamps > t_nsamps)
-                    copy_nsamps = t_nsamps;
-
-                /* Copy the data */
-                switch (data_type)
-                {
-                    case ARD_INT8:
-                        memcpy (&int8_ptr[curr_pix], &int8_t_ptr[curr_tile_pix],
-                            copy_nsamps * sizeof (int8));
-                        break;
-
-                    case ARD_UINT8:
-                        memcpy (&uint8_ptr[curr_pix],
-                                &uint8_t_ptr[curr_tile_pix],
-                                copy_nsamps * sizeof (uint8));
-                        break;
-
-                    case ARD_INT16:
-                        memcpy (&int16_ptr[curr_pix],
-                                &int16_t_ptr[curr_tile_pix],
-                                copy_nsamps * sizeof (int16));
-                        break;
-
-                    case ARD_UINT16:
-                        memcpy (&uint16_ptr[curr_pix],
-                                &uint16_t_ptr[curr_tile_pix],
-                                copy_nsamps * sizeof (uint16));
-                        break;
-
-                    case ARD_INT32:
-                        memcpy (&int32_ptr[curr_pix],
-                                &int32_t_ptr[curr_tile_pix],
-                                copy_nsamps * sizeof (int32));
-                        break;
-
-                    case ARD_UINT32:
-                        memcpy (&uint32_ptr[curr_pix],
-                                &uint32_t_ptr[curr_tile_pix],
-                                copy_nsamps * sizeof (uint32));
-                        break;
-
-                    case ARD_FLOAT32:
-                        memcpy (&float_ptr[curr_pix],
-                                &float_t_ptr[curr_tile_pix],
-                                copy_nsamps * sizeof (float));
-                        break;
-
-                    case ARD_FLOAT64:
-                        memcpy (&double_ptr[curr_pix],
-                                &double_t_ptr[curr_tile_pix],
-                                copy_nsamps * sizeof (double));
-                        break;
-                }
-            }  /* for t_line */
-        }  /* samp */
-    }  /* line */
-
-    /* Free the tile buffer */
-    _TIFFfree (t_buf);
+                sprintf (errmsg, "Unable to allocate memory for the row "
+                    "buffer");
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return ERROR;
+            }
+        }
+
+        copy_nlines = row_nlines - writer->row_nlines;
+        if (copy_nlines > nlines)
+            copy_nlines = nlines;
+        ard_copy_rows (in_ptr, stride,
+            &writer->row_buf[(size_t) writer->row_nlines * row_stride],
+            row_stride, copy_nlines, row_stride);
+        writer->row_nlines += copy_nlines;
+        in_ptr += (size_t) copy_nlines * stride;
+        nlines -= copy_nlines;
+
+        /* Write the row of tiles once it's complete */
+        if (writer->row_nlines == row_nlines)
+        {
+            if (ard_write_tiff_tile_row (writer, writer->row_buf, row_stride,
+                row_nlines) != SUCCESS)
+            {
+                sprintf (errmsg, "Writing the row of tiles at line %d",
+                    writer->cur_line);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return ERROR;
+            }
+            writer->cur_line += row_nlines;
+            writer->row_nlines = 0;
+        }
+    }
 
     return SUCCESS;
 }
 
+
+/******************************************************************************
+MODULE: ard_finish_tiff_writer
+
+PURPOSE: Finishes writing the Tiff file and frees the Tiff writer
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        Not all of the lines of the image were pushed
+SUCCESS      The entire image was written
+
+NOTES:
+1. The writer's buffers are freed even if the image isn't complete.  The Tiff
+   file itself still needs to be closed (ard_close_tiff).
+*****************************************************************************/
+int ard_finish_tiff_writer
+(
+    Ard_tiff_writer_t *writer   /* I/O: Tiff writer */
+)
+{
+    char FUNC_NAME[] = "ard_finish_tiff_writer"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int status = SUCCESS;   /* return status */
+
+    if (writer->cur_line != writer->nlines)
+    {
+        sprintf (errmsg, "Only %d of the %d lines of the image were written",
+            writer->cur_line + writer->row_nlines, writer->nlines);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        status = ERROR;
+    }
+
+    /* Free the buffers */
+    if (writer->t_buf != NULL)
+        _TIFFfree (writer->t_buf);
+    free (writer->row_buf);
+    writer->t_buf = NULL;
+    writer->row_buf = NULL;
+
+    return status;
+}
@@ -0,0 +1,416 @@
+/*****************************************************************************
+FILE: ard_tiff_memory_io.c
+
+PURPOSE: Contains functions for reading and writing Tiff files held in
+memory, such as band payloads received from a message queue or an object
+store, without a round trip through the file system.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+  1. The memory file is opened with XTIFFClientOpen, so the GeoTiff tags are
+     registered just as they are for XTIFFOpen.
+  2. When reading, the memory is handed to libtiff as a mapped file, so the
+     raw tiles are read straight out of the buffer without being copied.
+  3. Memory files aren't backed by a file descriptor, so they are never
+     cached (see ard_tiff_cache.h) or prefetched.
+*****************************************************************************/
+
+#include "ard_tiff_memory_io.h"
+
+
+/******************************************************************************
+MODULE: init_ard_tiff_memory
+
+PURPOSE: Initializes an empty memory file which is allocated and grows as
+needed
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        Error allocating the buffer
+SUCCESS      Successfully initialized the memory file
+
+NOTES:
+1. free_ard_tiff_memory needs to be called to free the buffer.
+*****************************************************************************/
+int init_ard_tiff_memory
+(
+    Ard_tiff_memory_t *mem,  /* O: memory file to be initialized */
+    size_t capacity          /* I: initial size of the buffer (bytes); 0 for
+                                   the default ARD_TIFF_MEMORY_SIZE */
+)
+{
+    char FUNC_NAME[] = "init_ard_tiff_memory"; /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+
+    mem->capacity = (capacity > 0) ? capacity : ARD_TIFF_MEMORY_SIZE;
+    mem->size = 0;
+    mem->pos = 0;
+    mem->allocated = true;
+    mem->buf = malloc (mem->capacity);
+    if (mem->buf == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate %ld bytes for the memory file",
+            (long) mem->capacity);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        mem->capacity = 0;
+        return ERROR;
+    }
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: init_ard_tiff_memory_fixed
+
+PURPOSE: Initializes a memory file in caller memory, either to read a file
+which is already in the memory or to write a new one
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The memory file can't grow past the caller memory, so writing fails if
+   the Tiff file doesn't fit.
+*****************************************************************************/
+void init_ard_tiff_memory_fixed
+(
+    Ard_tiff_memory_t *mem,  /* O: memory file to be initialized */
+    void *buf,               /* I: caller memory holding the file */
+    size_t size,             /* I: size of the file already in buf (bytes);
+                                   0 for an empty file to be written */
+    size_t capacity          /* I: size of the caller memory (bytes) */
+)
+{
+    mem->buf = buf;
+    mem->size = size;
+    mem->capacity = (capacity > size) ? capacity : size;
+    mem->pos = 0;
+    mem->allocated = false;
+}
+
+
+/******************************************************************************
+MODULE: free_ard_tiff_memory
+
+PURPOSE: Frees the buffer of an allocated memory file
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. Caller memory is left alone.
+*****************************************************************************/
+void free_ard_tiff_memory
+(
+    Ard_tiff_memory_t *mem   /* I/O: memory file to be freed */
+)
+{
+    if (mem->allocated)
+        free (mem->buf);
+    mem->buf = NULL;
+    mem->size = 0;
+    mem->capacity = 0;
+    mem->pos = 0;
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_memory_read
+
+PURPOSE: Reads from the current position of the memory file (TIFFReadWriteProc)
+
+RETURN VALUE:
+Type = tmsize_t
+Value        Description
+-----        -----------
+nbytes       Number of bytes read, which is short at the end of the file
+
+NOTES:
+*****************************************************************************/
+static tmsize_t ard_tiff_memory_read
+(
+    thandle_t handle,    /* I: memory file */
+    void *data,          /* O: bytes read */
+    tmsize_t nbytes      /* I: number of bytes to read */
+)
+{
+    Ard_tiff_memory_t *mem = (Ard_tiff_memory_t *) handle;
+
+    if (nbytes < 0)
+        return -1;
+    if (mem->pos >= mem->size)
+        return 0;
+    if ((size_t) nbytes > mem->size - mem->pos)
+        nbytes = mem->size - mem->pos;
+
+    memcpy (data, &mem->buf[mem->pos], nbytes);
+    mem->pos += nbytes;
+
+    return nbytes;
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_memory_write
+
+PURPOSE: Writes at the current position of the memory file, growing the
+buffer if it was allocated (TIFFReadWriteProc)
+
+RETURN VALUE:
+Type = tmsize_t
+Value        Description
+-----        -----------
+-1           The file doesn't fit in the caller memory, or the buffer
+             couldn't be grown
+nbytes       Number of bytes written
+
+NOTES:
+1. Any gap between the end of the file and the current position is zeroed.
+*****************************************************************************/
+static tmsize_t ard_tiff_memory_write
+(
+    thandle_t handle,    /* I/O: memory file */
+    void *data,          /* I: bytes to write */
+    tmsize_t nbytes      /* I: number of bytes to write */
+)
+{
+    Ard_tiff_memory_t *mem = (Ard_tiff_memory_t *) handle;
+    size_t end;          /* end of the write within the file */
+    size_t capacity;     /* new size of the buffer */
+    uint8_t *buf;        /* grown buffer */
+
+    if (nbytes < 0)
+        return -1;
+    end = mem->pos + nbytes;
+
+    /* Grow the buffer by doubling it until the write fits */
+    if (end > mem->capacity)
+    {
+        if (!mem->allocated)
+            return -1;
+        capacity = (mem->capacity > 0) ? mem->capacity : ARD_TIFF_MEMORY_SIZE;
+        while (capacity < end)
+            capacity *= 2;
+        buf = realloc (mem->buf, capacity);
+        if (buf == NULL)
+            return -1;
+        mem->buf = buf;
+        mem->capacity = capacity;
+    }
+
+    if (mem->pos > mem->size)
+        memset (&mem->buf[mem->size], 0, mem->pos - mem->size);
+    memcpy (&mem->buf[mem->pos], data, nbytes);
+    mem->pos = end;
+    if (end > mem->size)
+        mem->size = end;
+
+    return nbytes;
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_memory_seek
+
+PURPOSE: Moves the current position of the memory file (TIFFSeekProc)
+
+RETURN VALUE:
+Type = toff_t
+Value        Description
+-----        -----------
+-1           Invalid position
+pos          New position within the file
+
+NOTES:
+1. The position can be past the end of the file; the file is only extended
+   once it is written.
+*****************************************************************************/
+static toff_t ard_tiff_memory_seek
+(
+    thandle_t handle,    /* I/O: memory file */
+    toff_t offset,       /* I: offset to move to */
+    int whence           /* I: SEEK_SET, SEEK_CUR, or SEEK_END */
+)
+{
+    Ard_tiff_memory_t *mem = (Ard_tiff_memory_t *) handle;
+    int64_t pos;         /* new position */
+
+    switch (whence)
+    {
+        case SEEK_SET: pos = (int64_t) offset; break;
+        case SEEK_CUR: pos = (int64_t) mem->pos + (int64_t) offset; break;
+        case SEEK_END: pos = (int64_t) mem->size + (int64_t) offset; break;
+        default: return (toff_t) -1;
+    }
+    if (pos < 0)
+        return (toff_t) -1;
+
+    mem->pos = (size_t) pos;
+    return (toff_t) pos;
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_memory_close
+
+PURPOSE: Closes the memory file (TIFFCloseProc)
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+0            Always successful
+
+NOTES:
+1. The buffer belongs to the memory file, so it is left for the caller,
+   holding the complete Tiff file.
+*****************************************************************************/
+static int ard_tiff_memory_close
+(
+    thandle_t handle     /* I: memory file */
+)
+{
+    (void) handle;
+    return 0;
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_memory_size
+
+PURPOSE: Returns the size of the memory file (TIFFSizeProc)
+
+RETURN VALUE:
+Type = toff_t
+Value        Description
+-----        -----------
+size         Size of the file (bytes)
+
+NOTES:
+*****************************************************************************/
+static toff_t ard_tiff_memory_size
+(
+    thandle_t handle     /* I: memory file */
+)
+{
+    return ((Ard_tiff_memory_t *) handle)->size;
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_memory_map
+
+PURPOSE: Hands the memory file to libtiff as a mapped file (TIFFMapFileProc)
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+0            The file is empty, so there is nothing to map
+1            The file is mapped
+
+NOTES:
+1. libtiff only maps files which are opened for reading, so the buffer
+   doesn't move while it is mapped.
+*****************************************************************************/
+static int ard_tiff_memory_map
+(
+    thandle_t handle,    /* I: memory file */
+    void **base,         /* O: start of the mapped file */
+    toff_t *size         /* O: size of the mapped file (bytes) */
+)
+{
+    Ard_tiff_memory_t *mem = (Ard_tiff_memory_t *) handle;
+
+    if (mem->size == 0)
+        return 0;
+
+    *base = mem->buf;
+    *size = mem->size;
+    return 1;
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_memory_unmap
+
+PURPOSE: Unmaps the memory file (TIFFUnmapFileProc)
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. Nothing needs to be done, since the buffer belongs to the memory file.
+*****************************************************************************/
+static void ard_tiff_memory_unmap
+(
+    thandle_t handle,    /* I: memory file */
+    void *base,          /* I: start of the mapped file */
+    toff_t size          /* I: size of the mapped file (bytes) */
+)
+{
+    (void) handle;
+    (void) base;
+    (void) size;
+}
+
+
+/******************************************************************************
+MODULE: ard_open_tiff_memory
+
+PURPOSE: Opens a Tiff file held in memory for specified read/write/append
+access
+
+RETURN VALUE:
+Type = TIFF *
+Value        Description
+-----        -----------
+NULL         Error opening the memory file with the specified access
+non-NULL     Pointer to the opened Tiff file
+
+NOTES:
+1. The memory file must stay in place until the Tiff file is closed with
+   ard_close_tiff.  After closing a file which was written, mem->buf holds
+   the mem->size bytes of the complete Tiff file.
+2. Opening for writing ("w") starts a new, empty file.
+*****************************************************************************/
+TIFF *ard_open_tiff_memory
+(
+    Ard_tiff_memory_t *mem,  /* I/O: memory file to be opened */
+    char *access_type        /* I: string for the access type for reading the
+                                   memory file; use the ard_tiff_format
+                                   array in ard_tiff_io.c */
+)
+{
+    char FUNC_NAME[] = "ard_open_tiff_memory"; /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    TIFF *tif = NULL;        /* pointer to the Tiff file */
+
+    /* Writing starts a new file */
+    if (access_type[0] == 'w')
+        mem->size = 0;
+    mem->pos = 0;
+
+    /* Open the memory file with the specified access type */
+    tif = XTIFFClientOpen ("memory", access_type, (thandle_t) mem,
+        ard_tiff_memory_read, ard_tiff_memory_write, ard_tiff_memory_seek,
+        ard_tiff_memory_close, ard_tiff_memory_size, ard_tiff_memory_map,
+        ard_tiff_memory_unmap);
+    if (tif == NULL)
+    {
+        sprintf (errmsg, "Opening Tiff memory file with %s access.",
+            access_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return NULL;
+    }
+
+    /* Return the file pointer */
+    return tif;
+}
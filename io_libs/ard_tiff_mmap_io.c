@@ -0,0 +1,355 @@
+/*****************************************************************************
+FILE: ard_tiff_mmap_io.c
+
+PURPOSE: Contains functions for reading uncompressed tile-oriented Tiff files
+through a memory mapping of the file.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+  1. The Tiff directory is only read once, when the file is opened, to get
+     the image layout and the offset of each tile.  After that the tiles are
+     served directly from the mapping, so getting a tile is pointer
+     arithmetic and reading a window is a single copy out of the page cache,
+     with no decode buffer in between.
+*****************************************************************************/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ard_tiff_mmap_io.h"
+
+
+/******************************************************************************
+MODULE: ard_open_tiff_mmap
+
+PURPOSE: Opens an uncompressed tile-oriented Tiff file and memory-maps it
+for reading
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred opening or mapping the file, or the file
+             can't be memory-mapped
+SUCCESS      The file was opened and mapped
+
+NOTES:
+1. The file needs to be uncompressed, single-sample, native byte order, and
+   tile-oriented.  Other files need to be read with ard_open_tiff and
+   ard_read_tiff.
+2. Only the first directory (the full-resolution image) is mapped.
+3. ard_close_tiff_mmap needs to be called to unmap and close the file.
+*****************************************************************************/
+int ard_open_tiff_mmap
+(
+    char *tiff_file,        /* I: name of the input Tiff file to be opened */
+    Ard_tiff_mmap_t *mtif   /* O: memory-mapped Tiff file */
+)
+{
+    char FUNC_NAME[] = "ard_open_tiff_mmap"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    uint32_t tile;          /* looping variable for the tiles */
+    uint16_t compression = COMPRESSION_NONE; /* compression scheme */
+    uint16_t samps_per_pixel = 1;            /* number of samples per pixel */
+    uint16_t bits_per_samp = 0;              /* number of bits per sample */
+    uint64_t tile_size;     /* size of each tile (bytes) */
+    struct stat file_stat;  /* file status, for the size of the file */
+    TIFF *tif = NULL;       /* pointer to the Tiff file */
+
+    memset (mtif, 0, sizeof (Ard_tiff_mmap_t));
+    mtif->fd = -1;
+
+    /* Open the Tiff file to get the layout of the image */
+    tif = ard_open_tiff (tiff_file, "r");
+    if (tif == NULL)
+    {
+        sprintf (errmsg, "Opening Tiff file %s", tiff_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &mtif->nsamps);
+    TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &mtif->nlines);
+    TIFFGetField (tif, TIFFTAG_TILEWIDTH, &mtif->t_nsamps);
+    TIFFGetField (tif, TIFFTAG_TILELENGTH, &mtif->t_nlines);
+    TIFFGetField (tif, TIFFTAG_COMPRESSION, &compression);
+    TIFFGetField (tif, TIFFTAG_SAMPLESPERPIXEL, &samps_per_pixel);
+    TIFFGetField (tif, TIFFTAG_BITSPERSAMPLE, &bits_per_samp);
+
+    /* Make sure the tiles can be served directly from the file */
+    if (mtif->t_nsamps <= 0 || mtif->t_nlines <= 0)
+    {
+        sprintf (errmsg, "Tiff file %s is not a tile-oriented image",
+            tiff_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        ard_close_tiff (tif);
+        return ERROR;
+    }
+
+    if (compression != COMPRESSION_NONE || samps_per_pixel != 1 ||
+        TIFFIsByteSwapped (tif) || bits_per_samp % 8 != 0 ||
+        bits_per_samp == 0)
+    {
+        sprintf (errmsg, "Tiff file %s needs to be uncompressed, "
+            "single-sample, native byte order to be memory-mapped",
+            tiff_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        ard_close_tiff (tif);
+        return ERROR;
+    }
+
+    /* Save the offset of each tile */
+    mtif->nbytes = bits_per_samp / 8;
+    mtif->ntiles_across = (mtif->nsamps + mtif->t_nsamps - 1) /
+        mtif->t_nsamps;
+    mtif->ntiles = TIFFNumberOfTiles (tif);
+    tile_size = (uint64_t) mtif->t_nlines * mtif->t_nsamps * mtif->nbytes;
+    mtif->tile_offset = malloc (mtif->ntiles * sizeof (uint64_t));
+    if (mtif->tile_offset == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for the tile offsets");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        ard_close_tiff (tif);
+        return ERROR;
+    }
+
+    for (tile = 0; tile < mtif->ntiles; tile++)
+    {
+        mtif->tile_offset[tile] = TIFFGetStrileOffset (tif, tile);
+        if (mtif->tile_offset[tile] == 0 ||
+            TIFFGetStrileByteCount (tif, tile) < tile_size)
+        {
+            sprintf (errmsg, "Tile %u of Tiff file %s is missing or "
+                "incomplete", tile, tiff_file);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            ard_close_tiff (tif);
+            ard_close_tiff_mmap (mtif);
+            return ERROR;
+        }
+    }
+    ard_close_tiff (tif);
+
+    /* Map the file */
+    mtif->fd = open (tiff_file, O_RDONLY);
+    if (mtif->fd < 0 || fstat (mtif->fd, &file_stat) != 0)
+    {
+        sprintf (errmsg, "Opening Tiff file %s for memory-mapping",
+            tiff_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        ard_close_tiff_mmap (mtif);
+        return ERROR;
+    }
+
+    mtif->map_size = file_stat.st_size;
+    mtif->map = mmap (NULL, mtif->map_size, PROT_READ, MAP_SHARED, mtif->fd,
+        0);
+    if (mtif->map == MAP_FAILED)
+    {
+        mtif->map = NULL;
+        sprintf (errmsg, "Memory-mapping Tiff file %s", tiff_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        ard_close_tiff_mmap (mtif);
+        return ERROR;
+    }
+
+    /* Make sure every tile lies within the file */
+    for (tile = 0; tile < mtif->ntiles; tile++)
+    {
+        if (mtif->tile_offset[tile] + tile_size > mtif->map_size)
+        {
+            sprintf (errmsg, "Tile %u of Tiff file %s extends past the end "
+                "of the file", tile, tiff_file);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            ard_close_tiff_mmap (mtif);
+            return ERROR;
+        }
+    }
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_close_tiff_mmap
+
+PURPOSE: Unmaps and closes a memory-mapped Tiff file
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. Any tile pointers from ard_tiff_mmap_tile are no longer valid.
+*****************************************************************************/
+void ard_close_tiff_mmap
+(
+    Ard_tiff_mmap_t *mtif   /* I/O: memory-mapped Tiff file to be closed */
+)
+{
+    if (mtif->map != NULL)
+        munmap (mtif->map, mtif->map_size);
+    if (mtif->fd >= 0)
+        close (mtif->fd);
+    free (mtif->tile_offset);
+
+    mtif->map = NULL;
+    mtif->map_size = 0;
+    mtif->fd = -1;
+    mtif->tile_offset = NULL;
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_mmap_tile
+
+PURPOSE: Returns a pointer to the tile containing the specified line and
+sample, directly within the memory mapping
+
+RETURN VALUE:
+Type = const void *
+Value        Description
+-----        -----------
+NULL         The line and sample are not within the image
+non-NULL     Pointer to the first pixel of the tile
+
+NOTES:
+1. The tile is t_nlines x t_nsamps pixels, and line i of the tile starts at
+   i * t_nsamps * nbytes.  The tiles on the right and bottom edges of the
+   image extend past the image.
+*****************************************************************************/
+const void *ard_tiff_mmap_tile
+(
+    const Ard_tiff_mmap_t *mtif,  /* I: memory-mapped Tiff file */
+    int line,               /* I: image line (0-based), not a line
+                                  within the tile */
+    int samp                /* I: image sample (0-based), not a sample
+                                  within the tile */
+)
+{
+    if (line < 0 || samp < 0 || line >= mtif->nlines || samp >= mtif->nsamps)
+        return NULL;
+
+    return mtif->map + mtif->tile_offset[(line / mtif->t_nlines) *
+        mtif->ntiles_across + samp / mtif->t_nsamps];
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_window_mmap
+
+PURPOSE: Reads a rectangular window (region of interest) from a
+memory-mapped Tiff file into an image buffer with an arbitrary row stride
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. Line i of the window is returned at img_buf + i * stride.  A stride of 0
+   means the window is packed (nsamps * size bytes per line).
+2. The window must lie completely within the image.
+3. The pixels are copied directly from the mapping with ard_copy_rows.
+*****************************************************************************/
+int ard_read_tiff_window_mmap
+(
+    const Ard_tiff_mmap_t *mtif,  /* I: memory-mapped Tiff file */
+    int data_type,    /* I: data type of the array to be read (see
+                            Ard_data_type in ard_metadata.h) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window; sufficient space for
+                            nlines of stride bytes should already have been
+                            allocated */
+    size_t stride     /* I: number of bytes between the start of each line in
+                            img_buf; 0 for nsamps * size */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_window_mmap"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int line, samp;         /* UL line, samp of the current tile */
+    int end_line;           /* line after the last line of the window */
+    int end_samp;           /* sample after the last sample of the window */
+    int first_line;         /* first window line covered by the current tile */
+    int last_line;          /* line after the last window line covered by the
+                               current tile */
+    int first_samp;         /* first window samp covered by the current tile */
+    int copy_nsamps;        /* how many samples from the tile will be copied
+                               to the window */
+    int nbytes = mtif->nbytes;  /* number of bytes per pixel */
+    size_t t_stride;        /* number of bytes in each line of a tile */
+    uint8_t *win_ptr = img_buf;     /* byte pointer to the window buffer */
+    const uint8_t *tile_ptr = NULL; /* byte pointer to the current tile */
+
+    /* Make sure the data type matches the file */
+    if (ard_data_type_size (data_type) != nbytes)
+    {
+        sprintf (errmsg, "Data type %d doesn't match the %d-byte pixels of "
+            "the Tiff file", data_type, nbytes);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Make sure the window is within the image */
+    end_line = start_line + nlines;
+    end_samp = start_samp + nsamps;
+    if (start_line < 0 || start_samp < 0 || nlines <= 0 || nsamps <= 0 ||
+        end_line > mtif->nlines || end_samp > mtif->nsamps)
+    {
+        sprintf (errmsg, "Window (start line %d, start samp %d, %d lines x "
+            "%d samps) is not within the Tiff image size (%d lines x %d "
+            "samps)", start_line, start_samp, nlines, nsamps, mtif->nlines,
+            mtif->nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Check the stride */
+    t_stride = (size_t) mtif->t_nsamps * nbytes;
+    if (stride == 0)
+        stride = (size_t) nsamps * nbytes;
+    else if (stride < (size_t) nsamps * nbytes)
+    {
+        sprintf (errmsg, "Stride of %ld bytes is less than one line of %d "
+            "samps", (long) stride, nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Copy the portion of each tile within the window */
+    for (line = start_line - start_line % mtif->t_nlines; line < end_line;
+         line += mtif->t_nlines)
+    {
+        first_line = (line > start_line) ? line : start_line;
+        last_line = line + mtif->t_nlines;
+        if (last_line > end_line)
+            last_line = end_line;
+
+        for (samp = start_samp - start_samp % mtif->t_nsamps;
+             samp < end_samp; samp += mtif->t_nsamps)
+        {
+            first_samp = (samp > start_samp) ? samp : start_samp;
+            copy_nsamps = samp + mtif->t_nsamps;
+            if (copy_nsamps > end_samp)
+                copy_nsamps = end_samp;
+            copy_nsamps -= first_samp;
+
+            tile_ptr = ard_tiff_mmap_tile (mtif, line, samp);
+            ard_copy_rows (&tile_ptr[(size_t) (first_line - line) *
+                t_stride + (size_t) (first_samp - samp) * nbytes], t_stride,
+                &win_ptr[(size_t) (first_line - start_line) * stride +
+                (size_t) (first_samp - start_samp) * nbytes], stride,
+                last_line - first_line, (size_t) copy_nsamps * nbytes);
+        }  /* samp */
+    }  /* line */
+
+    return SUCCESS;
+}
@@ -0,0 +1,461 @@
+/*****************************************************************************
+FILE: ard_tiff_qa_io.c
+
+PURPOSE: Contains functions for reading a band with the pixels flagged in a
+QA band (cloud, cloud shadow, snow, fill, ...) set to fill.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+  1. The band and the QA band are read a block at a time, where the blocks
+     follow the tiles (or strips) of the QA band.  Each block of the band is
+     masked while it is still in cache, right after it is read, so the QA
+     band never needs a full size buffer and the band isn't passed over a
+     second time.  For ARD tiles the band and the QA band have the same
+     tiling, so each tile of either band is only decoded once.
+*****************************************************************************/
+
+#include "ard_tiff_qa_io.h"
+
+
+/******************************************************************************
+MODULE: ard_qa_bit_mask
+
+PURPOSE: Builds a QA bit mask from the names of the bits in the
+bitmap_description of the QA band
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        The QA band has no bitmap_description, or one of the names
+             doesn't match any of its bits
+SUCCESS      The mask was built
+
+NOTES:
+1. A name which is used for more than one bit (e.g. the two bits of a
+   confidence level) sets all of those bits.
+2. Only the first 32 bits of the bitmap_description can be used.
+*****************************************************************************/
+int ard_qa_bit_mask
+(
+    const Ard_band_meta_t *qa_bmeta,  /* I: QA band metadata */
+    int nnames,              /* I: number of bit names */
+    const char *const *bit_names,  /* I: names of the bits to be masked, as
+                                   given in the bitmap_description */
+    uint32_t *mask           /* O: mask with the named bits set */
+)
+{
+    char FUNC_NAME[] = "ard_qa_bit_mask"; /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    int i;                   /* looping variable for the names */
+    int bit;                 /* looping variable for the bits */
+    int nbits;               /* number of bits which can be used */
+    uint32_t name_mask;      /* bits for the current name */
+
+    *mask = 0;
+    if (qa_bmeta->bitmap_description == NULL || qa_bmeta->nbits <= 0)
+    {
+        sprintf (errmsg, "QA band doesn't have a bitmap description");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    nbits = (qa_bmeta->nbits > 32) ? 32 : qa_bmeta->nbits;
+    for (i = 0; i < nnames; i++)
+    {
+        name_mask = 0;
+        for (bit = 0; bit < nbits; bit++)
+        {
+            if (!strcmp (qa_bmeta->bitmap_description[bit], bit_names[i]))
+                name_mask |= (uint32_t) 1 << bit;
+        }
+
+        if (name_mask == 0)
+        {
+            sprintf (errmsg, "QA bit name %d doesn't match any bit in the "
+                "bitmap description", i);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return ERROR;
+        }
+        *mask |= name_mask;
+    }
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_mask_rows
+
+PURPOSE: Sets the pixels of a block of rows to fill wherever the QA value
+has any of the mask bits set
+
+RETURN VALUE: N/A
+
+NOTES:
+1. The pixels are handled as unsigned integers of the same size, so the fill
+   value is passed in as the bits of the fill value in the band data type.
+2. The masking is expanded for every pair of QA and band pixel sizes, and is
+   written as a select so the compiler can vectorize the inner loops.
+*****************************************************************************/
+static void ard_mask_rows
+(
+    const uint8_t *qa,   /* I: first QA value of the first row */
+    size_t qa_stride,    /* I: bytes between the QA rows */
+    int qa_nbytes,       /* I: number of bytes per QA value */
+    uint8_t *img,        /* I/O: first pixel of the first row to mask */
+    size_t img_stride,   /* I: bytes between the rows to mask */
+    int nbytes,          /* I: number of bytes per pixel */
+    int nrows,           /* I: number of rows to mask */
+    int npix,            /* I: number of pixels per row to mask */
+    uint32_t mask,       /* I: QA bits which flag a pixel to be masked */
+    uint64_t fill_bits   /* I: bits of the fill value */
+)
+{
+    int row;             /* looping variable for the rows */
+    int pix;             /* looping variable for the pixels */
+
+#define ARD_MASK_ROWS(qa_t, img_t)                                          \
+    {                                                                       \
+        const qa_t qa_mask = (qa_t) mask;                                   \
+        const img_t fill = (img_t) fill_bits;                               \
+        for (row = 0; row < nrows; row++)                                   \
+        {                                                                   \
+            const qa_t *in = (const qa_t *) qa;                             \
+            img_t *out = (img_t *) img;                                     \
+            for (pix = 0; pix < npix; pix++)                                \
+                out[pix] = (in[pix] & qa_mask) ? fill : out[pix];           \
+            qa += qa_stride;                                                \
+            img += img_stride;                                              \
+        }                                                                   \
+    }
+
+#define ARD_MASK_ROWS_QA(qa_t)                                              \
+    {                                                                       \
+        switch (nbytes)                                                     \
+        {                                                                   \
+            case 1: ARD_MASK_ROWS (qa_t, uint8_t); break;                   \
+            case 2: ARD_MASK_ROWS (qa_t, uint16_t); break;                  \
+            case 4: ARD_MASK_ROWS (qa_t, uint32_t); break;                  \
+            case 8: ARD_MASK_ROWS (qa_t, uint64_t); break;                  \
+        }                                                                   \
+    }
+
+    switch (qa_nbytes)
+    {
+        case 1: ARD_MASK_ROWS_QA (uint8_t); break;
+        case 2: ARD_MASK_ROWS_QA (uint16_t); break;
+        case 4: ARD_MASK_ROWS_QA (uint32_t); break;
+    }
+
+#undef ARD_MASK_ROWS_QA
+#undef ARD_MASK_ROWS
+}
+
+
+/******************************************************************************
+MODULE: ard_fill_bits
+
+PURPOSE: Returns the bits of the fill value in the band data type
+
+RETURN VALUE:
+Type = uint64_t
+Value        Description
+-----        -----------
+bits         Fill value of the band data type, as an unsigned integer of the
+             same size
+
+NOTES:
+*****************************************************************************/
+static uint64_t ard_fill_bits
+(
+    int data_type,       /* I: data type of the band */
+    long fill_value      /* I: fill value of the band */
+)
+{
+    float fill32;        /* fill value as FLOAT32 */
+    double fill64;       /* fill value as FLOAT64 */
+    uint32_t bits32;     /* bits of the FLOAT32 fill value */
+    uint64_t bits64;     /* bits of the FLOAT64 fill value */
+
+    switch (data_type)
+    {
+        case ARD_INT8:    return (uint8_t) (int8_t) fill_value;
+        case ARD_UINT8:   return (uint8_t) fill_value;
+        case ARD_INT16:   return (uint16_t) (int16_t) fill_value;
+        case ARD_UINT16:  return (uint16_t) fill_value;
+        case ARD_INT32:   return (uint32_t) (int32_t) fill_value;
+        case ARD_UINT32:  return (uint32_t) fill_value;
+        case ARD_FLOAT32:
+            fill32 = (float) fill_value;
+            memcpy (&bits32, &fill32, sizeof (bits32));
+            return bits32;
+        case ARD_FLOAT64:
+            fill64 = (double) fill_value;
+            memcpy (&bits64, &fill64, sizeof (bits64));
+            return bits64;
+        default: return 0;
+    }
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_window_masked
+
+PURPOSE: Reads a rectangular window (region of interest) from a Tiff file
+into an image buffer with an arbitrary row stride, setting the pixels which
+are flagged in the QA band to fill
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff files
+SUCCESS      Reading was successful
+
+NOTES:
+1. A pixel is masked if its QA value has any of the mask bits set.
+2. The band must have a fill value, and the QA band must be an integer band
+   of no more than 32 bits and the same size as the band.
+3. The window is read one QA tile (or strip) at a time; see the notes at the
+   top of this file.
+*****************************************************************************/
+int ard_read_tiff_window_masked
+(
+    TIFF *tif,        /* I: pointer to the Tiff file for the band */
+    const Ard_band_meta_t *bmeta,  /* I: band metadata for the data type and
+                            fill value */
+    TIFF *qa_tif,     /* I: pointer to the Tiff file for the QA band */
+    const Ard_band_meta_t *qa_bmeta,  /* I: QA band metadata */
+    uint32_t mask,    /* I: QA bits which flag a pixel to be masked (see
+                            ard_qa_bit_mask) */
+    int start_line,   /* I: starting line of the window (0-based) */
+    int start_samp,   /* I: starting sample of the window (0-based) */
+    int nlines,       /* I: number of lines in the window */
+    int nsamps,       /* I: number of samples in the window */
+    void *img_buf,    /* O: first pixel of the window; sufficient space for
+                            nlines of stride bytes should already have been
+                            allocated */
+    size_t stride     /* I: number of bytes between the start of each line in
+                            img_buf; 0 for nsamps * size */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_window_masked"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int line, samp;         /* UL line, samp of the current QA block */
+    int img_nlines, img_nsamps;  /* size of the band */
+    int qa_nlines, qa_nsamps;    /* size of the QA band */
+    int b_nlines = 0;       /* number of lines in each QA block */
+    int b_nsamps = 0;       /* number of samples in each QA block */
+    uint32_t rows_per_strip = 0;  /* number of lines in each QA strip */
+    int end_line;           /* line after the last line of the window */
+    int end_samp;           /* sample after the last sample of the window */
+    int first_line;         /* first window line covered by the block */
+    int last_line;          /* line after the last window line covered by
+                               the block */
+    int first_samp;         /* first window samp covered by the block */
+    int copy_nsamps;        /* how many window samples the block covers */
+    int nbytes;             /* number of bytes per pixel */
+    int qa_nbytes;          /* number of bytes per QA value */
+    uint64_t fill_bits;     /* bits of the fill value */
+    uint8_t *win_ptr = img_buf; /* byte pointer to the window buffer */
+    uint8_t *dst_ptr = NULL;    /* window location for the current block */
+    uint8_t *qa_buf = NULL;     /* QA values for the current block */
+
+    /* Make sure there is a fill value to mask with, and that the QA band
+       holds bits */
+    nbytes = ard_data_type_size (bmeta->data_type);
+    qa_nbytes = ard_data_type_size (qa_bmeta->data_type);
+    if (bmeta->fill_value == ARD_INT_META_FILL)
+    {
+        sprintf (errmsg, "Band doesn't have a fill value to mask with");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+    if (nbytes == ERROR || qa_nbytes == ERROR || qa_nbytes > 4 ||
+        qa_bmeta->data_type == ARD_FLOAT32 ||
+        qa_bmeta->data_type == ARD_FLOAT64)
+    {
+        sprintf (errmsg, "Unsupported band data type %d or QA data type %d",
+            bmeta->data_type, qa_bmeta->data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+    fill_bits = ard_fill_bits (bmeta->data_type, bmeta->fill_value);
+
+    /* The QA band has to line up with the band */
+    TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    TIFFGetField (qa_tif, TIFFTAG_IMAGEWIDTH, &qa_nsamps);
+    TIFFGetField (qa_tif, TIFFTAG_IMAGELENGTH, &qa_nlines);
+    if (qa_nlines != img_nlines || qa_nsamps != img_nsamps)
+    {
+        sprintf (errmsg, "QA band size (%d lines x %d samps) doesn't match "
+            "the band size (%d lines x %d samps)", qa_nlines, qa_nsamps,
+            img_nlines, img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Make sure the window is within the image */
+    end_line = start_line + nlines;
+    end_samp = start_samp + nsamps;
+    if (start_line < 0 || start_samp < 0 || nlines <= 0 || nsamps <= 0 ||
+        end_line > img_nlines || end_samp > img_nsamps)
+    {
+        sprintf (errmsg, "Window (start line %d, start samp %d, %d lines x "
+            "%d samps) is not within the Tiff image size (%d lines x %d "
+            "samps)", start_line, start_samp, nlines, nsamps, img_nlines,
+            img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Check the stride */
+    if (stride == 0)
+        stride = (size_t) nsamps * nbytes;
+    else if (stride < (size_t) nsamps * nbytes)
+    {
+        sprintf (errmsg, "Stride of %ld bytes is less than one line of %d "
+            "samps", (long) stride, nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Follow the tiles of the QA band, or its strips across the full
+       width of the image */
+    if (TIFFIsTiled (qa_tif))
+    {
+        TIFFGetField (qa_tif, TIFFTAG_TILEWIDTH, &b_nsamps);
+        TIFFGetField (qa_tif, TIFFTAG_TILELENGTH, &b_nlines);
+    }
+    else
+    {
+        TIFFGetField (qa_tif, TIFFTAG_ROWSPERSTRIP, &rows_per_strip);
+        if (rows_per_strip == 0 || rows_per_strip > (uint32_t) img_nlines)
+            rows_per_strip = img_nlines;
+        b_nlines = rows_per_strip;
+        b_nsamps = img_nsamps;
+    }
+    if (b_nlines <= 0 || b_nsamps <= 0)
+    {
+        sprintf (errmsg, "Invalid QA tile size (%d lines x %d samps)",
+            b_nlines, b_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Allocate space for the QA values of one block */
+    qa_buf = malloc ((size_t) b_nlines * b_nsamps * qa_nbytes);
+    if (qa_buf == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for the QA buffer");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Read and mask each block which intersects the window */
+    for (line = start_line - start_line % b_nlines; line < end_line;
+         line += b_nlines)
+    {
+        first_line = (line > start_line) ? line : start_line;
+        last_line = line + b_nlines;
+        if (last_line > end_line)
+            last_line = end_line;
+
+        for (samp = start_samp - start_samp % b_nsamps; samp < end_samp;
+             samp += b_nsamps)
+        {
+            first_samp = (samp > start_samp) ? samp : start_samp;
+            copy_nsamps = samp + b_nsamps;
+            if (copy_nsamps > end_samp)
+                copy_nsamps = end_samp;
+            copy_nsamps -= first_samp;
+            dst_ptr = &win_ptr[(size_t) (first_line - start_line) * stride +
+                (size_t) (first_samp - start_samp) * nbytes];
+
+            /* Read the block of the band straight into the window, and the
+               block of the QA band into the QA buffer */
+            if (ard_read_tiff_window_stride (tif, bmeta->data_type,
+                first_line, first_samp, last_line - first_line, copy_nsamps,
+                dst_ptr, stride) != SUCCESS ||
+                ard_read_tiff_window_stride (qa_tif, qa_bmeta->data_type,
+                first_line, first_samp, last_line - first_line, copy_nsamps,
+                qa_buf, 0) != SUCCESS)
+            {
+                sprintf (errmsg, "Reading Tiff files for line, samp: %d, %d.",
+                    first_line, first_samp);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                free (qa_buf);
+                return ERROR;
+            }
+
+            /* Mask the block while it is still in cache */
+            ard_mask_rows (qa_buf, (size_t) copy_nsamps * qa_nbytes,
+                qa_nbytes, dst_ptr, stride, nbytes, last_line - first_line,
+                copy_nsamps, mask, fill_bits);
+        }  /* samp */
+    }  /* line */
+
+    /* Free the QA buffer */
+    free (qa_buf);
+
+    return SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_masked
+
+PURPOSE: Reads the entire Tiff file, setting the pixels which are flagged in
+the QA band to fill (see ard_read_tiff_window_masked)
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff files
+SUCCESS      Reading was successful
+
+NOTES:
+*****************************************************************************/
+int ard_read_tiff_masked
+(
+    TIFF *tif,        /* I: pointer to the Tiff file for the band */
+    const Ard_band_meta_t *bmeta,  /* I: band metadata for the data type and
+                            fill value */
+    TIFF *qa_tif,     /* I: pointer to the Tiff file for the QA band */
+    const Ard_band_meta_t *qa_bmeta,  /* I: QA band metadata */
+    uint32_t mask,    /* I: QA bits which flag a pixel to be masked (see
+                            ard_qa_bit_mask) */
+    int nlines,       /* I: number of lines to read from the file */
+    int nsamps,       /* I: number of samples to read from the file */
+    void *img_buf     /* O: array of nlines * nsamps * size to be read from
+                            the Tiff file (sufficient space should already
+                            have been allocated) */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_masked"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+
+    /* Make sure the size of the image matches the user-specified size */
+    TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    if (img_nsamps != nsamps || img_nlines != nlines)
+    {
+        sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
+            "match Tiff image size (%d lines x %d samps)", nlines, nsamps,
+            img_nlines, img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    return ard_read_tiff_window_masked (tif, bmeta, qa_tif, qa_bmeta, mask,
+        0, 0, nlines, nsamps, img_buf, 0);
+}
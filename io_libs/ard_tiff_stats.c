@@ -0,0 +1,314 @@
+/*****************************************************************************
+FILE: ard_tiff_stats.c
+
+PURPOSE: Contains functions for accumulating band statistics and histograms
+a block of pixels at a time.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+  1. The blocks are expected to be tiles (or rows of tiles) which were just
+     decoded or are about to be encoded, so they are still in cache when the
+     statistics are computed.  See ard_read_tiff_stats and
+     ard_write_tiff_stats.
+  2. The mean and sum of squared differences of each line are merged into
+     the running values with the parallel algorithm of Chan et al., which
+     avoids the loss of precision of a running sum of squares.
+*****************************************************************************/
+
+#include <math.h>
+#include "ard_tiff_stats.h"
+
+
+/******************************************************************************
+MODULE: init_ard_tiff_stats
+
+PURPOSE: Initializes the statistics options to the defaults and clears the
+results
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The defaults are no fill value and no histogram.
+*****************************************************************************/
+void init_ard_tiff_stats
+(
+    Ard_tiff_stats_t *stats  /* O: statistics to be initialized */
+)
+{
+    stats->use_fill = false;
+    stats->fill_value = 0;
+    stats->nbins = 0;
+    stats->hist_min = 0.0;
+    stats->hist_max = 0.0;
+    stats->hist = NULL;
+
+    stats->nvalid = 0;
+    stats->nfill = 0;
+    stats->min = 0.0;
+    stats->max = 0.0;
+    stats->mean = 0.0;
+    stats->stddev = 0.0;
+    stats->m2 = 0.0;
+}
+
+
+/******************************************************************************
+MODULE: ard_merge_tiff_stats
+
+PURPOSE: Merges the statistics of a line of pixels into the running
+statistics
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The line is given by its count, sum, and sum of squares of the valid
+   pixels, all taken after subtracting shift.  The shift keeps the sums
+   small, so the sum of squared differences from the line mean loses little
+   precision.
+2. The standard deviation isn't updated; see ard_add_tiff_stats.
+*****************************************************************************/
+static void ard_merge_tiff_stats
+(
+    Ard_tiff_stats_t *stats, /* I/O: statistics to be updated */
+    unsigned long nvalid,    /* I: number of valid pixels in the line */
+    double shift,            /* I: value subtracted from each pixel */
+    double sum,              /* I: sum of the shifted valid pixels */
+    double sumsq,            /* I: sum of the squared shifted valid pixels */
+    double lmin,             /* I: minimum valid value in the line */
+    double lmax              /* I: maximum valid value in the line */
+)
+{
+    unsigned long total;     /* number of valid pixels after merging */
+    double lmean;            /* mean of the valid pixels in the line */
+    double lm2;              /* sum of squared differences from lmean */
+    double delta;            /* difference between the line and running
+                                means */
+
+    if (nvalid == 0)
+        return;
+
+    total = stats->nvalid + nvalid;
+    lmean = shift + sum / nvalid;
+    lm2 = sumsq - sum * sum / nvalid;
+    if (lm2 < 0.0)
+        lm2 = 0.0;
+    delta = lmean - stats->mean;
+    stats->mean += delta * nvalid / total;
+    stats->m2 += lm2 + delta * delta * ((double) stats->nvalid * nvalid /
+        total);
+    if (stats->nvalid == 0 || lmin < stats->min)
+        stats->min = lmin;
+    if (stats->nvalid == 0 || lmax > stats->max)
+        stats->max = lmax;
+    stats->nvalid = total;
+}
+
+
+/******************************************************************************
+MODULE: ard_add_tiff_stats
+
+PURPOSE: Adds a block of pixels to the running statistics and histogram
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. Each line of the block is passed over twice.  The first pass is a
+   branch-free masked pass for the count, sum, sum of squares, min, and max,
+   where the fill (and NaN) pixels are counted and then blended to values
+   which leave the results alone.  The second pass adds the valid pixels to
+   the histogram, and is skipped if there is no histogram.  The line is
+   merged into the running statistics in between (see
+   ard_merge_tiff_stats).
+2. For the 8 and 16-bit data types, the first pass is done exactly in
+   integers and is vectorized by the compiler (e.g. gcc -O3, or -O2
+   -ftree-vectorize).  The other data types are summed in double precision,
+   which the compiler won't reorder, so their first pass stays scalar.
+3. Unsupported data types are ignored.
+*****************************************************************************/
+void ard_add_tiff_stats
+(
+    Ard_tiff_stats_t *stats, /* I/O: statistics to be updated */
+    int data_type,           /* I: data type of the block (see Ard_data_type
+                                   in ard_metadata.h) */
+    const void *block,       /* I: first pixel of the block */
+    size_t stride,           /* I: bytes between the lines of the block */
+    int nlines,              /* I: number of lines in the block */
+    int nsamps               /* I: number of samples in the block */
+)
+{
+    int line, samp;          /* looping variables for the block */
+    int bin;                 /* histogram bin for the current pixel */
+    int nvalid;              /* number of valid pixels in the line */
+    const int use_fill = stats->use_fill;  /* should fill be left out? */
+    double value;            /* current pixel value */
+    double bin_scale = 0.0;  /* number of histogram bins per unit */
+    const uint8_t *row;      /* current line of the block */
+
+    if (nlines <= 0 || nsamps <= 0)
+        return;
+
+    if (stats->hist != NULL && stats->nbins > 0 &&
+        stats->hist_max > stats->hist_min)
+        bin_scale = stats->nbins / (stats->hist_max - stats->hist_min);
+
+/* Histogram pass over the valid pixels of the current line */
+#define ARD_LINE_HIST(type)                                                 \
+    if (bin_scale > 0.0)                                                    \
+    {                                                                       \
+        for (samp = 0; samp < nsamps; samp++)                               \
+        {                                                                   \
+            if (in[samp] != in[samp] || (use_fill && in[samp] == fill))     \
+                continue;                                                   \
+            value = (double) in[samp];                                      \
+            if (value >= stats->hist_min && value <= stats->hist_max)       \
+            {                                                               \
+                bin = (int) ((value - stats->hist_min) * bin_scale);        \
+                if (bin >= stats->nbins)                                    \
+                    bin = stats->nbins - 1;                                 \
+                stats->hist[bin]++;                                         \
+            }                                                               \
+        }                                                                   \
+    }
+
+/* Exact integer pass for the 8 and 16-bit data types.  The pixels are
+   widened to 32 bits and blended with an all-ones mask for the valid pixels,
+   which the compiler vectorizes (it turns a select back into a branch).  The
+   shifted values are within +/-65535, so their squares fit in 32 unsigned
+   bits. */
+#define ARD_BLOCK_STATS_INT(type, type_min, type_max)                       \
+    {                                                                       \
+        const int32_t fill = (type) stats->fill_value;                      \
+        const int32_t all_valid = use_fill ? 0 : -1;                        \
+        for (line = 0, row = block; line < nlines; line++, row += stride)   \
+        {                                                                   \
+            const type *restrict in = (const type *) row;                   \
+            const int32_t shift = in[0];                                    \
+            int64_t sum = 0;                                                \
+            uint64_t sumsq = 0;                                             \
+            int32_t lmin = type_max;                                        \
+            int32_t lmax = type_min;                                        \
+            nvalid = 0;                                                     \
+            for (samp = 0; samp < nsamps; samp++)                           \
+            {                                                               \
+                const int32_t pix = in[samp];                               \
+                const int32_t mask = -(int32_t) (pix != fill) | all_valid;  \
+                const int32_t diff = (pix - shift) & mask;                  \
+                const int32_t lo = type_max ^ ((pix ^ type_max) & mask);    \
+                const int32_t hi = type_min ^ ((pix ^ type_min) & mask);    \
+                nvalid -= mask;                                             \
+                sum += diff;                                                \
+                sumsq += (uint32_t) diff * (uint32_t) diff;                 \
+                lmin = (lo < lmin) ? lo : lmin;                             \
+                lmax = (hi > lmax) ? hi : lmax;                             \
+            }                                                               \
+            stats->nfill += nsamps - nvalid;                                \
+            ard_merge_tiff_stats (stats, nvalid, shift, (double) sum,       \
+                (double) sumsq, lmin, lmax);                                \
+            ARD_LINE_HIST (type)                                            \
+        }                                                                   \
+    }
+
+/* Double precision pass for the 32-bit integer and floating point data
+   types.  NaN pixels are never valid.  The shift is the first valid pixel,
+   since the sums are rounded. */
+#define ARD_BLOCK_STATS_WIDE(type)                                          \
+    {                                                                       \
+        const type fill = (type) stats->fill_value;                         \
+        for (line = 0, row = block; line < nlines; line++, row += stride)   \
+        {                                                                   \
+            const type *restrict in = (const type *) row;                   \
+            double shift = 0.0;                                             \
+            double sum = 0.0;                                               \
+            double sumsq = 0.0;                                             \
+            double lmin = INFINITY;                                         \
+            double lmax = -INFINITY;                                        \
+            nvalid = 0;                                                     \
+            for (samp = 0; samp < nsamps; samp++)                           \
+            {                                                               \
+                if (in[samp] == in[samp] &&                                 \
+                    (!use_fill || in[samp] != fill))                        \
+                {                                                           \
+                    shift = (double) in[samp];                              \
+                    break;                                                  \
+                }                                                           \
+            }                                                               \
+            for (samp = 0; samp < nsamps; samp++)                           \
+            {                                                               \
+                const type pix = in[samp];                                  \
+                const int valid = (pix == pix) &                            \
+                    (!use_fill | (pix != fill));                            \
+                const double pval = valid ? (double) pix : shift;           \
+                const double diff = pval - shift;                           \
+                const double lo = valid ? pval : INFINITY;                  \
+                const double hi = valid ? pval : -INFINITY;                 \
+                nvalid += valid;                                            \
+                sum += diff;                                                \
+                sumsq += diff * diff;                                       \
+                lmin = (lo < lmin) ? lo : lmin;                             \
+                lmax = (hi > lmax) ? hi : lmax;                             \
+            }                                                               \
+            stats->nfill += nsamps - nvalid;                                \
+            ard_merge_tiff_stats (stats, nvalid, shift, sum, sumsq, lmin,   \
+                lmax);                                                      \
+            ARD_LINE_HIST (type)                                            \
+        }                                                                   \
+    }
+
+    switch (data_type)
+    {
+        case ARD_INT8:
+            ARD_BLOCK_STATS_INT (int8_t, INT8_MIN, INT8_MAX); break;
+        case ARD_UINT8:
+            ARD_BLOCK_STATS_INT (uint8_t, 0, UINT8_MAX); break;
+        case ARD_INT16:
+            ARD_BLOCK_STATS_INT (int16_t, INT16_MIN, INT16_MAX); break;
+        case ARD_UINT16:
+            ARD_BLOCK_STATS_INT (uint16_t, 0, UINT16_MAX); break;
+        case ARD_INT32:   ARD_BLOCK_STATS_WIDE (int32_t); break;
+        case ARD_UINT32:  ARD_BLOCK_STATS_WIDE (uint32_t); break;
+        case ARD_FLOAT32: ARD_BLOCK_STATS_WIDE (float); break;
+        case ARD_FLOAT64: ARD_BLOCK_STATS_WIDE (double); break;
+        default: return;
+    }
+
+#undef ARD_BLOCK_STATS_WIDE
+#undef ARD_BLOCK_STATS_INT
+#undef ARD_LINE_HIST
+
+    if (stats->nvalid > 0)
+        stats->stddev = sqrt (stats->m2 / stats->nvalid);
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_stats_valid_range
+
+PURPOSE: Sets the valid range in the band metadata to the min and max of the
+statistics
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The band metadata is left alone if there were no valid pixels.
+*****************************************************************************/
+void ard_tiff_stats_valid_range
+(
+    const Ard_tiff_stats_t *stats, /* I: statistics for the band */
+    Ard_band_meta_t *bmeta   /* I/O: band metadata; valid_range is set to the
+                                   min and max */
+)
+{
+    if (stats->nvalid == 0)
+        return;
+
+    bmeta->valid_range[0] = stats->min;
+    bmeta->valid_range[1] = stats->max;
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************
+FILE: ard_tiff_stats.h
+
+PURPOSE: Contains defines, structures, and prototypes for accumulating band
+statistics and histograms a block of pixels at a time, as the tiles are read
+or written
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+1. The statistics for each block are computed on their own and then merged
+   into the running statistics, so the blocks can be added in any order.
+2. Fill pixels, and NaN pixels for the floating point data types, are
+   counted but otherwise left out of the statistics.
+*****************************************************************************/
+
+#ifndef ARD_TIFF_STATS_H
+#define ARD_TIFF_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "ard_metadata.h"
+
+/* Band statistics (see init_ard_tiff_stats) */
+typedef struct {
+  /* Options, set by the caller before adding any blocks */
+  bool use_fill;             /* should fill pixels be left out? */
+  long fill_value;           /* fill value for the band */
+  int nbins;                 /* number of histogram bins; 0 for no
+                                histogram */
+  double hist_min;           /* lower edge of the first histogram bin */
+  double hist_max;           /* upper edge of the last histogram bin */
+  unsigned long *hist;       /* nbins histogram counts, allocated and zeroed
+                                by the caller; values outside of hist_min to
+                                hist_max aren't counted */
+
+  /* Results */
+  unsigned long nvalid;      /* number of pixels in the statistics */
+  unsigned long nfill;       /* number of fill (or NaN) pixels */
+  double min;                /* minimum valid value */
+  double max;                /* maximum valid value */
+  double mean;               /* mean of the valid values */
+  double stddev;             /* population standard deviation of the valid
+                                values */
+  double m2;                 /* sum of the squared differences from the mean,
+                                used to merge the blocks */
+} Ard_tiff_stats_t;
+
+/* Prototypes */
+void init_ard_tiff_stats
+(
+    Ard_tiff_stats_t *stats  /* O: statistics to be initialized */
+);
+
+void ard_add_tiff_stats
+(
+    Ard_tiff_stats_t *stats, /* I/O: statistics to be updated */
+    int data_type,           /* I: data type of the block (see Ard_data_type
+                                   in ard_metadata.h) */
+    const void *block,       /* I: first pixel of the block */
+    size_t stride,           /* I: bytes between the lines of the block */
+    int nlines,              /* I: number of lines in the block */
+    int nsamps               /* I: number of samples in the block */
+);
+
+void ard_tiff_stats_valid_range
+(
+    const Ard_tiff_stats_t *stats, /* I: statistics for the band */
+    Ard_band_meta_t *bmeta   /* I/O: band metadata; valid_range is set to the
+                                   min and max */
+);
+
+#endif
@@ -0,0 +1,1136 @@
+/*****************************************************************************
+FILE: ard_tiff_threaded_io.c
+
+PURPOSE: Contains functions for reading/writing tile-oriented ARD Tiff files
+using multiple threads for the deflate compression/decompression, and for
+reading or writing multiple bands concurrently.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+  1. libtiff handles are not thread-safe, so the raw (compressed) tiles are
+     read/written serially with TIFFReadRawTile/TIFFWriteRawTile and only
+     the deflate and predictor work is spread across the threads.  Each
+     thread works in its own tile buffer.
+  2. Only deflate compressed, single-sample, native byte order files using
+     no predictor or the horizontal predictor are handled in parallel.  Any
+     other file falls back to the serial ard_read_tiff/ard_write_tiff.
+  3. The multi-band cube reader and the tile band writer open a separate
+     Tiff file for each band, so each thread reads or writes its own bands
+     through its own libtiff handle.
+*****************************************************************************/
+
+#include <zlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "ard_tiff_threaded_io.h"
+
+
+/******************************************************************************
+MODULE: ard_tiff_threads
+
+PURPOSE: Determines the number of threads to use
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+>= 1         Number of threads to use
+
+NOTES:
+*****************************************************************************/
+static int ard_tiff_threads
+(
+    int nthreads     /* I: requested number of threads (0 = default) */
+)
+{
+#ifdef _OPENMP
+    if (nthreads <= 0)
+        nthreads = omp_get_max_threads ();
+#else
+    nthreads = 1;
+#endif
+    if (nthreads < 1)
+        nthreads = 1;
+
+    return nthreads;
+}
+
+
+/******************************************************************************
+MODULE: ard_tiff_threadable
+
+PURPOSE: Determines if the deflate work for the current Tiff file can be
+handled by the threaded routines
+
+RETURN VALUE:
+Type = bool
+Value        Description
+-----        -----------
+true         The Tiff can be read/written via the threaded routines
+false        The serial routines need to be used
+
+NOTES:
+*****************************************************************************/
+static bool ard_tiff_threadable
+(
+    TIFF *tif,            /* I: pointer to the Tiff file */
+    uint16_t *predictor   /* O: predictor used by the Tiff file */
+)
+{
+    uint16_t compression = COMPRESSION_NONE; /* compression scheme */
+    uint16_t samps_per_pixel = 1;            /* number of samples per pixel */
+
+    TIFFGetField (tif, TIFFTAG_COMPRESSION, &compression);
+    TIFFGetField (tif, TIFFTAG_SAMPLESPERPIXEL, &samps_per_pixel);
+    if (compression != COMPRESSION_ADOBE_DEFLATE &&
+        compression != COMPRESSION_DEFLATE)
+        return false;
+    if (samps_per_pixel != 1 || TIFFIsByteSwapped (tif))
+        return false;
+
+    *predictor = PREDICTOR_NONE;
+    TIFFGetField (tif, TIFFTAG_PREDICTOR, predictor);
+    if (*predictor != PREDICTOR_NONE && *predictor != PREDICTOR_HORIZONTAL)
+        return false;
+
+    return true;
+}
+
+
+/******************************************************************************
+MODULE: ard_horizontal_predictor
+
+PURPOSE: Applies (encode) or removes (decode) the Tiff horizontal
+differencing predictor on each line of a tile
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. Differencing is done on unsigned integers of the pixel size, which is
+   what libtiff does for all sample formats.
+*****************************************************************************/
+static void ard_horizontal_predictor
+(
+    void *t_buf,       /* I/O: tile buffer */
+    int t_nlines,      /* I: number of lines in the tile */
+    int t_nsamps,      /* I: number of samples in the tile */
+    int nbytes,        /* I: number of bytes per pixel */
+    bool encode        /* I: true to apply, false to remove the predictor */
+)
+{
+    int line, samp;    /* looping variables */
+
+#define ARD_PREDICT(type)                                                   \
+    {                                                                       \
+        type *ptr;                                                          \
+        for (line = 0; line < t_nlines; line++)                             \
+        {                                                                   \
+            ptr = (type *) t_buf + (size_t) line * t_nsamps;                \
+            if (encode)                                                     \
+                for (samp = t_nsamps - 1; samp > 0; samp--)                 \
+                    ptr[samp] -= ptr[samp-1];                               \
+            else                                                            \
+                for (samp = 1; samp < t_nsamps; samp++)                     \
+                    ptr[samp] += ptr[samp-1];                               \
+        }                                                                   \
+    }
+
+    switch (nbytes)
+    {
+        case 1: ARD_PREDICT (uint8_t); break;
+        case 2: ARD_PREDICT (uint16_t); break;
+        case 4: ARD_PREDICT (uint32_t); break;
+        case 8: ARD_PREDICT (uint64_t); break;
+    }
+#undef ARD_PREDICT
+}
+
+
+/******************************************************************************
+MODULE: ard_write_tiff_threaded
+
+PURPOSE: Writes the entire Tiff file using multiple threads to compress the
+tiles
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred writing data to the Tiff file
+SUCCESS      Writing was successful
+
+NOTES:
+1. The Tiff tags need to be set (ard_set_tiff_tags) before calling this
+   routine, same as for ard_write_tiff.
+2. Tiles are compressed in parallel one batch at a time and then written
+   to the file in tile order.
+3. Files which can't be handled by the threaded routines are written with
+   ard_write_tiff.
+*****************************************************************************/
+int ard_write_tiff_threaded
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be written (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to write to the file */
+    int nsamps,      /* I: number of samples to write to the file */
+    int nthreads,    /* I: number of threads to use (0 = OpenMP default) */
+    void *img_buf    /* I: array of nlines * nsamps * size to be written to the
+                           Tiff file */
+)
+{
+    char FUNC_NAME[] = "ard_write_tiff_threaded"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int i;                  /* looping variable for tiles in the batch */
+    int t_line;             /* looping variable for tile lines */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+    int t_nlines = 0;       /* number of lines in each tile */
+    int t_nsamps = 0;       /* number of samples in each tile */
+    int ntiles_across;      /* number of tiles across the image */
+    int ntiles;             /* total number of tiles in the image */
+    int first_tile;         /* first tile in the current batch */
+    int batch_size;         /* number of tiles in each batch */
+    int nbytes;             /* number of bytes per pixel */
+    int zip_level = Z_DEFAULT_COMPRESSION; /* deflate compression level */
+    int status = SUCCESS;   /* return status */
+    uint16_t predictor;     /* predictor used for the Tiff */
+    tmsize_t tile_size;     /* size of each tile in bytes */
+    uLong out_capacity;     /* size of each compressed tile buffer */
+    uLongf *out_size = NULL;    /* size of each compressed tile */
+    int *tile_status = NULL;    /* status of each tile in the batch */
+    uint8_t *t_bufs = NULL;     /* tile buffers, one per thread */
+    uint8_t *out_bufs = NULL;   /* compressed tile buffers, one per tile in
+                                   the batch */
+
+    /* Get the size of the image as well as the size of each tile */
+    TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    TIFFGetField (tif, TIFFTAG_TILEWIDTH, &t_nsamps);
+    TIFFGetField (tif, TIFFTAG_TILELENGTH, &t_nlines);
+
+    /* If the size of the tile is invalid, then this isn't a tile-oriented
+       image */
+    if (t_nsamps <= 0 || t_nlines <= 0)
+    {
+        sprintf (errmsg, "Tiff is not a tile-oriented image");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* If the size of the image doesn't match that of the user-specified
+       size (and the size of the input image buffer), then it's an error */
+    if (img_nsamps != nsamps || img_nlines != nlines)
+    {
+        sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
+            "match Tiff image size (%d lines x %d samps)", nlines, nsamps,
+            img_nlines, img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Determine the size of each pixel */
+    nbytes = ard_data_type_size (data_type);
+    if (nbytes == ERROR)
+    {
+        sprintf (errmsg, "Unsupported data type %d", data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Use the serial writes if the compression can't be threaded */
+    if (!ard_tiff_threadable (tif, &predictor))
+        return ard_write_tiff (tif, data_type, nlines, nsamps, img_buf);
+    TIFFGetField (tif, TIFFTAG_ZIPQUALITY, &zip_level);
+
+    /* Allocate the tile buffers for each thread and the compressed tile
+       buffers for each tile in a batch */
+    nthreads = ard_tiff_threads (nthreads);
+    batch_size = nthreads * ARD_TILES_PER_THREAD;
+    tile_size = TIFFTileSize (tif);
+    out_capacity = compressBound (tile_size);
+    ntiles_across = (nsamps + t_nsamps - 1) / t_nsamps;
+    ntiles = TIFFNumberOfTiles (tif);
+
+    t_bufs = malloc ((size_t) nthreads * tile_size);
+    out_bufs = malloc ((size_t) batch_size * out_capacity);
+    out_size = calloc (batch_size, sizeof (uLongf));
+    tile_status = calloc (batch_size, sizeof (int));
+    if (t_bufs == NULL || out_bufs == NULL || out_size == NULL ||
+        tile_status == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for the tile buffers");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        free (t_bufs);
+        free (out_bufs);
+        free (out_size);
+        free (tile_status);
+        return ERROR;
+    }
+
+    for (first_tile = 0; first_tile < ntiles; first_tile += batch_size)
+    {
+        if (batch_size > ntiles - first_tile)
+            batch_size = ntiles - first_tile;
+
+        /* Compress the tiles in this batch */
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(nthreads) schedule(dynamic) \
+            private(t_line)
+#endif
+        for (i = 0; i < batch_size; i++)
+        {
+            int thread = 0;      /* current thread */
+            int tile;            /* current tile */
+            int line, samp;      /* UL line, samp of the current tile */
+            int copy_nlines;     /* number of lines to copy into the tile */
+            int copy_nsamps;     /* number of samples to copy into the tile */
+            uint8_t *t_buf;      /* tile buffer for this thread */
+            uint8_t *in_ptr = img_buf; /* byte pointer to the image */
+
+#ifdef _OPENMP
+            thread = omp_get_thread_num ();
+#endif
+            t_buf = &t_bufs[(size_t) thread * tile_size];
+            tile = first_tile + i;
+            line = (tile / ntiles_across) * t_nlines;
+            samp = (tile % ntiles_across) * t_nsamps;
+            copy_nlines = nlines - line;
+            if (copy_nlines > t_nlines)
+                copy_nlines = t_nlines;
+            copy_nsamps = nsamps - samp;
+            if (copy_nsamps > t_nsamps)
+                copy_nsamps = t_nsamps;
+
+            /* Copy the image into the tile, padding the partial tiles on the
+               right and bottom edges with zeros */
+            if (copy_nlines < t_nlines || copy_nsamps < t_nsamps)
+                memset (t_buf, 0, tile_size);
+            for (t_line = 0; t_line < copy_nlines; t_line++)
+            {
+                memcpy (&t_buf[(size_t) t_line * t_nsamps * nbytes],
+                    &in_ptr[((size_t) (line + t_line) * nsamps + samp) *
+                        nbytes],
+                    (size_t) copy_nsamps * nbytes);
+            }
+
+            /* Apply the predictor and compress the tile */
+            if (predictor == PREDICTOR_HORIZONTAL)
+                ard_horizontal_predictor (t_buf, t_nlines, t_nsamps, nbytes,
+                    true);
+            out_size[i] = out_capacity;
+            tile_status[i] = compress2 (&out_bufs[(size_t) i * out_capacity],
+                &out_size[i], t_buf, tile_size, zip_level);
+        }
+
+        /* Write the compressed tiles in tile order */
+        for (i = 0; i < batch_size; i++)
+        {
+            if (tile_status[i] != Z_OK)
+            {
+                sprintf (errmsg, "Compressing tile %d (zlib error %d)",
+                    first_tile + i, tile_status[i]);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                status = ERROR;
+                break;
+            }
+
+            if (TIFFWriteRawTile (tif, first_tile + i,
+                &out_bufs[(size_t) i * out_capacity], out_size[i]) < 0)
+            {
+                sprintf (errmsg, "Writing Tiff file for tile: %d.",
+                    first_tile + i);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                status = ERROR;
+                break;
+            }
+        }
+
+        if (status != SUCCESS)
+            break;
+    }
+
+    /* Free the buffers */
+    free (t_bufs);
+    free (out_bufs);
+    free (out_size);
+    free (tile_status);
+
+    return status;
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tiff_threaded
+
+PURPOSE: Reads the entire Tiff file using multiple threads to decompress the
+tiles
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading data from the Tiff file
+SUCCESS      Reading was successful
+
+NOTES:
+1. The raw tiles for one batch are read in tile order and then decompressed
+   in parallel.  Each thread inflates its tiles into its own tile buffer,
+   removes the predictor there, and copies the tile into the image.
+2. Files which can't be handled by the threaded routines are read with
+   ard_read_tiff.
+*****************************************************************************/
+int ard_read_tiff_threaded
+(
+    TIFF *tif,       /* I: pointer to the Tiff file */
+    int data_type,   /* I: data type of the array to be read (see
+                           Ard_data_type in ard_metadata.h) */
+    int nlines,      /* I: number of lines to read from the file */
+    int nsamps,      /* I: number of samples to read from the file */
+    int nthreads,    /* I: number of threads to use (0 = OpenMP default) */
+    void *img_buf    /* O: array of nlines * nsamps * size to be read from the
+                           Tiff file (sufficient space should already have
+                           been allocated) */
+)
+{
+    char FUNC_NAME[] = "ard_read_tiff_threaded"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int i;                  /* looping variable for tiles in the batch */
+    int t_line;             /* looping variable for tile lines */
+    int img_nlines;         /* number of lines in the Tiff file */
+    int img_nsamps;         /* number of samples in the Tiff file */
+    int t_nlines = 0;       /* number of lines in each tile */
+    int t_nsamps = 0;       /* number of samples in each tile */
+    int ntiles_across;      /* number of tiles across the image */
+    int ntiles;             /* total number of tiles in the image */
+    int first_tile;         /* first tile in the current batch */
+    int batch_size;         /* number of tiles in each batch */
+    int nbytes;             /* number of bytes per pixel */
+    int status = SUCCESS;   /* return status */
+    uint16_t predictor;     /* predictor used for the Tiff */
+    tmsize_t tile_size;     /* size of each tile in bytes */
+    tmsize_t *raw_size = NULL;     /* size of each raw tile in the batch */
+    tmsize_t *raw_capacity = NULL; /* size of each raw tile buffer */
+    int *tile_status = NULL;       /* status of each tile in the batch */
+    uint8_t **raw_bufs = NULL;     /* raw tile buffers, one per tile in the
+                                      batch */
+    uint8_t *t_bufs = NULL;        /* tile buffers, one per thread */
+
+    /* Get the size of the image as well as the size of each tile */
+    TIFFGetField (tif, TIFFTAG_IMAGEWIDTH, &img_nsamps);
+    TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &img_nlines);
+    TIFFGetField (tif, TIFFTAG_TILEWIDTH, &t_nsamps);
+    TIFFGetField (tif, TIFFTAG_TILELENGTH, &t_nlines);
+
+    /* If the size of the tile is invalid, then this isn't a tile-oriented
+       image */
+    if (t_nsamps <= 0 || t_nlines <= 0)
+    {
+        sprintf (errmsg, "Tiff is not a tile-oriented image");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* If the size of the image doesn't match that of the user-specified
+       size (and the size of the input image buffer), then it's an error */
+    if (img_nsamps != nsamps || img_nlines != nlines)
+    {
+        sprintf (errmsg, "User-specified size (%d lines x %d samps) doesn't "
+            "match Tiff image size (%d lines x %d samps)", nlines, nsamps,
+            img_nlines, img_nsamps);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Determine the size of each pixel */
+    nbytes = ard_data_type_size (data_type);
+    if (nbytes == ERROR)
+    {
+        sprintf (errmsg, "Unsupported data type %d", data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Use the serial reads if the decompression can't be threaded */
+    if (!ard_tiff_threadable (tif, &predictor))
+        return ard_read_tiff (tif, data_type, nlines, nsamps, img_buf);
+
+    /* Allocate the tile buffers for each thread and the raw tile buffer
+       pointers for each tile in a batch.  The raw tile buffers are grown as
+       needed. */
+    nthreads = ard_tiff_threads (nthreads);
+    batch_size = nthreads * ARD_TILES_PER_THREAD;
+    tile_size = TIFFTileSize (tif);
+    ntiles_across = (nsamps + t_nsamps - 1) / t_nsamps;
+    ntiles = TIFFNumberOfTiles (tif);
+
+    t_bufs = malloc ((size_t) nthreads * tile_size);
+    raw_bufs = calloc (batch_size, sizeof (uint8_t *));
+    raw_size = calloc (batch_size, sizeof (tmsize_t));
+    raw_capacity = calloc (batch_size, sizeof (tmsize_t));
+    tile_status = calloc (batch_size, sizeof (int));
+    if (t_bufs == NULL || raw_bufs == NULL || raw_size == NULL ||
+        raw_capacity == NULL || tile_status == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for the tile buffers");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        status = ERROR;
+        ntiles = 0;
+    }
+
+    for (first_tile = 0; first_tile < ntiles; first_tile += batch_size)
+    {
+        if (batch_size > ntiles - first_tile)
+            batch_size = ntiles - first_tile;
+
+        /* Read the raw tiles in this batch */
+        for (i = 0; i < batch_size; i++)
+        {
+            raw_size[i] = TIFFGetStrileByteCount (tif, first_tile + i);
+            if (raw_size[i] > raw_capacity[i])
+            {
+                free (raw_bufs[i]);
+                raw_bufs[i] = malloc (raw_size[i]);
+                if (raw_bufs[i] == NULL)
+                {
+                    sprintf (errmsg, "Unable to allocate memory for the raw "
+                        "tile buffer");
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    raw_capacity[i] = 0;
+                    status = ERROR;
+                    break;
+                }
+                raw_capacity[i] = raw_size[i];
+            }
+
+            /* Tiles which were never written are left empty */
+            if (raw_size[i] > 0 && TIFFReadRawTile (tif, first_tile + i,
+                raw_bufs[i], raw_size[i]) != raw_size[i])
+            {
+                sprintf (errmsg, "Reading Tiff file for tile: %d.",
+                    first_tile + i);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                status = ERROR;
+                break;
+            }
+        }
+
+        if (status != SUCCESS)
+            break;
+
+        /* Decompress the tiles in this batch into the image */
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(nthreads) schedule(dynamic) \
+            private(t_line)
+#endif
+        for (i = 0; i < batch_size; i++)
+        {
+            int thread = 0;      /* current thread */
+            int tile;            /* current tile */
+            int line, samp;      /* UL line, samp of the current tile */
+            int copy_nlines;     /* number of lines to copy from the tile */
+            int copy_nsamps;     /* number of samples to copy from the tile */
+            uLongf out_size;     /* size of the decompressed tile */
+            uint8_t *t_buf;      /* tile buffer for this thread */
+            uint8_t *out_ptr = img_buf; /* byte pointer to the image */
+
+#ifdef _OPENMP
+            thread = omp_get_thread_num ();
+#endif
+            t_buf = &t_bufs[(size_t) thread * tile_size];
+            tile = first_tile + i;
+
+            /* Decompress the tile and remove the predictor.  A short tile
+               is padded with zeros same as libtiff. */
+            out_size = tile_size;
+            tile_status[i] = Z_OK;
+            if (raw_size[i] > 0)
+                tile_status[i] = uncompress (t_buf, &out_size, raw_bufs[i],
+                    raw_size[i]);
+            else
+                out_size = 0;
+            if (tile_status[i] != Z_OK)
+                continue;
+            if ((tmsize_t) out_size < tile_size)
+                memset (&t_buf[out_size], 0, tile_size - out_size);
+            if (predictor == PREDICTOR_HORIZONTAL)
+                ard_horizontal_predictor (t_buf, t_nlines, t_nsamps, nbytes,
+                    false);
+
+            /* Copy the tile into the full-sized image */
+            line = (tile / ntiles_across) * t_nlines;
+            samp = (tile % ntiles_across) * t_nsamps;
+            copy_nlines = nlines - line;
+            if (copy_nlines > t_nlines)
+                copy_nlines = t_nlines;
+            copy_nsamps = nsamps - samp;
+            if (copy_nsamps > t_nsamps)
+                copy_nsamps = t_nsamps;
+            for (t_line = 0; t_line < copy_nlines; t_line++)
+            {
+                memcpy (&out_ptr[((size_t) (line + t_line) * nsamps + samp) *
+                        nbytes],
+                    &t_buf[(size_t) t_line * t_nsamps * nbytes],
+                    (size_t) copy_nsamps * nbytes);
+            }
+        }
+
+        for (i = 0; i < batch_size; i++)
+        {
+            if (tile_status[i] != Z_OK)
+            {
+                sprintf (errmsg, "Decompressing tile %d (zlib error %d)",
+                    first_tile + i, tile_status[i]);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                status = ERROR;
+                break;
+            }
+        }
+
+        if (status != SUCCESS)
+            break;
+    }
+
+    /* Free the buffers */
+    if (raw_bufs != NULL)
+    {
+        for (i = 0; i < nthreads * ARD_TILES_PER_THREAD; i++)
+            free (raw_bufs[i]);
+    }
+    free (raw_bufs);
+    free (raw_size);
+    free (raw_capacity);
+    free (tile_status);
+    free (t_bufs);
+
+    return status;
+}
+
+
+/******************************************************************************
+MODULE: ard_interleave_bip
+
+PURPOSE: Interleaves a block of lines from each band into band interleaved
+by pixel (BIP) order
+
+RETURN VALUE:
+Type = N/A
+
+NOTES:
+1. The transpose is done ARD_CUBE_BLOCK_PIXELS pixels at a time, so the
+   band lines being read and the interleaved pixels being written for each
+   block stay in cache.  The blocks are spread across the threads.
+*****************************************************************************/
+static void ard_interleave_bip
+(
+    uint8_t **planes,  /* I: pixels for each band, band by band */
+    int nbands,        /* I: number of bands */
+    size_t npix,       /* I: number of pixels in each band */
+    int nbytes,        /* I: number of bytes per pixel */
+    int nthreads,      /* I: number of threads to use */
+    uint8_t *bip_buf   /* O: npix * nbands pixels in BIP order */
+)
+{
+    long block;        /* looping variable for the blocks of pixels */
+    long nblocks;      /* number of blocks of pixels */
+
+    nblocks = (npix + ARD_CUBE_BLOCK_PIXELS - 1) / ARD_CUBE_BLOCK_PIXELS;
+
+#define ARD_INTERLEAVE(type)                                                \
+    {                                                                       \
+        const type *src;                                                    \
+        type *dst;                                                          \
+        for (band = 0; band < nbands; band++)                               \
+        {                                                                   \
+            src = (const type *) planes[band];                              \
+            dst = (type *) bip_buf + band;                                  \
+            for (pix = first_pix; pix < last_pix; pix++)                    \
+                dst[pix * nbands] = src[pix];                               \
+        }                                                                   \
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+    for (block = 0; block < nblocks; block++)
+    {
+        int band;          /* looping variable for the bands */
+        size_t pix;        /* looping variable for the pixels */
+        size_t first_pix;  /* first pixel in the block */
+        size_t last_pix;   /* pixel after the last pixel in the block */
+
+        first_pix = (size_t) block * ARD_CUBE_BLOCK_PIXELS;
+        last_pix = first_pix + ARD_CUBE_BLOCK_PIXELS;
+        if (last_pix > npix)
+            last_pix = npix;
+
+        switch (nbytes)
+        {
+            case 1: ARD_INTERLEAVE (uint8_t); break;
+            case 2: ARD_INTERLEAVE (uint16_t); break;
+            case 4: ARD_INTERLEAVE (uint32_t); break;
+            case 8: ARD_INTERLEAVE (uint64_t); break;
+        }
+    }
+#undef ARD_INTERLEAVE
+}
+
+
+/******************************************************************************
+MODULE: ard_read_tile_cube
+
+PURPOSE: Reads the selected bands of an ARD tile into a single image cube,
+reading the bands concurrently
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred reading the bands
+SUCCESS      Reading was successful
+
+NOTES:
+1. All of the selected bands need to have the same data type and size.
+2. For ARD_CUBE_BSQ, band i of the cube starts at cube_buf + i * nlines *
+   nsamps * size, and each band is read directly into its place in the cube.
+3. For ARD_CUBE_BIP, the pixels for all the bands are together, i.e. band i
+   of pixel (line, samp) is at ((line * nsamps + samp) * nbands + i) * size.
+   The bands are read one row of tiles at a time and interleaved from there,
+   so only one row of tiles for each band is held in addition to the cube.
+4. The band files are opened using the file names in the band metadata, as
+   for ard_open_tiff.
+5. If nlines is 0, all the lines of the band are read, starting at line 0.
+   Likewise, if nsamps is 0, all the samples are read, starting at sample 0.
+   The other dimension of the window is used as given.
+6. The read options are attached to each of the band files while they are
+   read, so a tile cache in them is shared by all the reading threads.
+*****************************************************************************/
+int ard_read_tile_cube
+(
+    Ard_tile_meta_t *tile_meta,  /* I: tile metadata for the bands */
+    int nbands,          /* I: number of bands to read */
+    const int *bands,    /* I: index of each band to read in tile_meta->band;
+                               NULL for the first nbands bands */
+    Ard_cube_layout_t layout,  /* I: layout of the cube */
+    int start_line,      /* I: starting line of the window (0-based) */
+    int start_samp,      /* I: starting sample of the window (0-based) */
+    int nlines,          /* I: number of lines in the window; 0 for all the
+                               lines, ignoring start_line */
+    int nsamps,          /* I: number of samples in the window; 0 for all
+                               the samples, ignoring start_samp */
+    const Ard_tiff_read_opts_t *read_opts,  /* I: read options (such as the
+                               tile cache) for the band files; NULL for the
+                               defaults */
+    int nthreads,        /* I: number of threads to use (0 = OpenMP
+                               default) */
+    void *cube_buf       /* O: array of nbands * nlines * nsamps * size to be
+                               read from the band files (sufficient space
+                               should already have been allocated) */
+)
+{
+    char FUNC_NAME[] = "ard_read_tile_cube"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    int i;                  /* looping variable for the bands */
+    int data_type;          /* data type of the bands */
+    int nbytes;             /* number of bytes per pixel */
+    int t_nlines = 0;       /* number of lines in each tile */
+    int line;               /* first line of the current row of tiles */
+    int end_line;           /* line after the last line of the window */
+    int strip_nlines;       /* number of lines in the current row of tiles */
+    int status = SUCCESS;   /* return status */
+    size_t band_size;       /* size of each band in the cube (bytes) */
+    int *band_status = NULL;    /* read status for each band */
+    TIFF **tifs = NULL;         /* Tiff file for each band */
+    uint8_t **planes = NULL;    /* row of tiles for each band (BIP) */
+    uint8_t *strip_bufs = NULL; /* buffer for the planes (BIP) */
+    uint8_t *cube_ptr = cube_buf;  /* byte pointer to the cube */
+    Ard_band_meta_t *bmeta = NULL; /* band metadata for the first band */
+    Ard_band_meta_t *cur_bmeta = NULL; /* band metadata for the current
+                                          band */
+
+    nthreads = ard_tiff_threads (nthreads);
+
+    /* Make sure the bands are valid and the same type and size */
+    if (nbands <= 0 || nbands > tile_meta->nbands)
+    {
+        sprintf (errmsg, "Invalid number of bands (%d) for a tile with %d "
+            "bands", nbands, tile_meta->nbands);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    for (i = 0; i < nbands; i++)
+    {
+        if (bands != NULL && (bands[i] < 0 || bands[i] >= tile_meta->nbands))
+        {
+            sprintf (errmsg, "Invalid band index %d for a tile with %d "
+                "bands", bands[i], tile_meta->nbands);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return ERROR;
+        }
+
+        cur_bmeta = &tile_meta->band[bands ? bands[i] : i];
+        if (i == 0)
+            bmeta = cur_bmeta;
+        else if (cur_bmeta->data_type != bmeta->data_type ||
+            cur_bmeta->nlines != bmeta->nlines ||
+            cur_bmeta->nsamps != bmeta->nsamps)
+        {
+            sprintf (errmsg, "Band %d doesn't have the same data type and "
+                "size as band %d", bands ? bands[i] : i,
+                bands ? bands[0] : 0);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return ERROR;
+        }
+    }
+
+    data_type = bmeta->data_type;
+    nbytes = ard_data_type_size (data_type);
+    if (nbytes == ERROR)
+    {
+        sprintf (errmsg, "Unsupported data type %d", data_type);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    /* Default each empty dimension to the entire band.  The window itself
+       is validated by the reads. */
+    if (nlines == 0)
+    {
+        start_line = 0;
+        nlines = bmeta->nlines;
+    }
+    if (nsamps == 0)
+    {
+        start_samp = 0;
+        nsamps = bmeta->nsamps;
+    }
+    end_line = start_line + nlines;
+    band_size = (size_t) nlines * nsamps * nbytes;
+
+    /* Open each of the bands */
+    tifs = calloc (nbands, sizeof (TIFF *));
+    band_status = calloc (nbands, sizeof (int));
+    if (tifs == NULL || band_status == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for the band files");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        status = ERROR;
+        goto cleanup;
+    }
+
+    for (i = 0; i < nbands; i++)
+    {
+        cur_bmeta = &tile_meta->band[bands ? bands[i] : i];
+        tifs[i] = ard_open_tiff (cur_bmeta->file_name, "r");
+        if (tifs[i] == NULL)
+        {
+            sprintf (errmsg, "Opening the Tiff file for band %d",
+                bands ? bands[i] : i);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
+        ard_set_tiff_read_opts (tifs[i], read_opts);
+    }
+
+    if (layout == ARD_CUBE_BSQ)
+    {
+        /* Read each band directly into the cube */
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+#endif
+        for (i = 0; i < nbands; i++)
+        {
+            band_status[i] = ard_read_tiff_window_stride (tifs[i],
+                data_type, start_line, start_samp, nlines, nsamps,
+                &cube_ptr[(size_t) i * band_size], 0);
+        }
+
+        for (i = 0; i < nbands; i++)
+        {
+            if (band_status[i] != SUCCESS)
+            {
+                sprintf (errmsg, "Reading band %d of the cube",
+                    bands ? bands[i] : i);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                status = ERROR;
+                goto cleanup;
+            }
+        }
+    }
+    else if (layout == ARD_CUBE_BIP)
+    {
+        /* Read the bands one row of tiles at a time */
+        TIFFGetField (tifs[0], TIFFTAG_TILELENGTH, &t_nlines);
+        if (t_nlines <= 0)
+        {
+            sprintf (errmsg, "Tiff file for band %d is not a tile-oriented "
+                "image", bands ? bands[0] : 0);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
+
+        planes = calloc (nbands, sizeof (uint8_t *));
+        strip_bufs = malloc ((size_t) nbands * t_nlines * nsamps * nbytes);
+        if (planes == NULL || strip_bufs == NULL)
+        {
+            sprintf (errmsg, "Unable to allocate memory for the band rows");
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
+        for (i = 0; i < nbands; i++)
+            planes[i] = &strip_bufs[(size_t) i * t_nlines * nsamps * nbytes];
+
+        for (line = start_line; line < end_line; line += strip_nlines)
+        {
+            /* Stop at the end of the current row of tiles */
+            strip_nlines = t_nlines - line % t_nlines;
+            if (strip_nlines > end_line - line)
+                strip_nlines = end_line - line;
+
+#ifdef _OPENMP
+            #pragma omp parallel for num_threads(nthreads) \
+                schedule(dynamic)
+#endif
+            for (i = 0; i < nbands; i++)
+            {
+                band_status[i] = ard_read_tiff_window_stride (tifs[i],
+                    data_type, line, start_samp, strip_nlines, nsamps,
+                    planes[i], 0);
+            }
+
+            for (i = 0; i < nbands; i++)
+            {
+                if (band_status[i] != SUCCESS)
+                {
+                    sprintf (errmsg, "Reading band %d of the cube for line "
+                        "%d", bands ? bands[i] : i, line);
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    status = ERROR;
+                    goto cleanup;
+                }
+            }
+
+            ard_interleave_bip (planes, nbands,
+                (size_t) strip_nlines * nsamps, nbytes, nthreads,
+                &cube_ptr[(size_t) (line - start_line) * nsamps * nbands *
+                    nbytes]);
+        }
+    }
+    else
+    {
+        sprintf (errmsg, "Unsupported cube layout %d", layout);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        status = ERROR;
+    }
+
+cleanup:
+    /* Close the bands and free the buffers */
+    if (tifs != NULL)
+    {
+        for (i = 0; i < nbands; i++)
+        {
+            if (tifs[i] != NULL)
+                ard_close_tiff (tifs[i]);
+        }
+    }
+    free (tifs);
+    free (band_status);
+    free (planes);
+    free (strip_bufs);
+
+    return status;
+}
+
+
+/******************************************************************************
+MODULE: ard_write_tile_bands
+
+PURPOSE: Writes the bands of an ARD tile to their Tiff files, writing the
+bands concurrently
+
+RETURN VALUE:
+Type = int
+Value        Description
+-----        -----------
+ERROR        An error occurred writing the bands
+SUCCESS      Writing was successful
+
+NOTES:
+1. Each band is written to its own Tiff file through its own libtiff handle,
+   using ard_set_tiff_tags_opts with opts, ard_set_geotiff_tags, and
+   ard_write_tiff.  The files are byte-identical to ones written one band at
+   a time with those calls and the same opts.  To match bands written with
+   ard_set_tiff_tags, use init_ard_tiff_write_opts with the predictor set to
+   ARD_PREDICTOR_HORIZONTAL and the same tile size.
+2. The geolocation tags are computed once for each pixel size in the tile
+   (see ard_compute_geotiff_tags) and shared by the bands.
+3. The band files are named by the file names in the band metadata,
+   relative to out_dir if it is specified.  The files are all created before
+   any band is written.
+4. Bands with a NULL image are skipped.
+*****************************************************************************/
+int ard_write_tile_bands
+(
+    Ard_tile_meta_t *tile_meta,  /* I: tile metadata for the bands */
+    void **band_bufs,    /* I: image for each band in tile_meta->band, with
+                               nlines * nsamps * size pixels; NULL to skip
+                               the band */
+    const char *out_dir, /* I: directory for the band files; NULL to use the
+                               file names as they are */
+    const Ard_tiff_write_opts_t *opts,  /* I: compression, predictor, and
+                               tile size to use for every band */
+    int nthreads         /* I: number of threads to use (0 = OpenMP
+                               default) */
+)
+{
+    char FUNC_NAME[] = "ard_write_tile_bands"; /* function name */
+    char errmsg[STR_SIZE];  /* error message */
+    char out_name[STR_SIZE];  /* name of the current band file */
+    int i, j;               /* looping variables for the bands */
+    int ngeos = 0;          /* number of distinct geolocation tags */
+    int status = SUCCESS;   /* return status */
+    int nbands = tile_meta->nbands;  /* number of bands in the tile */
+    int *band_status = NULL;    /* write status for each band */
+    int *geo_index = NULL;      /* geolocation tags for each band */
+    TIFF **tifs = NULL;         /* Tiff file for each band */
+    Ard_geotiff_tags_t *geos = NULL;  /* geolocation tags for each pixel
+                                         size */
+    Ard_band_meta_t *bmeta = NULL;    /* band metadata for the current
+                                         band */
+    Ard_proj_meta_t *proj_info = &tile_meta->tile_global.proj_info;
+                                      /* projection information */
+
+    nthreads = ard_tiff_threads (nthreads);
+    if (opts == NULL)
+    {
+        sprintf (errmsg, "Write options are required for the bands");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return ERROR;
+    }
+
+    tifs = calloc (nbands, sizeof (TIFF *));
+    band_status = calloc (nbands, sizeof (int));
+    geo_index = calloc (nbands, sizeof (int));
+    geos = malloc (nbands * sizeof (Ard_geotiff_tags_t));
+    if (tifs == NULL || band_status == NULL || geo_index == NULL ||
+        geos == NULL)
+    {
+        sprintf (errmsg, "Unable to allocate memory for the band files");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        status = ERROR;
+        goto cleanup;
+    }
+
+    /* Compute the geolocation tags for each pixel size, and create each of
+       the band files */
+    for (i = 0; i < nbands; i++)
+    {
+        if (band_bufs[i] == NULL)
+            continue;
+        bmeta = &tile_meta->band[i];
+
+        for (j = 0; j < ngeos; j++)
+        {
+            if (geos[j].pixelscale[0] == bmeta->pixel_size[0] &&
+                geos[j].pixelscale[1] == bmeta->pixel_size[1])
+                break;
+        }
+        if (j == ngeos)
+        {
+            if (ard_compute_geotiff_tags (bmeta, proj_info, &geos[j]) !=
+                SUCCESS)
+            {
+                sprintf (errmsg, "Computing the GeoTiff tags for band %d "
+                    "(%.*s)", i, ARD_BAND_NAME_LEN, bmeta->file_name);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                status = ERROR;
+                goto cleanup;
+            }
+            ngeos++;
+        }
+        geo_index[i] = j;
+
+        if (out_dir == NULL)
+            tifs[i] = ard_open_tiff (bmeta->file_name, "w");
+        else if (snprintf (out_name, sizeof (out_name), "%s/%s", out_dir,
+            bmeta->file_name) >= (int) sizeof (out_name))
+        {
+            sprintf (errmsg, "Output file name for band %d (%.*s) is too "
+                "long", i, ARD_BAND_NAME_LEN, bmeta->file_name);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
+        else
+            tifs[i] = ard_open_tiff (out_name, "w");
+        if (tifs[i] == NULL)
+        {
+            sprintf (errmsg, "Opening the Tiff file for band %d (%.*s)", i,
+                ARD_BAND_NAME_LEN, bmeta->file_name);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+            goto cleanup;
+        }
+    }
+
+    /* Write and close each band */
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+#endif
+    for (i = 0; i < nbands; i++)
+    {
+        Ard_band_meta_t *cur_bmeta = &tile_meta->band[i];  /* current band */
+
+        if (tifs[i] == NULL)
+            continue;
+
+        band_status[i] = ard_set_tiff_tags_opts (tifs[i],
+            cur_bmeta->data_type, cur_bmeta->nlines, cur_bmeta->nsamps, opts);
+        if (band_status[i] == SUCCESS)
+            band_status[i] = ard_apply_geotiff_tags (tifs[i],
+                &geos[geo_index[i]]);
+        if (band_status[i] == SUCCESS)
+            band_status[i] = ard_write_tiff (tifs[i], cur_bmeta->data_type,
+                cur_bmeta->nlines, cur_bmeta->nsamps, band_bufs[i]);
+        ard_close_tiff (tifs[i]);
+        tifs[i] = NULL;
+    }
+
+    for (i = 0; i < nbands; i++)
+    {
+        if (band_status[i] != SUCCESS)
+        {
+            sprintf (errmsg, "Writing band %d (%.*s) of the tile", i,
+                ARD_BAND_NAME_LEN, tile_meta->band[i].file_name);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            status = ERROR;
+        }
+    }
+
+cleanup:
+    /* Close any bands which weren't written and free the buffers */
+    if (tifs != NULL)
+    {
+        for (i = 0; i < nbands; i++)
+        {
+            if (tifs[i] != NULL)
+                ard_close_tiff (tifs[i]);
+        }
+    }
+    free (tifs);
+    free (band_status);
+    free (geo_index);
+    free (geos);
+
+    return status;
+}
@@ -0,0 +1,1272 @@
+/*****************************************************************************
+FILE: ard_compact_metadata.c
+
+PURPOSE: Contains functions for the string pool and for converting between
+the compact metadata and the ARD metadata structures.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+  1. The Ard_str_t offsets remain valid as the pool grows, however pointers
+     returned from ard_pool_string are only valid until the next string is
+     added to the pool.
+*****************************************************************************/
+
+#include <limits.h>
+#include "ard_compact_metadata.h"
+
+/* Names of the known product types, in the order of Ard_product_type */
+static const char *ard_product_names[] =
+{
+    "level1", "toa_refl", "toa_bt", "sr_refl", "level2_qa", "angle_bands",
+    ARD_STRING_META_FILL
+};
+
+/* Names of the category types, in the order of Ard_category_type */
+static const char *ard_category_names[] =
+{
+    "image", "qa", "browse", "index", "metadata"
+};
+
+/******************************************************************************
+MODULE:  hash_ard_string
+
+PURPOSE:  Computes the FNV-1a hash of a string.
+
+RETURN VALUE:
+Type = unsigned int
+Value           Description
+-----           -----------
+hash            Hash value of the string
+
+NOTES:
+******************************************************************************/
+static unsigned int hash_ard_string
+(
+    const char *str            /* I: string to be hashed */
+)
+{
+    unsigned int hash = 2166136261u;    /* FNV offset basis */
+
+    while (*str != '\0')
+    {
+        hash ^= (unsigned char) *str++;
+        hash *= 16777619u;              /* FNV prime */
+    }
+
+    return (hash);
+}
+
+
+/******************************************************************************
+MODULE:  grow_ard_string_pool_slots
+
+PURPOSE:  Doubles the size of the hash table in the string pool and adds the
+existing strings to the new table.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error allocating the hash table
+SUCCESS         Successfully grew the hash table
+
+NOTES:
+******************************************************************************/
+static int grow_ard_string_pool_slots
+(
+    Ard_string_pool_t *pool    /* I/O: string pool */
+)
+{
+    char FUNC_NAME[] = "grow_ard_string_pool_slots";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+    unsigned int i;            /* looping variable */
+    unsigned int slot;         /* hash slot for the current string */
+    unsigned int nslots = pool->nslots * 2;  /* new number of slots */
+    Ard_str_t *slots = NULL;   /* new hash table */
+
+    slots = calloc (nslots, sizeof (Ard_str_t));
+    if (slots == NULL)
+    {
+        sprintf (errmsg, "Allocating %u slots for the string pool", nslots);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Add each of the existing strings to the new table */
+    for (i = 0; i < pool->nslots; i++)
+    {
+        if (pool->slots[i] == 0)
+            continue;
+
+        slot = hash_ard_string (&pool->buf[pool->slots[i]]) & (nslots - 1);
+        while (slots[slot] != 0)
+            slot = (slot + 1) & (nslots - 1);
+        slots[slot] = pool->slots[i];
+    }
+
+    free (pool->slots);
+    pool->slots = slots;
+    pool->nslots = nslots;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  init_ard_string_pool
+
+PURPOSE:  Initializes the string pool, which will hold just the empty string.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error allocating the string pool
+SUCCESS         Successfully initialized the string pool
+
+NOTES:
+  1. The string pool needs to be freed via free_ard_string_pool.
+******************************************************************************/
+int init_ard_string_pool
+(
+    Ard_string_pool_t *pool    /* O: string pool to be initialized */
+)
+{
+    char FUNC_NAME[] = "init_ard_string_pool";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+
+    pool->buf = malloc (ARD_STRING_POOL_SIZE);
+    pool->slots = calloc (ARD_STRING_POOL_SLOTS, sizeof (Ard_str_t));
+    if (pool->buf == NULL || pool->slots == NULL)
+    {
+        free (pool->buf);
+        free (pool->slots);
+        pool->buf = NULL;
+        pool->slots = NULL;
+        sprintf (errmsg, "Allocating the string pool");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Offset 0 is the empty string */
+    pool->buf[0] = '\0';
+    pool->len = 1;
+    pool->size = ARD_STRING_POOL_SIZE;
+    pool->nslots = ARD_STRING_POOL_SLOTS;
+    pool->nstrings = 0;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  free_ard_string_pool
+
+PURPOSE:  Frees the memory in the string pool.
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void free_ard_string_pool
+(
+    Ard_string_pool_t *pool    /* I/O: string pool to be freed */
+)
+{
+    free (pool->buf);
+    free (pool->slots);
+    pool->buf = NULL;
+    pool->slots = NULL;
+    pool->len = pool->size = 0;
+    pool->nslots = pool->nstrings = 0;
+}
+
+
+/******************************************************************************
+MODULE:  ard_intern_string
+
+PURPOSE:  Returns the offset of the string in the string pool, adding the
+string to the pool if it isn't already there.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error adding the string to the pool
+SUCCESS         Successfully found or added the string
+
+NOTES:
+******************************************************************************/
+int ard_intern_string
+(
+    Ard_string_pool_t *pool,   /* I/O: string pool */
+    const char *str,           /* I: string to be added to the pool */
+    Ard_str_t *id              /* O: offset of the string in the pool */
+)
+{
+    char FUNC_NAME[] = "ard_intern_string";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+    size_t len;                /* length of the string, including the NULL */
+    size_t size;               /* new size of the string buffer */
+    unsigned int slot;         /* hash slot for the string */
+    char *buf = NULL;          /* reallocated string buffer */
+
+    /* The empty string is always at offset 0 */
+    if (str[0] == '\0')
+    {
+        *id = 0;
+        return (SUCCESS);
+    }
+
+    /* Keep the hash table at most half full */
+    if ((pool->nstrings + 1) * 2 > pool->nslots &&
+        grow_ard_string_pool_slots (pool) != SUCCESS)
+    {   /* Error messages already printed */
+        return (ERROR);
+    }
+
+    /* Look for the string in the pool */
+    slot = hash_ard_string (str) & (pool->nslots - 1);
+    while (pool->slots[slot] != 0)
+    {
+        if (!strcmp (&pool->buf[pool->slots[slot]], str))
+        {
+            *id = pool->slots[slot];
+            return (SUCCESS);
+        }
+        slot = (slot + 1) & (pool->nslots - 1);
+    }
+
+    /* Add the string to the end of the buffer */
+    len = strlen (str) + 1;
+    if (pool->len + len > UINT_MAX)
+    {
+        sprintf (errmsg, "String pool is full");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    if (pool->len + len > pool->size)
+    {
+        size = pool->size * 2;
+        while (pool->len + len > size)
+            size *= 2;
+        buf = realloc (pool->buf, size);
+        if (buf == NULL)
+        {
+            sprintf (errmsg, "Reallocating %zu bytes for the string pool",
+                size);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+        pool->buf = buf;
+        pool->size = size;
+    }
+
+    memcpy (&pool->buf[pool->len], str, len);
+    pool->slots[slot] = pool->len;
+    *id = pool->len;
+    pool->len += len;
+    pool->nstrings++;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_pool_string
+
+PURPOSE:  Returns the string at the specified offset in the string pool.
+
+RETURN VALUE:
+Type = const char *
+Value           Description
+-----           -----------
+string          String at the offset; the empty string for an invalid offset
+
+NOTES:
+******************************************************************************/
+const char *ard_pool_string
+(
+    const Ard_string_pool_t *pool,  /* I: string pool */
+    Ard_str_t id               /* I: offset of the string in the pool */
+)
+{
+    if (pool->buf == NULL || id >= pool->len)
+        return ("");
+
+    return (&pool->buf[id]);
+}
+
+
+/******************************************************************************
+MODULE:  ard_product_type
+
+PURPOSE:  Returns the product type for a band product or source name.
+
+RETURN VALUE:
+Type = enum Ard_product_type
+Value                   Description
+-----                   -----------
+ARD_PRODUCT_OTHER       Not one of the known product types
+ARD_PRODUCT_*           Known product type
+
+NOTES:
+******************************************************************************/
+enum Ard_product_type ard_product_type
+(
+    const char *product        /* I: product or source name */
+)
+{
+    int i;                     /* looping variable */
+
+    for (i = 0; i < ARD_PRODUCT_OTHER; i++)
+    {
+        if (!strcmp (product, ard_product_names[i]))
+            return (i);
+    }
+
+    return (ARD_PRODUCT_OTHER);
+}
+
+
+/******************************************************************************
+MODULE:  ard_category_type
+
+PURPOSE:  Returns the category type for a band category name.
+
+RETURN VALUE:
+Type = enum Ard_category_type
+Value                   Description
+-----                   -----------
+ARD_CATEGORY_OTHER      Not one of the schema category types
+ARD_CATEGORY_*          Known category type
+
+NOTES:
+******************************************************************************/
+enum Ard_category_type ard_category_type
+(
+    const char *category       /* I: category name */
+)
+{
+    int i;                     /* looping variable */
+
+    for (i = 0; i < ARD_CATEGORY_OTHER; i++)
+    {
+        if (!strcmp (category, ard_category_names[i]))
+            return (i);
+    }
+
+    return (ARD_CATEGORY_OTHER);
+}
+
+
+/******************************************************************************
+MODULE:  copy_ard_pool_string
+
+PURPOSE:  Copies a string from the string pool to a STR_SIZE character
+array.
+
+RETURN VALUE: N/A
+
+NOTES:
+  1. The strings in the pool come from STR_SIZE arrays, so they will fit.
+     Anything longer is truncated.
+******************************************************************************/
+static void copy_ard_pool_string
+(
+    const Ard_string_pool_t *pool,  /* I: string pool */
+    Ard_str_t id,              /* I: offset of the string in the pool */
+    char *dest                 /* O: STR_SIZE array to copy to */
+)
+{
+    snprintf (dest, STR_SIZE, "%s", ard_pool_string (pool, id));
+}
+
+
+/******************************************************************************
+MODULE:  init_ard_compact_metadata
+
+PURPOSE:  Initializes the compact metadata to be empty, using the specified
+string pool.
+
+RETURN VALUE: N/A
+
+NOTES:
+  1. The compact metadata is filled via ard_metadata_to_compact or
+     parse_ard_compact_metadata and freed via free_ard_compact_metadata.
+******************************************************************************/
+void init_ard_compact_metadata
+(
+    Ard_compact_meta_t *cmeta, /* O: compact metadata to be initialized */
+    Ard_string_pool_t *pool    /* I: string pool to use for the strings */
+)
+{
+    memset (cmeta, 0, sizeof (Ard_compact_meta_t));
+    cmeta->pool = pool;
+    cmeta->tile_meta.band = NULL;
+    cmeta->scene_meta = NULL;
+}
+
+
+/******************************************************************************
+MODULE:  free_ard_compact_band_metadata
+
+PURPOSE:  Frees an array of compact band metadata.
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void free_ard_compact_band_metadata
+(
+    int nbands,                     /* I: number of bands in the array */
+    Ard_compact_band_meta_t *cband  /* I/O: array of bands to be freed */
+)
+{
+    int i;                     /* looping variable */
+
+    if (cband == NULL)
+        return;
+
+    for (i = 0; i < nbands; i++)
+    {
+        free (cband[i].bitmap_description);
+        free (cband[i].class_values);
+    }
+    free (cband);
+}
+
+
+/******************************************************************************
+MODULE:  free_ard_compact_metadata
+
+PURPOSE:  Frees the memory in the compact metadata and resets it to empty.
+
+RETURN VALUE: N/A
+
+NOTES:
+  1. The string pool isn't freed since it may be shared.
+******************************************************************************/
+void free_ard_compact_metadata
+(
+    Ard_compact_meta_t *cmeta  /* I/O: compact metadata to be freed; the
+                                      string pool isn't freed */
+)
+{
+    int i;                     /* looping variable */
+
+    free_ard_compact_band_metadata (cmeta->tile_meta.nbands,
+        cmeta->tile_meta.band);
+    for (i = 0; i < cmeta->nscenes; i++)
+        free_ard_compact_band_metadata (cmeta->scene_meta[i].nbands,
+            cmeta->scene_meta[i].band);
+    free (cmeta->scene_meta);
+
+    init_ard_compact_metadata (cmeta, cmeta->pool);
+}
+
+
+/******************************************************************************
+MODULE:  allocate_ard_compact_scenes
+
+PURPOSE:  Grows (or shrinks) the scene metadata in the compact metadata to
+nscenes, keeping the existing scenes.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error allocating the scenes
+SUCCESS         Successfully allocated the scenes
+
+NOTES:
+  1. New scenes are empty and the bands of any removed scenes are freed.
+******************************************************************************/
+int allocate_ard_compact_scenes
+(
+    Ard_compact_meta_t *cmeta, /* I/O: compact metadata */
+    int nscenes                /* I: number of scenes */
+)
+{
+    char FUNC_NAME[] = "allocate_ard_compact_scenes";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+    int i;                     /* looping variable */
+    Ard_compact_scene_meta_t *smeta = NULL;  /* reallocated scenes */
+
+    /* Free the bands of any scenes being removed */
+    for (i = nscenes; i < cmeta->nscenes; i++)
+        free_ard_compact_band_metadata (cmeta->scene_meta[i].nbands,
+            cmeta->scene_meta[i].band);
+
+    if (nscenes <= 0)
+    {
+        free (cmeta->scene_meta);
+        cmeta->scene_meta = NULL;
+        cmeta->nscenes = 0;
+        return (SUCCESS);
+    }
+
+    smeta = realloc (cmeta->scene_meta,
+        nscenes * sizeof (Ard_compact_scene_meta_t));
+    if (smeta == NULL)
+    {
+        sprintf (errmsg, "Reallocating compact metadata for %d scenes",
+            nscenes);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    for (i = cmeta->nscenes; i < nscenes; i++)
+    {
+        memset (&smeta[i], 0, sizeof (Ard_compact_scene_meta_t));
+        smeta[i].band = NULL;
+    }
+    cmeta->scene_meta = smeta;
+    cmeta->nscenes = nscenes;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_band_to_compact
+
+PURPOSE:  Converts the band metadata to compact band metadata.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error converting the band
+SUCCESS         Successfully converted the band
+
+NOTES:
+  1. The bitmap description and class values are allocated in the compact
+     band and freed via free_ard_compact_band_metadata.
+******************************************************************************/
+int ard_band_to_compact
+(
+    Ard_string_pool_t *pool,        /* I/O: string pool */
+    Ard_band_meta_t *bmeta,         /* I: band metadata */
+    Ard_compact_band_meta_t *cband  /* O: compact band metadata */
+)
+{
+    char FUNC_NAME[] = "ard_band_to_compact";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+    int i;                     /* looping variable */
+
+    cband->nbits = 0;
+    cband->bitmap_description = NULL;
+    cband->nclass = 0;
+    cband->class_values = NULL;
+
+    cband->product_type = ard_product_type (bmeta->product);
+    cband->source_type = ard_product_type (bmeta->source);
+    cband->category_type = ard_category_type (bmeta->category);
+    if (ard_intern_string (pool, bmeta->product, &cband->product) ||
+        ard_intern_string (pool, bmeta->source, &cband->source) ||
+        ard_intern_string (pool, bmeta->name, &cband->name) ||
+        ard_intern_string (pool, bmeta->category, &cband->category) ||
+        ard_intern_string (pool, bmeta->short_name, &cband->short_name) ||
+        ard_intern_string (pool, bmeta->long_name, &cband->long_name) ||
+        ard_intern_string (pool, bmeta->file_name, &cband->file_name) ||
+        ard_intern_string (pool, bmeta->pixel_units, &cband->pixel_units) ||
+        ard_intern_string (pool, bmeta->data_units, &cband->data_units) ||
+        ard_intern_string (pool, bmeta->app_version, &cband->app_version) ||
+        ard_intern_string (pool, bmeta->production_date,
+            &cband->production_date))
+    {
+        sprintf (errmsg, "Adding band strings to the string pool");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    cband->data_type = bmeta->data_type;
+    cband->nlines = bmeta->nlines;
+    cband->nsamps = bmeta->nsamps;
+    cband->fill_value = bmeta->fill_value;
+    cband->saturate_value = bmeta->saturate_value;
+    cband->scale_factor = bmeta->scale_factor;
+    cband->add_offset = bmeta->add_offset;
+    cband->pixel_size[0] = bmeta->pixel_size[0];
+    cband->pixel_size[1] = bmeta->pixel_size[1];
+    cband->resample_method = bmeta->resample_method;
+    cband->valid_range[0] = bmeta->valid_range[0];
+    cband->valid_range[1] = bmeta->valid_range[1];
+
+    /* Bitmap description */
+    if (bmeta->nbits > 0)
+    {
+        cband->bitmap_description = calloc (bmeta->nbits, sizeof (Ard_str_t));
+        if (cband->bitmap_description == NULL)
+        {
+            sprintf (errmsg, "Allocating compact bitmap description");
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+        cband->nbits = bmeta->nbits;
+
+        for (i = 0; i < bmeta->nbits; i++)
+        {
+            if (ard_intern_string (pool, bmeta->bitmap_description[i],
+                &cband->bitmap_description[i]))
+            {
+                sprintf (errmsg, "Adding bitmap description to the string "
+                    "pool");
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return (ERROR);
+            }
+        }
+    }
+
+    /* Class values */
+    if (bmeta->nclass > 0)
+    {
+        cband->class_values = calloc (bmeta->nclass,
+            sizeof (Ard_compact_class_t));
+        if (cband->class_values == NULL)
+        {
+            sprintf (errmsg, "Allocating compact class values");
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+        cband->nclass = bmeta->nclass;
+
+        for (i = 0; i < bmeta->nclass; i++)
+        {
+            cband->class_values[i].class = bmeta->class_values[i].class;
+            if (ard_intern_string (pool, bmeta->class_values[i].description,
+                &cband->class_values[i].description))
+            {
+                sprintf (errmsg, "Adding class description to the string "
+                    "pool");
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return (ERROR);
+            }
+        }
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_compact_to_band
+
+PURPOSE:  Converts the compact band metadata to band metadata.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error converting the band
+SUCCESS         Successfully converted the band
+
+NOTES:
+  1. The bitmap description and class values are allocated in the band
+     metadata, the same as when the band is parsed.
+******************************************************************************/
+int ard_compact_to_band
+(
+    const Ard_string_pool_t *pool,  /* I: string pool */
+    Ard_compact_band_meta_t *cband, /* I: compact band metadata */
+    Ard_band_meta_t *bmeta          /* O: band metadata; bitmap and class
+                                          values are allocated */
+)
+{
+    int i;                     /* looping variable */
+
+    copy_ard_pool_string (pool, cband->product, bmeta->product);
+    copy_ard_pool_string (pool, cband->source, bmeta->source);
+    copy_ard_pool_string (pool, cband->name, bmeta->name);
+    copy_ard_pool_string (pool, cband->category, bmeta->category);
+    copy_ard_pool_string (pool, cband->short_name, bmeta->short_name);
+    copy_ard_pool_string (pool, cband->long_name, bmeta->long_name);
+    copy_ard_pool_string (pool, cband->file_name, bmeta->file_name);
+    copy_ard_pool_string (pool, cband->pixel_units, bmeta->pixel_units);
+    copy_ard_pool_string (pool, cband->data_units, bmeta->data_units);
+    copy_ard_pool_string (pool, cband->app_version, bmeta->app_version);
+    copy_ard_pool_string (pool, cband->production_date,
+        bmeta->production_date);
+
+    bmeta->data_type = cband->data_type;
+    bmeta->nlines = cband->nlines;
+    bmeta->nsamps = cband->nsamps;
+    bmeta->fill_value = cband->fill_value;
+    bmeta->saturate_value = cband->saturate_value;
+    bmeta->scale_factor = cband->scale_factor;
+    bmeta->add_offset = cband->add_offset;
+    bmeta->pixel_size[0] = cband->pixel_size[0];
+    bmeta->pixel_size[1] = cband->pixel_size[1];
+    bmeta->resample_method = cband->resample_method;
+    bmeta->valid_range[0] = cband->valid_range[0];
+    bmeta->valid_range[1] = cband->valid_range[1];
+
+    /* Bitmap description */
+    bmeta->nbits = 0;
+    bmeta->bitmap_description = NULL;
+    if (cband->nbits > 0)
+    {
+        if (allocate_ard_bitmap_metadata (bmeta, cband->nbits) != SUCCESS)
+        {   /* Error messages already printed */
+            return (ERROR);
+        }
+        for (i = 0; i < cband->nbits; i++)
+            copy_ard_pool_string (pool, cband->bitmap_description[i],
+                bmeta->bitmap_description[i]);
+    }
+
+    /* Class values */
+    bmeta->nclass = 0;
+    bmeta->class_values = NULL;
+    if (cband->nclass > 0)
+    {
+        if (allocate_ard_class_metadata (bmeta, cband->nclass) != SUCCESS)
+        {   /* Error messages already printed */
+            return (ERROR);
+        }
+        for (i = 0; i < cband->nclass; i++)
+        {
+            bmeta->class_values[i].class = cband->class_values[i].class;
+            copy_ard_pool_string (pool, cband->class_values[i].description,
+                bmeta->class_values[i].description);
+        }
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_proj_to_compact
+
+PURPOSE:  Converts the projection information to compact projection
+information.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error converting the projection information
+SUCCESS         Successfully converted the projection information
+
+NOTES:
+******************************************************************************/
+static int ard_proj_to_compact
+(
+    Ard_string_pool_t *pool,        /* I/O: string pool */
+    Ard_proj_meta_t *proj,          /* I: projection information */
+    Ard_compact_proj_meta_t *cproj  /* O: compact projection information */
+)
+{
+    if (ard_intern_string (pool, proj->units, &cproj->units) ||
+        ard_intern_string (pool, proj->grid_origin, &cproj->grid_origin))
+    {   /* Error messages already printed */
+        return (ERROR);
+    }
+
+    cproj->proj_type = proj->proj_type;
+    cproj->datum_type = proj->datum_type;
+    cproj->ul_corner[0] = proj->ul_corner[0];
+    cproj->ul_corner[1] = proj->ul_corner[1];
+    cproj->lr_corner[0] = proj->lr_corner[0];
+    cproj->lr_corner[1] = proj->lr_corner[1];
+    cproj->utm_zone = proj->utm_zone;
+    cproj->longitude_pole = proj->longitude_pole;
+    cproj->latitude_true_scale = proj->latitude_true_scale;
+    cproj->false_easting = proj->false_easting;
+    cproj->false_northing = proj->false_northing;
+    cproj->standard_parallel1 = proj->standard_parallel1;
+    cproj->standard_parallel2 = proj->standard_parallel2;
+    cproj->central_meridian = proj->central_meridian;
+    cproj->origin_latitude = proj->origin_latitude;
+    cproj->sphere_radius = proj->sphere_radius;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_compact_to_proj
+
+PURPOSE:  Converts the compact projection information to projection
+information.
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+static void ard_compact_to_proj
+(
+    const Ard_string_pool_t *pool,  /* I: string pool */
+    Ard_compact_proj_meta_t *cproj, /* I: compact projection information */
+    Ard_proj_meta_t *proj           /* O: projection information */
+)
+{
+    copy_ard_pool_string (pool, cproj->units, proj->units);
+    copy_ard_pool_string (pool, cproj->grid_origin, proj->grid_origin);
+
+    proj->proj_type = cproj->proj_type;
+    proj->datum_type = cproj->datum_type;
+    proj->ul_corner[0] = cproj->ul_corner[0];
+    proj->ul_corner[1] = cproj->ul_corner[1];
+    proj->lr_corner[0] = cproj->lr_corner[0];
+    proj->lr_corner[1] = cproj->lr_corner[1];
+    proj->utm_zone = cproj->utm_zone;
+    proj->longitude_pole = cproj->longitude_pole;
+    proj->latitude_true_scale = cproj->latitude_true_scale;
+    proj->false_easting = cproj->false_easting;
+    proj->false_northing = cproj->false_northing;
+    proj->standard_parallel1 = cproj->standard_parallel1;
+    proj->standard_parallel2 = cproj->standard_parallel2;
+    proj->central_meridian = cproj->central_meridian;
+    proj->origin_latitude = cproj->origin_latitude;
+    proj->sphere_radius = cproj->sphere_radius;
+}
+
+
+/******************************************************************************
+MODULE:  ard_tile_global_to_compact
+
+PURPOSE:  Converts the tile-based global metadata to compact tile-based
+global metadata.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error converting the global metadata
+SUCCESS         Successfully converted the global metadata
+
+NOTES:
+******************************************************************************/
+int ard_tile_global_to_compact
+(
+    Ard_string_pool_t *pool,                /* I/O: string pool */
+    Ard_global_tile_meta_t *gmeta,          /* I: tile global metadata */
+    Ard_compact_global_tile_meta_t *cgmeta  /* O: compact tile global
+                                                  metadata */
+)
+{
+    char FUNC_NAME[] = "ard_tile_global_to_compact";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+
+    if (ard_intern_string (pool, gmeta->data_provider,
+            &cgmeta->data_provider) ||
+        ard_intern_string (pool, gmeta->satellite, &cgmeta->satellite) ||
+        ard_intern_string (pool, gmeta->instrument, &cgmeta->instrument) ||
+        ard_intern_string (pool, gmeta->level1_collection,
+            &cgmeta->level1_collection) ||
+        ard_intern_string (pool, gmeta->ard_version, &cgmeta->ard_version) ||
+        ard_intern_string (pool, gmeta->region, &cgmeta->region) ||
+        ard_intern_string (pool, gmeta->acquisition_date,
+            &cgmeta->acquisition_date) ||
+        ard_intern_string (pool, gmeta->start_date, &cgmeta->start_date) ||
+        ard_intern_string (pool, gmeta->end_date, &cgmeta->end_date) ||
+        ard_intern_string (pool, gmeta->product_id, &cgmeta->product_id) ||
+        ard_intern_string (pool, gmeta->description, &cgmeta->description) ||
+        ard_intern_string (pool, gmeta->production_date,
+            &cgmeta->production_date) ||
+        ard_proj_to_compact (pool, &gmeta->proj_info, &cgmeta->proj_info))
+    {
+        sprintf (errmsg, "Adding tile global metadata strings to the string "
+            "pool");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    memcpy (cgmeta->bounding_coords, gmeta->bounding_coords,
+        sizeof (cgmeta->bounding_coords));
+    cgmeta->orientation_angle = gmeta->orientation_angle;
+    cgmeta->htile = gmeta->htile;
+    cgmeta->vtile = gmeta->vtile;
+    cgmeta->scene_count = gmeta->scene_count;
+    cgmeta->cloud_cover = gmeta->cloud_cover;
+    cgmeta->cloud_shadow = gmeta->cloud_shadow;
+    cgmeta->snow_ice = gmeta->snow_ice;
+    cgmeta->fill = gmeta->fill;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_compact_to_tile_global
+
+PURPOSE:  Converts the compact tile-based global metadata to tile-based
+global metadata.
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void ard_compact_to_tile_global
+(
+    const Ard_string_pool_t *pool,          /* I: string pool */
+    Ard_compact_global_tile_meta_t *cgmeta, /* I: compact tile global
+                                                  metadata */
+    Ard_global_tile_meta_t *gmeta           /* O: tile global metadata */
+)
+{
+    copy_ard_pool_string (pool, cgmeta->data_provider, gmeta->data_provider);
+    copy_ard_pool_string (pool, cgmeta->satellite, gmeta->satellite);
+    copy_ard_pool_string (pool, cgmeta->instrument, gmeta->instrument);
+    copy_ard_pool_string (pool, cgmeta->level1_collection,
+        gmeta->level1_collection);
+    copy_ard_pool_string (pool, cgmeta->ard_version, gmeta->ard_version);
+    copy_ard_pool_string (pool, cgmeta->region, gmeta->region);
+    copy_ard_pool_string (pool, cgmeta->acquisition_date,
+        gmeta->acquisition_date);
+    copy_ard_pool_string (pool, cgmeta->start_date, gmeta->start_date);
+    copy_ard_pool_string (pool, cgmeta->end_date, gmeta->end_date);
+    copy_ard_pool_string (pool, cgmeta->product_id, gmeta->product_id);
+    copy_ard_pool_string (pool, cgmeta->description, gmeta->description);
+    copy_ard_pool_string (pool, cgmeta->production_date,
+        gmeta->production_date);
+    ard_compact_to_proj (pool, &cgmeta->proj_info, &gmeta->proj_info);
+
+    memcpy (gmeta->bounding_coords, cgmeta->bounding_coords,
+        sizeof (gmeta->bounding_coords));
+    gmeta->orientation_angle = cgmeta->orientation_angle;
+    gmeta->htile = cgmeta->htile;
+    gmeta->vtile = cgmeta->vtile;
+    gmeta->scene_count = cgmeta->scene_count;
+    gmeta->cloud_cover = cgmeta->cloud_cover;
+    gmeta->cloud_shadow = cgmeta->cloud_shadow;
+    gmeta->snow_ice = cgmeta->snow_ice;
+    gmeta->fill = cgmeta->fill;
+}
+
+
+/******************************************************************************
+MODULE:  ard_scene_global_to_compact
+
+PURPOSE:  Converts the scene-based global metadata to compact scene-based
+global metadata.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error converting the global metadata
+SUCCESS         Successfully converted the global metadata
+
+NOTES:
+******************************************************************************/
+int ard_scene_global_to_compact
+(
+    Ard_string_pool_t *pool,                 /* I/O: string pool */
+    Ard_global_scene_meta_t *gmeta,          /* I: scene global metadata */
+    Ard_compact_global_scene_meta_t *cgmeta  /* O: compact scene global
+                                                   metadata */
+)
+{
+    char FUNC_NAME[] = "ard_scene_global_to_compact";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+
+    if (ard_intern_string (pool, gmeta->data_provider,
+            &cgmeta->data_provider) ||
+        ard_intern_string (pool, gmeta->satellite, &cgmeta->satellite) ||
+        ard_intern_string (pool, gmeta->instrument, &cgmeta->instrument) ||
+        ard_intern_string (pool, gmeta->acquisition_date,
+            &cgmeta->acquisition_date) ||
+        ard_intern_string (pool, gmeta->scene_center_time,
+            &cgmeta->scene_center_time) ||
+        ard_intern_string (pool, gmeta->level1_production_date,
+            &cgmeta->level1_production_date) ||
+        ard_intern_string (pool, gmeta->request_id, &cgmeta->request_id) ||
+        ard_intern_string (pool, gmeta->scene_id, &cgmeta->scene_id) ||
+        ard_intern_string (pool, gmeta->product_id, &cgmeta->product_id) ||
+        ard_intern_string (pool, gmeta->cpf_name, &cgmeta->cpf_name) ||
+        ard_intern_string (pool, gmeta->lpgs_metadata_file,
+            &cgmeta->lpgs_metadata_file))
+    {
+        sprintf (errmsg, "Adding scene global metadata strings to the string "
+            "pool");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    cgmeta->wrs_system = gmeta->wrs_system;
+    cgmeta->wrs_path = gmeta->wrs_path;
+    cgmeta->wrs_row = gmeta->wrs_row;
+    cgmeta->elevation_src = gmeta->elevation_src;
+    cgmeta->sensor_mode = gmeta->sensor_mode;
+    cgmeta->ephemeris_type = gmeta->ephemeris_type;
+    cgmeta->geometric_rmse_model = gmeta->geometric_rmse_model;
+    cgmeta->geometric_rmse_model_x = gmeta->geometric_rmse_model_x;
+    cgmeta->geometric_rmse_model_y = gmeta->geometric_rmse_model_y;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_compact_to_scene_global
+
+PURPOSE:  Converts the compact scene-based global metadata to scene-based
+global metadata.
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void ard_compact_to_scene_global
+(
+    const Ard_string_pool_t *pool,           /* I: string pool */
+    Ard_compact_global_scene_meta_t *cgmeta, /* I: compact scene global
+                                                   metadata */
+    Ard_global_scene_meta_t *gmeta           /* O: scene global metadata */
+)
+{
+    copy_ard_pool_string (pool, cgmeta->data_provider, gmeta->data_provider);
+    copy_ard_pool_string (pool, cgmeta->satellite, gmeta->satellite);
+    copy_ard_pool_string (pool, cgmeta->instrument, gmeta->instrument);
+    copy_ard_pool_string (pool, cgmeta->acquisition_date,
+        gmeta->acquisition_date);
+    copy_ard_pool_string (pool, cgmeta->scene_center_time,
+        gmeta->scene_center_time);
+    copy_ard_pool_string (pool, cgmeta->level1_production_date,
+        gmeta->level1_production_date);
+    copy_ard_pool_string (pool, cgmeta->request_id, gmeta->request_id);
+    copy_ard_pool_string (pool, cgmeta->scene_id, gmeta->scene_id);
+    copy_ard_pool_string (pool, cgmeta->product_id, gmeta->product_id);
+    copy_ard_pool_string (pool, cgmeta->cpf_name, gmeta->cpf_name);
+    copy_ard_pool_string (pool, cgmeta->lpgs_metadata_file,
+        gmeta->lpgs_metadata_file);
+
+    gmeta->wrs_system = cgmeta->wrs_system;
+    gmeta->wrs_path = cgmeta->wrs_path;
+    gmeta->wrs_row = cgmeta->wrs_row;
+    gmeta->elevation_src = cgmeta->elevation_src;
+    gmeta->sensor_mode = cgmeta->sensor_mode;
+    gmeta->ephemeris_type = cgmeta->ephemeris_type;
+    gmeta->geometric_rmse_model = cgmeta->geometric_rmse_model;
+    gmeta->geometric_rmse_model_x = cgmeta->geometric_rmse_model_x;
+    gmeta->geometric_rmse_model_y = cgmeta->geometric_rmse_model_y;
+}
+
+
+/******************************************************************************
+MODULE:  ard_bands_to_compact
+
+PURPOSE:  Converts an array of band metadata to a newly allocated array of
+compact band metadata.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error converting the bands
+SUCCESS         Successfully converted the bands
+
+NOTES:
+******************************************************************************/
+static int ard_bands_to_compact
+(
+    Ard_string_pool_t *pool,         /* I/O: string pool */
+    int nbands,                      /* I: number of bands */
+    Ard_band_meta_t *bmeta,          /* I: array of band metadata */
+    int *cnbands,                    /* O: number of compact bands */
+    Ard_compact_band_meta_t **cband  /* O: array of compact band metadata */
+)
+{
+    char FUNC_NAME[] = "ard_bands_to_compact";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+    int i;                     /* looping variable */
+
+    *cnbands = 0;
+    *cband = NULL;
+    if (nbands <= 0)
+        return (SUCCESS);
+
+    *cband = calloc (nbands, sizeof (Ard_compact_band_meta_t));
+    if (*cband == NULL)
+    {
+        sprintf (errmsg, "Allocating compact metadata for %d bands", nbands);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Count each band as it is converted so a partially converted array can
+       be freed */
+    for (i = 0; i < nbands; i++)
+    {
+        (*cnbands)++;
+        if (ard_band_to_compact (pool, &bmeta[i], &(*cband)[i]) != SUCCESS)
+        {   /* Error messages already printed */
+            return (ERROR);
+        }
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_metadata_to_compact
+
+PURPOSE:  Converts the ARD metadata to compact metadata.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error converting the metadata
+SUCCESS         Successfully converted the metadata
+
+NOTES:
+  1. Any existing contents of the compact metadata are freed first.
+******************************************************************************/
+int ard_metadata_to_compact
+(
+    Ard_meta_t *ard_meta,      /* I: ARD metadata */
+    Ard_compact_meta_t *cmeta  /* O: compact metadata, initialized via
+                                     init_ard_compact_metadata */
+)
+{
+    char FUNC_NAME[] = "ard_metadata_to_compact";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+    int i;                     /* looping variable */
+    Ard_string_pool_t *pool = cmeta->pool;   /* string pool */
+    Ard_scene_meta_t *smeta = NULL;          /* scene metadata */
+    Ard_compact_scene_meta_t *csmeta = NULL; /* compact scene metadata */
+
+    free_ard_compact_metadata (cmeta);
+
+    /* Namespace and tile metadata */
+    if (ard_intern_string (pool, ard_meta->meta_namespace,
+            &cmeta->meta_namespace) ||
+        ard_tile_global_to_compact (pool, &ard_meta->tile_meta.tile_global,
+            &cmeta->tile_meta.tile_global) ||
+        ard_bands_to_compact (pool, ard_meta->tile_meta.nbands,
+            ard_meta->tile_meta.band, &cmeta->tile_meta.nbands,
+            &cmeta->tile_meta.band))
+    {
+        sprintf (errmsg, "Converting the tile metadata");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Scene metadata */
+    if (allocate_ard_compact_scenes (cmeta, ard_meta->nscenes) != SUCCESS)
+    {   /* Error messages already printed */
+        return (ERROR);
+    }
+
+    for (i = 0; i < ard_meta->nscenes; i++)
+    {
+        smeta = &ard_meta->scene_meta[i];
+        csmeta = &cmeta->scene_meta[i];
+        if (ard_scene_global_to_compact (pool, &smeta->scene_global,
+                &csmeta->scene_global) ||
+            ard_bands_to_compact (pool, smeta->nbands, smeta->band,
+                &csmeta->nbands, &csmeta->band))
+        {
+            sprintf (errmsg, "Converting the metadata for scene %d", i);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_compact_to_metadata
+
+PURPOSE:  Converts the compact metadata to ARD metadata.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error converting the metadata
+SUCCESS         Successfully converted the metadata
+
+NOTES:
+  1. The band metadata is allocated in the ARD metadata and needs to be freed
+     via free_ard_metadata.
+******************************************************************************/
+int ard_compact_to_metadata
+(
+    Ard_compact_meta_t *cmeta, /* I: compact metadata */
+    Ard_meta_t *ard_meta       /* O: ARD metadata, initialized via
+                                     init_ard_metadata_struct */
+)
+{
+    char FUNC_NAME[] = "ard_compact_to_metadata";   /* function name */
+    char errmsg[STR_SIZE];     /* error message */
+    int i, b;                  /* looping variables */
+    Ard_string_pool_t *pool = cmeta->pool;   /* string pool */
+    Ard_scene_meta_t *smeta = NULL;          /* scene metadata */
+    Ard_compact_scene_meta_t *csmeta = NULL; /* compact scene metadata */
+
+    if (cmeta->nscenes > MAX_TOTAL_SCENES)
+    {
+        sprintf (errmsg, "Number of scenes (%d) exceeds the max total scenes "
+            "(%d)", cmeta->nscenes, MAX_TOTAL_SCENES);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Namespace and tile metadata */
+    copy_ard_pool_string (pool, cmeta->meta_namespace,
+        ard_meta->meta_namespace);
+    ard_compact_to_tile_global (pool, &cmeta->tile_meta.tile_global,
+        &ard_meta->tile_meta.tile_global);
+    if (cmeta->tile_meta.nbands > 0)
+    {
+        if (allocate_ard_band_metadata (&ard_meta->tile_meta, NULL,
+            cmeta->tile_meta.nbands) != SUCCESS)
+        {   /* Error messages already printed */
+            return (ERROR);
+        }
+        for (b = 0; b < cmeta->tile_meta.nbands; b++)
+        {
+            if (ard_compact_to_band (pool, &cmeta->tile_meta.band[b],
+                &ard_meta->tile_meta.band[b]) != SUCCESS)
+            {
+                sprintf (errmsg, "Converting tile band %d", b);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return (ERROR);
+            }
+        }
+    }
+
+    /* Scene metadata */
+    ard_meta->nscenes = cmeta->nscenes;
+    for (i = 0; i < cmeta->nscenes; i++)
+    {
+        smeta = &ard_meta->scene_meta[i];
+        csmeta = &cmeta->scene_meta[i];
+        ard_compact_to_scene_global (pool, &csmeta->scene_global,
+            &smeta->scene_global);
+        if (csmeta->nbands <= 0)
+            continue;
+
+        if (allocate_ard_band_metadata (NULL, smeta, csmeta->nbands)
+            != SUCCESS)
+        {   /* Error messages already printed */
+            return (ERROR);
+        }
+        for (b = 0; b < csmeta->nbands; b++)
+        {
+            if (ard_compact_to_band (pool, &csmeta->band[b],
+                &smeta->band[b]) != SUCCESS)
+            {
+                sprintf (errmsg, "Converting scene %d band %d", i, b);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return (ERROR);
+            }
+        }
+    }
+
+    return (SUCCESS);
+}
@@ -17,6 +17,9 @@ NOTES:
   2. This code relies on the libxml2 library developed for the Gnome project.
 *****************************************************************************/
 #include <sys/stat.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "ard_metadata.h"
 
 /******************************************************************************
@@ -32,6 +35,10 @@ ERROR           XML does not validate against the specified schema
 SUCCESS         XML validates
 
 NOTES:
+1. The schema is compiled for this one file and the XML library is cleaned
+   up afterwards.  Use create_ard_validator along with
+   validate_ard_xml_with_validator or validate_ard_xml_files to validate many
+   files against the same compiled schema.
 ******************************************************************************/
 int validate_ard_xml_file
 (
@@ -40,19 +47,72 @@ int validate_ard_xml_file
 {
     char FUNC_NAME[] = "validate_ard_xml_file";   /* function name */
     char errmsg[STR_SIZE];        /* error message */
-    char *schema_file = NULL;     /* name of schema file or URL to be validated
-                                     against */
     int status;                   /* return status */
-    xmlDocPtr doc = NULL;         /* resulting document tree */
-    xmlSchemaPtr schema = NULL;   /* pointer to the schema */
+    Ard_validator_t *validator = NULL;  /* compiled schema validator */
+
+    /* Compile the schema */
+    validator = create_ard_validator (NULL);
+    if (validator == NULL)
+    {
+        sprintf (errmsg, "Setting up the schema validator for %s", meta_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+    printf ("DEBUG: Using schema_file for validation ... %s\n",
+        validator->schema_file);
+
+    /* Validate the XML metadata against the schema */
+    status = validate_ard_xml_with_validator (validator, meta_file);
+
+    /* Free the resources and clean up the memory */
+    free_ard_validator (validator);
+    xmlSchemaCleanupTypes();
+    xmlCleanupParser();   /* cleanup the XML library */
+    xmlMemoryDump();      /* for debugging */
+
+    return (status);
+}
+
+
+/******************************************************************************
+MODULE:  create_ard_validator
+
+PURPOSE:  Compiles the ARD schema into a validator which can be reused for
+validating any number of ARD XML files.
+
+RETURN VALUE:
+Type = Ard_validator_t *
+Value           Description
+-----           -----------
+NULL            Error compiling the schema
+non-NULL        Pointer to the validator
+
+NOTES:
+1. If the schema file isn't specified, then the ARD_SCHEMA environment
+   variable is used.  If that isn't defined, then LOCAL_ARD_SCHEMA is used if
+   it exists, otherwise ARD_SCHEMA (https site) is used.
+2. This should be called from the main thread; it initializes the XML
+   library for use by multiple threads.
+3. The validator needs to be freed via free_ard_validator.
+******************************************************************************/
+Ard_validator_t *create_ard_validator
+(
+    char *schema_file         /* I: name of schema file or URL to compile; NULL
+                                    to use the ARD_SCHEMA environment variable
+                                    or the default schema locations */
+)
+{
+    char FUNC_NAME[] = "create_ard_validator";   /* function name */
+    char errmsg[STR_SIZE];        /* error message */
+    int count;                    /* number of chars copied in snprintf */
     xmlSchemaParserCtxtPtr ctxt = NULL;  /* parser context for the schema */
-    xmlSchemaValidCtxtPtr valid_ctxt = NULL;  /* pointer to validate from the
-                                                 schema */
+    Ard_validator_t *validator = NULL;   /* validator to be returned */
     struct stat statbuf;          /* buffer for the file stat function */
 
     /* Get the ARD schema environment variable which specifies the location
        of the XML schema to be used */
-    schema_file = getenv ("ARD_SCHEMA");
+    if (schema_file == NULL)
+        schema_file = getenv ("ARD_SCHEMA");
     if (schema_file == NULL)
     {  /* ARD schema environment variable wasn't defined. Try the version in
           /usr/local... */
@@ -63,17 +123,83 @@ int validate_ard_xml_file
             schema_file = ARD_SCHEMA;
         }
     }
-    printf ("DEBUG: Using schema_file for validation ... %s\n", schema_file);
+
+    /* Allocate the validator */
+    validator = calloc (1, sizeof (Ard_validator_t));
+    if (validator == NULL)
+    {
+        sprintf (errmsg, "Allocating memory for the validator");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (NULL);
+    }
+    count = snprintf (validator->schema_file, sizeof (validator->schema_file),
+        "%s", schema_file);
+    if (count < 0 || count >= sizeof (validator->schema_file))
+    {
+        sprintf (errmsg, "Overflow of validator->schema_file string");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        free (validator);
+        return (NULL);
+    }
 
     /* Set up the schema parser and parse the schema file/URL */
+    xmlInitParser ();
     xmlLineNumbersDefault (1);
     ctxt = xmlSchemaNewParserCtxt (schema_file);
-    xmlSchemaSetParserErrors (ctxt, (xmlSchemaValidityErrorFunc) fprintf,
-        (xmlSchemaValidityWarningFunc) fprintf, stderr);
-    schema = xmlSchemaParse (ctxt);
+    if (ctxt != NULL)
+    {
+        xmlSchemaSetParserErrors (ctxt, (xmlSchemaValidityErrorFunc) fprintf,
+            (xmlSchemaValidityWarningFunc) fprintf, stderr);
+        validator->schema = xmlSchemaParse (ctxt);
+
+        /* Free the schema parser context */
+        xmlSchemaFreeParserCtxt (ctxt);
+    }
+    if (validator->schema == NULL)
+    {
+        sprintf (errmsg, "Unable to compile schema %s.  ARD_SCHEMA "
+            "environment variable isn't defined or is invalid.  The first "
+            "default schema location of %s doesn't exist.  And the second "
+            "default location of %s was used as the last default.",
+            schema_file, LOCAL_ARD_SCHEMA, ARD_SCHEMA);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        free (validator);
+        return (NULL);
+    }
+
+    return (validator);
+}
+
+
+/******************************************************************************
+MODULE:  validate_ard_xml_with_validator
+
+PURPOSE:  Validates the specified ARD XML file with the compiled schema in the
+validator.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           XML does not validate against the specified schema
+SUCCESS         XML validates
 
-    /* Free the schema parser context */
-    xmlSchemaFreeParserCtxt (ctxt);
+NOTES:
+1. Thread-safe; the validator isn't modified and each call uses its own
+   validation context.
+******************************************************************************/
+int validate_ard_xml_with_validator
+(
+    Ard_validator_t *validator, /* I: validator from create_ard_validator */
+    char *meta_file             /* I: name of metadata file to be validated */
+)
+{
+    char FUNC_NAME[] = "validate_ard_xml_with_validator"; /* function name */
+    char errmsg[STR_SIZE];        /* error message */
+    int status;                   /* return status */
+    xmlDocPtr doc = NULL;         /* resulting document tree */
+    xmlSchemaValidCtxtPtr valid_ctxt = NULL;  /* pointer to validate from the
+                                                 schema */
 
     /* Load the XML file and parse it to the document tree */
     doc = xmlReadFile (meta_file, NULL, 0);
@@ -81,21 +207,29 @@ int validate_ard_xml_file
     {
         sprintf (errmsg, "Could not parse %s", meta_file);
         ard_error_handler (true, FUNC_NAME, errmsg);
-        sprintf (errmsg, "Possible schema file not found.  ARD_SCHEMA "
-            "environment variable isn't defined.  The first default schema "
-            "location of %s doesn't exist.  And the second default location of "
-            "%s was used as the last default.", LOCAL_ARD_SCHEMA, ARD_SCHEMA);
-        ard_error_handler (true, FUNC_NAME, errmsg);
         return (ERROR);
     }
 
     /* Identify the schema file as the validation source */
-    valid_ctxt = xmlSchemaNewValidCtxt (schema);
+    valid_ctxt = xmlSchemaNewValidCtxt (validator->schema);
+    if (valid_ctxt == NULL)
+    {
+        sprintf (errmsg, "Setting up the validation context for %s",
+            meta_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        xmlFreeDoc (doc);
+        return (ERROR);
+    }
     xmlSchemaSetValidErrors (valid_ctxt, (xmlSchemaValidityErrorFunc) fprintf,
         (xmlSchemaValidityWarningFunc) fprintf, stderr);
 
     /* Validate the XML metadata against the schema */
     status = xmlSchemaValidateDoc (valid_ctxt, doc);
+
+    /* Free the resources */
+    xmlSchemaFreeValidCtxt (valid_ctxt);
+    xmlFreeDoc (doc);
+
     if (status > 0)
     {
         sprintf (errmsg, "%s fails to validate", meta_file);
@@ -110,20 +244,91 @@ int validate_ard_xml_file
         return (ERROR);
     }
 
-    /* Free the resources and clean up the memory */
-    xmlSchemaFreeValidCtxt (valid_ctxt);
-    xmlFreeDoc (doc);
-    if (schema != NULL)
-        xmlSchemaFree (schema);
-    xmlSchemaCleanupTypes();
-    xmlCleanupParser();   /* cleanup the XML library */
-    xmlMemoryDump();      /* for debugging */
-
     /* Successful completion */
     return (SUCCESS);
 }
 
 
+/******************************************************************************
+MODULE:  validate_ard_xml_files
+
+PURPOSE:  Validates a batch of ARD XML files with the compiled schema in the
+validator.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           One or more of the XML files do not validate
+SUCCESS         All of the XML files validate
+
+NOTES:
+1. The files are validated in parallel when the library is built with
+   ENABLE_THREADING=yes (OpenMP), otherwise one at a time.
+2. The status of each file is returned in file_status, if specified.
+******************************************************************************/
+int validate_ard_xml_files
+(
+    Ard_validator_t *validator, /* I: validator from create_ard_validator */
+    int nfiles,                 /* I: number of metadata files to validate */
+    char **meta_files,          /* I: names of metadata files to validate */
+    int nthreads,               /* I: number of threads to use (0 = OpenMP
+                                      default) */
+    int *file_status            /* O: SUCCESS/ERROR for each file (may be
+                                      NULL) */
+)
+{
+    int i;                        /* looping variable */
+    int nfailed = 0;              /* number of files which failed */
+
+#ifdef _OPENMP
+    if (nthreads <= 0)
+        nthreads = omp_get_max_threads ();
+    #pragma omp parallel for num_threads(nthreads) schedule(dynamic) \
+        reduction(+:nfailed)
+#endif
+    for (i = 0; i < nfiles; i++)
+    {
+        int status = validate_ard_xml_with_validator (validator,
+            meta_files[i]);
+        if (file_status != NULL)
+            file_status[i] = status;
+        if (status != SUCCESS)
+            nfailed++;
+    }
+
+    if (nfailed > 0)
+        return (ERROR);
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  free_ard_validator
+
+PURPOSE:  Frees the compiled schema and the validator.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+1. The global XML library memory isn't cleaned up, since other threads may
+   still be using the XML library.
+******************************************************************************/
+void free_ard_validator
+(
+    Ard_validator_t *validator  /* I: validator to be freed */
+)
+{
+    if (validator == NULL)
+        return;
+
+    if (validator->schema != NULL)
+        xmlSchemaFree (validator->schema);
+    free (validator);
+}
+
+
 /******************************************************************************
 MODULE:  init_ard_tile_metadata_struct
 
@@ -148,6 +353,7 @@ void init_ard_tile_metadata_struct
     /* Initialze the number of bands for the tile-based metadata */
     tile_meta->nbands = 0;
     tile_meta->band = NULL;
+    tile_meta->arena = NULL;
 
     /* Initialize the tile-based global metadata values to fill for use by the
        write metadata routines */
@@ -219,6 +425,7 @@ void init_ard_metadata_struct
         scene_meta = &ard_meta->scene_meta[i];
         scene_meta->nbands = 0;
         scene_meta->band = NULL;
+        scene_meta->arena = NULL;
         scene_gmeta = &scene_meta->scene_global;
 
         /* Initialize the scene-based global metadata values to fill for use by
@@ -247,6 +454,129 @@ void init_ard_metadata_struct
 }
 
 
+/******************************************************************************
+MODULE:  set_ard_metadata_arena
+
+PURPOSE:  Sets the arena from which the band metadata, bitmap descriptions,
+and class values of the tile and scenes are allocated.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+  1. Needs to be called after init_ard_metadata_struct and before any bands
+     are allocated (i.e. before parsing).
+  2. With an arena, free_ard_metadata doesn't free anything; all of the
+     allocations for the document are released at once by resetting or
+     freeing the arena.  The arena needs to outlive the metadata.
+  3. An arena isn't thread-safe, so each thread parsing documents
+     concurrently should use its own arena.
+******************************************************************************/
+void set_ard_metadata_arena
+(
+    Ard_meta_t *ard_meta,     /* I/O: ARD metadata structure, initialized via
+                                      init_ard_metadata_struct */
+    Ard_arena_t *arena        /* I: arena for the band allocations; NULL to
+                                    allocate from the heap */
+)
+{
+    int i;                    /* looping variable */
+
+    ard_meta->tile_meta.arena = arena;
+    for (i = 0; i < MAX_TOTAL_SCENES; i++)
+        ard_meta->scene_meta[i].arena = arena;
+}
+
+
+/******************************************************************************
+MODULE:  ard_meta_calloc
+
+PURPOSE:  Allocates zeroed memory from the arena, or from the heap if there
+is no arena.
+
+RETURN VALUE:
+Type = void *
+Value           Description
+-----           -----------
+NULL            Error allocating the memory
+non-NULL        Pointer to the allocated memory
+
+NOTES:
+******************************************************************************/
+static void *ard_meta_calloc
+(
+    Ard_arena_t *arena,       /* I/O: arena to allocate from; NULL for the
+                                      heap */
+    size_t nmemb,             /* I: number of elements */
+    size_t size               /* I: size of each element (bytes) */
+)
+{
+    if (arena != NULL)
+        return (ard_arena_calloc (arena, nmemb, size));
+
+    return (calloc (nmemb, size));
+}
+
+
+/******************************************************************************
+MODULE:  init_ard_band_metadata
+
+PURPOSE:  Initializes a range of bands in an array of band metadata.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+  1. Initializes the bitmap_description and class_values for each band to NULL
+     and sets the nbits, nclass, ncover to 0.
+******************************************************************************/
+void init_ard_band_metadata
+(
+    Ard_band_meta_t *bmeta,  /* I/O: array of band metadata */
+    int first_band,          /* I: first band to be initialized */
+    int nbands               /* I: number of bands in the array */
+)
+{
+    int i;                          /* looping variable */
+
+    /* Set the nbits, nclass, ncover fields in the band metadata to 0 for each
+       band and initialize the pointers to NULL.  Initialize the other fields to
+       fill to make it easy to distinguish if they were populated by reading
+       an input metadata file or assigned directly. */
+    for (i = first_band; i < nbands; i++)
+    {
+        bmeta[i].nbits = 0;
+        bmeta[i].bitmap_description = NULL;
+        bmeta[i].nclass = 0;
+        bmeta[i].class_values = NULL;
+        bmeta[i].arena = NULL;
+
+        strcpy (bmeta[i].product, ARD_STRING_META_FILL);
+        strcpy (bmeta[i].source, ARD_STRING_META_FILL);
+        strcpy (bmeta[i].name, ARD_STRING_META_FILL);
+        strcpy (bmeta[i].category, ARD_STRING_META_FILL);
+        bmeta[i].data_type = ARD_UINT8;
+        bmeta[i].nlines = ARD_INT_META_FILL;
+        bmeta[i].nsamps = ARD_INT_META_FILL;
+        bmeta[i].fill_value = ARD_INT_META_FILL;
+        bmeta[i].saturate_value = ARD_INT_META_FILL;
+        bmeta[i].scale_factor = ARD_FLOAT_META_FILL;
+        bmeta[i].add_offset = ARD_FLOAT_META_FILL;
+        bmeta[i].resample_method = ARD_NONE;
+        strcpy (bmeta[i].short_name, ARD_STRING_META_FILL);
+        strcpy (bmeta[i].long_name, ARD_STRING_META_FILL);
+        strcpy (bmeta[i].file_name, ARD_STRING_META_FILL);
+        bmeta[i].pixel_size[0] = bmeta[i].pixel_size[1] = ARD_FLOAT_META_FILL;
+        strcpy (bmeta[i].pixel_units, ARD_STRING_META_FILL);
+        strcpy (bmeta[i].data_units, ARD_STRING_META_FILL);
+        bmeta[i].valid_range[0] = bmeta[i].valid_range[1] =
+            ARD_FLOAT_META_FILL;
+        strcpy (bmeta[i].app_version, ARD_STRING_META_FILL);
+        strcpy (bmeta[i].production_date, ARD_STRING_META_FILL);
+    }
+}
+
+
 /******************************************************************************
 MODULE:  allocate_ard_band_metadata
 
@@ -279,13 +609,16 @@ int allocate_ard_band_metadata
     Ard_band_meta_t *bmeta = NULL;  /* pointer to array of bands metadata in
                                        the tile-specific or scene-specific
                                        metadata structure */
+    Ard_arena_t *arena = NULL;      /* arena to allocate from, if any */
     int i;                          /* looping variable */
 
     /* Allocate the number of bands to nbands and the associated pointers */
     if (tile_meta != NULL)
     {
+        arena = tile_meta->arena;
         tile_meta->nbands = nbands;
-        tile_meta->band = calloc (nbands, sizeof (Ard_band_meta_t));
+        tile_meta->band = ard_meta_calloc (arena, nbands,
+            sizeof (Ard_band_meta_t));
         if (tile_meta->band == NULL)
         {
             sprintf (errmsg, "Allocating ARD tile-specific band metadata for "
@@ -297,8 +630,10 @@ int allocate_ard_band_metadata
     }
     else if (scene_meta != NULL)
     {
+        arena = scene_meta->arena;
         scene_meta->nbands = nbands;
-        scene_meta->band = calloc (nbands, sizeof (Ard_band_meta_t));
+        scene_meta->band = ard_meta_calloc (arena, nbands,
+            sizeof (Ard_band_meta_t));
         if (scene_meta->band == NULL)
         {
             sprintf (errmsg, "Allocating ARD scene-specific band metadata for "
@@ -309,41 +644,101 @@ int allocate_ard_band_metadata
         bmeta = scene_meta->band;
     }
 
-    /* Set the nbits, nclass, ncover fields in the band metadata to 0 for each
-       band and initialize the pointers to NULL.  Initialize the other fields to
-       fill to make it easy to distinguish if they were populated by reading
-       an input metadata file or assigned directly. */
+    /* Initialize the band metadata */
+    init_ard_band_metadata (bmeta, 0, nbands);
     for (i = 0; i < nbands; i++)
+        bmeta[i].arena = arena;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  reallocate_ard_band_metadata
+
+PURPOSE:  Grows (or shrinks) the band metadata in the ARD scene or tile
+metadata structure to nbands, keeping the existing bands.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error reallocating memory for the nbands
+SUCCESS         Successfully reallocated memory
+
+NOTES:
+  1. Any new bands are initialized the same as allocate_ard_band_metadata.
+  2. Shrinking the band metadata doesn't free the bitmap_description and
+     class_values of the removed bands; those should be unused.
+  3. With an arena, the bands are copied to a new array from the arena when
+     growing.  The old array is released along with the arena, so growing by
+     doubling keeps the unused space under half.
+******************************************************************************/
+int reallocate_ard_band_metadata
+(
+    Ard_tile_meta_t *tile_meta,   /* I: pointer to tile-specific metadata,
+                                        NULL if reallocating scene metadata */
+    Ard_scene_meta_t *scene_meta, /* I: pointer to scene-specific metadata,
+                                        NULL if reallocating tile metadata */
+    int nbands     /* I: number of bands for the tile-specific or
+                         scene-specific band field */
+)
+{
+    char FUNC_NAME[] = "reallocate_ard_band_metadata";   /* function name */
+    char errmsg[STR_SIZE];          /* error message */
+    int *cur_nbands = NULL;         /* pointer to the current number of bands
+                                       in the tile/scene metadata */
+    Ard_band_meta_t **band = NULL;  /* pointer to the array of bands metadata
+                                       in the tile/scene metadata */
+    Ard_band_meta_t *bmeta = NULL;  /* reallocated array of bands metadata */
+    Ard_arena_t *arena = NULL;      /* arena to allocate from, if any */
+    int i;                          /* looping variable */
+
+    if (tile_meta != NULL)
     {
-        bmeta[i].nbits = 0;
-        bmeta[i].bitmap_description = NULL;
-        bmeta[i].nclass = 0;
-        bmeta[i].class_values = NULL;
+        cur_nbands = &tile_meta->nbands;
+        band = &tile_meta->band;
+        arena = tile_meta->arena;
+    }
+    else if (scene_meta != NULL)
+    {
+        cur_nbands = &scene_meta->nbands;
+        band = &scene_meta->band;
+        arena = scene_meta->arena;
+    }
+    else
+        return (SUCCESS);
 
-        strcpy (bmeta[i].product, ARD_STRING_META_FILL);
-        strcpy (bmeta[i].source, ARD_STRING_META_FILL);
-        strcpy (bmeta[i].name, ARD_STRING_META_FILL);
-        strcpy (bmeta[i].category, ARD_STRING_META_FILL);
-        bmeta[i].data_type = ARD_UINT8;
-        bmeta[i].nlines = ARD_INT_META_FILL;
-        bmeta[i].nsamps = ARD_INT_META_FILL;
-        bmeta[i].fill_value = ARD_INT_META_FILL;
-        bmeta[i].saturate_value = ARD_INT_META_FILL;
-        bmeta[i].scale_factor = ARD_FLOAT_META_FILL;
-        bmeta[i].add_offset = ARD_FLOAT_META_FILL;
-        bmeta[i].resample_method = ARD_NONE;
-        strcpy (bmeta[i].short_name, ARD_STRING_META_FILL);
-        strcpy (bmeta[i].long_name, ARD_STRING_META_FILL);
-        strcpy (bmeta[i].file_name, ARD_STRING_META_FILL);
-        bmeta[i].pixel_size[0] = bmeta[i].pixel_size[1] = ARD_FLOAT_META_FILL;
-        strcpy (bmeta[i].pixel_units, ARD_STRING_META_FILL);
-        strcpy (bmeta[i].data_units, ARD_STRING_META_FILL);
-        bmeta[i].valid_range[0] = bmeta[i].valid_range[1] =
-            ARD_FLOAT_META_FILL;
-        strcpy (bmeta[i].app_version, ARD_STRING_META_FILL);
-        strcpy (bmeta[i].production_date, ARD_STRING_META_FILL);
+    /* Reallocate the bands, keeping the existing bands */
+    if (arena != NULL)
+    {
+        if (nbands <= *cur_nbands)
+            bmeta = *band;
+        else
+        {
+            bmeta = ard_arena_calloc (arena, nbands, sizeof (Ard_band_meta_t));
+            if (bmeta != NULL && *cur_nbands > 0)
+                memcpy (bmeta, *band, *cur_nbands * sizeof (Ard_band_meta_t));
+        }
+    }
+    else
+        bmeta = realloc (*band, (nbands > 0 ? nbands : 1) *
+            sizeof (Ard_band_meta_t));
+    if (bmeta == NULL)
+    {
+        sprintf (errmsg, "Reallocating ARD band metadata for %d bands",
+            nbands);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
     }
 
+    /* Initialize any new bands */
+    init_ard_band_metadata (bmeta, *cur_nbands, nbands);
+    for (i = *cur_nbands; i < nbands; i++)
+        bmeta[i].arena = arena;
+    *band = bmeta;
+    *cur_nbands = nbands;
+
     return (SUCCESS);
 }
 
@@ -375,7 +770,8 @@ int allocate_ard_class_metadata
     /* Allocate the number of classes to nclass and the associated class_values
        pointer */
     band_meta->nclass = nclass;
-    band_meta->class_values = calloc (nclass, sizeof (Ard_class_t));
+    band_meta->class_values = ard_meta_calloc (band_meta->arena, nclass,
+        sizeof (Ard_class_t));
     if (band_meta->class_values == NULL)
     {
         sprintf (errmsg, "Allocating ARD band metadata for %d nclasses",
@@ -415,7 +811,8 @@ int allocate_ard_bitmap_metadata
 
     /* Allocate the number of bits to nbits and the associated bitmap pointer */
     band_meta->nbits = nbits;
-    band_meta->bitmap_description = calloc (nbits, sizeof (char *));
+    band_meta->bitmap_description = ard_meta_calloc (band_meta->arena, nbits,
+        sizeof (char *));
     if (band_meta->bitmap_description == NULL)
     {
         sprintf (errmsg, "Allocating ARD bitmap description");
@@ -425,7 +822,8 @@ int allocate_ard_bitmap_metadata
 
     for (i = 0; i < nbits; i++)
     {
-        band_meta->bitmap_description[i] = calloc (STR_SIZE, sizeof (char));
+        band_meta->bitmap_description[i] = ard_meta_calloc (band_meta->arena,
+            STR_SIZE, sizeof (char));
         if (band_meta->bitmap_description[i] == NULL)
         {
             sprintf (errmsg, "Allocating ARD band metadata for %d nbits",
@@ -447,6 +845,8 @@ PURPOSE:  Frees memory in the ARD bands metadata
 RETURN VALUE: N/A
 
 NOTES:
+  1. Not to be used for bands allocated from an arena; those are released
+     with the arena.
 ******************************************************************************/
 void free_ard_band_metadata
 (
@@ -454,21 +854,48 @@ void free_ard_band_metadata
     Ard_band_meta_t *band  /* I/O: array of band metadata to be freed */
 )
 {
-    int i, b;       /* looping variables */
+    int i;          /* looping variable */
 
     /* Free the pointers in band metadata */
     for (i = 0; i < nbands; i++)
+        clear_ard_band_metadata (&band[i]);
+    free (band);
+}
+
+
+/******************************************************************************
+MODULE:  clear_ard_band_metadata
+
+PURPOSE:  Frees the bitmap description and class values of a single band and
+resets them to empty, so the band can be reused.
+
+RETURN VALUE: N/A
+
+NOTES:
+  1. If the band was allocated from an arena, the memory isn't freed but is
+     released with the arena.
+******************************************************************************/
+void clear_ard_band_metadata
+(
+    Ard_band_meta_t *bmeta  /* I/O: band metadata to be cleared */
+)
+{
+    int b;          /* looping variable */
+
+    if (bmeta->arena == NULL)
     {
-        if (band[i].nbits > 0)
+        if (bmeta->nbits > 0)
         {
-            for (b = 0; b < band[i].nbits; b++)
-                free (band[i].bitmap_description[b]);
-            free (band[i].bitmap_description);
+            for (b = 0; b < bmeta->nbits; b++)
+                free (bmeta->bitmap_description[b]);
+            free (bmeta->bitmap_description);
         }
-
-        free (band[i].class_values);
+        free (bmeta->class_values);
     }
-    free (band);
+    bmeta->nbits = 0;
+    bmeta->bitmap_description = NULL;
+    bmeta->nclass = 0;
+    bmeta->class_values = NULL;
 }
 
 
@@ -480,6 +907,8 @@ PURPOSE:  Frees memory in the ARD tile and scene metadata structures.
 RETURN VALUE: N/A
 
 NOTES:
+  1. If the metadata was allocated from an arena (see set_ard_metadata_arena)
+     nothing is freed here; the memory is released with the arena.
 ******************************************************************************/
 void free_ard_metadata
 (
@@ -491,11 +920,13 @@ void free_ard_metadata
 
     /* Free the pointers in the tile-specific band metadata */
     tmeta = &ard_meta->tile_meta;
-    free_ard_band_metadata (tmeta->nbands, tmeta->band);
+    if (tmeta->arena == NULL)
+        free_ard_band_metadata (tmeta->nbands, tmeta->band);
 
     /* Free the pointers in the scene-specific band metadata */
     smeta = ard_meta->scene_meta;
-    free_ard_band_metadata (smeta->nbands, smeta->band);
+    if (smeta->arena == NULL)
+        free_ard_band_metadata (smeta->nbands, smeta->band);
 }
 
 
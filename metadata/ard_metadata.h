@@ -22,6 +22,7 @@ NOTES:
 #include <libxml/xmlreader.h>
 #include <libxml/xmlschemastypes.h>
 #include "ard_error_handler.h"
+#include "ard_arena.h"
 #include "ard_gctp_defines.h"
 
 /* Defines - Namespace only contains the major version number (i.e. 1 for 1.x),
@@ -226,6 +227,9 @@ typedef struct
     char app_version[STR_SIZE];  /* version of the application which produced
                                     the current band */
     char production_date[STR_SIZE];  /* date the band was produced */
+    Ard_arena_t *arena;          /* arena the bitmap_description and
+                                    class_values are allocated from; NULL if
+                                    allocated from the heap */
 } Ard_band_meta_t;
 
 typedef struct
@@ -233,6 +237,8 @@ typedef struct
     Ard_global_tile_meta_t tile_global;    /* global metadata */
     int nbands;                /* number of bands in the metadata file */
     Ard_band_meta_t *band;     /* array of band metadata */
+    Ard_arena_t *arena;        /* arena the bands are allocated from; NULL if
+                                  allocated from the heap */
 } Ard_tile_meta_t;
 
 typedef struct
@@ -240,6 +246,8 @@ typedef struct
     Ard_global_scene_meta_t scene_global;  /* global metadata */
     int nbands;                /* number of bands in the metadata file */
     Ard_band_meta_t *band;     /* array of band metadata */
+    Ard_arena_t *arena;        /* arena the bands are allocated from; NULL if
+                                  allocated from the heap */
 } Ard_scene_meta_t;
 
 typedef struct
@@ -252,6 +260,15 @@ typedef struct
                                        the scenes in the tile */
 } Ard_meta_t;
 
+/* Compiled ARD schema used for validating XML files.  The schema is compiled
+   once and is read-only afterwards, so a single validator can be shared by
+   any number of threads. */
+typedef struct
+{
+    char schema_file[STR_SIZE];  /* schema file or URL which was compiled */
+    xmlSchemaPtr schema;         /* compiled schema */
+} Ard_validator_t;
+
 
 /* Prototypes */
 int validate_ard_xml_file
@@ -259,6 +276,35 @@ int validate_ard_xml_file
     char *meta_file           /* I: name of metadata file to be validated */
 );
 
+Ard_validator_t *create_ard_validator
+(
+    char *schema_file         /* I: name of schema file or URL to compile; NULL
+                                    to use the ARD_SCHEMA environment variable
+                                    or the default schema locations */
+);
+
+int validate_ard_xml_with_validator
+(
+    Ard_validator_t *validator, /* I: validator from create_ard_validator */
+    char *meta_file             /* I: name of metadata file to be validated */
+);
+
+int validate_ard_xml_files
+(
+    Ard_validator_t *validator, /* I: validator from create_ard_validator */
+    int nfiles,                 /* I: number of metadata files to validate */
+    char **meta_files,          /* I: names of metadata files to validate */
+    int nthreads,               /* I: number of threads to use (0 = OpenMP
+                                      default) */
+    int *file_status            /* O: SUCCESS/ERROR for each file (may be
+                                      NULL) */
+);
+
+void free_ard_validator
+(
+    Ard_validator_t *validator  /* I: validator to be freed */
+);
+
 void init_ard_tile_metadata_struct
 (
     Ard_tile_meta_t *tile_meta /* I: pointer to ARD tile_metadata structure to
@@ -271,6 +317,21 @@ void init_ard_metadata_struct
                                     initialized */
 );
 
+void set_ard_metadata_arena
+(
+    Ard_meta_t *ard_meta,     /* I/O: ARD metadata structure, initialized via
+                                      init_ard_metadata_struct */
+    Ard_arena_t *arena        /* I: arena for the band allocations; NULL to
+                                    allocate from the heap */
+);
+
+void init_ard_band_metadata
+(
+    Ard_band_meta_t *bmeta,  /* I/O: array of band metadata */
+    int first_band,          /* I: first band to be initialized */
+    int nbands               /* I: number of bands in the array */
+);
+
 int allocate_ard_band_metadata
 (
     Ard_tile_meta_t *tile_meta,   /* I: pointer to tile-specific metadata,
@@ -281,6 +342,16 @@ int allocate_ard_band_metadata
                          scene-specific band field */
 );
 
+int reallocate_ard_band_metadata
+(
+    Ard_tile_meta_t *tile_meta,   /* I: pointer to tile-specific metadata,
+                                        NULL if reallocating scene metadata */
+    Ard_scene_meta_t *scene_meta, /* I: pointer to scene-specific metadata,
+                                        NULL if reallocating tile metadata */
+    int nbands     /* I: number of bands for the tile-specific or
+                         scene-specific band field */
+);
+
 int allocate_ard_class_metadata
 (
     Ard_band_meta_t *band_meta,  /* I: pointer to band metadata structure */
@@ -301,6 +372,11 @@ void free_ard_band_metadata
     Ard_band_meta_t *band  /* I/O: array of band metadata to be freed */
 );
 
+void clear_ard_band_metadata
+(
+    Ard_band_meta_t *bmeta  /* I/O: band metadata to be cleared */
+);
+
 void free_ard_metadata
 (
     Ard_meta_t *ard_meta     /* I: pointer to ARD metadata structure */
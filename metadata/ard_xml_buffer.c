@@ -0,0 +1,779 @@
+/*****************************************************************************
+FILE: ard_xml_buffer.c
+
+PURPOSE: Contains functions for the XML output buffer used when writing the
+ARD metadata.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+*****************************************************************************/
+
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <float.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ard_common.h"
+#include "ard_error_handler.h"
+#include "ard_xml_buffer.h"
+
+/* Largest value (times 1e6) formatted by the fast %f path; beyond this the
+   value is formatted by snprintf */
+#define ARD_XML_MAX_FAST_DOUBLE 9.0e15
+
+/******************************************************************************
+MODULE:  ard_xml_buf_error
+
+PURPOSE:  Flags the XML buffer as failed.  Only the first failure is reported.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+******************************************************************************/
+static void ard_xml_buf_error
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer which failed */
+    char *func_name,      /* I: name of the function which failed */
+    char *errmsg          /* I: error message */
+)
+{
+    if (xbuf->status == SUCCESS)
+        ard_error_handler (true, func_name, errmsg);
+    xbuf->status = ERROR;
+}
+
+
+/******************************************************************************
+MODULE:  init_ard_xml_buf
+
+PURPOSE:  Initializes an XML buffer which is allocated and grows as needed.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error allocating the buffer
+SUCCESS         Successfully initialized the buffer
+
+NOTES:
+  1. free_ard_xml_buf needs to be called to free the buffer.
+******************************************************************************/
+int init_ard_xml_buf
+(
+    Ard_xml_buf_t *xbuf,  /* O: XML buffer to be initialized */
+    size_t size           /* I: initial size of the buffer (bytes); 0 for the
+                                default ARD_XML_BUF_SIZE */
+)
+{
+    char FUNC_NAME[] = "init_ard_xml_buf";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+
+    xbuf->size = (size > 0) ? size : ARD_XML_BUF_SIZE;
+    xbuf->len = 0;
+    xbuf->allocated = true;
+    xbuf->fptr = NULL;
+    xbuf->status = SUCCESS;
+    xbuf->buf = malloc (xbuf->size);
+    if (xbuf->buf == NULL)
+    {
+        xbuf->size = 0;
+        sprintf (errmsg, "Allocating the XML buffer");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  init_ard_xml_buf_fixed
+
+PURPOSE:  Initializes an XML buffer which uses caller supplied memory.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+  1. The buffer never grows.  If fptr is NULL, appending more than size bytes
+     is an error.  Otherwise the buffer is written to fptr each time it
+     fills, and flush_ard_xml_buf needs to be called to write out the rest.
+******************************************************************************/
+void init_ard_xml_buf_fixed
+(
+    Ard_xml_buf_t *xbuf,  /* O: XML buffer to be initialized */
+    char *mem,            /* I: caller memory to use for the buffer */
+    size_t size,          /* I: size of the caller memory (bytes) */
+    FILE *fptr            /* I: file to flush the buffer to when it fills;
+                                NULL if the output must fit in the buffer */
+)
+{
+    xbuf->buf = mem;
+    xbuf->size = size;
+    xbuf->len = 0;
+    xbuf->allocated = false;
+    xbuf->fptr = fptr;
+    xbuf->status = SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE:  reset_ard_xml_buf
+
+PURPOSE:  Empties the XML buffer and clears its status so it can be reused.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+******************************************************************************/
+void reset_ard_xml_buf
+(
+    Ard_xml_buf_t *xbuf   /* I/O: XML buffer to be emptied */
+)
+{
+    xbuf->len = 0;
+    xbuf->status = SUCCESS;
+}
+
+
+/******************************************************************************
+MODULE:  free_ard_xml_buf
+
+PURPOSE:  Frees the XML buffer if it was allocated.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+  1. Caller supplied memory is left alone.
+******************************************************************************/
+void free_ard_xml_buf
+(
+    Ard_xml_buf_t *xbuf   /* I/O: XML buffer to be freed */
+)
+{
+    if (xbuf->allocated)
+        free (xbuf->buf);
+    xbuf->buf = NULL;
+    xbuf->len = 0;
+    xbuf->size = 0;
+}
+
+
+/******************************************************************************
+MODULE:  flush_ard_xml_buf
+
+PURPOSE:  Writes the contents of the XML buffer to its file and empties the
+buffer.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error writing to the file, or an earlier append failed
+SUCCESS         Successfully flushed the buffer
+
+NOTES:
+  1. Nothing is written if the buffer doesn't have a file.
+******************************************************************************/
+int flush_ard_xml_buf
+(
+    Ard_xml_buf_t *xbuf   /* I/O: XML buffer to be flushed to its file */
+)
+{
+    char FUNC_NAME[] = "flush_ard_xml_buf";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+
+    if (xbuf->status != SUCCESS || xbuf->fptr == NULL || xbuf->len == 0)
+        return (xbuf->status);
+
+    if (fwrite (xbuf->buf, 1, xbuf->len, xbuf->fptr) != xbuf->len)
+    {
+        sprintf (errmsg, "Writing the XML buffer to the file");
+        ard_xml_buf_error (xbuf, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+    xbuf->len = 0;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  ard_xml_reserve
+
+PURPOSE:  Makes room for n more bytes in the XML buffer, flushing or growing
+the buffer as needed.
+
+RETURN VALUE:
+Type = char *
+Value           Description
+-----           -----------
+NULL            The buffer has failed or there isn't room for n bytes
+non-NULL        Pointer to the next free byte in the buffer
+
+NOTES:
+******************************************************************************/
+static char *ard_xml_reserve
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer */
+    size_t n              /* I: number of bytes needed */
+)
+{
+    char FUNC_NAME[] = "ard_xml_reserve";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    size_t newsize;          /* new size of the buffer */
+    char *newbuf = NULL;     /* reallocated buffer */
+
+    if (xbuf->status != SUCCESS)
+        return (NULL);
+    if (xbuf->size - xbuf->len >= n)
+        return (xbuf->buf + xbuf->len);
+
+    /* Write out what is in the buffer if it has a file */
+    if (xbuf->fptr != NULL)
+    {
+        if (flush_ard_xml_buf (xbuf) != SUCCESS)
+            return (NULL);
+        if (xbuf->size >= n)
+            return (xbuf->buf);
+    }
+
+    if (!xbuf->allocated)
+    {
+        sprintf (errmsg, "XML buffer of %ld bytes is too small",
+            (long) xbuf->size);
+        ard_xml_buf_error (xbuf, FUNC_NAME, errmsg);
+        return (NULL);
+    }
+
+    /* Double the size of the buffer until there is room */
+    newsize = (xbuf->size > 0) ? xbuf->size : ARD_XML_BUF_SIZE;
+    while (newsize - xbuf->len < n)
+        newsize *= 2;
+    newbuf = realloc (xbuf->buf, newsize);
+    if (newbuf == NULL)
+    {
+        sprintf (errmsg, "Growing the XML buffer to %ld bytes",
+            (long) newsize);
+        ard_xml_buf_error (xbuf, FUNC_NAME, errmsg);
+        return (NULL);
+    }
+    xbuf->buf = newbuf;
+    xbuf->size = newsize;
+
+    return (xbuf->buf + xbuf->len);
+}
+
+
+/******************************************************************************
+MODULE:  ard_xml_putn
+
+PURPOSE:  Appends n characters to the XML buffer.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+******************************************************************************/
+void ard_xml_putn
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    const char *str,      /* I: characters to append */
+    size_t n              /* I: number of characters to append */
+)
+{
+    char FUNC_NAME[] = "ard_xml_putn";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    char *ptr = NULL;        /* position in the buffer */
+
+    /* Strings larger than a fixed buffer go straight to the file */
+    if (!xbuf->allocated && xbuf->fptr != NULL && n > xbuf->size)
+    {
+        if (flush_ard_xml_buf (xbuf) != SUCCESS)
+            return;
+        if (fwrite (str, 1, n, xbuf->fptr) != n)
+        {
+            sprintf (errmsg, "Writing to the file");
+            ard_xml_buf_error (xbuf, FUNC_NAME, errmsg);
+        }
+        return;
+    }
+
+    ptr = ard_xml_reserve (xbuf, n);
+    if (ptr == NULL)
+        return;
+    memcpy (ptr, str, n);
+    xbuf->len += n;
+}
+
+
+/******************************************************************************
+MODULE:  ard_xml_puts
+
+PURPOSE:  Appends a string to the XML buffer.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+******************************************************************************/
+void ard_xml_puts
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    const char *str       /* I: string to append */
+)
+{
+    ard_xml_putn (xbuf, str, strlen (str));
+}
+
+
+/******************************************************************************
+MODULE:  ard_xml_put_int
+
+PURPOSE:  Appends an integer to the XML buffer.  The output matches printf
+%d/%ld, or %0<width>d for a non-zero width.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+******************************************************************************/
+void ard_xml_put_int
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    long value,           /* I: value to append */
+    int width             /* I: minimum number of digits, zero-padded */
+)
+{
+    char digits[64];         /* digits of the value, filled from the end */
+    char *ptr = digits + sizeof (digits);  /* first digit */
+    unsigned long mag;       /* magnitude of the value */
+    bool negative = (value < 0);  /* is the value negative? */
+
+    mag = negative ? 0UL - (unsigned long) value : (unsigned long) value;
+    do
+    {
+        *--ptr = '0' + (mag % 10);
+        mag /= 10;
+    } while (mag > 0);
+
+    /* The sign counts toward the width, as with printf */
+    if (width > (int) sizeof (digits) - 1)
+        width = sizeof (digits) - 1;
+    while (digits + sizeof (digits) - ptr < width - (negative ? 1 : 0))
+        *--ptr = '0';
+    if (negative)
+        *--ptr = '-';
+
+    ard_xml_putn (xbuf, ptr, digits + sizeof (digits) - ptr);
+}
+
+
+/******************************************************************************
+MODULE:  ard_xml_vformat
+
+PURPOSE:  Appends printf-formatted output to the XML buffer using vsnprintf.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+******************************************************************************/
+static void ard_xml_vformat
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    const char *format,   /* I: printf-style format */
+    va_list ap            /* I: values for the format */
+)
+{
+    char FUNC_NAME[] = "ard_xml_vformat";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    char tmp[STR_SIZE];      /* output which fits without reserving */
+    int count;               /* number of characters formatted */
+    char *ptr = NULL;        /* position in the buffer */
+    va_list ap2;             /* copy of the values for a second pass */
+
+    va_copy (ap2, ap);
+    count = vsnprintf (tmp, sizeof (tmp), format, ap);
+    if (count < 0)
+    {
+        sprintf (errmsg, "Formatting the XML output");
+        ard_xml_buf_error (xbuf, FUNC_NAME, errmsg);
+    }
+    else if (count < sizeof (tmp))
+        ard_xml_putn (xbuf, tmp, count);
+    else
+    {
+        /* Format straight into the buffer, which includes the terminator */
+        ptr = ard_xml_reserve (xbuf, count + 1);
+        if (ptr != NULL)
+        {
+            vsnprintf (ptr, count + 1, format, ap2);
+            xbuf->len += count;
+        }
+    }
+    va_end (ap2);
+}
+
+
+/******************************************************************************
+MODULE:  ard_xml_format
+
+PURPOSE:  Appends printf-formatted output to the XML buffer using vsnprintf.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+******************************************************************************/
+static void ard_xml_format
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    const char *format,   /* I: printf-style format */
+    ...                   /* I: values for the format */
+)
+{
+    va_list ap;              /* values for the format */
+
+    va_start (ap, format);
+    ard_xml_vformat (xbuf, format, ap);
+    va_end (ap);
+}
+
+
+/******************************************************************************
+MODULE:  ard_xml_put_double
+
+PURPOSE:  Appends a double to the XML buffer.  The output matches printf %f.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+  1. The value is scaled by 1e6 and rounded to an integer, whose digits are
+     then written out.  Scaling rounds at most once, so the rounded integer is
+     the same as printf's (exact) rounding unless the scaled value is within
+     rounding error of a half.  Those values, and values too large for the
+     integer, are formatted by snprintf.
+******************************************************************************/
+void ard_xml_put_double
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    double value          /* I: value to append */
+)
+{
+    char digits[64];         /* formatted value, filled from the end */
+    char *ptr = digits + sizeof (digits);  /* first character */
+    double scaled;           /* absolute value scaled by 1e6 */
+    double whole;            /* scaled value rounded down */
+    double frac;             /* fractional part of the scaled value */
+    unsigned long long n;    /* scaled value rounded to an integer */
+    int i;                   /* looping variable */
+
+    scaled = fabs (value) * 1e6;
+    if (!isfinite (value) || scaled >= ARD_XML_MAX_FAST_DOUBLE)
+    {
+        ard_xml_format (xbuf, "%f", value);
+        return;
+    }
+    whole = floor (scaled);
+    frac = scaled - whole;
+    if (fabs (frac - 0.5) <= (scaled + 1.0) * 2.0 * DBL_EPSILON)
+    {
+        ard_xml_format (xbuf, "%f", value);
+        return;
+    }
+    n = (unsigned long long) whole + (frac > 0.5 ? 1 : 0);
+
+    /* Six decimal places, then the integer part */
+    for (i = 0; i < 6; i++)
+    {
+        *--ptr = '0' + (n % 10);
+        n /= 10;
+    }
+    *--ptr = '.';
+    do
+    {
+        *--ptr = '0' + (n % 10);
+        n /= 10;
+    } while (n > 0);
+
+    /* printf keeps the sign of negative values which round to zero */
+    if (signbit (value))
+        *--ptr = '-';
+
+    ard_xml_putn (xbuf, ptr, digits + sizeof (digits) - ptr);
+}
+
+
+/******************************************************************************
+MODULE:  ard_xml_printf
+
+PURPOSE:  Appends printf-formatted output to the XML buffer.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+  1. The conversions used for the XML metadata (%s, %d, %ld, %0<width>d,
+     %f, and %lf without any other flags, width, or precision) are formatted
+     directly.  Any other conversion is formatted by snprintf.
+  2. A * width or precision isn't supported.
+******************************************************************************/
+void ard_xml_printf
+(
+    Ard_xml_buf_t *xbuf,  /* I/O: XML buffer to append to */
+    const char *format,   /* I: printf-style format */
+    ...                   /* I: values for the format */
+)
+{
+    char FUNC_NAME[] = "ard_xml_printf";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    char spec[32];           /* single conversion specification */
+    const char *start = NULL;  /* start of the current text or conversion */
+    const char *ptr = format;  /* current position in the format */
+    const char *str = NULL;  /* string value */
+    bool zero_pad;           /* was the 0 flag specified? */
+    bool other_flags;        /* were flags other than 0 specified? */
+    bool precision;          /* was a precision specified? */
+    int width;               /* field width */
+    int nlong;               /* number of l length modifiers */
+    bool other_length;       /* was a length modifier other than l given? */
+    va_list ap;              /* values for the format */
+
+    va_start (ap, format);
+    while (*ptr != '\0' && xbuf->status == SUCCESS)
+    {
+        /* Copy the text up to the next conversion */
+        if (*ptr != '%')
+        {
+            start = ptr;
+            while (*ptr != '\0' && *ptr != '%')
+                ptr++;
+            ard_xml_putn (xbuf, start, ptr - start);
+            continue;
+        }
+
+        /* Parse the conversion specification */
+        start = ptr++;
+        zero_pad = false;
+        other_flags = false;
+        precision = false;
+        width = 0;
+        nlong = 0;
+        other_length = false;
+        while (strchr ("-+ #0", *ptr) != NULL && *ptr != '\0')
+        {
+            if (*ptr == '0')
+                zero_pad = true;
+            else
+                other_flags = true;
+            ptr++;
+        }
+        while (*ptr >= '0' && *ptr <= '9')
+            width = width * 10 + (*ptr++ - '0');
+        if (*ptr == '.')
+        {
+            precision = true;
+            ptr++;
+            while (*ptr >= '0' && *ptr <= '9')
+                ptr++;
+        }
+        while (strchr ("hlLqjzt", *ptr) != NULL && *ptr != '\0')
+        {
+            if (*ptr == 'l')
+                nlong++;
+            else
+                other_length = true;
+            ptr++;
+        }
+        if (*ptr == '\0' || *ptr == '*' || ptr - start + 2 > sizeof (spec))
+        {
+            sprintf (errmsg, "Unsupported XML output format: %s", format);
+            ard_xml_buf_error (xbuf, FUNC_NAME, errmsg);
+            break;
+        }
+
+        /* Directly format the conversions used for the XML metadata */
+        if (*ptr == '%')
+            ard_xml_putn (xbuf, "%", 1);
+        else if (*ptr == 's' && !other_flags && !zero_pad && width == 0 &&
+            !precision && nlong == 0 && !other_length)
+        {
+            str = va_arg (ap, const char *);
+            ard_xml_puts (xbuf, (str != NULL) ? str : "(null)");
+        }
+        else if ((*ptr == 'd' || *ptr == 'i') && !other_flags &&
+            (zero_pad || width == 0) && !precision && nlong <= 1 &&
+            !other_length)
+        {
+            if (nlong == 1)
+                ard_xml_put_int (xbuf, va_arg (ap, long), width);
+            else
+                ard_xml_put_int (xbuf, va_arg (ap, int), width);
+        }
+        else if (*ptr == 'f' && !other_flags && !zero_pad && width == 0 &&
+            !precision && !other_length)
+            ard_xml_put_double (xbuf, va_arg (ap, double));
+        else
+        {
+            /* Everything else is formatted by snprintf */
+            memcpy (spec, start, ptr - start + 1);
+            spec[ptr - start + 1] = '\0';
+            switch (*ptr)
+            {
+                case 'd': case 'i': case 'c':
+                    if (nlong >= 2)
+                        ard_xml_format (xbuf, spec, va_arg (ap, long long));
+                    else if (nlong == 1)
+                        ard_xml_format (xbuf, spec, va_arg (ap, long));
+                    else
+                        ard_xml_format (xbuf, spec, va_arg (ap, int));
+                    break;
+                case 'u': case 'o': case 'x': case 'X':
+                    if (nlong >= 2)
+                        ard_xml_format (xbuf, spec,
+                            va_arg (ap, unsigned long long));
+                    else if (nlong == 1)
+                        ard_xml_format (xbuf, spec,
+                            va_arg (ap, unsigned long));
+                    else
+                        ard_xml_format (xbuf, spec,
+                            va_arg (ap, unsigned int));
+                    break;
+                case 'e': case 'E': case 'f': case 'F':
+                case 'g': case 'G': case 'a': case 'A':
+                    ard_xml_format (xbuf, spec, va_arg (ap, double));
+                    break;
+                case 's':
+                    ard_xml_format (xbuf, spec, va_arg (ap, const char *));
+                    break;
+                case 'p':
+                    ard_xml_format (xbuf, spec, va_arg (ap, void *));
+                    break;
+                default:
+                    sprintf (errmsg, "Unsupported XML output format: %s",
+                        format);
+                    ard_xml_buf_error (xbuf, FUNC_NAME, errmsg);
+                    break;
+            }
+        }
+        ptr++;
+    }
+    va_end (ap);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_xml_buf_fd
+
+PURPOSE:  Writes the contents of the XML buffer to an open file descriptor.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error writing the buffer, or an earlier append failed
+SUCCESS         Successfully wrote the buffer
+
+NOTES:
+  1. The buffer is written with a single write call, unless the write is
+     interrupted or only partially completed.
+******************************************************************************/
+int write_ard_xml_buf_fd
+(
+    Ard_xml_buf_t *xbuf,  /* I: XML buffer to be written */
+    int fd                /* I: open file descriptor to write to */
+)
+{
+    char FUNC_NAME[] = "write_ard_xml_buf_fd";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    size_t nwritten = 0;     /* number of bytes written so far */
+    ssize_t count;           /* number of bytes written by this write */
+
+    if (xbuf->status != SUCCESS)
+    {
+        sprintf (errmsg, "Unable to write the XML buffer since it is "
+            "incomplete");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    while (nwritten < xbuf->len)
+    {
+        count = write (fd, xbuf->buf + nwritten, xbuf->len - nwritten);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            sprintf (errmsg, "Writing the XML buffer: %s", strerror (errno));
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+        nwritten += count;
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_xml_buf_file
+
+PURPOSE:  Writes the contents of the XML buffer to the specified file.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error writing the file, or an earlier append failed
+SUCCESS         Successfully wrote the file
+
+NOTES:
+  1. If the file already exists, it will be overwritten.
+******************************************************************************/
+int write_ard_xml_buf_file
+(
+    Ard_xml_buf_t *xbuf,  /* I: XML buffer to be written */
+    char *xml_file        /* I: name of the file to be written or
+                                overwritten */
+)
+{
+    char FUNC_NAME[] = "write_ard_xml_buf_file";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    int fd;                  /* file descriptor for the file */
+
+    fd = open (xml_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        sprintf (errmsg, "Opening %s for write access.", xml_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    if (write_ard_xml_buf_fd (xbuf, fd) != SUCCESS)
+    {
+        close (fd);
+        sprintf (errmsg, "Writing %s", xml_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    if (close (fd) != 0)
+    {
+        sprintf (errmsg, "Closing %s", xml_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    return (SUCCESS);
+}
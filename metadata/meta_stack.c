@@ -202,3 +202,98 @@ char *pop
     }
 }
 
+
+
+/******************************************************************************
+MODULE:  init_meta_stack
+
+PURPOSE:  Initializes the stack of element names such that it is empty.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+  1. No memory is allocated for the stack, so there is nothing to free.
+******************************************************************************/
+void init_meta_stack
+(
+    Ard_meta_stack_t *stack   /* O: stack to be initialized */
+)
+{
+    stack->top = -1;
+}
+
+
+/******************************************************************************
+MODULE:  push_meta_stack
+
+PURPOSE:  Push an element name on the stack.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Stack is already full
+SUCCESS         Successfully added the item to the stack
+
+NOTES:
+  1. Only the pointer is stored, so the element name needs to remain valid
+     until it is popped from the stack.
+******************************************************************************/
+int push_meta_stack
+(
+    Ard_meta_stack_t *stack,  /* I/O: stack to push item to */
+    const char *strval        /* I: element name to push on stack */
+)
+{
+    char FUNC_NAME[] = "push_meta_stack";   /* function name */
+    char errmsg[STR_SIZE];       /* error message */
+
+    /* If the stack isn't full, then add the item to the stack */
+    if (stack->top == MAX_ARD_STACK_SIZE - 1)
+    {
+        snprintf (errmsg, sizeof (errmsg), "Stack is full. Can't add any "
+            "additional items to the stack. Failed to push %s.", strval);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    stack->elements[++stack->top] = strval;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  pop_meta_stack
+
+PURPOSE:  Pop an element name from the stack.
+
+RETURN VALUE:
+Type = const char *
+Value           Description
+-----           -----------
+NULL            Stack is empty
+non-NULL        Element name popped from the stack
+
+NOTES:
+******************************************************************************/
+const char *pop_meta_stack
+(
+    Ard_meta_stack_t *stack   /* I/O: stack to pop item from */
+)
+{
+    char FUNC_NAME[] = "pop_meta_stack";    /* function name */
+    char errmsg[STR_SIZE];       /* error message */
+
+    /* If the stack is empty, then return an error.  Otherwise pop the next
+       item from the stack. */
+    if (stack->top == -1)
+    {
+        sprintf (errmsg, "No more elements on the stack to pop.");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return NULL;
+    }
+
+    return (stack->elements[stack->top--]);
+}
@@ -19,6 +19,244 @@ NOTES:
 #include "ard_metadata.h"
 #include "parse_ard_metadata.h"
 
+/* Element, attribute, and attribute value names recognized by the global and
+   band metadata parsers */
+enum Ard_xml_name
+{
+    ARD_XML_UNKNOWN = 0,
+    /* global metadata elements and attributes */
+    ARD_XML_DATA_PROVIDER,
+    ARD_XML_SATELLITE,
+    ARD_XML_INSTRUMENT,
+    ARD_XML_ACQUISITION_DATE,
+    ARD_XML_SCENE_CENTER_TIME,
+    ARD_XML_LEVEL1_PRODUCTION_DATE,
+    ARD_XML_WRS,
+    ARD_XML_REQUEST_ID,
+    ARD_XML_SCENE_ID,
+    ARD_XML_PRODUCT_ID,
+    ARD_XML_ELEVATION_SOURCE,
+    ARD_XML_SENSOR_MODE,
+    ARD_XML_EPHEMERIS_TYPE,
+    ARD_XML_CPF_NAME,
+    ARD_XML_LPGS_METADATA_FILE,
+    ARD_XML_GEOMETRIC_RMSE_MODEL,
+    ARD_XML_GEOMETRIC_RMSE_MODEL_X,
+    ARD_XML_GEOMETRIC_RMSE_MODEL_Y,
+    ARD_XML_SYSTEM,
+    ARD_XML_PATH,
+    ARD_XML_ROW,
+    ARD_XML_LEVEL1_COLLECTION,
+    ARD_XML_ARD_VERSION,
+    ARD_XML_REGION,
+    ARD_XML_DATE_RANGE,
+    ARD_XML_DESCRIPTION,
+    ARD_XML_PRODUCTION_DATE,
+    ARD_XML_BOUNDING_COORDINATES,
+    ARD_XML_PROJECTION_INFORMATION,
+    ARD_XML_ORIENTATION_ANGLE,
+    ARD_XML_TILE_GRID,
+    ARD_XML_SCENE_COUNT,
+    ARD_XML_CLOUD_COVER,
+    ARD_XML_CLOUD_SHADOW,
+    ARD_XML_SNOW_ICE,
+    ARD_XML_FILL,
+    ARD_XML_START,
+    ARD_XML_END,
+    ARD_XML_H,
+    ARD_XML_V,
+    /* band metadata elements and attributes */
+    ARD_XML_PRODUCT,
+    ARD_XML_SOURCE,
+    ARD_XML_NAME,
+    ARD_XML_CATEGORY,
+    ARD_XML_DATA_TYPE,
+    ARD_XML_NLINES,
+    ARD_XML_NSAMPS,
+    ARD_XML_FILL_VALUE,
+    ARD_XML_SATURATE_VALUE,
+    ARD_XML_SCALE_FACTOR,
+    ARD_XML_ADD_OFFSET,
+    ARD_XML_SHORT_NAME,
+    ARD_XML_LONG_NAME,
+    ARD_XML_FILE_NAME,
+    ARD_XML_PIXEL_SIZE,
+    ARD_XML_RESAMPLE_METHOD,
+    ARD_XML_DATA_UNITS,
+    ARD_XML_VALID_RANGE,
+    ARD_XML_APP_VERSION,
+    ARD_XML_BITMAP_DESCRIPTION,
+    ARD_XML_CLASS_VALUES,
+    ARD_XML_X,
+    ARD_XML_Y,
+    ARD_XML_UNITS,
+    ARD_XML_MIN,
+    ARD_XML_MAX,
+    /* data_type attribute values */
+    ARD_XML_INT8,
+    ARD_XML_UINT8,
+    ARD_XML_INT16,
+    ARD_XML_UINT16,
+    ARD_XML_INT32,
+    ARD_XML_UINT32,
+    ARD_XML_FLOAT32,
+    ARD_XML_FLOAT64
+};
+
+/* Size of the name lookup table; must be a power of two */
+#define ARD_XML_HASH_SIZE 256
+
+/* Perfect hash table of the recognized names.  The slot for each name is
+   computed by ard_xml_hash.  The hash multipliers were chosen (by search over
+   the name list) so that no two names share a slot, which means a lookup is
+   one hash and at most one string compare.  When adding a name, add it to
+   the enum, pick its slot via ard_xml_hash, and verify the slot is free;
+   otherwise new multipliers need to be found for the whole list. */
+static const struct
+{
+    const char *name;          /* element, attribute, or value name */
+    enum Ard_xml_name id;      /* ID of the name */
+} ard_xml_names[ARD_XML_HASH_SIZE] =
+{
+    [1] = {"satellite", ARD_XML_SATELLITE},
+    [6] = {"saturate_value", ARD_XML_SATURATE_VALUE},
+    [7] = {"cpf_name", ARD_XML_CPF_NAME},
+    [8] = {"pixel_size", ARD_XML_PIXEL_SIZE},
+    [9] = {"cloud_shadow", ARD_XML_CLOUD_SHADOW},
+    [11] = {"FLOAT64", ARD_XML_FLOAT64},
+    [16] = {"min", ARD_XML_MIN},
+    [21] = {"snow_ice", ARD_XML_SNOW_ICE},
+    [24] = {"level1_production_date", ARD_XML_LEVEL1_PRODUCTION_DATE},
+    [30] = {"system", ARD_XML_SYSTEM},
+    [33] = {"short_name", ARD_XML_SHORT_NAME},
+    [34] = {"max", ARD_XML_MAX},
+    [43] = {"file_name", ARD_XML_FILE_NAME},
+    [44] = {"fill_value", ARD_XML_FILL_VALUE},
+    [45] = {"bitmap_description", ARD_XML_BITMAP_DESCRIPTION},
+    [47] = {"app_version", ARD_XML_APP_VERSION},
+    [48] = {"data_provider", ARD_XML_DATA_PROVIDER},
+    [54] = {"data_units", ARD_XML_DATA_UNITS},
+    [57] = {"ephemeris_type", ARD_XML_EPHEMERIS_TYPE},
+    [60] = {"source", ARD_XML_SOURCE},
+    [69] = {"valid_range", ARD_XML_VALID_RANGE},
+    [73] = {"scene_id", ARD_XML_SCENE_ID},
+    [75] = {"v", ARD_XML_V},
+    [82] = {"bounding_coordinates", ARD_XML_BOUNDING_COORDINATES},
+    [84] = {"category", ARD_XML_CATEGORY},
+    [85] = {"geometric_rmse_model_x", ARD_XML_GEOMETRIC_RMSE_MODEL_X},
+    [86] = {"tile_grid", ARD_XML_TILE_GRID},
+    [91] = {"scene_center_time", ARD_XML_SCENE_CENTER_TIME},
+    [94] = {"geometric_rmse_model_y", ARD_XML_GEOMETRIC_RMSE_MODEL_Y},
+    [100] = {"level1_collection", ARD_XML_LEVEL1_COLLECTION},
+    [101] = {"fill", ARD_XML_FILL},
+    [106] = {"orientation_angle", ARD_XML_ORIENTATION_ANGLE},
+    [112] = {"product_id", ARD_XML_PRODUCT_ID},
+    [120] = {"add_offset", ARD_XML_ADD_OFFSET},
+    [126] = {"production_date", ARD_XML_PRODUCTION_DATE},
+    [129] = {"ard_version", ARD_XML_ARD_VERSION},
+    [135] = {"request_id", ARD_XML_REQUEST_ID},
+    [137] = {"x", ARD_XML_X},
+    [138] = {"wrs", ARD_XML_WRS},
+    [139] = {"INT32", ARD_XML_INT32},
+    [140] = {"resample_method", ARD_XML_RESAMPLE_METHOD},
+    [142] = {"name", ARD_XML_NAME},
+    [143] = {"start", ARD_XML_START},
+    [151] = {"elevation_source", ARD_XML_ELEVATION_SOURCE},
+    [153] = {"h", ARD_XML_H},
+    [165] = {"long_name", ARD_XML_LONG_NAME},
+    [167] = {"sensor_mode", ARD_XML_SENSOR_MODE},
+    [168] = {"y", ARD_XML_Y},
+    [174] = {"description", ARD_XML_DESCRIPTION},
+    [175] = {"INT16", ARD_XML_INT16},
+    [183] = {"data_type", ARD_XML_DATA_TYPE},
+    [184] = {"date_range", ARD_XML_DATE_RANGE},
+    [188] = {"units", ARD_XML_UNITS},
+    [192] = {"INT8", ARD_XML_INT8},
+    [194] = {"instrument", ARD_XML_INSTRUMENT},
+    [197] = {"row", ARD_XML_ROW},
+    [199] = {"UINT32", ARD_XML_UINT32},
+    [203] = {"scale_factor", ARD_XML_SCALE_FACTOR},
+    [206] = {"acquisition_date", ARD_XML_ACQUISITION_DATE},
+    [209] = {"nlines", ARD_XML_NLINES},
+    [211] = {"end", ARD_XML_END},
+    [213] = {"path", ARD_XML_PATH},
+    [214] = {"projection_information", ARD_XML_PROJECTION_INFORMATION},
+    [215] = {"lpgs_metadata_file", ARD_XML_LPGS_METADATA_FILE},
+    [219] = {"cloud_cover", ARD_XML_CLOUD_COVER},
+    [220] = {"scene_count", ARD_XML_SCENE_COUNT},
+    [221] = {"region", ARD_XML_REGION},
+    [229] = {"class_values", ARD_XML_CLASS_VALUES},
+    [231] = {"geometric_rmse_model", ARD_XML_GEOMETRIC_RMSE_MODEL},
+    [235] = {"UINT16", ARD_XML_UINT16},
+    [240] = {"nsamps", ARD_XML_NSAMPS},
+    [249] = {"FLOAT32", ARD_XML_FLOAT32},
+    [252] = {"UINT8", ARD_XML_UINT8},
+    [253] = {"product", ARD_XML_PRODUCT}
+};
+
+
+/******************************************************************************
+MODULE:  ard_xml_hash
+
+PURPOSE: Computes the slot in the name lookup table for the specified name.
+
+RETURN VALUE:
+Type = unsigned int
+Value           Description
+-----           -----------
+0 - ARD_XML_HASH_SIZE-1  Slot in the ard_xml_names table
+
+NOTES:
+  1. The name must be at least one character long.
+******************************************************************************/
+static unsigned int ard_xml_hash
+(
+    const unsigned char *name,  /* I: name to be hashed */
+    size_t len                  /* I: length of the name */
+)
+{
+    return ((len + name[0] * 22 + name[1] * 41 + name[len-1] * 9) &
+        (ARD_XML_HASH_SIZE - 1));
+}
+
+
+/******************************************************************************
+MODULE:  ard_xml_name
+
+PURPOSE: Looks up the ID of an element, attribute, or attribute value name so
+the parsers can dispatch on an integer rather than comparing the name against
+each of the names they handle.
+
+RETURN VALUE:
+Type = enum Ard_xml_name
+Value           Description
+-----           -----------
+ARD_XML_UNKNOWN Name is not one of the recognized names
+ARD_XML_*       ID of the recognized name
+
+NOTES:
+******************************************************************************/
+static enum Ard_xml_name ard_xml_name
+(
+    const xmlChar *name         /* I: element, attribute, or value name */
+)
+{
+    size_t len;                 /* length of the name */
+    unsigned int slot;          /* slot in the lookup table */
+
+    if (name == NULL || name[0] == '\0')
+        return (ARD_XML_UNKNOWN);
+
+    len = strlen ((const char *) name);
+    slot = ard_xml_hash (name, len);
+    if (ard_xml_names[slot].name != NULL &&
+        !strcmp ((const char *) name, ard_xml_names[slot].name))
+        return (ard_xml_names[slot].id);
+
+    return (ARD_XML_UNKNOWN);
+}
+
+
 /******************************************************************************
 MODULE:  add_global_ard_metadata_proj_info_albers
 
@@ -557,12 +795,12 @@ int add_global_ard_metadata_proj_info
 
     /* Set up the current and child pointers */
     cur_node = a_node;
-    ns = cur_node->nsDef;
+    ns = (cur_node->ns != NULL) ? cur_node->ns : cur_node->nsDef;
     child_node = cur_node->children;
 
     /* Verify the namespace of this node is our ARD namespace.  If it isn't
        then the element won't be added to the metadata structure. */
-    if (!xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
+    if (ns == NULL || !xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
     {
         sprintf (errmsg, "Skipping %s since it is not in the ARD namespace",
             cur_node->name);
@@ -790,12 +1028,12 @@ int add_global_ard_metadata_bounding_coords
 
     /* Set up the current and child pointers */
     cur_node = a_node;
-    ns = cur_node->nsDef;
+    ns = (cur_node->ns != NULL) ? cur_node->ns : cur_node->nsDef;
     child_node = cur_node->children;
 
     /* Verify the namespace of this node is our ARD namespace.  If it isn't
        then the element won't be added to the metadata structure. */
-    if (!xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
+    if (ns == NULL || !xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
     {
         sprintf (errmsg, "Skipping %s since it is not in the ARD namespace",
             cur_node->name);
@@ -866,15 +1104,17 @@ int add_global_scene_metadata
     xmlNsPtr ns = NULL;           /* pointer to the namespace */
     xmlChar *attr_val = NULL;     /* attribute value */
     int count;                    /* number of chars copied in snprintf */
+    enum Ard_xml_name elem_id;    /* ID of the element name */
+    enum Ard_xml_name attr_id;    /* ID of the attribute name */
 
     /* Set up the current and child pointers */
     cur_node = a_node;
-    ns = cur_node->nsDef;
+    ns = (cur_node->ns != NULL) ? cur_node->ns : cur_node->nsDef;
     child_node = cur_node->children;
 
     /* Verify the namespace of this node is our ARD namespace.  If it isn't
        then the element won't be added to the metadata structure. */
-    if (!xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
+    if (ns == NULL || !xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
     {
         sprintf (errmsg, "Skipping %s since it is not in the ARD namespace",
             cur_node->name);
@@ -883,7 +1123,8 @@ int add_global_scene_metadata
     }
 
     /* Look for the scene-based global metadata elements and process them */
-    if (xmlStrEqual (cur_node->name, (const xmlChar *) "data_provider"))
+    elem_id = ard_xml_name (cur_node->name);
+    if (elem_id == ARD_XML_DATA_PROVIDER)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -905,7 +1146,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "satellite"))
+    else if (elem_id == ARD_XML_SATELLITE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -927,7 +1168,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "instrument"))
+    else if (elem_id == ARD_XML_INSTRUMENT)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -949,7 +1190,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "acquisition_date"))
+    else if (elem_id == ARD_XML_ACQUISITION_DATE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -972,8 +1213,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "scene_center_time"))
+    else if (elem_id == ARD_XML_SCENE_CENTER_TIME)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -996,8 +1236,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "level1_production_date"))
+    else if (elem_id == ARD_XML_LEVEL1_PRODUCTION_DATE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1020,17 +1259,18 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "wrs"))
+    else if (elem_id == ARD_XML_WRS)
     {
         /* Handle the element attributes */
         for (attr = cur_node->properties; attr != NULL; attr = attr->next)
         {
             attr_val = xmlGetProp (cur_node, attr->name);
-            if (xmlStrEqual (attr->name, (const xmlChar *) "system"))
+            attr_id = ard_xml_name (attr->name);
+            if (attr_id == ARD_XML_SYSTEM)
                 gmeta->wrs_system = atoi ((const char *) attr_val);
-            else if (xmlStrEqual (attr->name, (const xmlChar *) "path"))
+            else if (attr_id == ARD_XML_PATH)
                 gmeta->wrs_path = atoi ((const char *) attr_val);
-            else if (xmlStrEqual (attr->name, (const xmlChar *) "row"))
+            else if (attr_id == ARD_XML_ROW)
                 gmeta->wrs_row = atoi ((const char *) attr_val);
             else
             {
@@ -1041,7 +1281,7 @@ int add_global_scene_metadata
             xmlFree (attr_val);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "request_id"))
+    else if (elem_id == ARD_XML_REQUEST_ID)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1063,7 +1303,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "scene_id"))
+    else if (elem_id == ARD_XML_SCENE_ID)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1085,7 +1325,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "product_id"))
+    else if (elem_id == ARD_XML_PRODUCT_ID)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1107,7 +1347,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "elevation_source"))
+    else if (elem_id == ARD_XML_ELEVATION_SOURCE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1137,7 +1377,7 @@ int add_global_scene_metadata
             ard_error_handler (false, FUNC_NAME, errmsg);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "sensor_mode"))
+    else if (elem_id == ARD_XML_SENSOR_MODE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1161,7 +1401,7 @@ int add_global_scene_metadata
             ard_error_handler (false, FUNC_NAME, errmsg);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "ephemeris_type"))
+    else if (elem_id == ARD_XML_EPHEMERIS_TYPE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1186,7 +1426,7 @@ int add_global_scene_metadata
             ard_error_handler (false, FUNC_NAME, errmsg);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "cpf_name"))
+    else if (elem_id == ARD_XML_CPF_NAME)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1208,8 +1448,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "lpgs_metadata_file"))
+    else if (elem_id == ARD_XML_LPGS_METADATA_FILE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1232,8 +1471,7 @@ int add_global_scene_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "geometric_rmse_model"))
+    else if (elem_id == ARD_XML_GEOMETRIC_RMSE_MODEL)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1248,8 +1486,7 @@ int add_global_scene_metadata
         /* Copy the content of the child node into the value for this field */
         gmeta->geometric_rmse_model = atof ((const char *) child_node->content);
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "geometric_rmse_model_x"))
+    else if (elem_id == ARD_XML_GEOMETRIC_RMSE_MODEL_X)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1265,8 +1502,7 @@ int add_global_scene_metadata
         gmeta->geometric_rmse_model_x =
             atof ((const char *) child_node->content);
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "geometric_rmse_model_y"))
+    else if (elem_id == ARD_XML_GEOMETRIC_RMSE_MODEL_Y)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1322,15 +1558,17 @@ int add_global_tile_metadata
     xmlNsPtr ns = NULL;           /* pointer to the namespace */
     xmlChar *attr_val = NULL;     /* attribute value */
     int count;                    /* number of chars copied in snprintf */
+    enum Ard_xml_name elem_id;    /* ID of the element name */
+    enum Ard_xml_name attr_id;    /* ID of the attribute name */
 
     /* Set up the current and child pointers */
     cur_node = a_node;
-    ns = cur_node->nsDef;
+    ns = (cur_node->ns != NULL) ? cur_node->ns : cur_node->nsDef;
     child_node = cur_node->children;
 
     /* Verify the namespace of this node is our ARD namespace.  If it isn't
        then the element won't be added to the metadata structure. */
-    if (!xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
+    if (ns == NULL || !xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
     {
         sprintf (errmsg, "Skipping %s since it is not in the ARD namespace",
             cur_node->name);
@@ -1339,7 +1577,8 @@ int add_global_tile_metadata
     }
 
     /* Look for the scene-based global metadata elements and process them */
-    if (xmlStrEqual (cur_node->name, (const xmlChar *) "data_provider"))
+    elem_id = ard_xml_name (cur_node->name);
+    if (elem_id == ARD_XML_DATA_PROVIDER)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1361,7 +1600,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "satellite"))
+    else if (elem_id == ARD_XML_SATELLITE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1383,7 +1622,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "instrument"))
+    else if (elem_id == ARD_XML_INSTRUMENT)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1405,8 +1644,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "level1_collection"))
+    else if (elem_id == ARD_XML_LEVEL1_COLLECTION)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1429,7 +1667,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "ard_version"))
+    else if (elem_id == ARD_XML_ARD_VERSION)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1451,7 +1689,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "region"))
+    else if (elem_id == ARD_XML_REGION)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1473,7 +1711,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "acquisition_date"))
+    else if (elem_id == ARD_XML_ACQUISITION_DATE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1496,16 +1734,17 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "date_range"))
+    else if (elem_id == ARD_XML_DATE_RANGE)
     {
         /* Handle the element attributes */
         for (attr = cur_node->properties; attr != NULL; attr = attr->next)
         {
             attr_val = xmlGetProp (cur_node, attr->name);
-            if (xmlStrEqual (attr->name, (const xmlChar *) "start"))
+            attr_id = ard_xml_name (attr->name);
+            if (attr_id == ARD_XML_START)
                 snprintf (gmeta->start_date, sizeof (gmeta->start_date), "%s",
                     (const char *) attr_val);
-            else if (xmlStrEqual (attr->name, (const xmlChar *) "end"))
+            else if (attr_id == ARD_XML_END)
                 snprintf (gmeta->end_date, sizeof (gmeta->end_date), "%s",
                     (const char *) attr_val);
             else
@@ -1518,7 +1757,7 @@ int add_global_tile_metadata
             xmlFree (attr_val);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "product_id"))
+    else if (elem_id == ARD_XML_PRODUCT_ID)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1540,7 +1779,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "description"))
+    else if (elem_id == ARD_XML_DESCRIPTION)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1562,8 +1801,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "production_date"))
+    else if (elem_id == ARD_XML_PRODUCTION_DATE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1586,8 +1824,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "bounding_coordinates"))
+    else if (elem_id == ARD_XML_BOUNDING_COORDINATES)
     {
         /* Process the siblings in the bounding coordinates */
         for (cur_node = a_node->children; cur_node;
@@ -1603,8 +1840,7 @@ int add_global_tile_metadata
             }
         }
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "projection_information"))
+    else if (elem_id == ARD_XML_PROJECTION_INFORMATION)
     {
         /* Process the elements within the projection information */
         if (add_global_ard_metadata_proj_info (cur_node, &gmeta->proj_info))
@@ -1614,8 +1850,7 @@ int add_global_tile_metadata
             return (ERROR);
         }
     }
-    else if (xmlStrEqual (cur_node->name,
-        (const xmlChar *) "orientation_angle"))
+    else if (elem_id == ARD_XML_ORIENTATION_ANGLE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1630,15 +1865,16 @@ int add_global_tile_metadata
         /* Copy the content of the child node into the value for this field */
         gmeta->orientation_angle = atof ((const char *) child_node->content);
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "tile_grid"))
+    else if (elem_id == ARD_XML_TILE_GRID)
     {
         /* Handle the element attributes */
         for (attr = cur_node->properties; attr != NULL; attr = attr->next)
         {
             attr_val = xmlGetProp (cur_node, attr->name);
-            if (xmlStrEqual (attr->name, (const xmlChar *) "h"))
+            attr_id = ard_xml_name (attr->name);
+            if (attr_id == ARD_XML_H)
                 gmeta->htile = atoi ((const char *) attr_val);
-            else if (xmlStrEqual (attr->name, (const xmlChar *) "v"))
+            else if (attr_id == ARD_XML_V)
                 gmeta->vtile = atoi ((const char *) attr_val);
             else
             {
@@ -1650,7 +1886,7 @@ int add_global_tile_metadata
             xmlFree (attr_val);
         }
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "scene_count"))
+    else if (elem_id == ARD_XML_SCENE_COUNT)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1665,7 +1901,7 @@ int add_global_tile_metadata
         /* Copy the content of the child node into the value for this field */
         gmeta->scene_count = atoi ((const char *) child_node->content);
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "cloud_cover"))
+    else if (elem_id == ARD_XML_CLOUD_COVER)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1680,7 +1916,7 @@ int add_global_tile_metadata
         /* Copy the content of the child node into the value for this field */
         gmeta->cloud_cover = atof ((const char *) child_node->content);
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "cloud_shadow"))
+    else if (elem_id == ARD_XML_CLOUD_SHADOW)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1695,7 +1931,7 @@ int add_global_tile_metadata
         /* Copy the content of the child node into the value for this field */
         gmeta->cloud_shadow = atof ((const char *) child_node->content);
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "snow_ice"))
+    else if (elem_id == ARD_XML_SNOW_ICE)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1710,7 +1946,7 @@ int add_global_tile_metadata
         /* Copy the content of the child node into the value for this field */
         gmeta->snow_ice = atof ((const char *) child_node->content);
     }
-    else if (xmlStrEqual (cur_node->name, (const xmlChar *) "fill"))
+    else if (elem_id == ARD_XML_FILL)
     {
         /* Expect the child node to be a text node containing the value of
            this field */
@@ -1972,14 +2208,16 @@ int add_ard_band_metadata
     xmlNsPtr ns = NULL;           /* pointer to the namespace */
     xmlChar *attr_val = NULL;     /* attribute value */
     int count;                    /* number of chars copied in snprintf */
+    enum Ard_xml_name elem_id;    /* ID of the element name */
+    enum Ard_xml_name attr_id;    /* ID of the attribute name */
 
     /* Set up the current and child pointers */
     cur_node = a_node;
-    ns = cur_node->nsDef;
+    ns = (cur_node->ns != NULL) ? cur_node->ns : cur_node->nsDef;
 
     /* Verify the namespace of this node is our ARD namespace.  If it isn't
        then the element won't be added to the metadata structure. */
-    if (!xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
+    if (ns == NULL || !xmlStrEqual (ns->href, (const xmlChar *) ARD_NS))
     {
         sprintf (errmsg, "Skipping %s since it is not in the ARD namespace",
             cur_node->name);
@@ -1991,7 +2229,8 @@ int add_ard_band_metadata
     for (attr = cur_node->properties; attr != NULL; attr = attr->next)
     {
         attr_val = xmlGetProp (cur_node, attr->name);
-        if (xmlStrEqual (attr->name, (const xmlChar *) "product"))
+        attr_id = ard_xml_name (attr->name);
+        if (attr_id == ARD_XML_PRODUCT)
         {
             count = snprintf (bmeta->product, sizeof (bmeta->product),
                 "%s", (const char *) attr_val);
@@ -2002,7 +2241,7 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (attr->name, (const xmlChar *) "source"))
+        else if (attr_id == ARD_XML_SOURCE)
         {
             count = snprintf (bmeta->source, sizeof (bmeta->source),
                 "%s", (const char *) attr_val);
@@ -2013,7 +2252,7 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (attr->name, (const xmlChar *) "name"))
+        else if (attr_id == ARD_XML_NAME)
         {
             count = snprintf (bmeta->name, sizeof (bmeta->name),
                 "%s", (const char *) attr_val);
@@ -2024,7 +2263,7 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (attr->name, (const xmlChar *) "category"))
+        else if (attr_id == ARD_XML_CATEGORY)
         {
             count = snprintf (bmeta->category, sizeof (bmeta->category),
                 "%s", (const char *) attr_val);
@@ -2035,37 +2274,32 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (attr->name, (const xmlChar *) "data_type"))
-        {
-            if (xmlStrEqual (attr_val, (const xmlChar *) "INT8"))
-                bmeta->data_type = ARD_INT8;
-            else if (xmlStrEqual (attr_val, (const xmlChar *) "UINT8"))
-                bmeta->data_type = ARD_UINT8;
-            else if (xmlStrEqual (attr_val, (const xmlChar *) "INT16"))
-                bmeta->data_type = ARD_INT16;
-            else if (xmlStrEqual (attr_val, (const xmlChar *) "UINT16"))
-                bmeta->data_type = ARD_UINT16;
-            else if (xmlStrEqual (attr_val, (const xmlChar *) "INT32"))
-                bmeta->data_type = ARD_INT32;
-            else if (xmlStrEqual (attr_val, (const xmlChar *) "UINT32"))
-                bmeta->data_type = ARD_UINT32;
-            else if (xmlStrEqual (attr_val, (const xmlChar *) "FLOAT32"))
-                bmeta->data_type = ARD_FLOAT32;
-            else if (xmlStrEqual (attr_val, (const xmlChar *) "FLOAT64"))
-                bmeta->data_type = ARD_FLOAT64;
-        }
-        else if (xmlStrEqual (attr->name, (const xmlChar *) "nlines"))
+        else if (attr_id == ARD_XML_DATA_TYPE)
+        {
+            switch (ard_xml_name (attr_val))
+            {
+                case ARD_XML_INT8: bmeta->data_type = ARD_INT8; break;
+                case ARD_XML_UINT8: bmeta->data_type = ARD_UINT8; break;
+                case ARD_XML_INT16: bmeta->data_type = ARD_INT16; break;
+                case ARD_XML_UINT16: bmeta->data_type = ARD_UINT16; break;
+                case ARD_XML_INT32: bmeta->data_type = ARD_INT32; break;
+                case ARD_XML_UINT32: bmeta->data_type = ARD_UINT32; break;
+                case ARD_XML_FLOAT32: bmeta->data_type = ARD_FLOAT32; break;
+                case ARD_XML_FLOAT64: bmeta->data_type = ARD_FLOAT64; break;
+                default: break;
+            }
+        }
+        else if (attr_id == ARD_XML_NLINES)
             bmeta->nlines = atoi ((const char *) attr_val);
-        else if (xmlStrEqual (attr->name, (const xmlChar *) "nsamps"))
+        else if (attr_id == ARD_XML_NSAMPS)
             bmeta->nsamps = atoi ((const char *) attr_val);
-        else if (xmlStrEqual (attr->name, (const xmlChar *) "fill_value"))
+        else if (attr_id == ARD_XML_FILL_VALUE)
             bmeta->fill_value = atoi ((const char *) attr_val);
-        else if (xmlStrEqual (attr->name,
-            (const xmlChar *) "saturate_value"))
+        else if (attr_id == ARD_XML_SATURATE_VALUE)
             bmeta->saturate_value = atoi ((const char *) attr_val);
-        else if (xmlStrEqual (attr->name, (const xmlChar *) "scale_factor"))
+        else if (attr_id == ARD_XML_SCALE_FACTOR)
             bmeta->scale_factor = atof ((const char *) attr_val);
-        else if (xmlStrEqual (attr->name, (const xmlChar *) "add_offset"))
+        else if (attr_id == ARD_XML_ADD_OFFSET)
             bmeta->add_offset = atof ((const char *) attr_val);
         else
         {
@@ -2082,7 +2316,8 @@ int add_ard_band_metadata
          cur_node = xmlNextElementSibling (cur_node))
     {
         child_node = cur_node->children;
-        if (xmlStrEqual (cur_node->name, (const xmlChar *) "short_name"))
+        elem_id = ard_xml_name (cur_node->name);
+        if (elem_id == ARD_XML_SHORT_NAME)
         {
             /* Expect the child node to be a text node containing the value of
                this field */
@@ -2104,7 +2339,7 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (cur_node->name, (const xmlChar *) "long_name"))
+        else if (elem_id == ARD_XML_LONG_NAME)
         {
             /* Expect the child node to be a text node containing the value of
                this field */
@@ -2126,7 +2361,7 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (cur_node->name, (const xmlChar *) "file_name"))
+        else if (elem_id == ARD_XML_FILE_NAME)
         {
             /* Expect the child node to be a text node containing the value of
                this field */
@@ -2148,19 +2383,20 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (cur_node->name, (const xmlChar *) "pixel_size"))
+        else if (elem_id == ARD_XML_PIXEL_SIZE)
         {
             /* Handle the element attributes */
             for (attr = cur_node->properties; attr != NULL; attr = attr->next)
             {
                 attr_val = xmlGetProp (cur_node, attr->name);
-                if (xmlStrEqual (attr->name, (const xmlChar *) "x"))
+                attr_id = ard_xml_name (attr->name);
+                if (attr_id == ARD_XML_X)
                     bmeta->pixel_size[0] =
                         (double) atof ((const char *) attr_val);
-                else if (xmlStrEqual (attr->name, (const xmlChar *) "y"))
+                else if (attr_id == ARD_XML_Y)
                     bmeta->pixel_size[1] =
                         (double) atof ((const char *) attr_val);
-                else if (xmlStrEqual (attr->name, (const xmlChar *) "units"))
+                else if (attr_id == ARD_XML_UNITS)
                 {
                     count = snprintf (bmeta->pixel_units,
                         sizeof (bmeta->pixel_units), "%s",
@@ -2181,8 +2417,7 @@ int add_ard_band_metadata
                 xmlFree (attr_val);
             }
         }
-        else if (xmlStrEqual (cur_node->name,
-            (const xmlChar *) "resample_method"))
+        else if (elem_id == ARD_XML_RESAMPLE_METHOD)
         {
             /* Expect the child node to be a text node containing the value of
                this field */
@@ -2214,7 +2449,7 @@ int add_ard_band_metadata
                 ard_error_handler (false, FUNC_NAME, errmsg);
             }
         }
-        else if (xmlStrEqual (cur_node->name, (const xmlChar *) "data_units"))
+        else if (elem_id == ARD_XML_DATA_UNITS)
         {
             /* Expect the child node to be a text node containing the value of
                this field */
@@ -2236,15 +2471,16 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (cur_node->name, (const xmlChar *) "valid_range"))
+        else if (elem_id == ARD_XML_VALID_RANGE)
         {
             /* Handle the element attributes */
             for (attr = cur_node->properties; attr != NULL; attr = attr->next)
             {
                 attr_val = xmlGetProp (cur_node, attr->name);
-                if (xmlStrEqual (attr->name, (const xmlChar *) "min"))
+                attr_id = ard_xml_name (attr->name);
+                if (attr_id == ARD_XML_MIN)
                     bmeta->valid_range[0] = atof ((const char *) attr_val);
-                else if (xmlStrEqual (attr->name, (const xmlChar *) "max"))
+                else if (attr_id == ARD_XML_MAX)
                     bmeta->valid_range[1] = atof ((const char *) attr_val);
                 else
                 {
@@ -2255,7 +2491,7 @@ int add_ard_band_metadata
                 xmlFree (attr_val);
             }
         }
-        else if (xmlStrEqual (cur_node->name, (const xmlChar *) "app_version"))
+        else if (elem_id == ARD_XML_APP_VERSION)
         {
             /* Expect the child node to be a text node containing the value of
                this field */
@@ -2277,8 +2513,7 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (cur_node->name,
-            (const xmlChar *) "production_date"))
+        else if (elem_id == ARD_XML_PRODUCTION_DATE)
         {
             /* Expect the child node to be a text node containing the value of
                this field */
@@ -2301,8 +2536,7 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (cur_node->name,
-            (const xmlChar *) "bitmap_description"))
+        else if (elem_id == ARD_XML_BITMAP_DESCRIPTION)
         {
             if (add_ard_band_metadata_bitmap_description (cur_node->children,
                 bmeta) != SUCCESS)
@@ -2313,7 +2547,7 @@ int add_ard_band_metadata
                 return (ERROR);
             }
         }
-        else if (xmlStrEqual (cur_node->name, (const xmlChar *) "class_values"))
+        else if (elem_id == ARD_XML_CLASS_VALUES)
         {
             if (add_ard_band_metadata_class_values (cur_node->children, bmeta)
                 != SUCCESS)
@@ -2336,6 +2570,88 @@ int add_ard_band_metadata
 }
 
 
+/******************************************************************************
+MODULE:  init_ard_parse_ctx
+
+PURPOSE: Initializes the parser context.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error initializing the parser context
+SUCCESS         Successful initialization of the parser context
+
+NOTES:
+1. The parser context can be reused for parsing any number of documents, one
+   at a time, and needs to be freed via free_ard_parse_ctx.
+2. The element stack is part of the context, so no memory is allocated.
+******************************************************************************/
+int init_ard_parse_ctx
+(
+    Ard_parse_ctx_t *ctx       /* O: parser context to be initialized */
+)
+{
+    /* Initialize the parser state, including the stack of elements */
+    reset_ard_parse_ctx (ctx);
+    ctx->band_handler = NULL;
+    ctx->handler_data = NULL;
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  reset_ard_parse_ctx
+
+PURPOSE: Resets the parser state in the parser context to the start of a
+document.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+1. Called at the start of each parse so a parse which aborted halfway
+   doesn't leave stale state behind for the next document.
+******************************************************************************/
+void reset_ard_parse_ctx
+(
+    Ard_parse_ctx_t *ctx       /* I/O: parser context to be reset */
+)
+{
+    init_meta_stack (&ctx->stack);
+    ctx->nbands = 0;
+    ctx->cur_band = 0;
+    ctx->cur_scene = -1;
+    ctx->tile_metadata = false;
+    ctx->scene_metadata = false;
+    ctx->global_metadata = false;
+    ctx->bands_metadata = false;
+    ctx->scene_meta = NULL;
+}
+
+
+/******************************************************************************
+MODULE:  free_ard_parse_ctx
+
+PURPOSE: Frees the memory allocated for the parser context.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+1. Nothing is currently allocated for the parser context.  This is kept so
+   callers don't need to change if that changes.
+******************************************************************************/
+void free_ard_parse_ctx
+(
+    Ard_parse_ctx_t *ctx       /* I/O: parser context to be freed */
+)
+{
+    init_meta_stack (&ctx->stack);
+}
+
+
 /******************************************************************************
 MODULE:  parse_ard_xml_into_struct
 
@@ -2350,41 +2666,28 @@ SUCCESS         Successful parse of the metadata values
 
 NOTES:
 1. Uses a stack of character strings to keep track of the nodes that have
-   been parsed.  The stack must be allocated before calling this routine.
+   been parsed.  The stack and the rest of the parser state are held in the
+   parser context, which must be initialized (init_ard_parse_ctx) before
+   calling this routine.
 ******************************************************************************/
 int parse_ard_xml_into_struct
 (
     xmlNode *a_node,           /* I: pointer to the current node */
     Ard_meta_t *ard_meta,      /* I: ARD metadata structure to be filled */
-    int *top_of_stack,         /* I: pointer to top of the stack */
-    char **stack               /* I: stack to use for parsing */
+    Ard_parse_ctx_t *ctx       /* I/O: parser context for this document */
 )
 {
     char FUNC_NAME[] = "parse_ard_xml_into_struct";  /* function name */
     char errmsg[STR_SIZE];        /* error message */
-    char *curr_stack_element = NULL;  /* element popped from the stack */
+    const char *curr_stack_element = NULL;  /* element popped from the
+                                               stack */
     xmlNode *cur_node = NULL;    /* pointer to the current node */
     xmlNode *sib_node = NULL;    /* pointer to the sibling node */
-    static int nbands = 0;       /* number of bands in tile/scene container */
-    static bool tile_metadata = false;  /* are we parsing the tile-specific
-                                    metadata section of the ARD metadata? */
-    static bool scene_metadata = false; /* are we parsing the scene-specific
-                                    metadata section of the ARD metadata? */
-    static bool global_metadata = false;  /* are we parsing the global metadata
-                                    section of the ARD metadata? */
-    static bool bands_metadata = false;   /* are we parsing the bands metadata
-                                    section of the ARD metadata? */
-    static int cur_band = 0;     /* current band being processed in the bands
-                                    metadata section (zero-based) */
-    static int cur_scene = -1;   /* current scene being processed in the XML
-                                    metadata (zero-based) */
     bool skip_child;             /* boolean to specify the children of this
                                     node should not be processed */
     Ard_band_meta_t *bmeta = NULL;  /* pointer to tile/scene band metadata */
     Ard_tile_meta_t *tile_meta = &ard_meta->tile_meta;
                                  /* pointer to tile-specific metadata */
-    static Ard_scene_meta_t *scene_meta = NULL;
-                                 /* ptr to array of scene-specific metadata */
 
     /* Start at the input node and traverse the tree, visiting all the children
        and siblings */
@@ -2401,7 +2704,7 @@ int parse_ard_xml_into_struct
                is either the global metadata or the band metadata in either
                the tile- or scene- specific metadata */
             //printf ("***Pushed %s\n", cur_node->name); fflush (stdout);
-            if (push (top_of_stack, stack, (const char *) cur_node->name))
+            if (push_meta_stack (&ctx->stack, (const char *) cur_node->name))
             {
                 sprintf (errmsg, "Pushing element '%s' to the stack.",
                     cur_node->name);
@@ -2414,7 +2717,7 @@ int parse_ard_xml_into_struct
             if (xmlStrEqual (cur_node->name,
                 (const xmlChar *) "tile_metadata"))
             {
-                if (tile_metadata)
+                if (ctx->tile_metadata)
                 {
                     sprintf (errmsg, "Current element node is '%s' however we "
                         "are already in the tile_metadata section.",
@@ -2425,8 +2728,8 @@ int parse_ard_xml_into_struct
 
                 /* Turn on the tile metadata and reinitialize the number of
                    bands */
-                tile_metadata = true;
-                nbands = 0;
+                ctx->tile_metadata = true;
+                ctx->nbands = 0;
             }
 
             /* Turn the boolean on if this is the scene metadata container.
@@ -2435,7 +2738,7 @@ int parse_ard_xml_into_struct
             if (xmlStrEqual (cur_node->name,
                 (const xmlChar *) "scene_metadata"))
             {
-                if (scene_metadata)
+                if (ctx->scene_metadata)
                 {
                     sprintf (errmsg, "Current element node is '%s' however we "
                         "are already in the scene_metadata section.",
@@ -2443,22 +2746,23 @@ int parse_ard_xml_into_struct
                     ard_error_handler (true, FUNC_NAME, errmsg);
                     return (ERROR);
                 }
-                cur_scene++;  /* add to zero-based scene count */
-                if (cur_scene >= MAX_TOTAL_SCENES)
+                ctx->cur_scene++;  /* add to zero-based scene count */
+                if (ctx->cur_scene >= MAX_TOTAL_SCENES)
                 {
                     sprintf (errmsg, "Current scene count (%d) exceeds the max "
-                        "total scenes (%d).\n", cur_scene+1, MAX_TOTAL_SCENES);
+                        "total scenes (%d).\n", ctx->cur_scene+1,
+                        MAX_TOTAL_SCENES);
                     ard_error_handler (true, FUNC_NAME, errmsg);
                     return (ERROR);
                 }
 
                 /* Turn on the scene metadata and reinitialize the number of
                    bands */
-                scene_metadata = true;
-                nbands = 0;
+                ctx->scene_metadata = true;
+                ctx->nbands = 0;
 
                 /* Set up the scene metadata pointer for the current scene */
-                scene_meta = &ard_meta->scene_meta[cur_scene];
+                ctx->scene_meta = &ard_meta->scene_meta[ctx->cur_scene];
             }
 
             /* Turn the boolean on if this is the global_metadata. Flag an
@@ -2467,7 +2771,7 @@ int parse_ard_xml_into_struct
             if (xmlStrEqual (cur_node->name,
                 (const xmlChar *) "global_metadata"))
             {
-                if (global_metadata)
+                if (ctx->global_metadata)
                 {
                     sprintf (errmsg, "Current element node is '%s' however we "
                         "are already in the global_metadata section for either "
@@ -2475,7 +2779,7 @@ int parse_ard_xml_into_struct
                     ard_error_handler (true, FUNC_NAME, errmsg);
                     return (ERROR);
                 }
-                global_metadata = true;
+                ctx->global_metadata = true;
             }
 
             /* Turn the boolean on if this is the bands metadata. Flag an
@@ -2485,7 +2789,7 @@ int parse_ard_xml_into_struct
                nbands. */
             if (xmlStrEqual (cur_node->name, (const xmlChar *) "bands"))
             {
-                if (bands_metadata)
+                if (ctx->bands_metadata)
                 {
                     sprintf (errmsg, "Current element node is '%s' however we "
                         "are already in the bands section for either the tile "
@@ -2493,33 +2797,33 @@ int parse_ard_xml_into_struct
                     ard_error_handler (true, FUNC_NAME, errmsg);
                     return (ERROR);
                 }
-                bands_metadata = true;
-                cur_band = 0;  /* reset to zero for start of band count */
+                ctx->bands_metadata = true;
+                ctx->cur_band = 0;  /* reset to zero for start of band count */
 
                 /* Count the number of siblings which are band elements */
-                nbands = 0;
+                ctx->nbands = 0;
                 for (sib_node = cur_node->children; sib_node;
                      sib_node = xmlNextElementSibling (sib_node))
                 {
                     /* If this is a band element then count it */
                     if (xmlStrEqual (sib_node->name, (const xmlChar *) "band"))
-                        nbands++;
+                        ctx->nbands++;
                 }
 
                 /* Allocate the bands based on whether we are in the tile or
                    scene metadata */
-                if (tile_metadata)
+                if (ctx->tile_metadata)
                 {
-                    if (allocate_ard_band_metadata (tile_meta, NULL, nbands) !=
-                        SUCCESS)
+                    if (allocate_ard_band_metadata (tile_meta, NULL,
+                        ctx->nbands) != SUCCESS)
                     {   /* Error messages already printed */
                         return (ERROR);
                     }
                 }
-                else if (scene_metadata)
+                else if (ctx->scene_metadata)
                 {
-                    if (allocate_ard_band_metadata (NULL, scene_meta, nbands) !=
-                        SUCCESS)
+                    if (allocate_ard_band_metadata (NULL, ctx->scene_meta,
+                        ctx->nbands) != SUCCESS)
                     {   /* Error messages already printed */
                         return (ERROR);
                     }
@@ -2542,12 +2846,12 @@ int parse_ard_xml_into_struct
             /* If we are IN the global metadata (don't process the actual
                global_metadata element) then consume this node and add the
                information to the tile/scene global metadata structure */
-            if (global_metadata && !xmlStrEqual (cur_node->name,
+            if (ctx->global_metadata && !xmlStrEqual (cur_node->name,
                 (const xmlChar *) "global_metadata"))
             {
                 /* Global metadata for tile-based and scene-based metadata is
                    slightly different */
-                if (tile_metadata)
+                if (ctx->tile_metadata)
                 {
                     if (add_global_tile_metadata (cur_node,
                         &tile_meta->tile_global))
@@ -2558,10 +2862,10 @@ int parse_ard_xml_into_struct
                         return (ERROR);
                     }
                 }
-                else if (scene_metadata)
+                else if (ctx->scene_metadata)
                 {
                     if (add_global_scene_metadata (cur_node,
-                        &scene_meta->scene_global))
+                        &ctx->scene_meta->scene_global))
                     {
                         sprintf (errmsg, "Consuming scene-based "
                             "global_metadata element '%s'.", cur_node->name);
@@ -2578,23 +2882,23 @@ int parse_ard_xml_into_struct
             /* If we are IN the bands metadata and at a band element, then
                consume this node and add the information to the band metadata
                structure for the current band */
-            if (bands_metadata && xmlStrEqual (cur_node->name,
+            if (ctx->bands_metadata && xmlStrEqual (cur_node->name,
                 (const xmlChar *) "band"))
             {
-                if (cur_band >= nbands)
+                if (ctx->cur_band >= ctx->nbands)
                 {
                     sprintf (errmsg, "Number of bands consumed already "
                         "reached the total number of bands allocated for this "
-                        "scene/tile container (%d).", nbands);
+                        "scene/tile container (%d).", ctx->nbands);
                     ard_error_handler (true, FUNC_NAME, errmsg);
                     return (ERROR);
                 }
 
                 /* Add current band to the tile/scene-based band metadata */
-                if (tile_metadata)
-                    bmeta = &tile_meta->band[cur_band++];
-                else if (scene_metadata)
-                    bmeta = &scene_meta->band[cur_band++];
+                if (ctx->tile_metadata)
+                    bmeta = &tile_meta->band[ctx->cur_band++];
+                else if (ctx->scene_metadata)
+                    bmeta = &ctx->scene_meta->band[ctx->cur_band++];
                 if (add_ard_band_metadata (cur_node, bmeta))
                 {
                     sprintf (errmsg, "Consuming band metadata element '%s'.",
@@ -2619,7 +2923,7 @@ int parse_ard_xml_into_struct
         if (!skip_child)
         {
             if (parse_ard_xml_into_struct (cur_node->children, ard_meta,
-                top_of_stack, stack))
+                ctx))
             {
                 sprintf (errmsg, "Parsing the children of this element '%s'.",
                     cur_node->name);
@@ -2629,10 +2933,10 @@ int parse_ard_xml_into_struct
         }
 
         /* Done with the element and its siblings so pop the element name off
-           the stack and reset static variables */
+           the stack and reset the parser state */
         if (cur_node->type == XML_ELEMENT_NODE)
         {
-            curr_stack_element = pop (top_of_stack, stack);
+            curr_stack_element = pop_meta_stack (&ctx->stack);
             if (curr_stack_element == NULL)
             {
                 sprintf (errmsg, "Popping elements off the stack.");
@@ -2642,20 +2946,20 @@ int parse_ard_xml_into_struct
             //printf ("***Popped %s\n", curr_stack_element); fflush (stdout);
 
             if (!strcmp (curr_stack_element, "global_metadata"))
-                global_metadata = false;
+                ctx->global_metadata = false;
             if (!strcmp (curr_stack_element, "bands"))
-                bands_metadata = false;
+                ctx->bands_metadata = false;
             if (!strcmp (curr_stack_element, "tile_metadata"))
-                tile_metadata = false;
+                ctx->tile_metadata = false;
             if (!strcmp (curr_stack_element, "scene_metadata"))
             {
                 /* Set the number of scenes based on the number of
                    scene_metadata that were parsed */
-                ard_meta->nscenes = cur_scene + 1;
+                ard_meta->nscenes = ctx->cur_scene + 1;
 
                 /* Reset the scene metadata vars */
-                scene_metadata = false;
-                cur_scene = -1;
+                ctx->scene_metadata = false;
+                ctx->cur_scene = -1;
             }
         }
     }  /* for cur_node */
@@ -2666,10 +2970,10 @@ int parse_ard_xml_into_struct
 
 
 /******************************************************************************
-MODULE:  parse_ard_metadata
+MODULE:  parse_ard_metadata_ctx
 
 PURPOSE: Parse the input metadata file and populate the associated ARD metadata
-file.
+file, using the caller's parser context.
 
 RETURN VALUE:
 Type = int
@@ -2686,24 +2990,32 @@ NOTES:
    can be used to dump/print the XML doc to the screen.
 3. Input ARD metadata structure needs to be initialized via
    init_ard_metadata_struct.
+4. All of the parser state is held in the parser context, so separate
+   threads may parse separate documents at the same time as long as each
+   thread uses its own context.  xmlInitParser should be called once from
+   the main thread before parsing in multiple threads, and the global XML
+   library memory is not cleaned up by this routine (see parse_ard_metadata).
 ******************************************************************************/
-int parse_ard_metadata
+int parse_ard_metadata_ctx
 (
+    Ard_parse_ctx_t *ctx, /* I/O: parser context initialized via
+                                init_ard_parse_ctx */
     char *metafile,       /* I: input metadata file or URL */
     Ard_meta_t *ard_meta  /* I: input ARD metadata structure which has been
                                 initialized via init_ard_metadata_struct */
 )
 {
-    char FUNC_NAME[] = "parse_ard_metadata";  /* function name */
+    char FUNC_NAME[] = "parse_ard_metadata_ctx";  /* function name */
     char errmsg[STR_SIZE];    /* error message */
     xmlTextReaderPtr reader;  /* reader for the XML file */
     xmlDocPtr doc = NULL;     /* document tree pointer */
     xmlNodePtr current=NULL;  /* pointer to the current node */
     int status;               /* return status */
     int nodeType;             /* node type (element, text, attribute, etc.) */
-    int top_of_stack;         /* top of the stack */
     int count;                /* number of chars copied in snprintf */
-    char **stack = NULL;      /* stack to keep track of elements in the tree */
+
+    /* Start with a clean parser state for this document */
+    reset_ard_parse_ctx (ctx);
 
     /* Establish the reader for this metadata file */
     reader = xmlNewTextReaderFilename (metafile);
@@ -2727,6 +3039,8 @@ int parse_ard_metadata
         {
             sprintf (errmsg, "Getting node type");
             ard_error_handler (true, FUNC_NAME, errmsg);
+            xmlFreeDoc (doc);
+            xmlFreeTextReader (reader);
             return (ERROR);
         }
         switch (nodeType)
@@ -2863,6 +3177,8 @@ int parse_ard_metadata
     {
         sprintf (errmsg, "Failed to parse %s", metafile);
         ard_error_handler (true, FUNC_NAME, errmsg);
+        xmlFreeDoc (doc);
+        xmlFreeTextReader (reader);
         return (ERROR);
     }
 
@@ -2878,38 +3194,691 @@ int parse_ard_metadata
         {
             sprintf (errmsg, "Overflow of ard_meta->meta_namespace string");
             ard_error_handler (true, FUNC_NAME, errmsg);
-            return (ERROR);
-        }
-
-        /* Initialize the stack to hold the elements */
-        if (init_stack (&top_of_stack, &stack))
-        {
-            sprintf (errmsg, "Initializing the stack.");
-            ard_error_handler (true, FUNC_NAME, errmsg);
+            xmlFreeDoc (doc);
+            xmlFreeTextReader (reader);
             return (ERROR);
         }
         //print_ard_element_names (xmlDocGetRootElement (doc));
 
         /* Parse the XML document into our ARD metadata structure */
         if (parse_ard_xml_into_struct (xmlDocGetRootElement(doc), ard_meta,
-            &top_of_stack, stack))
+            ctx))
         {
             sprintf (errmsg, "Parsing the metadata file into the ARD metadata "
                 "structure.");
             ard_error_handler (true, FUNC_NAME, errmsg);
+            xmlFreeDoc (doc);
+            xmlFreeTextReader (reader);
             return (ERROR);
         }
 
-        /* Clean up the XML document and the stack */
+        /* Clean up the XML document */
         xmlFreeDoc (doc);
-        free_stack (&stack);
     }
 
-    /* Free the reader and associated memory */
+    /* Free the reader */
     xmlFreeTextReader (reader);
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  parse_ard_metadata
+
+PURPOSE: Parse the input metadata file and populate the associated ARD metadata
+file.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error parsing the metadata elements
+SUCCESS         Successful parse of the metadata values
+
+NOTES:
+1. Input ARD metadata structure needs to be initialized via
+   init_ard_metadata_struct.
+2. Uses a parser context local to this call (see parse_ard_metadata_ctx) and
+   cleans up the global XML library memory once done.  Multi-threaded
+   applications should use parse_ard_metadata_ctx instead.
+******************************************************************************/
+int parse_ard_metadata
+(
+    char *metafile,       /* I: input metadata file or URL */
+    Ard_meta_t *ard_meta  /* I: input ARD metadata structure which has been
+                                initialized via init_ard_metadata_struct */
+)
+{
+    char FUNC_NAME[] = "parse_ard_metadata";  /* function name */
+    char errmsg[STR_SIZE];    /* error message */
+    int status;               /* return status */
+    Ard_parse_ctx_t ctx;      /* parser context for this document */
+
+    /* Initialize the parser context */
+    if (init_ard_parse_ctx (&ctx) != SUCCESS)
+    {
+        sprintf (errmsg, "Initializing the parser context.");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Parse the metadata file */
+    status = parse_ard_metadata_ctx (&ctx, metafile, ard_meta);
+    free_ard_parse_ctx (&ctx);
+    if (status != SUCCESS)
+    {
+        sprintf (errmsg, "Parsing metadata file %s", metafile);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Free the global memory used by the XML library */
     xmlCleanupParser();
     xmlMemoryDump();
 
     return (SUCCESS);
 }
 
+
+
+/******************************************************************************
+MODULE:  start_ard_stream_element
+
+PURPOSE: Handles the start of a container element (tile_metadata,
+scene_metadata, global_metadata, bands) for the streaming parser.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error handling the element
+SUCCESS         Successful handling of the element
+
+NOTES:
+1. Mirrors the container handling in parse_ard_xml_into_struct, except the
+   bands are allocated as they are found since the number of band elements
+   isn't known ahead of time.
+******************************************************************************/
+static int start_ard_stream_element
+(
+    Ard_parse_ctx_t *ctx,      /* I/O: parser context for this document */
+    Ard_meta_t *ard_meta,      /* I: ARD metadata structure to be filled */
+    const xmlChar *name        /* I: name of the element */
+)
+{
+    char FUNC_NAME[] = "start_ard_stream_element";  /* function name */
+    char errmsg[STR_SIZE];        /* error message */
+    Ard_tile_meta_t *tile_meta = &ard_meta->tile_meta;
+                                  /* pointer to tile-specific metadata */
+
+    if (xmlStrEqual (name, (const xmlChar *) "tile_metadata"))
+    {
+        if (ctx->tile_metadata)
+        {
+            sprintf (errmsg, "Current element node is '%s' however we are "
+                "already in the tile_metadata section.", name);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+        ctx->tile_metadata = true;
+        ctx->nbands = 0;
+    }
+    else if (xmlStrEqual (name, (const xmlChar *) "scene_metadata"))
+    {
+        if (ctx->scene_metadata)
+        {
+            sprintf (errmsg, "Current element node is '%s' however we are "
+                "already in the scene_metadata section.", name);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+        ctx->cur_scene++;  /* add to zero-based scene count */
+        if (ctx->cur_scene >= MAX_TOTAL_SCENES)
+        {
+            sprintf (errmsg, "Current scene count (%d) exceeds the max total "
+                "scenes (%d).\n", ctx->cur_scene+1, MAX_TOTAL_SCENES);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+        ctx->scene_metadata = true;
+        ctx->nbands = 0;
+        ctx->scene_meta = &ard_meta->scene_meta[ctx->cur_scene];
+    }
+    else if (xmlStrEqual (name, (const xmlChar *) "global_metadata"))
+    {
+        if (ctx->global_metadata)
+        {
+            sprintf (errmsg, "Current element node is '%s' however we are "
+                "already in the global_metadata section for either the tile "
+                "or scene section.", name);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+        ctx->global_metadata = true;
+    }
+    else if (xmlStrEqual (name, (const xmlChar *) "bands"))
+    {
+        if (ctx->bands_metadata)
+        {
+            sprintf (errmsg, "Current element node is '%s' however we are "
+                "already in the bands section for either the tile or scene "
+                "section.", name);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+        ctx->bands_metadata = true;
+        ctx->cur_band = 0;  /* reset to zero for start of band count */
+        ctx->nbands = 0;
+
+        /* Start with no bands in the tile or scene metadata */
+        if (ctx->tile_metadata)
+        {
+            if (tile_meta->band != NULL && tile_meta->arena == NULL)
+                free_ard_band_metadata (tile_meta->nbands, tile_meta->band);
+            tile_meta->band = NULL;
+            tile_meta->nbands = 0;
+        }
+        else if (ctx->scene_metadata)
+        {
+            if (ctx->scene_meta->band != NULL &&
+                ctx->scene_meta->arena == NULL)
+                free_ard_band_metadata (ctx->scene_meta->nbands,
+                    ctx->scene_meta->band);
+            ctx->scene_meta->band = NULL;
+            ctx->scene_meta->nbands = 0;
+        }
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  consume_ard_stream_element
+
+PURPOSE: Adds a global metadata element or a band element, along with its
+children, to the ARD metadata structure for the streaming parser.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error consuming the element
+SUCCESS         Successful consumption of the element
+
+NOTES:
+1. The band metadata is grown as needed, doubling each time.
+2. If the context has a band handler, the band is parsed into a temporary
+   band and handed to the handler instead.
+******************************************************************************/
+static int consume_ard_stream_element
+(
+    Ard_parse_ctx_t *ctx,      /* I/O: parser context for this document */
+    Ard_meta_t *ard_meta,      /* I: ARD metadata structure to be filled */
+    xmlNode *cur_node          /* I: expanded element to be consumed */
+)
+{
+    char FUNC_NAME[] = "consume_ard_stream_element";  /* function name */
+    char errmsg[STR_SIZE];        /* error message */
+    Ard_tile_meta_t *tile_meta = &ard_meta->tile_meta;
+                                  /* pointer to tile-specific metadata */
+    Ard_band_meta_t *bmeta = NULL;  /* pointer to tile/scene band metadata */
+    Ard_band_meta_t band;         /* band for the band handler */
+    int nbands;                   /* number of bands currently allocated */
+    int status;                   /* return status */
+
+    /* Global metadata elements */
+    if (ctx->global_metadata)
+    {
+        if (ctx->tile_metadata)
+        {
+            if (add_global_tile_metadata (cur_node, &tile_meta->tile_global))
+            {
+                sprintf (errmsg, "Consuming tile-based global_metadata "
+                    "element '%s'.", cur_node->name);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return (ERROR);
+            }
+        }
+        else if (ctx->scene_metadata)
+        {
+            if (add_global_scene_metadata (cur_node,
+                &ctx->scene_meta->scene_global))
+            {
+                sprintf (errmsg, "Consuming scene-based global_metadata "
+                    "element '%s'.", cur_node->name);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                return (ERROR);
+            }
+        }
+
+        return (SUCCESS);
+    }
+
+    /* Band elements handed to the band handler */
+    if (ctx->band_handler != NULL)
+    {
+        init_ard_band_metadata (&band, 0, 1);
+        status = add_ard_band_metadata (cur_node, &band);
+        if (status == SUCCESS)
+            status = ctx->band_handler (ctx->handler_data,
+                ctx->scene_metadata ? ctx->cur_scene : -1, ctx->cur_band,
+                &band);
+        clear_ard_band_metadata (&band);
+        if (status != SUCCESS)
+        {
+            sprintf (errmsg, "Handling band metadata element '%s'.",
+                cur_node->name);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            return (ERROR);
+        }
+
+        ctx->cur_band++;
+        return (SUCCESS);
+    }
+
+    /* Band elements; make room for the band if needed */
+    if (ctx->tile_metadata)
+    {
+        nbands = tile_meta->nbands;
+        if (ctx->cur_band >= nbands && reallocate_ard_band_metadata (
+            tile_meta, NULL, nbands > 0 ? 2 * nbands : 8) != SUCCESS)
+        {   /* Error messages already printed */
+            return (ERROR);
+        }
+        bmeta = &tile_meta->band[ctx->cur_band++];
+    }
+    else if (ctx->scene_metadata)
+    {
+        nbands = ctx->scene_meta->nbands;
+        if (ctx->cur_band >= nbands && reallocate_ard_band_metadata (
+            NULL, ctx->scene_meta, nbands > 0 ? 2 * nbands : 8) != SUCCESS)
+        {   /* Error messages already printed */
+            return (ERROR);
+        }
+        bmeta = &ctx->scene_meta->band[ctx->cur_band++];
+    }
+    else
+        return (SUCCESS);
+
+    if (add_ard_band_metadata (cur_node, bmeta))
+    {
+        sprintf (errmsg, "Consuming band metadata element '%s'.",
+            cur_node->name);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  end_ard_stream_element
+
+PURPOSE: Handles the end of a container element (tile_metadata,
+scene_metadata, global_metadata, bands) for the streaming parser.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error handling the element
+SUCCESS         Successful handling of the element
+
+NOTES:
+1. The band metadata is trimmed to the number of bands found.
+******************************************************************************/
+static int end_ard_stream_element
+(
+    Ard_parse_ctx_t *ctx,      /* I/O: parser context for this document */
+    Ard_meta_t *ard_meta,      /* I: ARD metadata structure to be filled */
+    const xmlChar *name        /* I: name of the element */
+)
+{
+    if (xmlStrEqual (name, (const xmlChar *) "global_metadata"))
+        ctx->global_metadata = false;
+    else if (xmlStrEqual (name, (const xmlChar *) "bands"))
+    {
+        /* Trim the bands to the number found, unless the bands were handed
+           to the band handler */
+        ctx->nbands = ctx->cur_band;
+        if (ctx->band_handler == NULL && ctx->tile_metadata)
+        {
+            if (reallocate_ard_band_metadata (&ard_meta->tile_meta, NULL,
+                ctx->nbands) != SUCCESS)
+            {   /* Error messages already printed */
+                return (ERROR);
+            }
+        }
+        else if (ctx->band_handler == NULL && ctx->scene_metadata)
+        {
+            if (reallocate_ard_band_metadata (NULL, ctx->scene_meta,
+                ctx->nbands) != SUCCESS)
+            {   /* Error messages already printed */
+                return (ERROR);
+            }
+        }
+        ctx->bands_metadata = false;
+    }
+    else if (xmlStrEqual (name, (const xmlChar *) "tile_metadata"))
+        ctx->tile_metadata = false;
+    else if (xmlStrEqual (name, (const xmlChar *) "scene_metadata"))
+    {
+        /* Set the number of scenes based on the number of scene_metadata
+           that were parsed */
+        ard_meta->nscenes = ctx->cur_scene + 1;
+
+        /* Reset the scene metadata vars */
+        ctx->scene_metadata = false;
+        ctx->cur_scene = -1;
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  parse_ard_metadata_stream
+
+PURPOSE: Parse the input metadata file in a single streaming pass and populate
+the associated ARD metadata structure, without building a tree for the entire
+document.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error parsing the metadata elements
+SUCCESS         Successful parse of the metadata values
+
+NOTES:
+1. The container elements are handled directly from the reader events.  Only
+   the element currently being consumed (one global metadata element or one
+   band) is expanded into a subtree, which is handed to the same add_*
+   routines used by parse_ard_metadata and then released by the reader.
+   Peak memory is therefore bounded by the largest band rather than the
+   size of the document, and the resulting metadata structure is the same
+   as from parse_ard_metadata.
+2. Input ARD metadata structure needs to be initialized via
+   init_ard_metadata_struct.
+3. Same as parse_ard_metadata_ctx, separate threads may parse separate
+   documents at the same time using their own parser contexts.
+******************************************************************************/
+int parse_ard_metadata_stream
+(
+    Ard_parse_ctx_t *ctx, /* I/O: parser context initialized via
+                                init_ard_parse_ctx */
+    char *metafile,       /* I: input metadata file or URL */
+    Ard_meta_t *ard_meta  /* I: input ARD metadata structure which has been
+                                initialized via init_ard_metadata_struct */
+)
+{
+    char FUNC_NAME[] = "parse_ard_metadata_stream";  /* function name */
+    char errmsg[STR_SIZE];    /* error message */
+    xmlTextReaderPtr reader;  /* reader for the XML file */
+    xmlNodePtr node = NULL;   /* expanded element being consumed */
+    const xmlChar *name;      /* name of the current element */
+    const xmlChar *ns_uri;    /* namespace of the root element */
+    int status;               /* return status */
+    int node_type;            /* node type (element, end element, etc.) */
+    int count;                /* number of chars copied in snprintf */
+    bool empty;               /* is the current element empty? */
+
+    /* Start with a clean parser state for this document */
+    reset_ard_parse_ctx (ctx);
+
+    /* Establish the reader for this metadata file, dropping the white space
+       between elements */
+    reader = xmlReaderForFile (metafile, NULL, XML_PARSE_NOBLANKS);
+    if (reader == NULL)
+    {
+        sprintf (errmsg, "Setting up reader for %s", metafile);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    status = xmlTextReaderRead (reader);
+    while (status == 1)
+    {
+        node_type = xmlTextReaderNodeType (reader);
+        name = xmlTextReaderConstLocalName (reader);
+        if (node_type == XML_READER_TYPE_ELEMENT)
+        {
+            /* Store the namespace for the overall metadata file */
+            if (xmlTextReaderDepth (reader) == 0)
+            {
+                ns_uri = xmlTextReaderConstNamespaceUri (reader);
+                if (ns_uri == NULL)
+                {
+                    sprintf (errmsg, "Root element of %s has no namespace",
+                        metafile);
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    xmlFreeTextReader (reader);
+                    return (ERROR);
+                }
+                count = snprintf (ard_meta->meta_namespace,
+                    sizeof (ard_meta->meta_namespace), "%s",
+                    (const char *) ns_uri);
+                if (count < 0 || count >= sizeof (ard_meta->meta_namespace))
+                {
+                    sprintf (errmsg, "Overflow of ard_meta->meta_namespace "
+                        "string");
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    xmlFreeTextReader (reader);
+                    return (ERROR);
+                }
+            }
+
+            empty = xmlTextReaderIsEmptyElement (reader);
+            if (start_ard_stream_element (ctx, ard_meta, name) != SUCCESS)
+            {   /* Error messages already printed */
+                xmlFreeTextReader (reader);
+                return (ERROR);
+            }
+
+            /* Consume the elements IN the global metadata and the band
+               elements IN the bands metadata, then skip past them */
+            if ((ctx->global_metadata && !xmlStrEqual (name,
+                (const xmlChar *) "global_metadata")) ||
+                (ctx->bands_metadata && xmlStrEqual (name,
+                (const xmlChar *) "band")))
+            {
+                node = xmlTextReaderExpand (reader);
+                if (node == NULL ||
+                    consume_ard_stream_element (ctx, ard_meta, node))
+                {
+                    sprintf (errmsg, "Consuming element '%s'.", name);
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    xmlFreeTextReader (reader);
+                    return (ERROR);
+                }
+
+                status = xmlTextReaderNext (reader);
+                continue;
+            }
+
+            /* An empty element is also the end of the element */
+            if (empty && end_ard_stream_element (ctx, ard_meta, name))
+            {   /* Error messages already printed */
+                xmlFreeTextReader (reader);
+                return (ERROR);
+            }
+        }
+        else if (node_type == XML_READER_TYPE_END_ELEMENT)
+        {
+            if (end_ard_stream_element (ctx, ard_meta, name))
+            {   /* Error messages already printed */
+                xmlFreeTextReader (reader);
+                return (ERROR);
+            }
+        }
+
+        /* Read the next node */
+        status = xmlTextReaderRead (reader);
+    }
+
+    /* Free the reader */
+    xmlFreeTextReader (reader);
+    if (status != 0)
+    {
+        sprintf (errmsg, "Failed to parse %s", metafile);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  add_compact_band
+
+PURPOSE: Band handler for parse_ard_compact_metadata, which adds the band to
+the tile or scene bands of the compact metadata.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error adding the band
+SUCCESS         Successfully added the band
+
+NOTES:
+1. The first band of a bands section replaces any bands already found for
+   the tile or scene, the same as parse_ard_metadata.
+******************************************************************************/
+static int add_compact_band
+(
+    void *handler_data,     /* I/O: compact metadata being filled */
+    int cur_scene,          /* I: current scene; -1 for the tile bands */
+    int cur_band,           /* I: current band in the bands section */
+    Ard_band_meta_t *bmeta  /* I: metadata for the current band */
+)
+{
+    char FUNC_NAME[] = "add_compact_band";  /* function name */
+    char errmsg[STR_SIZE];        /* error message */
+    Ard_compact_meta_t *cmeta = handler_data;  /* compact metadata */
+    int *nbands = NULL;           /* number of bands in the tile/scene */
+    Ard_compact_band_meta_t **band = NULL;  /* bands in the tile/scene */
+    Ard_compact_band_meta_t *cband = NULL;  /* reallocated bands */
+
+    /* Find the tile or scene bands, adding the scene if needed */
+    if (cur_scene < 0)
+    {
+        nbands = &cmeta->tile_meta.nbands;
+        band = &cmeta->tile_meta.band;
+    }
+    else
+    {
+        if (cur_scene >= cmeta->nscenes &&
+            allocate_ard_compact_scenes (cmeta, cur_scene + 1) != SUCCESS)
+        {   /* Error messages already printed */
+            return (ERROR);
+        }
+        nbands = &cmeta->scene_meta[cur_scene].nbands;
+        band = &cmeta->scene_meta[cur_scene].band;
+    }
+
+    /* Start a new set of bands */
+    if (cur_band == 0)
+    {
+        free_ard_compact_band_metadata (*nbands, *band);
+        *nbands = 0;
+        *band = NULL;
+    }
+
+    /* Add the band */
+    cband = realloc (*band, (*nbands + 1) * sizeof (Ard_compact_band_meta_t));
+    if (cband == NULL)
+    {
+        sprintf (errmsg, "Reallocating compact metadata for %d bands",
+            *nbands + 1);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+    *band = cband;
+    (*nbands)++;
+
+    return (ard_band_to_compact (cmeta->pool, bmeta, &cband[*nbands - 1]));
+}
+
+
+/******************************************************************************
+MODULE:  parse_ard_compact_metadata
+
+PURPOSE: Parse the input metadata file directly into the compact metadata.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error parsing the metadata elements
+SUCCESS         Successful parse of the metadata values
+
+NOTES:
+1. The file is parsed via parse_ard_metadata_stream with each band converted
+   to the compact form as it is found, so at most one full band structure
+   exists at a time.  Only the global metadata is parsed into a temporary
+   ARD metadata structure before being converted.
+2. Any existing contents of the compact metadata are freed first.
+******************************************************************************/
+int parse_ard_compact_metadata
+(
+    Ard_parse_ctx_t *ctx,      /* I/O: parser context initialized via
+                                     init_ard_parse_ctx */
+    char *metafile,            /* I: input metadata file or URL */
+    Ard_compact_meta_t *cmeta  /* O: compact metadata, initialized via
+                                     init_ard_compact_metadata */
+)
+{
+    char FUNC_NAME[] = "parse_ard_compact_metadata";  /* function name */
+    char errmsg[STR_SIZE];        /* error message */
+    int i;                        /* looping variable */
+    int status;                   /* return status */
+    Ard_meta_t *ard_meta = NULL;  /* global metadata from the parse */
+
+    free_ard_compact_metadata (cmeta);
+
+    ard_meta = malloc (sizeof (Ard_meta_t));
+    if (ard_meta == NULL)
+    {
+        sprintf (errmsg, "Allocating the ARD metadata structure");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+    init_ard_metadata_struct (ard_meta);
+
+    /* Parse the file, handing the bands to the compact metadata */
+    ctx->band_handler = add_compact_band;
+    ctx->handler_data = cmeta;
+    status = parse_ard_metadata_stream (ctx, metafile, ard_meta);
+    ctx->band_handler = NULL;
+    ctx->handler_data = NULL;
+
+    /* Convert the global metadata */
+    if (status == SUCCESS)
+        status = allocate_ard_compact_scenes (cmeta, ard_meta->nscenes);
+    if (status == SUCCESS)
+        status = ard_intern_string (cmeta->pool, ard_meta->meta_namespace,
+            &cmeta->meta_namespace);
+    if (status == SUCCESS)
+        status = ard_tile_global_to_compact (cmeta->pool,
+            &ard_meta->tile_meta.tile_global, &cmeta->tile_meta.tile_global);
+    for (i = 0; status == SUCCESS && i < ard_meta->nscenes; i++)
+        status = ard_scene_global_to_compact (cmeta->pool,
+            &ard_meta->scene_meta[i].scene_global,
+            &cmeta->scene_meta[i].scene_global);
+
+    free_ard_metadata (ard_meta);
+    free (ard_meta);
+    if (status != SUCCESS)
+    {
+        sprintf (errmsg, "Parsing %s into the compact metadata", metafile);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    return (SUCCESS);
+}
@@ -23,8 +23,46 @@ NOTES:
 #include <libxml/xmlschemastypes.h>
 #include "ard_error_handler.h"
 #include "ard_metadata.h"
+#include "ard_compact_metadata.h"
 #include "meta_stack.h"
 
+/* Handler for each band found by the streaming parser.  cur_scene is -1 for
+   the tile bands and cur_band is the zero-based band within the current
+   bands section.  The band is only valid for the duration of the call. */
+typedef int (*Ard_band_handler_t)
+(
+    void *handler_data,     /* I/O: data passed through from the context */
+    int cur_scene,          /* I: current scene; -1 for the tile bands */
+    int cur_band,           /* I: current band in the bands section */
+    Ard_band_meta_t *bmeta  /* I: metadata for the current band */
+);
+
+/* Structure to hold the state of the parser for a single XML document.  Each
+   thread parsing XML documents concurrently needs its own parser context. */
+typedef struct
+{
+    Ard_meta_stack_t stack;  /* stack of elements for the current node */
+    int nbands;            /* number of bands in tile/scene container */
+    int cur_band;          /* current band being processed in the bands
+                              metadata section (zero-based) */
+    int cur_scene;         /* current scene being processed in the XML
+                              metadata (zero-based) */
+    bool tile_metadata;    /* are we parsing the tile-specific metadata
+                              section of the ARD metadata? */
+    bool scene_metadata;   /* are we parsing the scene-specific metadata
+                              section of the ARD metadata? */
+    bool global_metadata;  /* are we parsing the global metadata section of
+                              the ARD metadata? */
+    bool bands_metadata;   /* are we parsing the bands metadata section of
+                              the ARD metadata? */
+    Ard_scene_meta_t *scene_meta; /* pointer to the current scene-specific
+                              metadata */
+    Ard_band_handler_t band_handler;  /* if not NULL, the streaming parser
+                              hands each band to this handler rather than
+                              storing it in the ARD metadata */
+    void *handler_data;    /* data passed to the band handler */
+} Ard_parse_ctx_t;
+
 int add_global_ard_metadata_proj_info_albers
 (
     xmlNode *a_node,            /* I: pointer to the element node to process */
@@ -96,12 +134,53 @@ int add_ard_band_metadata
                                       band in the bands structure */
 );
 
+int init_ard_parse_ctx
+(
+    Ard_parse_ctx_t *ctx       /* O: parser context to be initialized */
+);
+
+void reset_ard_parse_ctx
+(
+    Ard_parse_ctx_t *ctx       /* I/O: parser context to be reset */
+);
+
+void free_ard_parse_ctx
+(
+    Ard_parse_ctx_t *ctx       /* I/O: parser context to be freed */
+);
+
 int parse_ard_xml_into_struct
 (
     xmlNode *a_node,           /* I: pointer to the current node */
     Ard_meta_t *ard_meta,      /* I: ARD metadata structure to be filled */
-    int *top_of_stack,         /* I: pointer to top of the stack */
-    char **stack               /* I: stack to use for parsing */
+    Ard_parse_ctx_t *ctx       /* I/O: parser context for this document */
+);
+
+int parse_ard_metadata_ctx
+(
+    Ard_parse_ctx_t *ctx, /* I/O: parser context initialized via
+                                init_ard_parse_ctx */
+    char *metafile,       /* I: input metadata file or URL */
+    Ard_meta_t *ard_meta  /* I: input ARD metadata structure which has been
+                                initialized via init_metadata_struct */
+);
+
+int parse_ard_metadata_stream
+(
+    Ard_parse_ctx_t *ctx, /* I/O: parser context initialized via
+                                init_ard_parse_ctx */
+    char *metafile,       /* I: input metadata file or URL */
+    Ard_meta_t *ard_meta  /* I: input ARD metadata structure which has been
+                                initialized via init_metadata_struct */
+);
+
+int parse_ard_compact_metadata
+(
+    Ard_parse_ctx_t *ctx,      /* I/O: parser context initialized via
+                                     init_ard_parse_ctx */
+    char *metafile,            /* I: input metadata file or URL */
+    Ard_compact_meta_t *cmeta  /* O: compact metadata, initialized via
+                                     init_ard_compact_metadata */
 );
 
 int parse_ard_metadata
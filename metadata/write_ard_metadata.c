@@ -18,18 +18,42 @@ NOTES:
 #include "write_ard_metadata.h"
 
 /******************************************************************************
-MODULE:  write_ard_proj_metadata
+MODULE:  write_ard_metadata_header
 
-PURPOSE: Write the ARD projection metadata to the open XML file
+PURPOSE: Write the overall ARD metadata header to the XML buffer
 
 RETURN VALUE: N/A
 
 NOTES:
 ******************************************************************************/
-void write_ard_proj_metadata
+static void write_ard_metadata_header
+(
+    Ard_xml_buf_t *xbuf      /* I/O: XML buffer to write to */
+)
+{
+    ard_xml_printf (xbuf,
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n\n"
+        "<ard_metadata version=\"%s\"\n"
+        "xmlns=\"%s\"\n"
+        "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n"
+        "xsi:schemaLocation=\"%s %s\">\n\n", ARD_SCHEMA_VERSION, ARD_NS,
+        ARD_SCHEMA_LOCATION, ARD_SCHEMA);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_proj_metadata_buf
+
+PURPOSE: Write the ARD projection metadata to the XML buffer
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void write_ard_proj_metadata_buf
 (
     Ard_proj_meta_t *proj_info, /* I: pointer to the projection information */
-    FILE *fptr               /* I: file pointer to the open XML metadata file */
+    Ard_xml_buf_t *xbuf      /* I/O: XML buffer to write to */
 )
 {
     char myproj[STR_SIZE];   /* projection type string */
@@ -54,18 +78,18 @@ void write_ard_proj_metadata
             case ARD_NAD27: strcpy (mydatum, "NAD27"); break;
             case ARD_NAD83: strcpy (mydatum, "NAD83"); break;
         }
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <projection_information projection=\"%s\" datum=\"%s\" "
             "units=\"%s\">\n", myproj, mydatum, proj_info->units);
     }
     else
     {
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <projection_information projection=\"%s\" units=\"%s\">\n",
             myproj, proj_info->units);
     }
 
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "            <corner_point location=\"UL\" x=\"%lf\" y=\"%lf\"/>\n"
         "            <corner_point location=\"LR\" x=\"%lf\" y=\"%lf\"/>\n"
         "            <grid_origin>%s</grid_origin>\n",
@@ -76,7 +100,7 @@ void write_ard_proj_metadata
     /* UTM-specific parameters */
     if (proj_info->proj_type == ARD_GCTP_UTM_PROJ)
     {
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "            <utm_proj_params>\n"
             "                <zone_code>%d</zone_code>\n"
             "            </utm_proj_params>\n",
@@ -86,7 +110,7 @@ void write_ard_proj_metadata
     /* ALBERS-specific parameters */
     if (proj_info->proj_type == ARD_GCTP_ALBERS_PROJ)
     {
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "            <albers_proj_params>\n"
             "                <standard_parallel1>%lf</standard_parallel1>\n"
             "                <standard_parallel2>%lf</standard_parallel2>\n"
@@ -106,7 +130,7 @@ void write_ard_proj_metadata
     /* PS-specific parameters */
     if (proj_info->proj_type == ARD_GCTP_PS_PROJ)
     {
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "            <ps_proj_params>\n"
             "                <longitude_pole>%lf</longitude_pole>\n"
             "                <latitude_true_scale>%lf</latitude_true_scale>\n"
@@ -122,7 +146,7 @@ void write_ard_proj_metadata
     /* SIN-specific parameters */
     if (proj_info->proj_type == ARD_GCTP_SIN_PROJ)
     {
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "            <sin_proj_params>\n"
             "                <sphere_radius>%lf</sphere_radius>\n"
             "                <central_meridian>%lf</central_meridian>\n"
@@ -135,26 +159,26 @@ void write_ard_proj_metadata
             proj_info->false_northing);
     }
 
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "        </projection_information>\n");
 }
 
 
 /******************************************************************************
-MODULE:  write_ard_band_metadata
+MODULE:  write_ard_band_metadata_buf
 
-PURPOSE: Write the ARD band metadata structure to the open XML file
+PURPOSE: Write the ARD band metadata structure to the XML buffer
 
 RETURN VALUE: N/A
 
 NOTES:
 ******************************************************************************/
-void write_ard_band_metadata
+void write_ard_band_metadata_buf
 (
     int nbands,              /* I: number of bands to be written */
     Ard_band_meta_t *bmeta,  /* I: pointer to the array of either tile or
                                    scene band metadata */
-    FILE *fptr,              /* I: file pointer to the open XML metadata file */
+    Ard_xml_buf_t *xbuf,     /* I/O: XML buffer to write to */
     bool skip_bands_cntnr    /* I: skip writing the opening and closing bands
                                    container information <bands> and </bands>,
                                    in the event the bands are going to be
@@ -168,7 +192,7 @@ void write_ard_band_metadata
     /* Write the bands metadata */
     if (!skip_bands_cntnr)
     {
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "    <bands>\n");
     }
 
@@ -199,36 +223,36 @@ void write_ard_band_metadata
         }
 
         /* Start with the required band attributes */
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <band product=\"%s\" ", bmeta[i].product);
 
         if (strcmp (bmeta[i].source, ARD_STRING_META_FILL))
-            fprintf (fptr, "source=\"%s\" ", bmeta[i].source);
+            ard_xml_printf (xbuf, "source=\"%s\" ", bmeta[i].source);
 
-        fprintf (fptr, "name=\"%s\" category=\"%s\" data_type=\"%s\"",
+        ard_xml_printf (xbuf, "name=\"%s\" category=\"%s\" data_type=\"%s\"",
             bmeta[i].name, bmeta[i].category, my_dtype);
 
         /* If nlines is valid then assume nsamps is also valid since they go
            hand-in-hand */
         if (bmeta[i].nlines != ARD_INT_META_FILL)
-            fprintf (fptr, " nlines=\"%d\" nsamps=\"%d\"",
+            ard_xml_printf (xbuf, " nlines=\"%d\" nsamps=\"%d\"",
                 bmeta[i].nlines, bmeta[i].nsamps);
 
         /* Handle the rest of the optional attributes */
         if (bmeta[i].fill_value != ARD_INT_META_FILL)
-            fprintf (fptr, " fill_value=\"%ld\"", bmeta[i].fill_value);
+            ard_xml_printf (xbuf, " fill_value=\"%ld\"", bmeta[i].fill_value);
         if (bmeta[i].saturate_value != ARD_INT_META_FILL)
-            fprintf (fptr, " saturate_value=\"%d\"", bmeta[i].saturate_value);
+            ard_xml_printf (xbuf, " saturate_value=\"%d\"", bmeta[i].saturate_value);
         if (fabs (bmeta[i].scale_factor-ARD_FLOAT_META_FILL) > ARD_EPSILON)
-            fprintf (fptr, " scale_factor=\"%f\"", bmeta[i].scale_factor);
+            ard_xml_printf (xbuf, " scale_factor=\"%f\"", bmeta[i].scale_factor);
         if (fabs (bmeta[i].add_offset-ARD_FLOAT_META_FILL) > ARD_EPSILON)
-            fprintf (fptr, " add_offset=\"%f\"", bmeta[i].add_offset);
+            ard_xml_printf (xbuf, " add_offset=\"%f\"", bmeta[i].add_offset);
 
         /* Close out the band and attributes */
-        fprintf (fptr, ">\n");
+        ard_xml_printf (xbuf, ">\n");
 
         /* Print the required band elements */
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "            <short_name>%s</short_name>\n"
             "            <long_name>%s</long_name>\n"
             "            <file_name>%s</file_name>\n"
@@ -245,49 +269,49 @@ void write_ard_band_metadata
             fabs (bmeta[i].valid_range[1] - ARD_FLOAT_META_FILL) >
             ARD_EPSILON)
         {
-            fprintf (fptr,
+            ard_xml_printf (xbuf,
                 "            <valid_range min=\"%f\" max=\"%f\"/>\n",
                 bmeta[i].valid_range[0], bmeta[i].valid_range[1]);
         }
 
         if (bmeta[i].nbits != ARD_INT_META_FILL && bmeta[i].nbits > 0)
         {
-            fprintf (fptr,
+            ard_xml_printf (xbuf,
                 "            <bitmap_description>\n");
             for (j = 0; j < bmeta[i].nbits; j++)
             {
-                fprintf (fptr,
+                ard_xml_printf (xbuf,
                     "                <bit num=\"%d\">%s</bit>\n",
                     j, bmeta[i].bitmap_description[j]);
             }
-            fprintf (fptr,
+            ard_xml_printf (xbuf,
                 "            </bitmap_description>\n");
         }
 
         if (bmeta[i].nclass != ARD_INT_META_FILL && bmeta[i].nclass > 0)
         {
-            fprintf (fptr,
+            ard_xml_printf (xbuf,
                 "            <class_values>\n");
             for (j = 0; j < bmeta[i].nclass; j++)
             {
-                fprintf (fptr,
+                ard_xml_printf (xbuf,
                     "                <class num=\"%d\">%s</class>\n",
                      bmeta[i].class_values[j].class,
                      bmeta[i].class_values[j].description);
             }
-            fprintf (fptr,
+            ard_xml_printf (xbuf,
                 "            </class_values>\n");
         }
 
         /* Close out the current band */
         if (strcmp (bmeta[i].app_version, ARD_STRING_META_FILL))
         {
-            fprintf (fptr,
+            ard_xml_printf (xbuf,
                 "            <app_version>%s</app_version>\n",
                 bmeta[i].app_version);
         }
 
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "            <production_date>%s</production_date>\n"
             "        </band>\n",
             bmeta[i].production_date);
@@ -296,85 +320,39 @@ void write_ard_band_metadata
     /* End bands metadata unless otherwise specified */
     if (!skip_bands_cntnr)
     {
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "    </bands>\n");
     }
 }
 
 
 /******************************************************************************
-MODULE:  write_ard_metadata
+MODULE:  write_ard_tile_global_metadata_buf
 
-PURPOSE: Write the ARD metadata structure to the specified XML metadata file
+PURPOSE: Write the ARD tile-based global metadata to the XML buffer
 
-RETURN VALUE:
-Type = int
-Value           Description
------           -----------
-ERROR           Error writing the metadata file
-SUCCESS         Successfully wrote the metadata file
+RETURN VALUE: N/A
 
 NOTES:
-  1. If the XML file specified already exists, it will be overwritten.
-  2. Use this routine to create a new metadata file.  To append bands to an
-     existing metadata file, use append_tile_bands_ard_metadata.
-  3. It is recommended that validate_meta be used after writing the XML file
-     to make sure the new file is valid against the ARD schema.
 ******************************************************************************/
-int write_ard_metadata
+void write_ard_tile_global_metadata_buf
 (
-    Ard_meta_t *ard_meta,      /* I: input ARD metadata structure to be written
-                                     to XML */
-    char *xml_file             /* I: name of the XML metadata file to be
-                                     written to or overwritten */
+    Ard_global_tile_meta_t *tile_gmeta, /* I: pointer to the tile-based global
+                                              metadata */
+    Ard_xml_buf_t *xbuf      /* I/O: XML buffer to write to */
 )
 {
-    char FUNC_NAME[] = "write_ard_metadata";   /* function name */
-    char errmsg[STR_SIZE];   /* error message */
-    char myelev[STR_SIZE];   /* elevation source string */
-    char mysensor[STR_SIZE]; /* sensor mode string */
-    char myephem[STR_SIZE];  /* ephemeris type string */
-    int i;                   /* looping variables */
-    FILE *fptr = NULL;       /* file pointer to the XML metadata file */
-    Ard_global_tile_meta_t *tile_gmeta = &ard_meta->tile_meta.tile_global;
-                             /* ptr to tile-based global metadata structure */
-    Ard_global_scene_meta_t *scene_gmeta = NULL;
-                             /* ptr to scene-based global metadata structure */
-
-    /* Open the metadata XML file for write or rewrite privelages */
-    fptr = fopen (xml_file, "w");
-    if (fptr == NULL)
-    {
-        sprintf (errmsg, "Opening %s for write access.", xml_file);
-        ard_error_handler (true, FUNC_NAME, errmsg);
-        return (ERROR);
-    }
-
-    /* Write the overall header */
-    fprintf (fptr,
-        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n\n"
-        "<ard_metadata version=\"%s\"\n"
-        "xmlns=\"%s\"\n"
-        "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n"
-        "xsi:schemaLocation=\"%s %s\">\n\n", ARD_SCHEMA_VERSION, ARD_NS,
-        ARD_SCHEMA_LOCATION, ARD_SCHEMA);
-
-    /* Write the tile metadata header */
-    fprintf (fptr,
-        "<tile_metadata>\n");
-
-    /* Write the global tile metadata */
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "    <global_metadata>\n"
         "        <data_provider>%s</data_provider>\n"
         "        <satellite>%s</satellite>\n",
         tile_gmeta->data_provider, tile_gmeta->satellite);
 
     if (strcmp (tile_gmeta->instrument, "undefined"))
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <instrument>%s</instrument>\n", tile_gmeta->instrument);
 
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "        <level1_collection>%s</level1_collection>\n"
         "        <ard_version>%s</ard_version>\n"
         "        <region>%s</region>\n",
@@ -382,25 +360,25 @@ int write_ard_metadata
         tile_gmeta->ard_version, tile_gmeta->region);
 
     if (strcmp (tile_gmeta->acquisition_date, "undefined"))
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <acquisition_date>%s</acquisition_date>\n",
             tile_gmeta->acquisition_date);
 
     if (strcmp (tile_gmeta->start_date, "undefined") &&
         strcmp (tile_gmeta->end_date, "undefined"))
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <date_range end=\"%s\" start=\"%s\"/>\n",
             tile_gmeta->end_date, tile_gmeta->start_date);
 
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "        <product_id>%s</product_id>\n",
         tile_gmeta->product_id);
 
     if (strcmp (tile_gmeta->description, "undefined"))
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <description>%s</description>\n", tile_gmeta->description);
 
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "        <production_date>%s</production_date>\n"
         "        <bounding_coordinates>\n"
         "            <west>%lf</west>\n"
@@ -415,46 +393,302 @@ int write_ard_metadata
         tile_gmeta->bounding_coords[ARD_SOUTH]);
 
     /* Write the projection information */
-    write_ard_proj_metadata (&tile_gmeta->proj_info, fptr);
+    write_ard_proj_metadata_buf (&tile_gmeta->proj_info, xbuf);
 
     /* Continue with the global metadata */
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "        <orientation_angle>%f</orientation_angle>\n"
         "        <tile_grid h=\"%03d\" v=\"%03d\"/>\n",
         tile_gmeta->orientation_angle, tile_gmeta->htile, tile_gmeta->vtile);
 
     if (tile_gmeta->scene_count != ARD_INT_META_FILL)
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <scene_count>%d</scene_count>\n",
             tile_gmeta->scene_count);
 
     if (fabs (tile_gmeta->cloud_cover - ARD_FLOAT_META_FILL) > ARD_EPSILON)
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <cloud_cover>%f</cloud_cover>\n", tile_gmeta->cloud_cover);
 
     if (fabs (tile_gmeta->cloud_shadow - ARD_FLOAT_META_FILL) > ARD_EPSILON)
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <cloud_shadow>%f</cloud_shadow>\n",
             tile_gmeta->cloud_shadow);
 
     if (fabs (tile_gmeta->snow_ice - ARD_FLOAT_META_FILL) > ARD_EPSILON)
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <snow_ice>%f</snow_ice>\n", tile_gmeta->snow_ice);
 
     if (fabs (tile_gmeta->fill - ARD_FLOAT_META_FILL) > ARD_EPSILON)
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "        <fill>%f</fill>\n", tile_gmeta->fill);
 
     /* End global tile metadata */
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "    </global_metadata>\n\n");
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_scene_global_metadata_buf
+
+PURPOSE: Write the ARD scene-based global metadata to the XML buffer
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void write_ard_scene_global_metadata_buf
+(
+    Ard_global_scene_meta_t *scene_gmeta, /* I: pointer to the scene-based
+                                                global metadata */
+    Ard_xml_buf_t *xbuf      /* I/O: XML buffer to write to */
+)
+{
+    char myelev[STR_SIZE];   /* elevation source string */
+    char mysensor[STR_SIZE]; /* sensor mode string */
+    char myephem[STR_SIZE];  /* ephemeris type string */
+
+    /* Get the elevation source type */
+    switch (scene_gmeta->elevation_src)
+    {
+        case ARD_NED: strcpy (myelev, "NED"); break;
+        case ARD_SRTM: strcpy (myelev, "SRTM"); break;
+        case ARD_GTOPO30: strcpy (myelev, "GTOPO30"); break;
+        case ARD_GLS2000: strcpy (myelev, "GLS2000"); break;
+        case ARD_RAMP: strcpy (myelev, "RAMP"); break;
+        default: strcpy (myelev, "undefined"); break;
+    }
+
+    switch (scene_gmeta->sensor_mode)
+    {
+        case ARD_SAM: strcpy (mysensor, "SAM"); break;
+        case ARD_BUMPER: strcpy (mysensor, "BUMPER"); break;
+        default: strcpy (mysensor, "undefined"); break;
+    }
+
+    switch (scene_gmeta->ephemeris_type)
+    {
+        case ARD_DEFINITIVE: strcpy (myephem, "DEFINITIVE"); break;
+        case ARD_PREDICTIVE: strcpy (myephem, "PREDICTIVE"); break;
+        default: strcpy (myephem, "undefined"); break;
+    }
+
+    /* Write the global scene metadata */
+    ard_xml_printf (xbuf,
+        "    <global_metadata>\n"
+        "        <data_provider>%s</data_provider>\n"
+        "        <satellite>%s</satellite>\n"
+        "        <instrument>%s</instrument>\n"
+        "        <acquisition_date>%s</acquisition_date>\n"
+        "        <scene_center_time>%s</scene_center_time>\n"
+        "        <level1_production_date>%s</level1_production_date>\n"
+        "        <wrs system=\"%d\" path=\"%d\" row=\"%d\"/>\n"
+        "        <request_id>%s</request_id>\n"
+        "        <scene_id>%s</scene_id>\n"
+        "        <product_id>%s</product_id>\n"
+        "        <elevation_source>%s</elevation_source>\n",
+        scene_gmeta->data_provider, scene_gmeta->satellite,
+        scene_gmeta->instrument, scene_gmeta->acquisition_date,
+        scene_gmeta->scene_center_time, scene_gmeta->level1_production_date,
+        scene_gmeta->wrs_system, scene_gmeta->wrs_path,
+        scene_gmeta->wrs_row, scene_gmeta->request_id,
+        scene_gmeta->scene_id, scene_gmeta->product_id, myelev);
+
+    if (strcmp (mysensor, "undefined"))
+        ard_xml_printf (xbuf,
+            "        <sensor_mode>%s</sensor_mode>\n", mysensor);
+
+    if (strcmp (myephem, "undefined"))
+        ard_xml_printf (xbuf,
+            "        <ephemeris_type>%s</ephemeris_type>\n", myephem);
+
+    ard_xml_printf (xbuf,
+        "        <cpf_name>%s</cpf_name>\n"
+        "        <lpgs_metadata_file>%s</lpgs_metadata_file>\n",
+        scene_gmeta->cpf_name, scene_gmeta->lpgs_metadata_file);
+
+    if (fabs (scene_gmeta->geometric_rmse_model - ARD_FLOAT_META_FILL) >
+        ARD_EPSILON)
+    {
+        ard_xml_printf (xbuf,
+            "        <geometric_rmse_model>%f</geometric_rmse_model>\n",
+            scene_gmeta->geometric_rmse_model);
+    }
+
+    if (fabs (scene_gmeta->geometric_rmse_model_x - ARD_FLOAT_META_FILL) >
+        ARD_EPSILON)
+    {
+        ard_xml_printf (xbuf,
+            "        <geometric_rmse_model_x>%f</geometric_rmse_model_x>\n",
+            scene_gmeta->geometric_rmse_model_x);
+    }
+
+    if (fabs (scene_gmeta->geometric_rmse_model_y - ARD_FLOAT_META_FILL) >
+        ARD_EPSILON)
+    {
+        ard_xml_printf (xbuf,
+            "        <geometric_rmse_model_y>%f</geometric_rmse_model_y>\n",
+            scene_gmeta->geometric_rmse_model_y);
+    }
+
+    ard_xml_printf (xbuf,
+        "    </global_metadata>\n\n");
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_proj_metadata
+
+PURPOSE: Write the ARD projection metadata to the open XML file
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void write_ard_proj_metadata
+(
+    Ard_proj_meta_t *proj_info, /* I: pointer to the projection information */
+    FILE *fptr               /* I: file pointer to the open XML metadata file */
+)
+{
+    char mem[ARD_XML_FILE_BUF_SIZE];  /* output buffer */
+    Ard_xml_buf_t xbuf;      /* XML buffer flushed to the file */
+
+    init_ard_xml_buf_fixed (&xbuf, mem, sizeof (mem), fptr);
+    write_ard_proj_metadata_buf (proj_info, &xbuf);
+    flush_ard_xml_buf (&xbuf);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_band_metadata
+
+PURPOSE: Write the ARD band metadata structure to the open XML file
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void write_ard_band_metadata
+(
+    int nbands,              /* I: number of bands to be written */
+    Ard_band_meta_t *bmeta,  /* I: pointer to the array of either tile or
+                                   scene band metadata */
+    FILE *fptr,              /* I: file pointer to the open XML metadata file */
+    bool skip_bands_cntnr    /* I: skip writing the opening and closing bands
+                                   container information <bands> and </bands>,
+                                   in the event the bands are going to be
+                                   appended to */
+)
+{
+    char mem[ARD_XML_FILE_BUF_SIZE];  /* output buffer */
+    Ard_xml_buf_t xbuf;      /* XML buffer flushed to the file */
+
+    init_ard_xml_buf_fixed (&xbuf, mem, sizeof (mem), fptr);
+    write_ard_band_metadata_buf (nbands, bmeta, &xbuf, skip_bands_cntnr);
+    flush_ard_xml_buf (&xbuf);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_tile_global_metadata
+
+PURPOSE: Write the ARD tile-based global metadata to the open XML file
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void write_ard_tile_global_metadata
+(
+    Ard_global_tile_meta_t *tile_gmeta, /* I: pointer to the tile-based global
+                                              metadata */
+    FILE *fptr               /* I: file pointer to the open XML metadata file */
+)
+{
+    char mem[ARD_XML_FILE_BUF_SIZE];  /* output buffer */
+    Ard_xml_buf_t xbuf;      /* XML buffer flushed to the file */
+
+    init_ard_xml_buf_fixed (&xbuf, mem, sizeof (mem), fptr);
+    write_ard_tile_global_metadata_buf (tile_gmeta, &xbuf);
+    flush_ard_xml_buf (&xbuf);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_scene_global_metadata
+
+PURPOSE: Write the ARD scene-based global metadata to the open XML file
+
+RETURN VALUE: N/A
+
+NOTES:
+******************************************************************************/
+void write_ard_scene_global_metadata
+(
+    Ard_global_scene_meta_t *scene_gmeta, /* I: pointer to the scene-based
+                                                global metadata */
+    FILE *fptr               /* I: file pointer to the open XML metadata file */
+)
+{
+    char mem[ARD_XML_FILE_BUF_SIZE];  /* output buffer */
+    Ard_xml_buf_t xbuf;      /* XML buffer flushed to the file */
+
+    init_ard_xml_buf_fixed (&xbuf, mem, sizeof (mem), fptr);
+    write_ard_scene_global_metadata_buf (scene_gmeta, &xbuf);
+    flush_ard_xml_buf (&xbuf);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_metadata_buf
+
+PURPOSE: Write the ARD metadata structure to the XML buffer
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error writing the metadata to the buffer
+SUCCESS         Successfully wrote the metadata to the buffer
+
+NOTES:
+  1. The metadata is appended to the buffer.  The buffer can then be written
+     to a file or file descriptor via write_ard_xml_buf_file or
+     write_ard_xml_buf_fd, or used directly if it was supplied by the caller.
+******************************************************************************/
+int write_ard_metadata_buf
+(
+    Ard_meta_t *ard_meta,      /* I: input ARD metadata structure to be written
+                                     to XML */
+    Ard_xml_buf_t *xbuf        /* I/O: XML buffer to write to */
+)
+{
+    char FUNC_NAME[] = "write_ard_metadata_buf";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    int i;                   /* looping variables */
+    Ard_global_tile_meta_t *tile_gmeta = &ard_meta->tile_meta.tile_global;
+                             /* ptr to tile-based global metadata structure */
+    Ard_global_scene_meta_t *scene_gmeta = NULL;
+                             /* ptr to scene-based global metadata structure */
+
+    /* Write the overall header */
+    write_ard_metadata_header (xbuf);
+
+    /* Write the tile metadata header */
+    ard_xml_printf (xbuf,
+        "<tile_metadata>\n");
+
+    /* Write the global tile metadata */
+    write_ard_tile_global_metadata_buf (tile_gmeta, xbuf);
 
     /* Write the tile-based band metadata and close the bands */
-    write_ard_band_metadata (ard_meta->tile_meta.nbands,
-        ard_meta->tile_meta.band, fptr, false);
+    write_ard_band_metadata_buf (ard_meta->tile_meta.nbands,
+        ard_meta->tile_meta.band, xbuf, false);
 
     /* End tile metadata */
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "</tile_metadata>\n");
 
     /* Loop through each scene in the overall tile and write the scene-based
@@ -465,113 +699,333 @@ int write_ard_metadata
         scene_gmeta = &ard_meta->scene_meta[i].scene_global;
 
         /* Write the scene metadata header */
-        fprintf (fptr,
+        ard_xml_printf (xbuf,
             "\n<scene_metadata>\n"
             "    <index>%d</index>\n", i+1);
 
-        /* Get the elevation source type */
-        switch (scene_gmeta->elevation_src)
-        {
-            case ARD_NED: strcpy (myelev, "NED"); break;
-            case ARD_SRTM: strcpy (myelev, "SRTM"); break;
-            case ARD_GTOPO30: strcpy (myelev, "GTOPO30"); break;
-            case ARD_GLS2000: strcpy (myelev, "GLS2000"); break;
-            case ARD_RAMP: strcpy (myelev, "RAMP"); break;
-            default: strcpy (myelev, "undefined"); break;
-        }
+        /* Write the global scene metadata */
+        write_ard_scene_global_metadata_buf (scene_gmeta, xbuf);
 
-        switch (scene_gmeta->sensor_mode)
-        {
-            case ARD_SAM: strcpy (mysensor, "SAM"); break;
-            case ARD_BUMPER: strcpy (mysensor, "BUMPER"); break;
-            default: strcpy (mysensor, "undefined"); break;
-        }
+        /* Write the scene-based band metadata and close the bands */
+        write_ard_band_metadata_buf (ard_meta->scene_meta[i].nbands,
+            ard_meta->scene_meta[i].band, xbuf, false);
 
-        switch (scene_gmeta->ephemeris_type)
-        {
-            case ARD_DEFINITIVE: strcpy (myephem, "DEFINITIVE"); break;
-            case ARD_PREDICTIVE: strcpy (myephem, "PREDICTIVE"); break;
-            default: strcpy (myephem, "undefined"); break;
-        }
+        /* End scene metadata */
+        ard_xml_printf (xbuf,
+            "</scene_metadata>\n");
+    } /* end nscenes */
 
-        /* Write the global scene metadata */
-        fprintf (fptr,
-            "    <global_metadata>\n"
-            "        <data_provider>%s</data_provider>\n"
-            "        <satellite>%s</satellite>\n"
-            "        <instrument>%s</instrument>\n"
-            "        <acquisition_date>%s</acquisition_date>\n"
-            "        <scene_center_time>%s</scene_center_time>\n"
-            "        <level1_production_date>%s</level1_production_date>\n"
-            "        <wrs system=\"%d\" path=\"%d\" row=\"%d\"/>\n"
-            "        <request_id>%s</request_id>\n"
-            "        <scene_id>%s</scene_id>\n"
-            "        <product_id>%s</product_id>\n"
-            "        <elevation_source>%s</elevation_source>\n",
-            scene_gmeta->data_provider, scene_gmeta->satellite,
-            scene_gmeta->instrument, scene_gmeta->acquisition_date,
-            scene_gmeta->scene_center_time, scene_gmeta->level1_production_date,
-            scene_gmeta->wrs_system, scene_gmeta->wrs_path,
-            scene_gmeta->wrs_row, scene_gmeta->request_id,
-            scene_gmeta->scene_id, scene_gmeta->product_id, myelev);
-
-        if (strcmp (mysensor, "undefined"))
-            fprintf (fptr,
-                "        <sensor_mode>%s</sensor_mode>\n", mysensor);
-
-        if (strcmp (myephem, "undefined"))
-            fprintf (fptr,
-                "        <ephemeris_type>%s</ephemeris_type>\n", myephem);
-
-        fprintf (fptr,
-            "        <cpf_name>%s</cpf_name>\n"
-            "        <lpgs_metadata_file>%s</lpgs_metadata_file>\n",
-            scene_gmeta->cpf_name, scene_gmeta->lpgs_metadata_file);
-
-        if (fabs (scene_gmeta->geometric_rmse_model - ARD_FLOAT_META_FILL) >
-            ARD_EPSILON)
-        {
-            fprintf (fptr,
-                "        <geometric_rmse_model>%f</geometric_rmse_model>\n",
-                scene_gmeta->geometric_rmse_model);
-        }
+    /* End of the overall ARD metadata container */
+    ard_xml_printf (xbuf,
+        "</ard_metadata>\n");
 
-        if (fabs (scene_gmeta->geometric_rmse_model_x - ARD_FLOAT_META_FILL) >
-            ARD_EPSILON)
-        {
-            fprintf (fptr,
-                "        <geometric_rmse_model_x>%f</geometric_rmse_model_x>\n",
-                scene_gmeta->geometric_rmse_model_x);
-        }
+    if (xbuf->status != SUCCESS)
+    {
+        sprintf (errmsg, "Writing the ARD metadata to the XML buffer");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
 
-        if (fabs (scene_gmeta->geometric_rmse_model_y - ARD_FLOAT_META_FILL) >
-            ARD_EPSILON)
-        {
-            fprintf (fptr,
-                "        <geometric_rmse_model_y>%f</geometric_rmse_model_y>\n",
-                scene_gmeta->geometric_rmse_model_y);
+    /* Successful generation */
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_metadata
+
+PURPOSE: Write the ARD metadata structure to the specified XML metadata file
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error writing the metadata file
+SUCCESS         Successfully wrote the metadata file
+
+NOTES:
+  1. If the XML file specified already exists, it will be overwritten.
+  2. Use this routine to create a new metadata file.  To append bands to an
+     existing metadata file, use append_tile_bands_ard_metadata.
+  3. It is recommended that validate_meta be used after writing the XML file
+     to make sure the new file is valid against the ARD schema.
+  4. The XML is built in memory and written to the file in a single write.
+******************************************************************************/
+int write_ard_metadata
+(
+    Ard_meta_t *ard_meta,      /* I: input ARD metadata structure to be written
+                                     to XML */
+    char *xml_file             /* I: name of the XML metadata file to be
+                                     written to or overwritten */
+)
+{
+    char FUNC_NAME[] = "write_ard_metadata";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    Ard_xml_buf_t xbuf;      /* XML buffer for the metadata */
+
+    if (init_ard_xml_buf (&xbuf, 0) != SUCCESS)
+    {   /* Error messages already printed */
+        return (ERROR);
+    }
+
+    if (write_ard_metadata_buf (ard_meta, &xbuf) != SUCCESS ||
+        write_ard_xml_buf_file (&xbuf, xml_file) != SUCCESS)
+    {
+        free_ard_xml_buf (&xbuf);
+        sprintf (errmsg, "Writing the ARD metadata to %s", xml_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Free the buffer */
+    free_ard_xml_buf (&xbuf);
+
+    /* Successful generation */
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_metadata_fd
+
+PURPOSE: Write the ARD metadata structure to an open file descriptor
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error writing the metadata
+SUCCESS         Successfully wrote the metadata
+
+NOTES:
+  1. The XML is built in memory and written to the file descriptor in a single
+     write.  The file descriptor is left open.
+******************************************************************************/
+int write_ard_metadata_fd
+(
+    Ard_meta_t *ard_meta,      /* I: input ARD metadata structure to be written
+                                     to XML */
+    int fd                     /* I: open file descriptor to write to */
+)
+{
+    char FUNC_NAME[] = "write_ard_metadata_fd";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    Ard_xml_buf_t xbuf;      /* XML buffer for the metadata */
+
+    if (init_ard_xml_buf (&xbuf, 0) != SUCCESS)
+    {   /* Error messages already printed */
+        return (ERROR);
+    }
+
+    if (write_ard_metadata_buf (ard_meta, &xbuf) != SUCCESS ||
+        write_ard_xml_buf_fd (&xbuf, fd) != SUCCESS)
+    {
+        free_ard_xml_buf (&xbuf);
+        sprintf (errmsg, "Writing the ARD metadata to file descriptor %d", fd);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Free the buffer */
+    free_ard_xml_buf (&xbuf);
+
+    /* Successful generation */
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  write_ard_compact_bands
+
+PURPOSE: Write the compact band metadata to the XML buffer, one band at a
+time
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error writing the bands
+SUCCESS         Successfully wrote the bands
+
+NOTES:
+******************************************************************************/
+static int write_ard_compact_bands
+(
+    Ard_string_pool_t *pool,        /* I: string pool */
+    int nbands,                     /* I: number of bands to be written */
+    Ard_compact_band_meta_t *cband, /* I: array of compact band metadata */
+    Ard_band_meta_t *bmeta,         /* I/O: band to use for each band */
+    Ard_xml_buf_t *xbuf             /* I/O: XML buffer to write to */
+)
+{
+    int i;                   /* looping variable */
+
+    ard_xml_printf (xbuf,
+        "    <bands>\n");
+
+    for (i = 0; i < nbands; i++)
+    {
+        if (ard_compact_to_band (pool, &cband[i], bmeta) != SUCCESS)
+        {   /* Error messages already printed */
+            clear_ard_band_metadata (bmeta);
+            return (ERROR);
         }
+        write_ard_band_metadata_buf (1, bmeta, xbuf, true);
+        clear_ard_band_metadata (bmeta);
+    }
 
-        fprintf (fptr,
-            "    </global_metadata>\n\n");
+    ard_xml_printf (xbuf,
+        "    </bands>\n");
 
-        /* Write the scene-based band metadata and close the bands */
-        write_ard_band_metadata (ard_meta->scene_meta[i].nbands,
-            ard_meta->scene_meta[i].band, fptr, false);
+    return (SUCCESS);
+}
 
-        /* End scene metadata */
-        fprintf (fptr,
+
+/******************************************************************************
+MODULE:  write_ard_compact_metadata_buf
+
+PURPOSE: Write the compact metadata to the XML buffer
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error writing the metadata to the buffer
+SUCCESS         Successfully wrote the metadata to the buffer
+
+NOTES:
+  1. The output is the same as write_ard_metadata_buf for the equivalent ARD
+     metadata.  Each band and global metadata section is expanded into a
+     single temporary structure as it is written, so the full ARD metadata
+     structure is never built.
+******************************************************************************/
+int write_ard_compact_metadata_buf
+(
+    Ard_compact_meta_t *cmeta, /* I: compact metadata to be written to XML */
+    Ard_xml_buf_t *xbuf        /* I/O: XML buffer to write to */
+)
+{
+    char FUNC_NAME[] = "write_ard_compact_metadata_buf";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    int i;                   /* looping variable */
+    int status = SUCCESS;    /* return status */
+    Ard_global_tile_meta_t *tile_gmeta = NULL;
+                             /* tile-based global metadata for writing */
+    Ard_global_scene_meta_t *scene_gmeta = NULL;
+                             /* scene-based global metadata for writing */
+    Ard_band_meta_t *bmeta = NULL;  /* band metadata for writing */
+
+    /* Allocate the temporary structures */
+    tile_gmeta = malloc (sizeof (Ard_global_tile_meta_t));
+    scene_gmeta = malloc (sizeof (Ard_global_scene_meta_t));
+    bmeta = malloc (sizeof (Ard_band_meta_t));
+    if (tile_gmeta == NULL || scene_gmeta == NULL || bmeta == NULL)
+    {
+        free (tile_gmeta);
+        free (scene_gmeta);
+        free (bmeta);
+        sprintf (errmsg, "Allocating the metadata structures for writing");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+    init_ard_band_metadata (bmeta, 0, 1);
+
+    /* Write the overall header */
+    write_ard_metadata_header (xbuf);
+
+    /* Write the tile metadata */
+    ard_xml_printf (xbuf,
+        "<tile_metadata>\n");
+    ard_compact_to_tile_global (cmeta->pool, &cmeta->tile_meta.tile_global,
+        tile_gmeta);
+    write_ard_tile_global_metadata_buf (tile_gmeta, xbuf);
+    status = write_ard_compact_bands (cmeta->pool, cmeta->tile_meta.nbands,
+        cmeta->tile_meta.band, bmeta, xbuf);
+    ard_xml_printf (xbuf,
+        "</tile_metadata>\n");
+
+    /* Write the scene metadata */
+    for (i = 0; status == SUCCESS && i < cmeta->nscenes; i++)
+    {
+        ard_xml_printf (xbuf,
+            "\n<scene_metadata>\n"
+            "    <index>%d</index>\n", i+1);
+        ard_compact_to_scene_global (cmeta->pool,
+            &cmeta->scene_meta[i].scene_global, scene_gmeta);
+        write_ard_scene_global_metadata_buf (scene_gmeta, xbuf);
+        status = write_ard_compact_bands (cmeta->pool,
+            cmeta->scene_meta[i].nbands, cmeta->scene_meta[i].band, bmeta,
+            xbuf);
+        ard_xml_printf (xbuf,
             "</scene_metadata>\n");
-    } /* end nscenes */
+    }
 
     /* End of the overall ARD metadata container */
-    fprintf (fptr,
+    ard_xml_printf (xbuf,
         "</ard_metadata>\n");
 
-    /* Close the XML file */
-    fclose (fptr);
+    /* Free the temporary structures */
+    free (tile_gmeta);
+    free (scene_gmeta);
+    free (bmeta);
+
+    if (status != SUCCESS || xbuf->status != SUCCESS)
+    {
+        sprintf (errmsg, "Writing the compact metadata to the XML buffer");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
 
     /* Successful generation */
     return (SUCCESS);
 }
 
+
+/******************************************************************************
+MODULE:  write_ard_compact_metadata
+
+PURPOSE: Write the compact metadata to the specified XML metadata file
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error writing the metadata file
+SUCCESS         Successfully wrote the metadata file
+
+NOTES:
+  1. The output is the same as write_ard_metadata for the equivalent ARD
+     metadata.
+  2. If the XML file specified already exists, it will be overwritten.
+******************************************************************************/
+int write_ard_compact_metadata
+(
+    Ard_compact_meta_t *cmeta, /* I: compact metadata to be written to XML */
+    char *xml_file             /* I: name of the XML metadata file to be
+                                     written to or overwritten */
+)
+{
+    char FUNC_NAME[] = "write_ard_compact_metadata";   /* function name */
+    char errmsg[STR_SIZE];   /* error message */
+    Ard_xml_buf_t xbuf;      /* XML buffer for the metadata */
+
+    if (init_ard_xml_buf (&xbuf, 0) != SUCCESS)
+    {   /* Error messages already printed */
+        return (ERROR);
+    }
+
+    if (write_ard_compact_metadata_buf (cmeta, &xbuf) != SUCCESS ||
+        write_ard_xml_buf_file (&xbuf, xml_file) != SUCCESS)
+    {
+        free_ard_xml_buf (&xbuf);
+        sprintf (errmsg, "Writing the compact metadata to %s", xml_file);
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        return (ERROR);
+    }
+
+    /* Free the buffer */
+    free_ard_xml_buf (&xbuf);
+
+    /* Successful generation */
+    return (SUCCESS);
+}
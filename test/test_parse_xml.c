@@ -34,12 +34,19 @@ NOTES:
 void usage ()
 {
     printf ("test_parse_xml parses the input XML file");
-    printf ("usage: test_parse_xml --xml=input_ard_metadata_filename\n");
+    printf ("usage: test_parse_xml --xml=input_ard_metadata_filename "
+            "[--stream] [--arena]\n");
 
     printf ("\nwhere the following parameters are required:\n");
     printf ("    -xml: name of the input ARD XML metadata file which follows "
             "the ARD schema (format defined in the ARD DFCB)\n");
 
+    printf ("\nwhere the following parameters are optional:\n");
+    printf ("    -stream: parse the XML file in a single streaming pass "
+            "rather than building the full document tree\n");
+    printf ("    -arena: allocate the band metadata from an arena which is "
+            "freed all at once\n");
+
     printf ("\nExample: test_parse_xml "
             "--xml=LE07_CU_019002_19991006_20170307_C01_V01.xml\n");
     printf ("This parses the specified ARD XML file.\n");
@@ -69,16 +76,22 @@ short get_args
 (
     int argc,             /* I: number of cmd-line args */
     char *argv[],         /* I: string of cmd-line args */
-    char **xml_infile     /* O: address of input XML filename */
+    char **xml_infile,    /* O: address of input XML filename */
+    bool *stream,         /* O: use the streaming parser? */
+    bool *arena           /* O: allocate from an arena? */
 )
 {
     int c;                           /* current argument index */
     int option_index;                /* index for the command-line option */
     char errmsg[STR_SIZE];           /* error message */
     char FUNC_NAME[] = "get_args";   /* function name */
+    static int stream_flag = 0;      /* flag for the streaming parser */
+    static int arena_flag = 0;       /* flag for the arena */
     static struct option long_options[] =
     {
         {"xml", required_argument, 0, 'i'},
+        {"stream", no_argument, &stream_flag, 1},
+        {"arena", no_argument, &arena_flag, 1},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
@@ -130,6 +143,10 @@ short get_args
         return (ERROR);
     }
 
+    /* Check the streaming and arena flags */
+    *stream = (stream_flag != 0);
+    *arena = (arena_flag != 0);
+
     return (SUCCESS);
 }
 
@@ -153,11 +170,17 @@ int main (int argc, char** argv)
 //    char FUNC_NAME[] = "test_parse_xml";  /* function name */
 //    char errmsg[STR_SIZE];       /* error message */
     char *xml_infile = NULL;     /* input XML filename */
+    bool stream = false;         /* use the streaming parser? */
+    bool use_arena = false;      /* allocate from an arena? */
+    Ard_arena_t arena;           /* arena for the band metadata */
+    int status;                  /* return status */
+    Ard_parse_ctx_t ctx;         /* parser context for the streaming parser */
     Ard_meta_t ard_meta;         /* XML metadata structure to be populated by
                                     reading the input XML metadata file */
 
     /* Read the command-line arguments */
-    if (get_args (argc, argv, &xml_infile) != SUCCESS)
+    if (get_args (argc, argv, &xml_infile, &stream, &use_arena)
+        != SUCCESS)
     {   /* get_args already printed the error message */
         exit (ERROR);
     }
@@ -171,11 +194,27 @@ int main (int argc, char** argv)
 
     /* Initialize the metadata structure */
     init_ard_metadata_struct (&ard_meta);
+    if (use_arena)
+    {
+        init_ard_arena (&arena, 0);
+        set_ard_metadata_arena (&ard_meta, &arena);
+    }
 
     /* Parse the metadata file into our internal metadata structure; also
        allocates space as needed for various pointers in the global and band
        metadata */
-    if (parse_ard_metadata (xml_infile, &ard_meta) != SUCCESS)
+    if (stream)
+    {
+        if (init_ard_parse_ctx (&ctx) != SUCCESS)
+        {  /* Error messages already written */
+            return (ERROR);
+        }
+        status = parse_ard_metadata_stream (&ctx, xml_infile, &ard_meta);
+        free_ard_parse_ctx (&ctx);
+    }
+    else
+        status = parse_ard_metadata (xml_infile, &ard_meta);
+    if (status != SUCCESS)
     {  /* Error messages already written */
         return (ERROR);
     }
@@ -186,6 +225,8 @@ int main (int argc, char** argv)
 
     /* Free the input XML metadata */
     free_ard_metadata (&ard_meta);
+    if (use_arena)
+        free_ard_arena (&arena);
 
     /* Free the pointers */
     free (xml_infile);
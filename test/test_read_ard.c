@@ -16,7 +16,8 @@ NOTES:
      https://landsat.usgs.gov/ard/ard_metadata_vX_X.xsd
 *****************************************************************************/
 #include <getopt.h>
-#include "ard_tiff_io.h"
+#include "ard_tiff_cog_io.h"
+#include "ard_tiff_threaded_io.h"
 
 /******************************************************************************
 MODULE: usage
@@ -32,11 +33,37 @@ void usage ()
 {
     printf ("test_read_ard parses the XML, reads the Tiff files, and writes "
             "back out the GeoTiff test files to duplicate each band.\n\n");
-    printf ("usage: test_read_ard --xml=xml_filename\n");
+    printf ("usage: test_read_ard --xml=xml_filename "
+            "[--compress=codec] [--level=level] [--predictor=predictor] "
+            "[--overviews=noverviews] [--resample=resampling] "
+            "[--row_block=nlines] [--stats] [--prefetch=ntiles] "
+            "[--product]\n");
 
     printf ("\nwhere the following parameters are required:\n");
     printf ("    -xml: name of the input XML metadata file which follows "
             "the ARD schema\n");
+    printf ("\nwhere the following parameters are optional:\n");
+    printf ("    -compress: compression codec for the output bands; none, "
+            "lzw, deflate, zstd, lzma, or lerc (default is deflate)\n");
+    printf ("    -level: compression level for deflate, zstd, or lzma "
+            "(default is the codec default)\n");
+    printf ("    -predictor: predictor for the output bands; auto, none, "
+            "horizontal, or float (default is horizontal)\n");
+    printf ("    -overviews: write the output bands as cloud-optimized "
+            "GeoTiffs with this many overviews; auto to keep adding "
+            "overviews until the smallest fits in a tile\n");
+    printf ("    -resample: resampling for the overviews; nearest or "
+            "average (default is nearest)\n");
+    printf ("    -row_block: write the output bands incrementally, this many "
+            "lines at a time (default is to write the entire band at "
+            "once)\n");
+    printf ("    -stats: print the min, max, mean, and standard deviation "
+            "of each band as it is read, leaving out the fill pixels\n");
+    printf ("    -prefetch: number of tiles to prefetch ahead of the reads "
+            "(default is no prefetching)\n");
+    printf ("    -product: read all the bands, then write them together, "
+            "concurrently; the bands need to have the same tile size "
+            "(default is to write each band after reading it)\n");
     printf ("\nExample: test_read_ard "
             "--xml=LT05_CU_003009_20110702_20170430_C01_V01_SR\n");
 }
@@ -65,7 +92,15 @@ short get_args
 (
     int argc,             /* I: number of cmd-line args */
     char *argv[],         /* I: string of cmd-line args */
-    char **xml_infile     /* O: address of input XML filename */
+    char **xml_infile,    /* O: address of input XML filename */
+    Ard_tiff_write_opts_t *opts, /* O: Tiff write options */
+    bool *cog,            /* O: write cloud-optimized GeoTiffs? */
+    Ard_tiff_overview_opts_t *ovr_opts, /* O: overview options */
+    int *row_block,       /* O: number of lines to write at a time; 0 for
+                                the entire band */
+    bool *stats,          /* O: print the statistics of each band? */
+    int *prefetch,        /* O: number of tiles to prefetch ahead */
+    bool *product         /* O: write all the bands together? */
 )
 {
     int c;                           /* current argument index */
@@ -75,6 +110,15 @@ short get_args
     static struct option long_options[] =
     {
         {"xml", required_argument, 0, 'i'},
+        {"compress", required_argument, 0, 'c'},
+        {"level", required_argument, 0, 'l'},
+        {"predictor", required_argument, 0, 'p'},
+        {"overviews", required_argument, 0, 'o'},
+        {"resample", required_argument, 0, 'r'},
+        {"row_block", required_argument, 0, 'b'},
+        {"stats", no_argument, 0, 's'},
+        {"prefetch", required_argument, 0, 'f'},
+        {"product", no_argument, 0, 'w'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
@@ -106,7 +150,89 @@ short get_args
             case 'i':  /* XML infile */
                 *xml_infile = strdup (optarg);
                 break;
+
+            case 'c':  /* compression codec */
+                if (!strcmp (optarg, "none"))
+                    opts->codec = ARD_CODEC_NONE;
+                else if (!strcmp (optarg, "lzw"))
+                    opts->codec = ARD_CODEC_LZW;
+                else if (!strcmp (optarg, "deflate"))
+                    opts->codec = ARD_CODEC_DEFLATE;
+                else if (!strcmp (optarg, "zstd"))
+                    opts->codec = ARD_CODEC_ZSTD;
+                else if (!strcmp (optarg, "lzma"))
+                    opts->codec = ARD_CODEC_LZMA;
+                else if (!strcmp (optarg, "lerc"))
+                    opts->codec = ARD_CODEC_LERC;
+                else
+                {
+                    sprintf (errmsg, "Unknown compression codec %s", optarg);
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    usage ();
+                    return (ERROR);
+                }
+                break;
+
+            case 'l':  /* compression level */
+                opts->level = atoi (optarg);
+                break;
+
+            case 'p':  /* predictor */
+                if (!strcmp (optarg, "auto"))
+                    opts->predictor = ARD_PREDICTOR_AUTO;
+                else if (!strcmp (optarg, "none"))
+                    opts->predictor = ARD_PREDICTOR_NONE;
+                else if (!strcmp (optarg, "horizontal"))
+                    opts->predictor = ARD_PREDICTOR_HORIZONTAL;
+                else if (!strcmp (optarg, "float"))
+                    opts->predictor = ARD_PREDICTOR_FLOAT;
+                else
+                {
+                    sprintf (errmsg, "Unknown predictor %s", optarg);
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    usage ();
+                    return (ERROR);
+                }
+                break;
      
+            case 'o':  /* number of overviews */
+                *cog = true;
+                if (!strcmp (optarg, "auto"))
+                    ovr_opts->noverviews = ARD_COG_AUTO_OVERVIEWS;
+                else
+                    ovr_opts->noverviews = atoi (optarg);
+                break;
+
+            case 'r':  /* overview resampling */
+                if (!strcmp (optarg, "nearest"))
+                    ovr_opts->resample = ARD_RESAMPLE_NEAREST;
+                else if (!strcmp (optarg, "average"))
+                    ovr_opts->resample = ARD_RESAMPLE_AVERAGE;
+                else
+                {
+                    sprintf (errmsg, "Unknown resampling %s", optarg);
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    usage ();
+                    return (ERROR);
+                }
+                break;
+
+            case 'b':  /* lines to write at a time */
+                *row_block = atoi (optarg);
+                break;
+
+            case 's':  /* print the band statistics */
+                *stats = true;
+                break;
+
+            case 'f':  /* tiles to prefetch ahead */
+                *prefetch = atoi (optarg);
+                break;
+
+            case 'w':  /* write all the bands together */
+                *product = true;
+                break;
+
             case '?':
             default:
                 sprintf (errmsg, "Unknown option %s", argv[optind-1]);
@@ -126,6 +252,16 @@ short get_args
         return (ERROR);
     }
 
+    /* The bands are written together with the default writer */
+    if (*product && (*cog || *row_block > 0))
+    {
+        sprintf (errmsg, "--product can't be used with --overviews or "
+            "--row_block");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        usage ();
+        return (ERROR);
+    }
+
     return (SUCCESS);
 }
 
@@ -170,12 +306,35 @@ int main (int argc, char** argv)
                                           metadata structure */
     Ard_band_meta_t *bmeta = NULL;     /* pointer to current band metadata */
     TIFF *tif_fptr = NULL;             /* file pointer for Tiff file */
+    Ard_tiff_write_opts_t opts;        /* Tiff write options */
+    Ard_tiff_overview_opts_t ovr_opts; /* overview options */
+    Ard_tiff_read_opts_t read_opts;    /* Tiff read options */
+    bool cog = false;                  /* write cloud-optimized GeoTiffs? */
+    int row_block = 0;                 /* number of lines to write at a
+                                          time; 0 for the entire band */
+    int line;                          /* current line of the band */
+    int nbytes;                        /* number of bytes per pixel */
+    Ard_tiff_writer_t writer;          /* incremental Tiff writer */
+    bool stats = false;                /* print the band statistics? */
+    Ard_tiff_stats_t band_stats;       /* statistics for the current band */
+    int prefetch = 0;                  /* number of tiles to prefetch ahead */
+    bool product = false;              /* write all the bands together? */
+    void **band_bufs = NULL;           /* image buffer for each band, when
+                                          writing the bands together */
+
+    /* Default to the same compression as ard_set_tiff_tags */
+    init_ard_tiff_write_opts (&opts);
+    opts.predictor = ARD_PREDICTOR_HORIZONTAL;
+    init_ard_tiff_overview_opts (&ovr_opts);
 
     /* Read the command-line arguments */
-    if (get_args (argc, argv, &xml_infile) != SUCCESS)
+    if (get_args (argc, argv, &xml_infile, &opts, &cog, &ovr_opts,
+        &row_block, &stats, &prefetch, &product) != SUCCESS)
     {   /* get_args already printed the error message */
         exit (EXIT_FAILURE);
     }
+    init_ard_tiff_read_opts (&read_opts);
+    read_opts.prefetch = prefetch;
 
     /* Validate the input metadata file */
     if (validate_ard_xml_file (xml_infile) != SUCCESS)
@@ -195,6 +354,18 @@ int main (int argc, char** argv)
     }
     gmeta = &xml_metadata.tile_meta.tile_global;
 
+    /* Hold on to each band when writing the bands together */
+    if (product)
+    {
+        band_bufs = calloc (xml_metadata.tile_meta.nbands, sizeof (void *));
+        if (band_bufs == NULL)
+        {
+            sprintf (errmsg, "Unable to allocate memory for the bands");
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            exit (EXIT_FAILURE);
+        }
+    }
+
     /* Loop through each band in the XML file */
     for (i = 0; i < xml_metadata.tile_meta.nbands; i++)
     {
@@ -250,12 +421,28 @@ int main (int argc, char** argv)
         {  /* Error messages already written */
             exit (EXIT_FAILURE);
         }
+        ard_set_tiff_read_opts (tif_fptr, &read_opts);
         TIFFGetField(tif_fptr, TIFFTAG_TILEWIDTH, &t_nsamps);
         TIFFGetField(tif_fptr, TIFFTAG_TILELENGTH, &t_nlines);
 
-        /* Read the current band */
-        status = ard_read_tiff (tif_fptr, bmeta->data_type, bmeta->nlines,
-            bmeta->nsamps, band_buffer);
+        /* Read the current band, gathering the statistics on the way if
+           they were requested */
+        if (stats)
+        {
+            init_ard_tiff_stats (&band_stats);
+            band_stats.use_fill = (bmeta->fill_value != ARD_INT_META_FILL);
+            band_stats.fill_value = bmeta->fill_value;
+            status = ard_read_tiff_stats (tif_fptr, bmeta->data_type,
+                bmeta->nlines, bmeta->nsamps, band_buffer, &band_stats);
+            if (status == SUCCESS)
+                printf ("    min %g, max %g, mean %g, stddev %g (%lu valid, "
+                    "%lu fill)\n", band_stats.min, band_stats.max,
+                    band_stats.mean, band_stats.stddev, band_stats.nvalid,
+                    band_stats.nfill);
+        }
+        else
+            status = ard_read_tiff (tif_fptr, bmeta->data_type,
+                bmeta->nlines, bmeta->nsamps, band_buffer);
         if (status != SUCCESS)
         {
             sprintf (errmsg, "Error reading the Tiff file %s",
@@ -267,6 +454,27 @@ int main (int argc, char** argv)
         /* Close the input Tiff file */
         ard_close_tiff (tif_fptr);
 
+        /* Keep the band to write with the others.  The bands are all
+           written with the same options, so they need to have the same
+           tile size as the first input Tiff. */
+        if (product)
+        {
+            if (i > 0 && (t_nlines != opts.t_nlines ||
+                t_nsamps != opts.t_nsamps))
+            {
+                sprintf (errmsg, "Band %d has %d x %d tiles, but band 0 has "
+                    "%d x %d tiles; --product needs the same tile size for "
+                    "all the bands", i, t_nlines, t_nsamps, opts.t_nlines,
+                    opts.t_nsamps);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                exit (EXIT_FAILURE);
+            }
+            band_bufs[i] = band_buffer;
+            opts.t_nlines = t_nlines;
+            opts.t_nsamps = t_nsamps;
+            continue;
+        }
+
         /* Open the output band as a Tiff file for writing */
         sprintf (outname, "output/%s", bmeta->file_name);
         tif_fptr = ard_open_tiff (outname, "w");
@@ -278,20 +486,22 @@ int main (int argc, char** argv)
         /* Set the Tiff tags before writing so the Tiff library knows the
            specifics of the band.  Pull the tile size from the input Tiff
            and use that for the output Tiff. */
-        ard_set_tiff_tags (tif_fptr, bmeta->data_type, bmeta->nlines,
-            bmeta->nsamps, t_nlines, t_nsamps);
-
-        /* Write the current band to the output directory */
-        status = ard_write_tiff (tif_fptr, bmeta->data_type, bmeta->nlines,
-            bmeta->nsamps, band_buffer);
-        if (status != SUCCESS)
+        opts.t_nlines = t_nlines;
+        opts.t_nsamps = t_nsamps;
+        if (ard_set_tiff_tags_opts (tif_fptr, bmeta->data_type,
+            bmeta->nlines, bmeta->nsamps, &opts) != SUCCESS)
         {
-            sprintf (errmsg, "Error writing the Tiff file %s", outname);
+            /* Bound the file name so the message always fits */
+            snprintf (errmsg, sizeof (errmsg),
+                "Error setting the Tiff tags for %.*s", STR_SIZE - 64,
+                outname);
             ard_error_handler (true, FUNC_NAME, errmsg);
             exit (EXIT_FAILURE);
         }
 
-        /* Write the GeoTiff tags */
+        /* Write the GeoTiff tags.  These need to be set before writing a
+           cloud-optimized GeoTiff, since its directories are written
+           before the image data. */
         status = ard_set_geotiff_tags (tif_fptr, bmeta, &gmeta->proj_info);
         if (status != SUCCESS)
         {
@@ -300,6 +510,42 @@ int main (int argc, char** argv)
             exit (EXIT_FAILURE);
         }
 
+        /* Write the current band to the output directory.  Leave the fill
+           pixels out of the overview averages. */
+        if (cog)
+        {
+            ovr_opts.use_fill = (bmeta->fill_value != ARD_INT_META_FILL);
+            ovr_opts.fill_value = bmeta->fill_value;
+            status = ard_write_tiff_cog (tif_fptr, bmeta->data_type,
+                bmeta->nlines, bmeta->nsamps, &opts, &ovr_opts, band_buffer);
+        }
+        else if (row_block > 0)
+        {
+            nbytes = ard_data_type_size (bmeta->data_type);
+            status = ard_open_tiff_writer (tif_fptr, bmeta->data_type,
+                bmeta->nlines, bmeta->nsamps, &writer);
+            for (line = 0; status == SUCCESS && line < bmeta->nlines;
+                 line += row_block)
+            {
+                status = ard_write_tiff_rows (&writer,
+                    (line + row_block > bmeta->nlines) ?
+                        bmeta->nlines - line : row_block,
+                    (uint8_t *) band_buffer +
+                        (size_t) line * bmeta->nsamps * nbytes, 0);
+            }
+            if (ard_finish_tiff_writer (&writer) != SUCCESS)
+                status = ERROR;
+        }
+        else
+            status = ard_write_tiff (tif_fptr, bmeta->data_type,
+                bmeta->nlines, bmeta->nsamps, band_buffer);
+        if (status != SUCCESS)
+        {
+            sprintf (errmsg, "Error writing the Tiff file %s", outname);
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            exit (EXIT_FAILURE);
+        }
+
         /* Close the output Tiff file */
         ard_close_tiff (tif_fptr);
 
@@ -307,6 +553,23 @@ int main (int argc, char** argv)
         free (band_buffer);
     }
 
+    /* Write all the bands to the output directory together */
+    if (product)
+    {
+        if (ard_write_tile_bands (&xml_metadata.tile_meta, band_bufs,
+            "output", &opts, 0) != SUCCESS)
+        {
+            sprintf (errmsg, "Error writing the bands to the output "
+                "directory");
+            ard_error_handler (true, FUNC_NAME, errmsg);
+            exit (EXIT_FAILURE);
+        }
+
+        for (i = 0; i < xml_metadata.tile_meta.nbands; i++)
+            free (band_bufs[i]);
+        free (band_bufs);
+    }
+
     /* Free the metadata structure */
     free_ard_metadata (&xml_metadata);
 
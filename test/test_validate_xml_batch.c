@@ -0,0 +1,223 @@
+/*****************************************************************************
+FILE: test_validate_xml_batch
+
+PURPOSE: Tests the batch validation of ARD XML files using a single compiled
+schema validator.
+
+PROJECT:  Land Satellites Data System Science Research and Development (LSRD)
+at the USGS EROS
+
+LICENSE TYPE:  NASA Open Source Agreement Version 1.3
+
+NOTES:
+*****************************************************************************/
+#include <getopt.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "ard_metadata.h"
+#include "ard_error_handler.h"
+
+/* Maximum number of XML files which can be specified */
+#define MAX_XML_FILES 1000
+
+/******************************************************************************
+MODULE: usage
+
+PURPOSE: Prints the usage information for this application.
+
+RETURN VALUE:
+Type = None
+
+NOTES:
+******************************************************************************/
+void usage ()
+{
+    printf ("test_validate_xml_batch validates the input XML files against "
+            "one compiled schema\n");
+    printf ("usage: test_validate_xml_batch "
+            "--xml=input_ard_metadata_filename [--xml=...] "
+            "[--threads=nthreads]\n");
+
+    printf ("\nwhere the following parameters are required:\n");
+    printf ("    -xml: name of the input ARD XML metadata file which follows "
+            "the ARD schema (format defined in the ARD DFCB); may be "
+            "specified multiple times\n");
+
+    printf ("\nwhere the following parameters are optional:\n");
+    printf ("    -threads: number of threads to use for validation (default "
+            "is the OpenMP default)\n");
+
+    printf ("\nExample: test_validate_xml_batch "
+            "--xml=LE07_CU_019002_19991006_20170307_C01_V01.xml "
+            "--xml=LE07_CU_019002_19991022_20170307_C01_V01.xml\n");
+    printf ("This validates that the specified ARD XML files meet the "
+            "specifications outlined in the ARD schema.\n");
+}
+
+
+/******************************************************************************
+MODULE:  get_args
+
+PURPOSE:  Gets the command-line arguments and validates that the required
+arguments were specified.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error getting the command-line arguments or a command-line
+                argument and associated value were not specified
+SUCCESS         No errors encountered
+
+NOTES:
+  1. Memory is allocated for the input files.  The caller is responsible
+     for freeing the allocated memory upon successful return.
+******************************************************************************/
+short get_args
+(
+    int argc,             /* I: number of cmd-line args */
+    char *argv[],         /* I: string of cmd-line args */
+    int *nfiles,          /* O: number of input XML files */
+    char **xml_infiles,   /* O: array of input XML filenames */
+    int *nthreads         /* O: number of threads to use */
+)
+{
+    int c;                           /* current argument index */
+    int option_index;                /* index for the command-line option */
+    char errmsg[STR_SIZE];           /* error message */
+    char FUNC_NAME[] = "get_args";   /* function name */
+    static struct option long_options[] =
+    {
+        {"xml", required_argument, 0, 'i'},
+        {"threads", required_argument, 0, 't'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    /* Loop through all the cmd-line options */
+    opterr = 0;   /* turn off getopt_long error msgs as we'll print our own */
+    while (1)
+    {
+        /* optstring in call to getopt_long is empty since we will only
+           support the long options */
+        c = getopt_long (argc, argv, "", long_options, &option_index);
+        if (c == -1)
+        {   /* Out of cmd-line options */
+            break;
+        }
+
+        switch (c)
+        {
+            case 0:
+                /* If this option set a flag, do nothing else now. */
+                if (long_options[option_index].flag != 0)
+                    break;
+
+            case 'h':  /* help */
+                usage ();
+                return (ERROR);
+                break;
+
+            case 'i':  /* XML file */
+                if (*nfiles >= MAX_XML_FILES)
+                {
+                    sprintf (errmsg, "Too many XML files specified (max %d)",
+                        MAX_XML_FILES);
+                    ard_error_handler (true, FUNC_NAME, errmsg);
+                    return (ERROR);
+                }
+                xml_infiles[(*nfiles)++] = strdup (optarg);
+                break;
+
+            case 't':  /* number of threads */
+                *nthreads = atoi (optarg);
+                break;
+
+            case '?':
+            default:
+                sprintf (errmsg, "Unknown option %s", argv[optind-1]);
+                ard_error_handler (true, FUNC_NAME, errmsg);
+                usage ();
+                return (ERROR);
+                break;
+        }
+    }
+
+    /* Make sure at least one XML file was specified */
+    if (*nfiles == 0)
+    {
+        sprintf (errmsg, "Input XML file is a required argument");
+        ard_error_handler (true, FUNC_NAME, errmsg);
+        usage ();
+        return (ERROR);
+    }
+
+    return (SUCCESS);
+}
+
+
+/******************************************************************************
+MODULE:  main
+
+PURPOSE: Grabs the input XML files and validates them against the ARD schema,
+compiling the schema only once.
+
+RETURN VALUE:
+Type = int
+Value           Description
+-----           -----------
+ERROR           Error validating one or more of the XML files
+SUCCESS         No errors encountered
+
+NOTES:
+******************************************************************************/
+int main (int argc, char** argv)
+{
+    int i;                       /* looping variable */
+    int nfiles = 0;              /* number of input XML files */
+    int nthreads = 0;            /* number of threads to use */
+    int status;                  /* return status */
+    char *xml_infiles[MAX_XML_FILES]; /* input XML filenames */
+    int file_status[MAX_XML_FILES];   /* validation status of each file */
+    Ard_validator_t *validator = NULL;  /* compiled schema validator */
+
+    /* Read the command-line arguments */
+    if (get_args (argc, argv, &nfiles, xml_infiles, &nthreads) != SUCCESS)
+    {   /* get_args already printed the error message */
+        exit (ERROR);
+    }
+    printf ("TEST batch validation of %d XML files\n", nfiles);
+
+    /* Compile the schema once for all the files */
+    validator = create_ard_validator (NULL);
+    if (validator == NULL)
+    {  /* Error messages already written */
+        exit (ERROR);
+    }
+
+    /* Validate the input metadata files */
+    status = validate_ard_xml_files (validator, nfiles, xml_infiles,
+        nthreads, file_status);
+    for (i = 0; i < nfiles; i++)
+    {
+        printf ("%s: %s\n", xml_infiles[i],
+            file_status[i] == SUCCESS ? "valid" : "INVALID");
+        free (xml_infiles[i]);
+    }
+
+    /* Free the validator and clean up the XML library */
+    free_ard_validator (validator);
+    xmlCleanupParser ();
+
+    if (status != SUCCESS)
+    {  /* Error messages already written */
+        exit (ERROR);
+    }
+
+    /* Successful completion */
+    printf ("Files successfully validated\n");
+    exit (SUCCESS);
+}
@@ -15,6 +15,8 @@ NOTES:
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "ard_metadata.h"
 #include "ard_error_handler.h"
@@ -37,12 +39,19 @@ void usage ()
     printf ("test_write_xml parses the input XML file and then writes it "
             "back out to a new XML file to allow them to be compared.");
     printf ("usage: test_write_xml "
-            "--xml=input_ard_metadata_filename\n");
+            "--xml=input_ard_metadata_filename [--compact] "
+            "[--buffer_size=nbytes]\n");
 
     printf ("\nwhere the following parameters are required:\n");
     printf ("    -xml: name of the input ARD XML metadata file which follows "
             "the ARD schema (format defined in the ARD DFCB)\n");
 
+    printf ("\nwhere the following parameters are optional:\n");
+    printf ("    -compact: parse and write the XML file using the compact "
+            "metadata representation\n");
+    printf ("    -buffer_size: serialize the XML into a caller-supplied buffer "
+            "of this many bytes, then write the buffer to the file\n");
+
     printf ("\nExample: test_write_xml "
             "--xml=LE07_CU_019002_19991006_20170307_C01_V01.xml\n");
     printf ("This reads the input XML and then writes it back out as "
@@ -73,16 +82,22 @@ short get_args
 (
     int argc,             /* I: number of cmd-line args */
     char *argv[],         /* I: string of cmd-line args */
-    char **xml_infile     /* O: address of input XML filename */
+    char **xml_infile,    /* O: address of input XML filename */
+    bool *compact,        /* O: use the compact metadata? */
+    long *buffer_size     /* O: size of the caller-supplied XML buffer; 0 if
+                                not used */
 )
 {
     int c;                           /* current argument index */
     int option_index;                /* index for the command-line option */
     char errmsg[STR_SIZE];           /* error message */
     char FUNC_NAME[] = "get_args";   /* function name */
+    static int compact_flag = 0;     /* flag for the compact metadata */
     static struct option long_options[] =
     {
         {"xml", required_argument, 0, 'i'},
+        {"compact", no_argument, &compact_flag, 1},
+        {"buffer_size", required_argument, 0, 'b'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
@@ -114,6 +129,10 @@ short get_args
             case 'i':  /* XML file */
                 *xml_infile = strdup (optarg);
                 break;
+
+            case 'b':  /* XML buffer size */
+                *buffer_size = atol (optarg);
+                break;
      
             case '?':
             default:
@@ -134,6 +153,9 @@ short get_args
         return (ERROR);
     }
 
+    /* Check the compact flag */
+    *compact = (compact_flag != 0);
+
     return (SUCCESS);
 }
 
@@ -159,11 +181,20 @@ int main (int argc, char** argv)
     char *cptr = NULL;           /* pointer to file extension */
     char *xml_infile = NULL;     /* input XML filename */
     char xml_outfile[STR_SIZE];  /* output XML filename */
+    bool compact = false;        /* use the compact metadata? */
+    long buffer_size = 0;        /* size of the caller-supplied XML buffer */
+    int status;                  /* return status */
+    int fd;                      /* file descriptor for the output file */
+    char *mem = NULL;            /* caller-supplied XML buffer */
+    Ard_xml_buf_t xbuf;          /* XML buffer using the supplied memory */
+    Ard_parse_ctx_t ctx;         /* parser context for the compact metadata */
+    Ard_string_pool_t pool;      /* string pool for the compact metadata */
+    Ard_compact_meta_t cmeta;    /* compact metadata */
     Ard_meta_t ard_meta;         /* XML metadata structure to be populated by
                                     reading the input XML metadata file */
 
     /* Read the command-line arguments */
-    if (get_args (argc, argv, &xml_infile) != SUCCESS)
+    if (get_args (argc, argv, &xml_infile, &compact, &buffer_size) != SUCCESS)
     {   /* get_args already printed the error message */
         exit (ERROR);
     }
@@ -175,13 +206,26 @@ int main (int argc, char** argv)
         return (ERROR);
     }
 
-    /* Initialize the metadata structure */
+    /* Initialize the metadata structures */
     init_ard_metadata_struct (&ard_meta);
+    if (compact)
+    {
+        if (init_ard_string_pool (&pool) != SUCCESS ||
+            init_ard_parse_ctx (&ctx) != SUCCESS)
+        {  /* Error messages already written */
+            return (ERROR);
+        }
+        init_ard_compact_metadata (&cmeta, &pool);
+    }
 
     /* Parse the metadata file into our internal metadata structure; also
        allocates space as needed for various pointers in the global and band
        metadata */
-    if (parse_ard_metadata (xml_infile, &ard_meta) != SUCCESS)
+    if (compact)
+        status = parse_ard_compact_metadata (&ctx, xml_infile, &cmeta);
+    else
+        status = parse_ard_metadata (xml_infile, &ard_meta);
+    if (status != SUCCESS)
     {  /* Error messages already written */
         return (ERROR);
     }
@@ -193,13 +237,48 @@ int main (int argc, char** argv)
 
     /* Write the metadata to a new output XML file */
     printf ("Writing ARD metadata to %s\n", xml_outfile);
-    if (write_ard_metadata (&ard_meta, xml_outfile) != SUCCESS)
+    if (buffer_size > 0)
+    {
+        /* Serialize into the supplied buffer, then write it in one call */
+        mem = malloc (buffer_size);
+        if (mem == NULL)
+            return (ERROR);
+        init_ard_xml_buf_fixed (&xbuf, mem, buffer_size, NULL);
+        if (compact)
+            status = write_ard_compact_metadata_buf (&cmeta, &xbuf);
+        else
+            status = write_ard_metadata_buf (&ard_meta, &xbuf);
+        if (status == SUCCESS)
+        {
+            printf ("Serialized %ld bytes of XML\n", (long) xbuf.len);
+            fd = open (xml_outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+                status = ERROR;
+            else
+            {
+                status = write_ard_xml_buf_fd (&xbuf, fd);
+                close (fd);
+            }
+        }
+        free (mem);
+    }
+    else if (compact)
+        status = write_ard_compact_metadata (&cmeta, xml_outfile);
+    else
+        status = write_ard_metadata (&ard_meta, xml_outfile);
+    if (status != SUCCESS)
     {  /* Error messages already written */
         return (ERROR);
     }
 
     /* Free the input and output XML metadata */
     free_ard_metadata (&ard_meta);
+    if (compact)
+    {
+        free_ard_compact_metadata (&cmeta);
+        free_ard_string_pool (&pool);
+        free_ard_parse_ctx (&ctx);
+    }
 
     /* Free the pointers */
     free (xml_infile);